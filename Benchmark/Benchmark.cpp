@@ -0,0 +1,416 @@
+#include "BenchmarkApp.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+
+// CMakeŃrhꍇ̓VF[_[̏o͐Ȃǂ𐶐wb_[擾
+#ifdef HAS_SHADER_BUILD_H
+#include "ShaderBuild.h"
+#endif
+
+#ifndef BENCHMARK_SHADER_DIR
+#define BENCHMARK_SHADER_DIR "shaders"
+#endif
+
+// zbg[hɊĎ\[XƍăRpC̃R}h (CMakeŐݒ肷)
+#ifndef BENCHMARK_SHADER_SOURCE_DIR
+#define BENCHMARK_SHADER_SOURCE_DIR ""
+#endif
+#ifndef BENCHMARK_SHADER_COMPILE_COMMAND
+#define BENCHMARK_SHADER_COMPILE_COMMAND ""
+#endif
+
+// R}hC̐ݒ
+struct BenchmarkOptions
+{
+	BenchmarkScene scene;
+	uint32_t width = 1280;
+	uint32_t height = 720;
+	uint32_t warmupFrames = 30;		// v珜t[ (pCvC⃁̏̏)
+	uint32_t frames = 300;
+	uint32_t framesInFlight = AppBase::MinFramesInFlight;
+	uint32_t threads = 0;			// 0̏ꍇ̓RA
+	std::string shaderDirectory = BENCHMARK_SHADER_DIR;
+	std::string jsonPath = "benchmark.json";
+	std::string csvPath;			// w肵ꍇ1sǋL
+	bool hotReload = false;			// VF[_[̕ҏW`撆ɔf (vɂ͎gȂ)
+};
+
+// Ot̃V[ (--draws ȂǂŌʂɏ㏑ł)
+static bool ApplyScenePreset(const std::string& name, BenchmarkScene& scene)
+{
+	struct Preset
+	{
+		BenchmarkScene::Type type;
+		uint32_t draws;
+		uint32_t instances;
+	};
+	typedef BenchmarkScene::Type Type;
+	static const std::map<std::string, Preset> presets = {
+		{ "empty", { Type::Quads, 0, 1 } },			// `Ȃ (t[̌Œ̕)
+		{ "light", { Type::Quads, 100, 1 } },
+		{ "default", { Type::Quads, 1000, 1 } },
+		{ "heavy", { Type::Quads, 10000, 1 } },		// `R}h̋L^̕
+		{ "instanced", { Type::Quads, 100, 1000 } },	// GPU̒_̕
+		{ "objects", { Type::Objects, 20000, 1 } },	// t[̃^XN (XVEJOEL^) ̕
+		{ "gpu_driven", { Type::GpuDriven, 20000, 1 } },	// objectsƓV[GPUŃJOĊԐڕ`悷
+		{ "deferred", { Type::Deferred, 5000, 1 } },	// G-bufferƓ_̃CeBO (--lightsœ_̐)
+	};
+	auto found = presets.find(name);
+	if (found == presets.end())
+	{
+		return false;
+	}
+	scene.name = name;
+	scene.type = found->second.type;
+	scene.draws = found->second.draws;
+	scene.instances = found->second.instances;
+	return true;
+}
+
+static const char* GetSceneTypeName(BenchmarkScene::Type type)
+{
+	switch (type)
+	{
+	case BenchmarkScene::Type::Objects: return "objects";
+	case BenchmarkScene::Type::GpuDriven: return "gpu_driven";
+	case BenchmarkScene::Type::Deferred: return "deferred";
+	default: return "quads";
+	}
+}
+
+static void PrintUsage()
+{
+	std::printf(
+		"usage: vulkan_practice_benchmark [options]\n"
+		"  --scene <empty|light|default|heavy|instanced|objects|gpu_driven|deferred>\n"
+		"  --draws <n> --instances <n> --lights <n> --seed <n>\n"
+		"  --width <n> --height <n>\n"
+		"  --frames <n> --warmup <n> --frames-in-flight <n> --threads <n>\n"
+		"  --shaders <dir> --json <path> --csv <path>\n"
+		"  --hot-reload\n");
+}
+
+static bool ParseOptions(int argc, char** argv, BenchmarkOptions& options)
+{
+	for (int i = 1; i < argc; ++i)
+	{
+		const std::string key = argv[i];
+		if (key == "--hot-reload")
+		{
+			options.hotReload = true;
+			continue;
+		}
+		if (key == "--help" || i + 1 >= argc)
+		{
+			return false;
+		}
+
+		const std::string value = argv[++i];
+		const auto number = uint32_t(std::strtoul(value.c_str(), nullptr, 10));
+		if (key == "--scene")
+		{
+			if (!ApplyScenePreset(value, options.scene))
+			{
+				return false;
+			}
+		}
+		else if (key == "--draws") options.scene.draws = number;
+		else if (key == "--instances") options.scene.instances = (std::max)(number, 1u);
+		else if (key == "--lights") options.scene.lights = number;
+		else if (key == "--seed") options.scene.seed = number;
+		else if (key == "--width") options.width = (std::max)(number, 1u);
+		else if (key == "--height") options.height = (std::max)(number, 1u);
+		else if (key == "--frames") options.frames = (std::max)(number, 1u);
+		else if (key == "--warmup") options.warmupFrames = number;
+		else if (key == "--frames-in-flight") options.framesInFlight = number;
+		else if (key == "--threads") options.threads = number;
+		else if (key == "--shaders") options.shaderDirectory = value;
+		else if (key == "--json") options.jsonPath = value;
+		else if (key == "--csv") options.csvPath = value;
+		else
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+// JSON̕ (foCXȂǂɊ܂܂LGXP[v)
+static std::string JsonString(const std::string& value)
+{
+	std::string result = "\"";
+	for (auto c : value)
+	{
+		if (c == '"' || c == '\\')
+		{
+			result += '\\';
+		}
+		if (uint8_t(c) >= 0x20)
+		{
+			result += c;
+		}
+	}
+	return result + "\"";
+}
+
+// vʂ̂܂Ƃ
+struct BenchmarkResult
+{
+	std::string deviceName;
+	uint32_t recordThreads = 0;
+	double startupMs = 0.0;
+	MemoryStats memory;
+	PipelineManager::Stats pipelines = {};
+	uint32_t visibleObjects = 0;	// Ō̃t[ŕ`悵IuWFNg̐ (gpu_driven͓ǂݖ߂ŐṼt[)
+	uint32_t occludedObjects = 0;	// ̃t[Ŏ̓ɂHi-ZŉBĂIuWFNg̐ (gpu_driven̂)
+	std::map<std::string, FrameTimeHistogram> histograms;
+};
+
+// cpuRecordedgpu_drivenƔrobjects̃V[̌ (Ȃꍇnullptr)
+static bool WriteJson(const std::string& path, const BenchmarkOptions& options, const BenchmarkResult& result, const BenchmarkResult* cpuRecorded)
+{
+	std::ofstream file(path);
+	if (!file)
+	{
+		return false;
+	}
+
+	const auto& scene = options.scene;
+	file << "{\n";
+	file << "  \"scene\": { \"name\": " << JsonString(scene.name) << ", \"type\": " << JsonString(GetSceneTypeName(scene.type)) << ", \"draws\": " << scene.draws
+		<< ", \"instances\": " << scene.instances;
+	if (scene.type == BenchmarkScene::Type::Deferred)
+	{
+		file << ", \"lights\": " << scene.lights;
+	}
+	file << ", \"seed\": " << scene.seed << " },\n";
+	file << "  \"config\": { \"width\": " << options.width << ", \"height\": " << options.height
+		<< ", \"warmup_frames\": " << options.warmupFrames << ", \"frames\": " << options.frames
+		<< ", \"frames_in_flight\": " << options.framesInFlight << ", \"record_threads\": " << result.recordThreads << " },\n";
+	file << "  \"device\": " << JsonString(result.deviceName) << ",\n";
+	file << "  \"startup_ms\": " << result.startupMs << ",\n";
+	if (scene.type != BenchmarkScene::Type::Quads)
+	{
+		file << "  \"visible_objects\": " << result.visibleObjects << ",\n";
+	}
+	if (scene.type == BenchmarkScene::Type::GpuDriven)
+	{
+		file << "  \"occluded_objects\": " << result.occludedObjects << ",\n";
+	}
+
+	const auto& m = result.memory;
+	file << "  \"memory\": { \"device_memory_count\": " << m.deviceMemoryCount << ", \"block_count\": " << m.blockCount
+		<< ", \"dedicated_count\": " << m.dedicatedCount << ", \"allocation_count\": " << m.allocationCount
+		<< ", \"reserved_bytes\": " << m.reservedBytes << ", \"used_bytes\": " << m.usedBytes << " },\n";
+
+	const auto& p = result.pipelines;
+	file << "  \"pipelines\": { \"requests\": " << p.requestCount << ", \"deduped\": " << p.dedupedCount
+		<< ", \"compiled\": " << p.compiledCount << ", \"failed\": " << p.failedCount << ", \"compile_ms\": " << p.compileMs << " },\n";
+
+	file << "  \"scopes\": [";
+	bool first = true;
+	for (const auto& v : result.histograms)
+	{
+		const auto& h = v.second;
+		file << (first ? "\n" : ",\n");
+		file << "    { \"name\": " << JsonString(v.first) << ", \"count\": " << h.Count()
+			<< ", \"avg_ms\": " << h.Average() << ", \"p50_ms\": " << h.Percentile(50.0)
+			<< ", \"p95_ms\": " << h.Percentile(95.0) << ", \"p99_ms\": " << h.Percentile(99.0)
+			<< ", \"max_ms\": " << h.Max() << " }";
+		first = false;
+	}
+	file << "\n  ]";
+
+	if (cpuRecorded != nullptr && cpuRecorded->histograms.count("cpu:Frame") != 0)
+	{
+		const auto& h = cpuRecorded->histograms.at("cpu:Frame");
+		file << ",\n  \"cpu_recorded\": { \"scene\": \"objects\", \"visible_objects\": " << cpuRecorded->visibleObjects
+			<< ", \"cpu_frame_avg_ms\": " << h.Average() << ", \"cpu_frame_p95_ms\": " << h.Percentile(95.0)
+			<< ", \"cpu_frame_p99_ms\": " << h.Percentile(99.0) << " }";
+	}
+	file << "\n}\n";
+	return bool(file);
+}
+
+// sƂ1sǋL (CIőǑʂƔr邽)
+static bool AppendCsv(const std::string& path, const BenchmarkOptions& options, const BenchmarkResult& result)
+{
+	bool writeHeader = false;
+	{
+		std::ifstream existing(path, std::ios::binary | std::ios::ate);
+		writeHeader = !existing || existing.tellg() == 0;
+	}
+
+	std::ofstream file(path, std::ios::app);
+	if (!file)
+	{
+		return false;
+	}
+
+	if (writeHeader)
+	{
+		file << "scene,draws,instances,seed,width,height,frames,record_threads,device,"
+			"cpu_frame_avg_ms,cpu_frame_p95_ms,cpu_frame_p99_ms,cpu_render_avg_ms,gpu_frame_avg_ms,gpu_frame_p95_ms,"
+			"startup_ms,device_memory_count,allocation_count,reserved_bytes,used_bytes\n";
+	}
+
+	static const FrameTimeHistogram empty(1);
+	auto histogram = [&](const char* name) -> const FrameTimeHistogram& {
+		auto found = result.histograms.find(name);
+		return found != result.histograms.end() ? found->second : empty;
+	};
+	const auto& cpuFrame = histogram("cpu:Frame");
+	const auto& cpuRender = histogram("cpu:Render");
+	const auto& gpuFrame = histogram("gpu:RenderPass");
+
+	const auto& scene = options.scene;
+	std::string device = result.deviceName;
+	std::replace(device.begin(), device.end(), ',', ' ');
+	file << scene.name << ',' << scene.draws << ',' << scene.instances << ',' << scene.seed << ','
+		<< options.width << ',' << options.height << ',' << options.frames << ',' << result.recordThreads << ',' << device << ','
+		<< cpuFrame.Average() << ',' << cpuFrame.Percentile(95.0) << ',' << cpuFrame.Percentile(99.0) << ','
+		<< cpuRender.Average() << ',' << gpuFrame.Average() << ',' << gpuFrame.Percentile(95.0) << ','
+		<< result.startupMs << ',' << result.memory.deviceMemoryCount << ',' << result.memory.allocationCount << ','
+		<< result.memory.reservedBytes << ',' << result.memory.usedBytes << '\n';
+	return bool(file);
+}
+
+// sceneItXN[Ō܂t[`悵At[Ԃƃ̎gpʂv
+static bool RunScene(const BenchmarkOptions& options, const BenchmarkScene& scene, BenchmarkResult& result)
+{
+	BenchmarkApp app(scene);
+	app.SetShaderDirectory(options.shaderDirectory.c_str());
+	app.SetFramesInFlight(options.framesInFlight);
+	app.SetRecordThreadCount(options.threads);
+	app.SetPipelineCachePath("benchmark_pipeline_cache.bin");
+	auto initializeResult = app.InitializeHeadless(options.width, options.height, "Vulkan Practice Benchmark");
+	if (initializeResult != VK_SUCCESS)
+	{
+		// 𖞂foCXȂȂ (r͔̂̂jς݂Ȃ̂ŁATerminate͌Ă΂Ȃ)
+		std::fprintf(stderr, "failed to initialize Vulkan for scene %s (VkResult %d)\n", scene.name.c_str(), int(initializeResult));
+		return false;
+	}
+
+	// pCvC̓[J[XbhŐ̂ŁAv̑OɏI点Ă
+	app.GetPipelineManager().WaitIdle();
+	if (!app.IsReady())
+	{
+		std::fprintf(stderr, "failed to load shaders from %s\n", options.shaderDirectory.c_str());
+		app.Terminate();
+		return false;
+	}
+	if (options.hotReload && std::strlen(BENCHMARK_SHADER_COMPILE_COMMAND) > 0)
+	{
+		app.EnableShaderHotReload(BENCHMARK_SHADER_SOURCE_DIR, BENCHMARK_SHADER_COMPILE_COMMAND);
+	}
+
+	// Main.cpp̃[vƓԂv
+	auto& profiler = app.GetProfiler();
+	result.startupMs = app.GetStartupTimeMs();
+	for (uint32_t frame = 0; frame < options.warmupFrames + options.frames; ++frame)
+	{
+		if (frame == options.warmupFrames)
+		{
+			profiler.ClearSamples();
+		}
+
+		Profiler::CpuScope frameScope(profiler, "Frame");
+		{
+			Profiler::CpuScope scope(profiler, "WaitForFrame");
+			app.WaitForNextFrame();
+		}
+		{
+			Profiler::CpuScope scope(profiler, "Render");
+			app.Render();
+		}
+	}
+
+	result.deviceName = app.GetDeviceProperties().deviceName;
+	result.recordThreads = app.GetRecordThreadCount();
+	result.memory = app.GetMemoryAllocator().GetStats();
+	result.pipelines = app.GetPipelineManager().GetStats();
+	result.visibleObjects = app.GetVisibleCount();
+	result.occludedObjects = app.GetOccludedCount();
+	result.histograms = profiler.GetHistograms();
+	app.Terminate();
+	return true;
+}
+
+static const FrameTimeHistogram* FindHistogram(const BenchmarkResult& result, const char* name)
+{
+	auto found = result.histograms.find(name);
+	return found != result.histograms.end() ? &found->second : nullptr;
+}
+
+// V[ItXN[Ō܂t[`悵At[Ԃƃ̎gpʂo͂
+// gpu_driven̏ꍇ́AIuWFNgCPUŃJOĕ`R}hL^objects̃V[vĕׂ
+int main(int argc, char** argv)
+{
+	BenchmarkOptions options;
+	if (!ParseOptions(argc, argv, options))
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	BenchmarkResult result;
+	if (!RunScene(options, options.scene, result))
+	{
+		return 1;
+	}
+
+	BenchmarkResult cpuRecorded;
+	auto compare = options.scene.type == BenchmarkScene::Type::GpuDriven;
+	if (compare)
+	{
+		// rp̃V[Ȃꍇ͔rȂāAvς݂̌ʂo͂
+		auto scene = options.scene;
+		scene.name = "objects";
+		scene.type = BenchmarkScene::Type::Objects;
+		if (!RunScene(options, scene, cpuRecorded))
+		{
+			std::fprintf(stderr, "skipping the comparison with the objects scene\n");
+			compare = false;
+		}
+	}
+
+	auto succeeded = WriteJson(options.jsonPath, options, result, compare ? &cpuRecorded : nullptr);
+	if (!options.csvPath.empty())
+	{
+		succeeded = AppendCsv(options.csvPath, options, result) && succeeded;
+	}
+
+	const auto* cpuFrame = FindHistogram(result, "cpu:Frame");
+	std::printf("%s: %u draws x %u instances, %ux%u, %u frames on %s\n", options.scene.name.c_str(), options.scene.draws,
+		options.scene.instances, options.width, options.height, options.frames, result.deviceName.c_str());
+	if (cpuFrame != nullptr)
+	{
+		std::printf("cpu frame avg %.3f ms, p95 %.3f ms, p99 %.3f ms\n", cpuFrame->Average(), cpuFrame->Percentile(95.0), cpuFrame->Percentile(99.0));
+	}
+	if (options.scene.type == BenchmarkScene::Type::Deferred)
+	{
+		std::printf("%u point lights\n", options.scene.lights);
+	}
+	if (options.scene.type == BenchmarkScene::Type::Objects || options.scene.type == BenchmarkScene::Type::Deferred)
+	{
+		std::printf("%u of %u objects visible in the last frame\n", result.visibleObjects, options.scene.draws);
+	}
+	if (options.scene.type == BenchmarkScene::Type::GpuDriven)
+	{
+		std::printf("%u of %u objects drawn, %u occluded by hi-z (last frame read back)\n", result.visibleObjects, options.scene.draws,
+			result.occludedObjects);
+	}
+
+	const auto* cpuRecordedFrame = FindHistogram(cpuRecorded, "cpu:Frame");
+	if (compare && cpuRecordedFrame != nullptr)
+	{
+		std::printf("cpu-recorded (objects) cpu frame avg %.3f ms, p95 %.3f ms, p99 %.3f ms, %u objects visible in the last frame\n",
+			cpuRecordedFrame->Average(), cpuRecordedFrame->Percentile(95.0), cpuRecordedFrame->Percentile(99.0), cpuRecorded.visibleObjects);
+	}
+	return succeeded ? 0 : 1;
+}
@@ -0,0 +1,608 @@
+#include "BenchmarkApp.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <algorithm>
+#include <random>
+#include <cmath>
+
+// 1̃ZJ_R}hobt@ɋL^ŏ̕`搔 (ׂƋL^̊JnEIׂ̕ڗ)
+static const uint32_t MinDrawsPerTask = 64;
+
+// ̂12̎Op` (CfbNX̒l̃rbg0E1E2pxEyEz0/1)
+static const uint16_t CubeIndices[] = {
+	0, 4, 6, 0, 6, 2,	// -X
+	1, 3, 7, 1, 7, 5,	// +X
+	0, 1, 5, 0, 5, 4,	// -Y
+	2, 6, 7, 2, 7, 3,	// +Y
+	0, 2, 3, 0, 3, 1,	// -Z
+	4, 5, 7, 4, 7, 6,	// +Z
+};
+static const uint32_t CubeIndexCount = uint32_t(sizeof(CubeIndices) / sizeof(CubeIndices[0]));
+
+// S_ŕӂ̒1̗̂̋E̔a
+static const float CubeRadius = 0.8660254f;
+
+// 킩͓zuɂȂ悤Az̎ɈˑȂ@ŗg
+template<class Random>
+static float Uniform(Random& random)
+{
+	return float(random() >> 8) / float(1u << 24);
+}
+
+
+BenchmarkApp::BenchmarkApp(const BenchmarkScene& scene) : _scene(scene), _pipelineLayout(VK_NULL_HANDLE), _pipelineKey(0),
+	_activePipeline(VK_NULL_HANDLE), _taskCount(0), _viewProjection(1.0f), _visibleCount(0), _frameSlot(0),
+	_setLayout(VK_NULL_HANDLE), _descriptorPool(VK_NULL_HANDLE), _indexBuffer(VK_NULL_HANDLE), _indexUpload(0), _gpuCullingReady(false),
+	_cullStatistics{}, _deferredReady(false)
+{
+	// Ԑڕ`firstInstanceŃIuWFNg̔ԍn (VK_KHR_draw_indirect_countmulti draw indirectȂꍇ͑̕@ŕ`)
+	if (scene.type == BenchmarkScene::Type::GpuDriven)
+	{
+		AddDeviceFeature(&VkPhysicalDeviceFeatures::drawIndirectFirstInstance, true);
+		AddDeviceFeature(&VkPhysicalDeviceFeatures::multiDrawIndirect, false);
+		AddDeviceExtension(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME, false);
+	}
+
+	if (HasObjects())
+	{
+		CreateObjects();
+	}
+	else
+	{
+		CreateQuads();
+	}
+}
+
+// ʓɎU΂lp`
+void BenchmarkApp::CreateQuads()
+{
+	std::mt19937 random(_scene.seed);
+	auto uniform = [&random]() { return Uniform(random); };
+
+	const auto columns = uint32_t(std::ceil(std::sqrt(double((std::max)(_scene.instances, 1u)))));
+	_draws.resize(_scene.draws);
+	for (auto& v : _draws)
+	{
+		const auto size = 0.05f + 0.45f * uniform();
+		v.rect[0] = -1.0f + (2.0f - size) * uniform();
+		v.rect[1] = -1.0f + (2.0f - size) * uniform();
+		v.rect[2] = size;
+		v.rect[3] = size;
+		v.color[0] = uniform();
+		v.color[1] = uniform();
+		v.color[2] = uniform();
+		v.color[3] = 1.0f;
+		v.columns = columns;
+	}
+}
+
+// _̃J̎ɎU΂ (ĴŁA̓̂̂̓t[Ƃɕς)
+// xIuWFNg̐ɂȂ悤A͈̗͂͐ɔႳ
+void BenchmarkApp::CreateObjects()
+{
+	std::mt19937 random(_scene.seed);
+	auto uniform = [&random]() { return Uniform(random); };
+
+	const auto extent = 4.0f * std::cbrt(float((std::max)(_scene.draws, 1u)));
+	_objects.Reserve(_scene.draws);
+	_spins.resize(_scene.draws);
+	_objectData.resize(_scene.draws);
+	for (uint32_t i = 0; i < _scene.draws; ++i)
+	{
+		const glm::vec3 position((uniform() - 0.5f) * 2.0f * extent, (uniform() - 0.5f) * 0.5f * extent, (uniform() - 0.5f) * 2.0f * extent);
+		const glm::vec3 scale(0.5f + uniform() * 1.5f);
+
+		auto& spin = _spins[i];
+		spin.axis = glm::normalize(glm::vec3(uniform() - 0.5f, uniform() - 0.5f, uniform() - 0.5f) + glm::vec3(0.0f, 0.001f, 0.0f));
+		spin.phase = uniform() * 6.2831853f;
+		spin.speed = 0.01f + uniform() * 0.05f;
+		_objects.Add(position, glm::angleAxis(spin.phase, spin.axis), scale, glm::vec3(0.0f), CubeRadius);
+
+		auto& data = _objectData[i];
+		data.color[0] = 0.2f + 0.8f * uniform();
+		data.color[1] = 0.2f + 0.8f * uniform();
+		data.color[2] = 0.2f + 0.8f * uniform();
+		data.color[3] = 1.0f;
+	}
+	_objects.UpdateBounds();
+	_visible.resize(_objects.GetPaddedCount());
+}
+
+// GpuDriven: JÕpX̌̃CpXŁAJǑʂԐڕ`悵A̐[xHi-Z̃s~bh
+// JÕpX̓s~bhpXOɐ錾̂ŁAÕt[̃s~bhǂ
+// GpuCulling̃obt@̓Otɓo^̂ŁAPrepareÔŏ
+// Deferred: G-buffer̃pXŃIuWFNg` (Cg̃obt@Otɓo^̂ŁADeferredRenderer)
+uint32_t BenchmarkApp::SetupRenderGraph(RenderGraph& graph, RenderGraph::Resource backbuffer)
+{
+	if (_scene.type == BenchmarkScene::Type::Deferred && PrepareDeferred())
+	{
+		const VkClearColorValue background = { { 0.5f, 0.25f, 0.25f, 1.0f } };
+		return _deferred.AddPasses(graph, backbuffer, RenderGraph::InvalidResource, &background).GetIndex();
+	}
+	if (_scene.type != BenchmarkScene::Type::GpuDriven || !PrepareGpuCulling())
+	{
+		return AppBase::SetupRenderGraph(graph, backbuffer);
+	}
+
+	_gpuCulling.AddCullPass(graph);
+
+	RenderGraph::ImageDesc depthDesc;
+	depthDesc.format = VK_FORMAT_D32_SFLOAT;
+	auto depth = graph.CreateImage("Depth", depthDesc);
+
+	const VkClearColorValue clearColor = { { 0.5f, 0.25f, 0.25f, 1.0f } };
+	const VkClearDepthStencilValue clearDepth = { 1.0f, 0 };
+	auto& pass = graph.AddGraphicsPass("Main")
+		.WriteColor(backbuffer, &clearColor)
+		.WriteDepth(depth, &clearDepth);
+	_gpuCulling.ReadDraws(pass);
+	_hiZ.AddBuildPass(graph, depth);
+	return pass.GetIndex();
+}
+
+bool BenchmarkApp::PrepareGpuCulling()
+{
+	const auto drawIndirectCount = IsDeviceExtensionEnabled(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+	const auto multiDrawIndirect = GetEnabledFeatures().multiDrawIndirect == VK_TRUE;
+	if (!_hiZ.Initialize(GetDevice(), GetShaderCache().GetModule("HiZDownsample.comp"), GetPipelineCache(), &GetDeletionQueue()))
+	{
+		return false;
+	}
+	_gpuCullingReady = _gpuCulling.Initialize(GetDevice(), &GetMemoryAllocator(), GetShaderCache().GetModule("GpuCulling.comp"),
+		GetPipelineCache(), (std::max)(_objects.GetObjectCount(), 1u), drawIndirectCount, multiDrawIndirect, &_hiZ);
+	_gpuCullingReady = _gpuCullingReady && _gpuCulling.EnableStatistics(GetFramesInFlight());
+	return _gpuCullingReady;
+}
+
+// _̓IuWFNgƓ͈͂ɎU΂AȂ
+bool BenchmarkApp::PrepareDeferred()
+{
+	auto& shaderCache = GetShaderCache();
+	_deferredReady = _deferred.Initialize(GetDevice(), &GetMemoryAllocator(), &GetPipelineManager(), &GetDeletionQueue(),
+		shaderCache.GetModule("DeferredLight.vert"), shaderCache.GetModule("DeferredLight.frag"), _scene.lights);
+	if (!_deferredReady)
+	{
+		return false;
+	}
+
+	std::mt19937 random(_scene.seed + 1);
+	auto uniform = [&random]() { return Uniform(random); };
+
+	const auto extent = 4.0f * std::cbrt(float((std::max)(_scene.draws, 1u)));
+	std::vector<DeferredRenderer::Light> lights((std::min)(_scene.lights, _deferred.GetMaxLights()));
+	for (auto& v : lights)
+	{
+		v.position[0] = (uniform() - 0.5f) * 2.0f * extent;
+		v.position[1] = (uniform() - 0.5f) * 0.5f * extent;
+		v.position[2] = (uniform() - 0.5f) * 2.0f * extent;
+		v.radius = 4.0f + 8.0f * uniform();
+		v.color[0] = 0.3f + 0.7f * uniform();
+		v.color[1] = 0.3f + 0.7f * uniform();
+		v.color[2] = 0.3f + 0.7f * uniform();
+		v.intensity = 1.0f + uniform();
+	}
+	_deferred.SetLights(lights);
+	return true;
+}
+
+// Objects: V[̍XV̌ɁAJOƓ]̏sĂȂ
+// R}h̋L^̓JǑʂĝŁAJǑɎs
+// GpuDriven: JOGPUłȂ̂ŁAV[̍XVƓ]̏ȂAL^͑҂Ȃ
+// ̃t[̃XbgOɎgt[̃JO̓v́AœǂݏoĂ㏑
+JobGraph::TaskId BenchmarkApp::SetupFrameTasks(JobGraph& graph)
+{
+	if (!HasObjects() || _objects.GetObjectCount() == 0)
+	{
+		return JobGraph::InvalidTask;
+	}
+
+	// ̃t[̃Xg[Wobt@ (gĂt[̊Render̊Jnɑ҂Ă)
+	const auto frameNumber = GetFrameNumber();
+	const auto frameSlot = uint32_t(frameNumber % GetFramesInFlight());
+	_frameSlot = frameSlot;
+
+	const auto update = graph.AddTask("UpdateScene", [this, frameNumber]() { UpdateObjects(frameNumber); });
+	graph.AddTask("PrepareUploads", [this, frameSlot]() { PrepareObjectUploads(frameSlot); }, { update });
+	if (_scene.type == BenchmarkScene::Type::GpuDriven)
+	{
+		if (_gpuCulling.GetStatistics(frameSlot, _cullStatistics))
+		{
+			_visibleCount = _cullStatistics.frustumVisible - _cullStatistics.occluded;
+		}
+		_gpuCulling.SetStatisticsFrame(frameSlot);
+		return JobGraph::InvalidTask;
+	}
+	return graph.AddTask("Cull", [this]() { CullObjects(); }, { update });
+}
+
+// IuWFNg]AJi߂ (Ԃ̓t[ԍ猈߂̂ŁAsƂɓGɂȂ)
+void BenchmarkApp::UpdateObjects(uint64_t frameNumber)
+{
+	const auto time = float(frameNumber);
+	for (Scene::ObjectId i = 0; i < _objects.GetObjectCount(); ++i)
+	{
+		const auto& spin = _spins[i];
+		_objects.SetTransform(i, _objects.GetPosition(i), glm::angleAxis(spin.phase + spin.speed * time, spin.axis), _objects.GetScale(i));
+	}
+	_objects.UpdateBounds();
+
+	// VulkañNbv ([x0`1AY͉)
+	const auto extent = GetExtent();
+	const auto range = 8.0f * std::cbrt(float(_objects.GetObjectCount()));
+	auto projection = glm::perspective(glm::radians(60.0f), float(extent.width) / float((std::max)(extent.height, 1u)), 0.1f, range);
+	projection[1][1] *= -1.0f;
+
+	const auto yaw = time * 0.005f;
+	const glm::vec3 eye(0.0f);
+	const auto view = glm::lookAt(eye, eye + glm::vec3(std::sin(yaw), 0.0f, std::cos(yaw)), glm::vec3(0.0f, 1.0f, 0.0f));
+	_viewProjection = projection * view;
+
+	// JÕpX̓CXbhł̋L^Ɏǂ
+	if (_scene.type == BenchmarkScene::Type::GpuDriven)
+	{
+		_gpuCulling.SetViewProjection(glm::value_ptr(_viewProjection));
+	}
+	else if (_scene.type == BenchmarkScene::Type::Deferred)
+	{
+		_deferred.SetCamera(glm::value_ptr(_viewProjection), glm::value_ptr(eye));
+	}
+}
+
+// IuWFNg̔ԍ_visible֏o (FrustumCuller̓WuVXeŕɔ肷)
+void BenchmarkApp::CullObjects()
+{
+	const auto planes = GpuCulling::ExtractFrustum(glm::value_ptr(_viewProjection));
+	_visibleCount = _culler.Cull(_objects, planes, _visible);
+}
+
+// viewProjectionƃIuWFNg̍s̃t[̃Xg[Wobt@֓]A_VF[_[ő҂悤錾
+void BenchmarkApp::PrepareObjectUploads(uint32_t frameSlot)
+{
+	for (Scene::ObjectId i = 0; i < _objects.GetObjectCount(); ++i)
+	{
+		// D̉]Egƕsړ
+		const auto rotation = _objects.GetRotation(i);
+		const auto scale = _objects.GetScale(i);
+		const auto position = _objects.GetPosition(i);
+		const glm::vec3 axes[3] = { rotation * glm::vec3(scale.x, 0.0f, 0.0f), rotation * glm::vec3(0.0f, scale.y, 0.0f), rotation * glm::vec3(0.0f, 0.0f, scale.z) };
+
+		auto& model = _objectData[i].model;
+		for (int column = 0; column < 3; ++column)
+		{
+			model[column * 4 + 0] = axes[column].x;
+			model[column * 4 + 1] = axes[column].y;
+			model[column * 4 + 2] = axes[column].z;
+			model[column * 4 + 3] = 0.0f;
+		}
+		model[12] = position.x;
+		model[13] = position.y;
+		model[14] = position.z;
+		model[15] = 1.0f;
+	}
+
+	// ̗\̃`Pbg͑O̗\̊\
+	auto& uploadManager = GetUploadManager();
+	const auto buffer = _frames[frameSlot].buffer;
+	uploadManager.UploadBuffer(buffer, 0, glm::value_ptr(_viewProjection), sizeof(float) * 16);
+	const auto ticket = uploadManager.UploadBuffer(buffer, sizeof(float) * 16, _objectData.data(), sizeof(ObjectData) * _objectData.size());
+	uploadManager.Require(ticket, VK_PIPELINE_STAGE_VERTEX_SHADER_BIT);
+	uploadManager.Require(_indexUpload, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT);
+}
+
+// `搔ƃXbh番߂ (t[ƂSetupFrameTaskšɃCXbh1xĂ΂)
+// Objectš鐔̓JÕ^XNI܂ŕȂ̂ŁAIuWFNg̐ŕ
+// GpuDriven͊Ԑڕ`1̃ZJ_R}hobt@ɋL^
+// pCvC̐IĂȂꍇ͕`悵Ȃ
+uint32_t BenchmarkApp::GetCommandTaskCount()
+{
+	_activePipeline = GetPipelineManager().Get(_pipelineKey);
+	const auto drawCount = HasObjects() ? _objects.GetObjectCount() : uint32_t(_draws.size());
+	if (_activePipeline == VK_NULL_HANDLE || drawCount == 0)
+	{
+		_taskCount = 0;
+		return 0;
+	}
+	if (_scene.type == BenchmarkScene::Type::GpuDriven)
+	{
+		_taskCount = 1;
+		return _taskCount;
+	}
+	const auto byDraws = (drawCount + MinDrawsPerTask - 1) / MinDrawsPerTask;
+	_taskCount = (std::min)(byDraws, GetRecordThreadCount() * 4);
+	return _taskCount;
+}
+
+// taskIndexԖڂ͈̔͂̕`L^
+void BenchmarkApp::CreateCommand(VkCommandBuffer command, uint32_t taskIndex, uint32_t /*threadIndex*/)
+{
+	SetViewport(command);
+	vkCmdBindPipeline(command, VK_PIPELINE_BIND_POINT_GRAPHICS, _activePipeline);
+	switch (_scene.type)
+	{
+	case BenchmarkScene::Type::Objects:
+	case BenchmarkScene::Type::Deferred:
+		RecordObjects(command, taskIndex);
+		break;
+	case BenchmarkScene::Type::GpuDriven:
+		RecordGpuDriven(command);
+		break;
+	default:
+		RecordQuads(command, taskIndex);
+		break;
+	}
+}
+
+void BenchmarkApp::SetViewport(VkCommandBuffer command)
+{
+	const auto extent = GetExtent();
+	VkViewport viewport{ 0.0f, 0.0f, float(extent.width), float(extent.height), 0.0f, 1.0f };
+	VkRect2D scissor{ { 0, 0 }, extent };
+	vkCmdSetViewport(command, 0, 1, &viewport);
+	vkCmdSetScissor(command, 0, 1, &scissor);
+}
+
+void BenchmarkApp::RecordQuads(VkCommandBuffer command, uint32_t taskIndex)
+{
+	const auto drawCount = uint32_t(_draws.size());
+	const auto begin = uint32_t(uint64_t(drawCount) * taskIndex / _taskCount);
+	const auto end = uint32_t(uint64_t(drawCount) * (taskIndex + 1) / _taskCount);
+	for (auto i = begin; i < end; ++i)
+	{
+		vkCmdPushConstants(command, _pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(Draw), &_draws[i]);
+		vkCmdDraw(command, 4, _scene.instances, 0, 0);
+	}
+}
+
+// IuWFNgtaskIndexԖڂ͈̔͂`悷 (IuWFNg̔ԍfirstInstanceœn)
+void BenchmarkApp::RecordObjects(VkCommandBuffer command, uint32_t taskIndex)
+{
+	const auto begin = uint32_t(uint64_t(_visibleCount) * taskIndex / _taskCount);
+	const auto end = uint32_t(uint64_t(_visibleCount) * (taskIndex + 1) / _taskCount);
+	if (begin == end)
+	{
+		return;
+	}
+
+	vkCmdBindDescriptorSets(command, VK_PIPELINE_BIND_POINT_GRAPHICS, _pipelineLayout, 0, 1, &_frames[_frameSlot].descriptorSet, 0, nullptr);
+	vkCmdBindIndexBuffer(command, _indexBuffer, 0, VK_INDEX_TYPE_UINT16);
+	for (auto i = begin; i < end; ++i)
+	{
+		vkCmdDrawIndexed(command, CubeIndexCount, 1, 0, 0, _visible[i]);
+	}
+}
+
+// JÕpXoԐڕ`L^ (CPUׂ̓̕IuWFNgɂȂ)
+void BenchmarkApp::RecordGpuDriven(VkCommandBuffer command)
+{
+	vkCmdBindDescriptorSets(command, VK_PIPELINE_BIND_POINT_GRAPHICS, _pipelineLayout, 0, 1, &_frames[_frameSlot].descriptorSet, 0, nullptr);
+	vkCmdBindIndexBuffer(command, _indexBuffer, 0, VK_INDEX_TYPE_UINT16);
+	_gpuCulling.RecordDraws(command);
+}
+
+// pCvCCAEg̐ƃpCvC̗v
+void BenchmarkApp::Prepare()
+{
+	if (HasObjects())
+	{
+		if (PrepareObjects())
+		{
+			_pipelineKey = RequestPipeline(0);
+		}
+		return;
+	}
+
+	VkPushConstantRange pushConstantRange{};
+	pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+	pushConstantRange.offset = 0;
+	pushConstantRange.size = sizeof(Draw);
+
+	VkPipelineLayoutCreateInfo layoutCI{};
+	layoutCI.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+	layoutCI.pushConstantRangeCount = 1;
+	layoutCI.pPushConstantRanges = &pushConstantRange;
+	vkCreatePipelineLayout(GetDevice(), &layoutCI, nullptr, &_pipelineLayout);
+
+	_pipelineKey = RequestPipeline(0);
+}
+
+// Objects: t[Ƃ̃Xg[Wobt@ƃfXNv^ZbgẪCfbNXobt@
+bool BenchmarkApp::PrepareObjects()
+{
+	auto device = GetDevice();
+	auto& allocator = GetMemoryAllocator();
+	_culler.Initialize(&GetJobSystem());
+
+	// binding 0: viewProjectionƃIuWFNg (_VF[_[œǂ)
+	VkDescriptorSetLayoutBinding binding{};
+	binding.binding = 0;
+	binding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	binding.descriptorCount = 1;
+	binding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+
+	VkDescriptorSetLayoutCreateInfo setLayoutCI{};
+	setLayoutCI.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+	setLayoutCI.bindingCount = 1;
+	setLayoutCI.pBindings = &binding;
+	vkCreateDescriptorSetLayout(device, &setLayoutCI, nullptr, &_setLayout);
+
+	VkPipelineLayoutCreateInfo layoutCI{};
+	layoutCI.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+	layoutCI.setLayoutCount = 1;
+	layoutCI.pSetLayouts = &_setLayout;
+	vkCreatePipelineLayout(device, &layoutCI, nullptr, &_pipelineLayout);
+
+	const auto frameCount = GetFramesInFlight();
+	VkDescriptorPoolSize poolSize{ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, frameCount };
+	VkDescriptorPoolCreateInfo poolCI{};
+	poolCI.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+	poolCI.maxSets = frameCount;
+	poolCI.poolSizeCount = 1;
+	poolCI.pPoolSizes = &poolSize;
+	vkCreateDescriptorPool(device, &poolCI, nullptr, &_descriptorPool);
+
+	// ]pL[珑݁AOtBbNXL[̒_VF[_[œǂ
+	VkBufferCreateInfo bufferCI{};
+	bufferCI.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	bufferCI.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+	bufferCI.size = sizeof(float) * 16 + sizeof(ObjectData) * _objectData.size();
+	bufferCI.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+
+	_frames.resize(frameCount);
+	for (auto& v : _frames)
+	{
+		if (!allocator.CreateBuffer(bufferCI, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0, v.buffer, v.allocation))
+		{
+			return false;
+		}
+
+		VkDescriptorSetAllocateInfo setAI{};
+		setAI.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+		setAI.descriptorPool = _descriptorPool;
+		setAI.descriptorSetCount = 1;
+		setAI.pSetLayouts = &_setLayout;
+		vkAllocateDescriptorSets(device, &setAI, &v.descriptorSet);
+
+		VkDescriptorBufferInfo bufferInfo{ v.buffer, 0, VK_WHOLE_SIZE };
+		VkWriteDescriptorSet write{};
+		write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		write.dstSet = v.descriptorSet;
+		write.dstBinding = 0;
+		write.descriptorCount = 1;
+		write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		write.pBufferInfo = &bufferInfo;
+		vkUpdateDescriptorSets(device, 1, &write, 0, nullptr);
+	}
+
+	// CfbNX1x] (`悷t[̃^XNŖRequire)
+	bufferCI.size = sizeof(CubeIndices);
+	bufferCI.usage = VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+	if (!allocator.CreateBuffer(bufferCI, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0, _indexBuffer, _indexAllocation))
+	{
+		return false;
+	}
+	_indexUpload = GetUploadManager().UploadBuffer(_indexBuffer, 0, CubeIndices, sizeof(CubeIndices));
+	if (_indexUpload == 0)
+	{
+		return false;
+	}
+	if (_scene.type != BenchmarkScene::Type::GpuDriven)
+	{
+		return true;
+	}
+
+	// GpuDriven: IuWFNg͒Sŉ]邾Ȃ̂ŁA[hԂ̋E1x]
+	if (!_gpuCullingReady)
+	{
+		return false;
+	}
+	std::vector<GpuCulling::Object> objects(_objects.GetObjectCount());
+	for (Scene::ObjectId i = 0; i < _objects.GetObjectCount(); ++i)
+	{
+		auto& v = objects[i];
+		v.center[0] = _objects.GetCenterX()[i];
+		v.center[1] = _objects.GetCenterY()[i];
+		v.center[2] = _objects.GetCenterZ()[i];
+		v.radius = _objects.GetRadius()[i];
+		v.indexCount = CubeIndexCount;
+		v.firstIndex = 0;
+		v.vertexOffset = 0;
+		v.reserved = 0;
+	}
+	return _gpuCulling.SetObjects(GetUploadManager(), objects);
+}
+
+// VF[_[ăRpCꂽpCvCv (I܂ł͌Â̂g)
+void BenchmarkApp::OnShadersReloaded(const std::vector<std::string>& names)
+{
+	const auto vertexShader = HasObjects() ? "BenchmarkObject.vert" : "Benchmark.vert";
+	const auto fragmentShader = _deferredReady ? "BenchmarkGBuffer.frag" : "Benchmark.frag";
+	const auto used = std::any_of(names.begin(), names.end(),
+		[vertexShader, fragmentShader](const std::string& v) { return v == vertexShader || v == fragmentShader; });
+	if (used)
+	{
+		_pipelineKey = RequestPipeline(_pipelineKey);
+	}
+
+	const auto lighting = std::any_of(names.begin(), names.end(), [](const std::string& v) { return v == "DeferredLight.vert" || v == "DeferredLight.frag"; });
+	if (_deferredReady && lighting)
+	{
+		auto& shaderCache = GetShaderCache();
+		_deferred.SetShaders(shaderCache.GetModule("DeferredLight.vert"), shaderCache.GetModule("DeferredLight.frag"));
+	}
+}
+
+// pCvC̗v (VF[_[ShaderCache擾)
+PipelineManager::Key BenchmarkApp::RequestPipeline(PipelineManager::Key fallback)
+{
+	auto& shaderCache = GetShaderCache();
+
+	// _gl_VertexIndex̂Œ_obt@͂Ȃ
+	GraphicsPipelineState state;
+	if (HasObjects())
+	{
+		state.AddShader(VK_SHADER_STAGE_VERTEX_BIT, shaderCache.GetModule("BenchmarkObject.vert"));
+	}
+	else
+	{
+		state.AddShader(VK_SHADER_STAGE_VERTEX_BIT, shaderCache.GetModule("Benchmark.vert"));
+		state.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP;
+	}
+	if (_deferredReady)
+	{
+		// G-buffer̃A^b`g̐sȏo͂
+		VkPipelineColorBlendAttachmentState opaque{};
+		opaque.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+		state.blendAttachments.assign(DeferredRenderer::GBufferColorCount, opaque);
+		state.AddShader(VK_SHADER_STAGE_FRAGMENT_BIT, shaderCache.GetModule("BenchmarkGBuffer.frag"));
+	}
+	else
+	{
+		state.AddShader(VK_SHADER_STAGE_FRAGMENT_BIT, shaderCache.GetModule("Benchmark.frag"));
+	}
+	state.layout = _pipelineLayout;
+	state.renderPass = GetRenderPass();
+	state.subpass = GetSubpass();
+	return GetPipelineManager().Request(state, fallback);
+}
+
+// pCvCCAEg̔j (pCvCPipelineManagerj)
+void BenchmarkApp::Clean()
+{
+	_gpuCulling.Terminate();
+	_hiZ.Terminate();
+	_gpuCullingReady = false;
+	_deferred.Terminate();
+	_deferredReady = false;
+	CleanObjects();
+	if (_pipelineLayout != VK_NULL_HANDLE)
+	{
+		vkDestroyPipelineLayout(GetDevice(), _pipelineLayout, nullptr);
+		_pipelineLayout = VK_NULL_HANDLE;
+	}
+}
+
+void BenchmarkApp::CleanObjects()
+{
+	auto device = GetDevice();
+	auto& allocator = GetMemoryAllocator();
+	for (auto& v : _frames)
+	{
+		allocator.DestroyBuffer(v.buffer, v.allocation);
+	}
+	_frames.clear();
+	allocator.DestroyBuffer(_indexBuffer, _indexAllocation);
+
+	// fXNv^Zbg̓v[̔jŊJ
+	if (_descriptorPool != VK_NULL_HANDLE)
+	{
+		vkDestroyDescriptorPool(device, _descriptorPool, nullptr);
+		_descriptorPool = VK_NULL_HANDLE;
+	}
+	if (_setLayout != VK_NULL_HANDLE)
+	{
+		vkDestroyDescriptorSetLayout(device, _setLayout, nullptr);
+		_setLayout = VK_NULL_HANDLE;
+	}
+}
@@ -0,0 +1,149 @@
+#pragma once
+
+#include "AppBase.h"
+#include "Scene.h"
+#include "FrustumCuller.h"
+#include "GpuCulling.h"
+#include "HiZBuffer.h"
+#include "DeferredRenderer.h"
+
+#include <vector>
+#include <string>
+
+// x`}[Np̃V[̐ݒ
+struct BenchmarkScene
+{
+	enum class Type
+	{
+		Quads,		// ʓ̎lp` (`R}hƂɃCX^X̃}X)
+		Objects,	// ]闧 (t[̃^XNōXVEJOÂ`R}hŋL^)
+		GpuDriven,	// ObjectsƓ̂GpuCulling (Õt[Hi-Zg) JOA1̊Ԑڕ`ŕ`
+		Deferred,	// ObjectsƓ̂DeferredRendererG-buffer֕`A_ŏƂ炷
+	};
+
+	std::string name = "default";
+	Type type = Type::Quads;
+	uint32_t draws = 1000;			// `R}h̐ (Objectsł̓IuWFNg̐)
+	uint32_t instances = 1;			// `R}hƂ̃CX^X (Quadŝ)
+	uint32_t lights = 512;			// _̐ (Deferred̂)
+	uint32_t seed = 1;				// zuƐF߂闐̎ (Ȃ瓯V[ɂȂ)
+};
+
+// V[ItXN[֕`悷Av
+// Quads: e`R}h͉ʓ̋`CX^X̃}XڂɕĎlp`` (_obt@͎gȂ)
+// Objects: t[̃^XNŃV[̍XV  JO  IuWFNg𕪂ZJ_R}hobt@̋L^ ȂA
+// săIuWFNg̍st[Ƃ̃Xg[Wobt@֓]
+// GpuDriven: V[̍XVƓ]ObjectsƓŁAJÕRs[gpX̌̃CpXvkCmdDrawIndexedIndirectCount1L^
+// CpX̐[xHi-Z̃s~bhÃt[̃JOŎՕ̔Ɏg
+// Deferred: ObjectsƓ^XNG-buffer̃TupXL^A_[pX̃CeBÕTupXœ_Z
+class BenchmarkApp : public AppBase
+{
+public:
+	explicit BenchmarkApp(const BenchmarkScene& scene);
+
+	uint32_t SetupRenderGraph(RenderGraph& graph, RenderGraph::Resource backbuffer) override;
+	JobGraph::TaskId SetupFrameTasks(JobGraph& graph) override;
+	uint32_t GetCommandTaskCount() override;
+	void CreateCommand(VkCommandBuffer command, uint32_t taskIndex, uint32_t threadIndex) override;
+	void Prepare() override;
+	void Clean() override;
+	void OnShadersReloaded(const std::vector<std::string>& names) override;
+
+	// pCvC̐IĂ邩
+	bool IsReady() { return GetPipelineManager().IsReady(_pipelineKey); }
+
+	// Ō̃t[ŕ`悵IuWFNg̐
+	// GpuDrivenł͓ǂݖ߂ŐṼt[ (GetFramesInFlight()O) ̂
+	uint32_t GetVisibleCount() const { return _visibleCount; }
+
+	// GpuDriven: ǂݖ߂ŐṼt[ŁA̓ɂHi-ZŉBĂIuWFNg̐
+	uint32_t GetOccludedCount() const { return _cullStatistics.occluded; }
+
+private:
+	// VF[_[̃vbV萔Ɠ
+	struct Draw
+	{
+		float rect[4];		// xy:  (NDC), zw: 傫
+		float color[4];
+		uint32_t columns;	// CX^Xׂ}Xڂ̗
+	};
+
+	// Shaders/BenchmarkObject.vertObjectDataƓ (std430)
+	struct ObjectData
+	{
+		float model[16];	// D
+		float color[4];
+	};
+
+	// IuWFNg̉]
+	struct Spin
+	{
+		glm::vec3 axis;
+		float phase;
+		float speed;		// 1t[̃WA
+	};
+
+	// t[ (GetFramesInFlight()) ̃Xg[Wobt@
+	// 擪viewProjectionǍObjectData
+	struct FrameResources
+	{
+		VkBuffer buffer = VK_NULL_HANDLE;
+		MemoryAllocation allocation;
+		VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+	};
+
+	bool HasObjects() const { return _scene.type != BenchmarkScene::Type::Quads; }
+	void CreateQuads();
+	void CreateObjects();
+	bool PrepareObjects();
+	bool PrepareGpuCulling();
+	bool PrepareDeferred();
+	void CleanObjects();
+	void UpdateObjects(uint64_t frameNumber);
+	void CullObjects();
+	void PrepareObjectUploads(uint32_t frameSlot);
+	void RecordQuads(VkCommandBuffer command, uint32_t taskIndex);
+	void RecordObjects(VkCommandBuffer command, uint32_t taskIndex);
+	void RecordGpuDriven(VkCommandBuffer command);
+	void SetViewport(VkCommandBuffer command);
+	PipelineManager::Key RequestPipeline(PipelineManager::Key fallback);
+
+	BenchmarkScene _scene;
+	std::vector<Draw> _draws;
+
+	VkPipelineLayout _pipelineLayout;
+	PipelineManager::Key _pipelineKey;
+
+	// ̃t[̋L^Ɏg (GetCommandTaskCountŌ߂)
+	VkPipeline _activePipeline;
+	uint32_t _taskCount;
+
+	// Objects̃V[
+	Scene _objects;
+	std::vector<Spin> _spins;
+	std::vector<ObjectData> _objectData;
+	glm::mat4 _viewProjection;
+	FrustumCuller _culler;
+	std::vector<uint32_t> _visible;
+	uint32_t _visibleCount;
+	uint32_t _frameSlot;
+
+	VkDescriptorSetLayout _setLayout;
+	VkDescriptorPool _descriptorPool;
+	std::vector<FrameResources> _frames;
+
+	// ̂̃CfbNX (_VF[_[̓CfbNX̒lp̈ʒu)
+	VkBuffer _indexBuffer;
+	MemoryAllocation _indexAllocation;
+	UploadTicket _indexUpload;
+
+	// GpuDriveñV[ (SetupRenderGraphŏ)
+	GpuCulling _gpuCulling;
+	HiZBuffer _hiZ;
+	bool _gpuCullingReady;
+	GpuCulling::Statistics _cullStatistics;
+
+	// Deferred̃V[ (SetupRenderGraphŏ)
+	DeferredRenderer _deferred;
+	bool _deferredReady;
+};
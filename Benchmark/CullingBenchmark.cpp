@@ -0,0 +1,155 @@
+#include "FrustumCuller.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+
+// R}hC̐ݒ
+struct CullingBenchmarkOptions
+{
+	uint32_t objects = 100000;
+	uint32_t iterations = 200;
+	uint32_t warmup = 10;
+	uint32_t threads = 0;		// 0̏ꍇ̓RA
+	uint32_t seed = 1;
+};
+
+static void PrintUsage()
+{
+	std::printf(
+		"usage: vulkan_practice_culling_benchmark [options]\n"
+		"  --objects <n> --iterations <n> --warmup <n> --threads <n> --seed <n>\n");
+}
+
+static bool ParseOptions(int argc, char** argv, CullingBenchmarkOptions& options)
+{
+	for (int i = 1; i < argc; ++i)
+	{
+		const std::string key = argv[i];
+		if (key == "--help" || i + 1 >= argc)
+		{
+			return false;
+		}
+
+		const auto number = uint32_t(std::strtoul(argv[++i], nullptr, 10));
+		if (key == "--objects") options.objects = number;
+		else if (key == "--iterations") options.iterations = (std::max)(number, 1u);
+		else if (key == "--warmup") options.warmup = number;
+		else if (key == "--threads") options.threads = number;
+		else if (key == "--seed") options.seed = number;
+		else
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+// J̎ɎU΂IuWFNg (悻̊OɂȂ)
+static void CreateScene(uint32_t objectCount, uint32_t seed, Scene& scene)
+{
+	std::mt19937 random(seed);
+	auto uniform = [&random]() { return float(random() >> 8) / float(1u << 24); };
+
+	scene.Clear();
+	scene.Reserve(objectCount);
+	for (uint32_t i = 0; i < objectCount; ++i)
+	{
+		const glm::vec3 position((uniform() - 0.5f) * 2000.0f, (uniform() - 0.5f) * 200.0f, (uniform() - 0.2f) * 1000.0f);
+		const glm::vec3 axis = glm::normalize(glm::vec3(uniform() - 0.5f, uniform() - 0.5f, uniform() - 0.5f) + glm::vec3(0.0f, 0.001f, 0.0f));
+		const auto rotation = glm::angleAxis(uniform() * 6.2831853f, axis);
+		const glm::vec3 scale(0.5f + uniform() * 4.0f);
+		scene.Add(position, rotation, scale, glm::vec3(0.0f, 0.5f, 0.0f), 0.9f);
+	}
+	scene.UpdateBounds();
+}
+
+// 1񂠂̎ (~b)
+template<class Function>
+static double Measure(const CullingBenchmarkOptions& options, const Function& function)
+{
+	for (uint32_t i = 0; i < options.warmup; ++i)
+	{
+		function();
+	}
+	const auto start = std::chrono::steady_clock::now();
+	for (uint32_t i = 0; i < options.iterations; ++i)
+	{
+		function();
+	}
+	std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+	return elapsed.count() / options.iterations;
+}
+
+// V[eJ[lŃJOA1~bɔ肵IuWFNgo͂
+// ʂXJ[̔ƈvȂꍇ͎sƂďI
+int main(int argc, char** argv)
+{
+	CullingBenchmarkOptions options;
+	if (!ParseOptions(argc, argv, options))
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	Scene scene;
+	CreateScene(options.objects, options.seed, scene);
+
+	// VulkañNbv ([x0`1AY͉)
+	auto projection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 500.0f);
+	projection[1][1] *= -1.0f;
+	const auto view = glm::lookAt(glm::vec3(0.0f, 10.0f, 0.0f), glm::vec3(0.0f, 10.0f, 1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+	const auto planes = GpuCulling::ExtractFrustum(glm::value_ptr(projection * view));
+
+	JobSystem jobSystem;
+	jobSystem.Initialize(options.threads);
+	FrustumCuller culler;
+	culler.Initialize(&jobSystem);
+
+	std::vector<uint32_t> expected(scene.GetPaddedCount());
+	const auto expectedCount = FrustumCuller::CullRange(FrustumCuller::Kernel::Scalar, scene, planes, 0, scene.GetPaddedCount(), expected.data());
+	expected.resize(expectedCount);
+
+	std::printf("%u objects, %u visible, %u threads\n", scene.GetObjectCount(), expectedCount, culler.GetThreadCount());
+	std::printf("%-8s %8s %12s %16s\n", "kernel", "threads", "ms", "objects/ms");
+
+	bool succeeded = true;
+	std::vector<uint32_t> visible(scene.GetPaddedCount());
+	for (auto kernel : { FrustumCuller::Kernel::Scalar, FrustumCuller::Kernel::SSE, FrustumCuller::Kernel::AVX2 })
+	{
+		if (!FrustumCuller::IsKernelSupported(kernel))
+		{
+			continue;
+		}
+
+		// 1Xbhł̔̑ƁA`Nɕĕɂꍇ
+		uint32_t count = 0;
+		const auto singleMs = Measure(options, [&]() {
+			count = FrustumCuller::CullRange(kernel, scene, planes, 0, scene.GetPaddedCount(), visible.data());
+		});
+		succeeded = succeeded && count == expectedCount && std::equal(expected.begin(), expected.end(), visible.begin());
+
+		culler.SetKernel(kernel);
+		const auto parallelMs = Measure(options, [&]() {
+			count = culler.Cull(scene, planes, visible);
+		});
+		succeeded = succeeded && count == expectedCount && std::equal(expected.begin(), expected.end(), visible.begin());
+
+		const auto name = FrustumCuller::GetKernelName(kernel);
+		std::printf("%-8s %8u %12.4f %16.0f\n", name, 1u, singleMs, scene.GetObjectCount() / singleMs);
+		std::printf("%-8s %8u %12.4f %16.0f\n", name, culler.GetThreadCount(), parallelMs, scene.GetObjectCount() / parallelMs);
+	}
+	jobSystem.Terminate();
+
+	if (!succeeded)
+	{
+		std::fprintf(stderr, "culling results differ from the scalar kernel\n");
+	}
+	return succeeded ? 0 : 1;
+}
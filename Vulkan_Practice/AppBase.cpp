@@ -1,47 +1,141 @@
 #include "AppBase.h"
 
+#include <fstream>
+#include <cstdio>
+#include <cstdlib>
+
 // CreateȂǂ̌ʂ󂯔Ȃ
 void AppBase::CheckResult(VkResult result)
 {
 	if (result != VK_SUCCESS)
 	{
+#ifdef _WIN32
 		DebugBreak();
+#else
+		std::fprintf(stderr, "VkResult %d\n", int(result));
+		std::abort();
+#endif
 	}
 }
 
 
 // RXgN^
-AppBase::AppBase() : _presentMode(VK_PRESENT_MODE_FIFO_KHR), _imageIndex(0)
+AppBase::AppBase() : _presentMode(VK_PRESENT_MODE_FIFO_KHR), _presentPolicy(PresentPolicy::Vsync), _window(nullptr), _swapchain(VK_NULL_HANDLE), _swapchainDirty(false), _acquireCount(0),
+	_headless(false), _backbuffer(RenderGraph::InvalidResource), _commandPass(0), _commandTaskCount(0), _recordThreadCount(0), _inputSampled(false), _inputLatencyMs(0.0), _imageIndex(0), _framesInFlight(MinFramesInFlight), _frameIndex(0), _frameNumber(0),
+	_shaderDirectory("shaders"), _pipelineCache(VK_NULL_HANDLE), _pipelineCachePath("pipeline_cache.bin"), _pipelineCacheWarm(false), _pipelineThreadCount(0), _startupTimeMs(0.0),
+	_enabledFeatures{}, _descriptorIndexingFeatures{}
 {
 }
 
 
+// ɏt[ݒ肷
+void AppBase::SetFramesInFlight(uint32_t count)
+{
+	_framesInFlight = count < MinFramesInFlight ? MinFramesInFlight : count > MaxFramesInFlight ? MaxFramesInFlight : count;
+}
 
-// AvP[V̏Ȃ
-void AppBase::Initialize(GLFWwindow* window, const char* appName)
+
+
+// g@\̐錾 (ɂꍇrequiredXV)
+void AppBase::AddExtensionRequest(std::vector<ExtensionRequest>& requests, const char* name, bool required)
 {
-	// CX^X̐
-	InitializeInstance(appName);
+	for (auto& v : requests)
+	{
+		if (v.name == name)
+		{
+			v.required |= required;
+			return;
+		}
+	}
 
-	// foCX̎擾
-	GetPhysicalDevice();
+	ExtensionRequest request;
+	request.name = name;
+	request.required = required;
+	requests.emplace_back(request);
+}
 
-	// OtBbNXp̃L[t@~[CfbNX̎擾
-	_graphicsQueueFamilyIndex = SearchGraphicsQueueFamilyIndex();
+void AppBase::AddInstanceExtension(const char* name, bool required)
+{
+	AddExtensionRequest(_instanceExtensionRequests, name, required);
+}
 
-#ifdef _DEBUG
-	// fobO|[g֐L
-	EnableDebugReport();
-#endif
+void AppBase::AddDeviceExtension(const char* name, bool required)
+{
+	AddExtensionRequest(_deviceExtensionRequests, name, required);
+}
 
-	// _foCX̐
-	CreateDevice();
+void AppBase::AddDeviceFeature(VkBool32 VkPhysicalDeviceFeatures::* feature, bool required)
+{
+	for (auto& v : _featureRequests)
+	{
+		if (v.feature == feature)
+		{
+			v.required |= required;
+			return;
+		}
+	}
 
-	// R}hv[̍쐬
-	CreateCommandPool();
+	FeatureRequest request;
+	request.feature = feature;
+	request.required = required;
+	_featureRequests.emplace_back(request);
+}
+
+bool AppBase::IsInstanceExtensionEnabled(const char* name) const
+{
+	return std::find(_enabledInstanceExtensions.begin(), _enabledInstanceExtensions.end(), name) != _enabledInstanceExtensions.end();
+}
+
+bool AppBase::IsDeviceExtensionEnabled(const char* name) const
+{
+	return std::find(_enabledDeviceExtensions.begin(), _enabledDeviceExtensions.end(), name) != _enabledDeviceExtensions.end();
+}
+
+VkPhysicalDeviceProperties AppBase::GetDeviceProperties() const
+{
+	VkPhysicalDeviceProperties props;
+	vkGetPhysicalDeviceProperties(_physicalDevice, &props);
+	return props;
+}
 
-	// Surface
-	glfwCreateWindowSurface(_instance, window, nullptr, &_surface);
+
+// \@ݒ肷
+void AppBase::SetPresentPolicy(PresentPolicy policy)
+{
+	if (_presentPolicy == policy)
+	{
+		return;
+	}
+
+	_presentPolicy = policy;
+	if (_swapchain != VK_NULL_HANDLE)
+	{
+		_swapchainDirty = true;
+	}
+}
+
+
+// AvP[V̏Ȃ
+void AppBase::Initialize(GLFWwindow* window, const char* appName)
+{
+	_headless = false;
+	_window = window;
+
+	// TCYύX̒ʒm󂯎
+	glfwSetWindowUserPointer(window, this);
+	glfwSetFramebufferSizeCallback(window, &AppBase::FramebufferSizeCallback);
+
+	// EBhEւ̕\ɕKvȊg@\
+	uint32_t glfwExtensionCount = 0;
+	auto glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+	for (uint32_t i = 0; i < glfwExtensionCount; ++i)
+	{
+		AddInstanceExtension(glfwExtensions[i], true);
+	}
+	AddDeviceExtension(VK_KHR_SWAPCHAIN_EXTENSION_NAME, true);
+
+	// CX^XR}hv[܂ł̐ (Surface)
+	CheckResult(InitializeDevice(appName, window));
 
 	// SurfacẽtH[}bgI
 	SelectSurfaceFormat(VK_FORMAT_B8G8R8A8_UNORM);
@@ -53,34 +147,207 @@ void AppBase::Initialize(GLFWwindow* window, const char* appName)
 	VkBool32 isSupported;
 	vkGetPhysicalDeviceSurfaceSupportKHR(_physicalDevice, _graphicsQueueFamilyIndex, _surface, &isSupported);
 
+	// \[h̑I
+	SelectPresentMode();
+
 	// Swapchain
 	CreateSwapchain(window);
+	MarkStartupStage("swapchain");
 
-	// depth buffer 
-	CreateDepthBuffer();
+	// `ȍ~̃\[X
+	InitializeFrameResources();
+}
 
-	// eImageView̐
-	CreateImageViews();
 
-	// _[pX̐
-	CreateRenderPass();
+// EBhESurfaceg킸ɃItXN[֕`悷邽߂̏Ȃ
+VkResult AppBase::InitializeHeadless(uint32_t width, uint32_t height, const char* appName)
+{
+	_headless = true;
+
+	// CX^XR}hv[܂ł̐
+	auto result = InitializeDevice(appName, nullptr);
+	if (result != VK_SUCCESS)
+	{
+		return result;
+	}
+
+	// Surfacȇɕ`̃tH[}bgƃTCY߂
+	_swapchain = VK_NULL_HANDLE;
+	_surfaceFormat.format = VK_FORMAT_R8G8B8A8_UNORM;
+	_surfaceFormat.colorSpace = VK_COLOR_SPACE_SRGB_NONLINEAR_KHR;
+	_swapchainExtent2D.width = width;
+	_swapchainExtent2D.height = height;
+
+	// Swapchain̑̃C[W
+	CreateOffscreenImages();
+	MarkStartupStage("offscreen_images");
+
+	// `ȍ~̃\[X
+	InitializeFrameResources();
+	return VK_SUCCESS;
+}
+
+
+// InstanceR}hv[܂ł𐶐 (sꍇ͂܂łɐ̂jČʂԂ)
+VkResult AppBase::InitializeDevice(const char* appName, GLFWwindow* window)
+{
+	// NԂ̌vJn
+	_initializeStart = std::chrono::steady_clock::now();
+	_startupStageStart = _initializeStart;
+	_startupTimeline.clear();
 
-	// Framebuffer̐
-	CreateFramebuffer();
+	// oChX̃e[uɎg (T|[gĂȂꍇ̓e[ugȂ)
+	AddDeviceExtension(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME, false);
 
-	// CommandBuffer̊蓖
-	AllocateCommandBuffers();
+	// GPUŃJOʂ̊Ԑڕ`Ɏg (T|[gĂȂꍇ͕`搔Œ肵ĕ`悷)
+	AddDeviceExtension(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME, false);
+	AddDeviceFeature(&VkPhysicalDeviceFeatures::multiDrawIndirect, false);
+	AddDeviceFeature(&VkPhysicalDeviceFeatures::drawIndirectFirstInstance, false);
 
-	// fence
-	CreateFences();
+	// eNX`̃Xg[~OŃq[v̗\Z擾 (T|[gĂȂꍇ̓q[v̑傫猩ς)
+	AddDeviceExtension(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME, false);
+
+	// L[Ƃ̃^CCŊǗ (T|[gĂȂꍇ͑MƂfenceŊǗ)
+	AddDeviceExtension(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME, false);
+
+	// CX^X̐
+	auto result = InitializeInstance(appName);
+	if (result != VK_SUCCESS)
+	{
+		_instance = VK_NULL_HANDLE;
+		return result;
+	}
+	MarkStartupStage("instance");
+
+#ifdef _DEBUG
+	// fobO|[g֐L (sƂɔjł悤ACX^X̒ɂȂ)
+	EnableDebugReport();
+#endif
+
+	// Surface (\łfoCXIԂ߁AfoCX̑IɂȂ)
+	_surface = VK_NULL_HANDLE;
+	if (window != nullptr)
+	{
+		result = glfwCreateWindowSurface(_instance, window, nullptr, &_surface);
+		CheckResult(result);
+		MarkStartupStage("surface");
+	}
+
+	// foCX̑I
+	result = GetPhysicalDevice();
+	if (result != VK_SUCCESS)
+	{
+		DestroyInstance();
+		return result;
+	}
+	MarkStartupStage("physical_device");
+
+	// OtBbNXp̃L[t@~[CfbNX̎擾
+	_graphicsQueueFamilyIndex = SearchGraphicsQueueFamilyIndex();
+
+	// ]p̃L[t@~[CfbNX̎擾
+	_transferQueueFamilyIndex = SearchTransferQueueFamilyIndex();
+
+	// Rs[gp̃L[t@~[CfbNX̎擾
+	_computeQueueFamilyIndex = SearchComputeQueueFamilyIndex(_computeQueueIndex);
+
+	// _foCX̐
+	result = CreateDevice();
+	if (result != VK_SUCCESS)
+	{
+		_device = VK_NULL_HANDLE;
+		DestroyInstance();
+		return result;
+	}
+	MarkStartupStage("device");
+
+	// R}hv[̍쐬
+	CreateCommandPool();
+
+	// AP[^̏
+	if (IsDeviceExtensionEnabled(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME))
+	{
+		_memoryAllocator.EnableMemoryBudget();
+	}
+	_memoryAllocator.Initialize(_physicalDevice, _device, _framesInFlight);
+
+	// ]̏
+	_uploadManager.Initialize(_device, &_memoryAllocator, &_timeline, _transferQueueFamilyIndex, _transferQueue, _graphicsQueueFamilyIndex);
+
+	// oChX̃e[u̐ (foCXT|[gĂȂꍇ͎gȂ܂)
+	_bindlessTable.Initialize(_physicalDevice, _device, _descriptorIndexingFeatures);
+
+	// eNX`̃Xg[~O̓ǂݍ݃Xbh̋N
+	_textureStreamer.Initialize(_device, &_memoryAllocator, &_uploadManager, &_bindlessTable, &_deletionQueue);
+	MarkStartupStage("allocator");
+
+	// pCvCLbV̓ǂݍ
+	LoadPipelineCache();
+	_pipelineManager.Initialize(_device, _pipelineCache, _pipelineThreadCount);
+	MarkStartupStage("pipeline_cache");
+
+	// RpCς݂̃VF[_[̑Ή\̓ǂݍ (W[͎gƂɐ)
+	_shaderCache.Initialize(_device, _shaderDirectory);
+	MarkStartupStage("shader_cache");
+	return VK_SUCCESS;
+}
+
+
+// ̒iK̏IL^
+void AppBase::MarkStartupStage(const char* name)
+{
+	const auto now = std::chrono::steady_clock::now();
+	std::chrono::duration<double, std::milli> elapsed = now - _startupStageStart;
+	_startupStageStart = now;
+
+	StartupStage stage;
+	stage.name = name;
+	stage.ms = elapsed.count();
+	_startupTimeline.emplace_back(stage);
+	_profiler.AddSample(std::string("startup:") + name, stage.ms);
+}
+
+
+// `̃TCYɈˑ郊\[XƁAt[Ƃ̃\[X𐶐
+void AppBase::InitializeFrameResources()
+{
+	// eImageView̐
+	CreateImageViews();
+
+	// _[pXAdepth bufferAframebuffer̐
+	InitializeRenderGraph();
+
+	// CommandBuffer̋L^̏
+	InitializeCommandRecorder();
 
 	// Z}tH
 	CreateSemaphores();
+
+	// Rs[gp̃R}hobt@̏
+	_asyncCompute.Initialize(_device, &_timeline, _computeQueueFamilyIndex, _computeQueue, _computeQueue != _deviceQueue, _framesInFlight);
+
+	// xv̏
+	_inputSampleTimes.resize(_framesInFlight);
+	_latencyFrameValues.assign(_framesInFlight, 0);
+
+	// ^CX^vv̏
+	_profiler.Initialize(_physicalDevice, _device, _graphicsQueueFamilyIndex, _framesInFlight);
+
+	MarkStartupStage("frame_resources");
+
+	// hNX̃\[X̐
+	Prepare();
+	MarkStartupStage("prepare");
+
+	// NԂ̋L^ (LbV̗LŕĂ)
+	std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - _initializeStart;
+	_startupTimeMs = elapsed.count();
+	_profiler.AddSample(_pipelineCacheWarm ? "startup:warm" : "startup:cold", _startupTimeMs);
 }
 
 
 // Instance𐶐
-void AppBase::InitializeInstance(const char* appName)
+VkResult AppBase::InitializeInstance(const char* appName)
 {
 	// ApplicationInfȍ
 	VkApplicationInfo appInfo{};
@@ -92,18 +359,36 @@ void AppBase::InitializeInstance(const char* appName)
 	appInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
 	appInfo.apiVersion = VK_API_VERSION_1_1;
 
-	// Instance extension̎擾
+#ifdef _DEBUG
+	// fobO|[g͂Ύg
+	AddInstanceExtension(VK_EXT_DEBUG_REPORT_EXTENSION_NAME, false);
+#endif
+
+	// 錾ꂽg@\̂T|[gĂ̂Lɂ
+	// (SėLɂƐxȂAsvȃhCȍLɂȂ)
 	std::vector<const char*> extensions;
-	std::vector<VkExtensionProperties> props;
 	{
 		uint32_t count = 0;
 		vkEnumerateInstanceExtensionProperties(nullptr, &count, nullptr);
-		props.resize(count);
+		std::vector<VkExtensionProperties> props(count);
 		vkEnumerateInstanceExtensionProperties(nullptr, &count, props.data());
 
-		for (const auto& v : props)
+		_enabledInstanceExtensions.clear();
+		for (const auto& v : _instanceExtensionRequests)
 		{
-			extensions.emplace_back(v.extensionName);
+			auto found = std::find_if(props.begin(), props.end(), [&](const VkExtensionProperties& p) { return v.name == p.extensionName; });
+			if (found != props.end())
+			{
+				_enabledInstanceExtensions.push_back(v.name);
+			}
+			else if (v.required)
+			{
+				return VK_ERROR_EXTENSION_NOT_PRESENT;
+			}
+		}
+		for (const auto& v : _enabledInstanceExtensions)
+		{
+			extensions.push_back(v.c_str());
 		}
 	}
 
@@ -115,23 +400,39 @@ void AppBase::InitializeInstance(const char* appName)
 	ci.pApplicationInfo = &appInfo;
 
 #ifdef _DEBUG
-	// Debug͉Lmeta layerLɂ
-	const char* layers[] = { "VK_LAYER_LUNARG_standard_validation" };
-	ci.enabledLayerCount = 1;
-	ci.ppEnabledLayerNames = layers;
+	// Debug͌؃C[ΗLɂ
+	std::vector<const char*> layers;
+	{
+		uint32_t count = 0;
+		vkEnumerateInstanceLayerProperties(&count, nullptr);
+		std::vector<VkLayerProperties> props(count);
+		vkEnumerateInstanceLayerProperties(&count, props.data());
+
+		const char* candidates[] = { "VK_LAYER_KHRONOS_validation", "VK_LAYER_LUNARG_standard_validation" };
+		for (auto name : candidates)
+		{
+			auto found = std::find_if(props.begin(), props.end(), [&](const VkLayerProperties& p) { return strcmp(name, p.layerName) == 0; });
+			if (found != props.end())
+			{
+				layers.push_back(name);
+				break;
+			}
+		}
+	}
+	ci.enabledLayerCount = uint32_t(layers.size());
+	ci.ppEnabledLayerNames = layers.data();
 #endif
 
 	ci.enabledExtensionCount = uint32_t(extensions.size());
 	ci.ppEnabledExtensionNames = extensions.data();
 
 	// Instance̐
-	auto result = vkCreateInstance(&ci, nullptr, &_instance);
-	CheckResult(result);
+	return vkCreateInstance(&ci, nullptr, &_instance);
 }
 
 
-// foCX擾
-void AppBase::GetPhysicalDevice()
+// foCXI
+VkResult AppBase::GetPhysicalDevice()
 {
 	// ڑĂ镨foCX񋓂
 	uint32_t count = 0;
@@ -139,9 +440,130 @@ void AppBase::GetPhysicalDevice()
 	std::vector<VkPhysicalDevice> physicalDevices(count);
 	vkEnumeratePhysicalDevices(_instance, &count, physicalDevices.data());
 
-	// ŏ̃foCX̃vpeB擾
-	_physicalDevice = physicalDevices[0];
+	// ł]̍foCXI
+	_physicalDevice = VK_NULL_HANDLE;
+	int64_t bestScore = -1;
+	for (auto v : physicalDevices)
+	{
+		auto score = ScorePhysicalDevice(v);
+		if (score > bestScore)
+		{
+			bestScore = score;
+			_physicalDevice = v;
+		}
+	}
+	if (_physicalDevice == VK_NULL_HANDLE)
+	{
+		// 𖞂foCXȂ
+		return VK_ERROR_INCOMPATIBLE_DRIVER;
+	}
+
+	// I񂾃foCX̃vpeB擾
 	vkGetPhysicalDeviceMemoryProperties(_physicalDevice, &_physicalDeviceMemoryProperties);
+	return VK_SUCCESS;
+}
+
+// foCX̕] (gȂꍇ-1)
+int64_t AppBase::ScorePhysicalDevice(VkPhysicalDevice physicalDevice) const
+{
+	VkPhysicalDeviceProperties props;
+	vkGetPhysicalDeviceProperties(physicalDevice, &props);
+
+	// K{̊g@\
+	uint32_t count = 0;
+	vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &count, nullptr);
+	std::vector<VkExtensionProperties> extensions(count);
+	vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &count, extensions.data());
+
+	int64_t score = 0;
+	for (const auto& v : _deviceExtensionRequests)
+	{
+		auto found = std::find_if(extensions.begin(), extensions.end(), [&](const VkExtensionProperties& p) { return v.name == p.extensionName; });
+		if (found != extensions.end())
+		{
+			score += 10;
+		}
+		else if (v.required)
+		{
+			return -1;
+		}
+	}
+
+	// K{̋@\
+	VkPhysicalDeviceFeatures features;
+	vkGetPhysicalDeviceFeatures(physicalDevice, &features);
+	for (const auto& v : _featureRequests)
+	{
+		if (features.*v.feature)
+		{
+			score += 10;
+		}
+		else if (v.required)
+		{
+			return -1;
+		}
+	}
+
+	// L[̔\ (OtBbNXƕ\͕K{Ap̓]ERs[gΉ_)
+	vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &count, nullptr);
+	std::vector<VkQueueFamilyProperties> queueProps(count);
+	vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &count, queueProps.data());
+
+	bool hasGraphics = false;
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		const auto flags = queueProps[i].queueFlags;
+		if (flags & VK_QUEUE_GRAPHICS_BIT)
+		{
+			VkBool32 presentSupported = VK_TRUE;
+			if (_surface != VK_NULL_HANDLE)
+			{
+				vkGetPhysicalDeviceSurfaceSupportKHR(physicalDevice, i, _surface, &presentSupported);
+			}
+			hasGraphics |= presentSupported == VK_TRUE;
+		}
+		else if (flags & VK_QUEUE_COMPUTE_BIT)
+		{
+			score += 50;
+		}
+		else if (flags & VK_QUEUE_TRANSFER_BIT)
+		{
+			score += 50;
+		}
+	}
+	if (!hasGraphics)
+	{
+		return -1;
+	}
+
+	// foCX̎
+	switch (props.deviceType)
+	{
+	case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU:
+		score += 10000;
+		break;
+	case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU:
+		score += 1000;
+		break;
+	case VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU:
+		score += 500;
+		break;
+	default:
+		break;
+	}
+
+	// device local̃ (256MiBƂɉ_)
+	VkPhysicalDeviceMemoryProperties memoryProps;
+	vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memoryProps);
+	for (uint32_t i = 0; i < memoryProps.memoryHeapCount; ++i)
+	{
+		if (memoryProps.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT)
+		{
+			score += int64_t(memoryProps.memoryHeaps[i].size >> 28);
+		}
+	}
+
+	return score;
 }
 
 
@@ -155,60 +577,203 @@ uint32_t AppBase::SearchGraphicsQueueFamilyIndex()
 	vkGetPhysicalDeviceQueueFamilyProperties(_physicalDevice, &count, props.data());
 
 	// 擾L[t@~[̂AOtBbNXp̃L[t@~[̃CfbNX擾
+	// (Surfaceꍇ͕\łt@~[)
 	uint32_t graphicsQueue = ~0u;
 	for (uint32_t i = 0; i < count; ++i)
 	{
 		if (props[i].queueFlags & VK_QUEUE_GRAPHICS_BIT)
 		{
-			graphicsQueue = i;
-			break;
+			VkBool32 presentSupported = VK_TRUE;
+			if (_surface != VK_NULL_HANDLE)
+			{
+				vkGetPhysicalDeviceSurfaceSupportKHR(_physicalDevice, i, _surface, &presentSupported);
+			}
+			if (presentSupported == VK_TRUE)
+			{
+				graphicsQueue = i;
+				break;
+			}
 		}
 	}
 
 	return graphicsQueue;
 }	
 
+// ]p̃L[t@~[T (Ȃꍇ̓OtBbNXp̃L[t@~[)
+uint32_t AppBase::SearchTransferQueueFamilyIndex()
+{
+	uint32_t count = 0;
+	vkGetPhysicalDeviceQueueFamilyProperties(_physicalDevice, &count, nullptr);
+	std::vector<VkQueueFamilyProperties> props(count);
+	vkGetPhysicalDeviceQueueFamilyProperties(_physicalDevice, &count, props.data());
+
+	// OtBbNXƃRs[gȂt@~[DMAGWŏ
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		const auto flags = props[i].queueFlags;
+		if ((flags & VK_QUEUE_TRANSFER_BIT) && !(flags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT)))
+		{
+			return i;
+		}
+	}
+
+	return _graphicsQueueFamilyIndex;
+}
+
+// Rs[gp̃L[T
+// OtBbNXȂt@~[AOtBbNX̃t@~[2ڂ̃L[AOtBbNXƓL[̏ɑI
+uint32_t AppBase::SearchComputeQueueFamilyIndex(uint32_t& queueIndex)
+{
+	uint32_t count = 0;
+	vkGetPhysicalDeviceQueueFamilyProperties(_physicalDevice, &count, nullptr);
+	std::vector<VkQueueFamilyProperties> props(count);
+	vkGetPhysicalDeviceQueueFamilyProperties(_physicalDevice, &count, props.data());
+
+	queueIndex = 0;
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		const auto flags = props[i].queueFlags;
+		if ((flags & VK_QUEUE_COMPUTE_BIT) && !(flags & VK_QUEUE_GRAPHICS_BIT))
+		{
+			return i;
+		}
+	}
+
+	// OtBbNX̃t@~[̓Rs[gKT|[gĂ
+	if (props[_graphicsQueueFamilyIndex].queueCount > 1)
+	{
+		queueIndex = 1;
+	}
+	return _graphicsQueueFamilyIndex;
+}
+
 
 // _foCX쐬
-void AppBase::CreateDevice()
+VkResult AppBase::CreateDevice()
 {
-	const float defaultQueuePriority(1.0f);
-	VkDeviceQueueCreateInfo deviceQueueCreateInfo{};
-	deviceQueueCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
-	deviceQueueCreateInfo.queueFamilyIndex = _graphicsQueueFamilyIndex;
-	deviceQueueCreateInfo.queueCount = 1;
-	deviceQueueCreateInfo.pQueuePriorities = &defaultQueuePriority;
+	const float defaultQueuePriorities[] = { 1.0f, 1.0f };
+	std::vector<VkDeviceQueueCreateInfo> deviceQueueCreateInfos;
+	{
+		// OtBbNX̃t@~[Rs[gp2ڂ̃L[ꍇ
+		VkDeviceQueueCreateInfo deviceQueueCreateInfo{};
+		deviceQueueCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+		deviceQueueCreateInfo.queueFamilyIndex = _graphicsQueueFamilyIndex;
+		deviceQueueCreateInfo.queueCount = _computeQueueFamilyIndex == _graphicsQueueFamilyIndex ? _computeQueueIndex + 1 : 1;
+		deviceQueueCreateInfo.pQueuePriorities = defaultQueuePriorities;
+		deviceQueueCreateInfos.push_back(deviceQueueCreateInfo);
+
+		// ]p̃L[
+		if (_transferQueueFamilyIndex != _graphicsQueueFamilyIndex)
+		{
+			deviceQueueCreateInfo.queueFamilyIndex = _transferQueueFamilyIndex;
+			deviceQueueCreateInfo.queueCount = 1;
+			deviceQueueCreateInfos.push_back(deviceQueueCreateInfo);
+		}
+
+		// Rs[gp̃L[
+		if (_computeQueueFamilyIndex != _graphicsQueueFamilyIndex)
+		{
+			deviceQueueCreateInfo.queueFamilyIndex = _computeQueueFamilyIndex;
+			deviceQueueCreateInfo.queueCount = 1;
+			deviceQueueCreateInfos.push_back(deviceQueueCreateInfo);
+		}
+	}
 
-	// device extension̎擾
+	// 錾ꂽg@\̂T|[gĂ̂Lɂ
 	std::vector<const char*> extensions;
-	std::vector<VkExtensionProperties> props;
 	{
 		uint32_t count = 0;
 		vkEnumerateDeviceExtensionProperties(_physicalDevice, nullptr, &count, nullptr);
-		props.resize(count);
+		std::vector<VkExtensionProperties> props(count);
 		vkEnumerateDeviceExtensionProperties(_physicalDevice, nullptr, &count, props.data());
 
-		for (const auto& v : props)
+		_enabledDeviceExtensions.clear();
+		for (const auto& v : _deviceExtensionRequests)
+		{
+			auto found = std::find_if(props.begin(), props.end(), [&](const VkExtensionProperties& p) { return v.name == p.extensionName; });
+			if (found != props.end())
+			{
+				_enabledDeviceExtensions.push_back(v.name);
+			}
+		}
+		for (const auto& v : _enabledDeviceExtensions)
+		{
+			extensions.push_back(v.c_str());
+		}
+	}
+
+	// 錾ꂽ@\̂T|[gĂ̂Lɂ
+	{
+		VkPhysicalDeviceFeatures supported;
+		vkGetPhysicalDeviceFeatures(_physicalDevice, &supported);
+
+		_enabledFeatures = VkPhysicalDeviceFeatures{};
+		for (const auto& v : _featureRequests)
 		{
-			extensions.emplace_back(v.extensionName);
+			_enabledFeatures.*v.feature = supported.*v.feature;
 		}
 	}
 
+	// fXNv^CfbNX̋@\ (oChX̃e[uɕKvȂ̂ĂꍇLɂ)
+	_descriptorIndexingFeatures = VkPhysicalDeviceDescriptorIndexingFeaturesEXT{};
+	_descriptorIndexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+	auto descriptorIndexing = false;
+	if (IsDeviceExtensionEnabled(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME))
+	{
+		VkPhysicalDeviceDescriptorIndexingFeaturesEXT supported{};
+		supported.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+		VkPhysicalDeviceFeatures2 features2{};
+		features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+		features2.pNext = &supported;
+		vkGetPhysicalDeviceFeatures2(_physicalDevice, &features2);
+		descriptorIndexing = BindlessTable::SelectFeatures(supported, _descriptorIndexingFeatures);
+	}
+
+	// ^CCZ}tH̋@\
+	VkPhysicalDeviceTimelineSemaphoreFeaturesKHR timelineSemaphoreFeatures{};
+	timelineSemaphoreFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES_KHR;
+	auto timelineSemaphore = false;
+	if (IsDeviceExtensionEnabled(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME))
+	{
+		VkPhysicalDeviceFeatures2 features2{};
+		features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+		features2.pNext = &timelineSemaphoreFeatures;
+		vkGetPhysicalDeviceFeatures2(_physicalDevice, &features2);
+		timelineSemaphore = timelineSemaphoreFeatures.timelineSemaphore == VK_TRUE;
+		timelineSemaphoreFeatures.pNext = descriptorIndexing ? &_descriptorIndexingFeatures : nullptr;
+	}
+
 	// Device Create Info ̏
 	VkDeviceCreateInfo ci{};
 	ci.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
-	ci.pQueueCreateInfos = &deviceQueueCreateInfo;
-	ci.queueCreateInfoCount = 1;
+	ci.pQueueCreateInfos = deviceQueueCreateInfos.data();
+	ci.queueCreateInfoCount = uint32_t(deviceQueueCreateInfos.size());
 	ci.ppEnabledExtensionNames = extensions.data();
 	ci.enabledExtensionCount = uint32_t(extensions.size());
+	ci.pEnabledFeatures = &_enabledFeatures;
+	ci.pNext = descriptorIndexing ? &_descriptorIndexingFeatures : nullptr;
+	if (timelineSemaphore)
+	{
+		ci.pNext = &timelineSemaphoreFeatures;
+	}
 
 
 	// foCX̐
 	auto result = vkCreateDevice(_physicalDevice, &ci, nullptr, &_device);
-	CheckResult(result);
+	if (result != VK_SUCCESS)
+	{
+		return result;
+	}
 
 	// foCXL[̎擾
 	vkGetDeviceQueue(_device, _graphicsQueueFamilyIndex, 0, &_deviceQueue);
+	vkGetDeviceQueue(_device, _transferQueueFamilyIndex, 0, &_transferQueue);
+	vkGetDeviceQueue(_device, _computeQueueFamilyIndex, _computeQueueIndex, &_computeQueue);
+
+	// L[Ƃ̃^CC̐
+	_timeline.Initialize(_device, timelineSemaphore);
+	_deletionQueue.Initialize(&_timeline);
+	return VK_SUCCESS;
 }
 
 
@@ -223,37 +788,226 @@ void AppBase::CreateCommandPool()
 	CheckResult(result);
 }
 
-
-// SurfacẽtH[}bgI
-void AppBase::SelectSurfaceFormat(VkFormat format)
+
+// pCvCLbṼt@C̐擪ɕtwb_
+// (vk̃wb_ɉāAhCõo[WƉĂȂmF)
+struct PipelineCacheFileHeader
+{
+	uint32_t magic;
+	uint32_t driverVersion;
+	uint64_t dataSize;
+	uint64_t dataHash;
+};
+static const uint32_t PipelineCacheFileMagic = 0x43505056; // "VPPC"
+
+// FNV-1a
+static uint64_t HashBytes(const uint8_t* data, size_t size)
+{
+	uint64_t hash = 14695981039346656037ull;
+	for (size_t i = 0; i < size; ++i)
+	{
+		hash ^= data[i];
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+// pCvCLbVt@CǂݍŐ
+void AppBase::LoadPipelineCache()
+{
+	VkPhysicalDeviceProperties props;
+	vkGetPhysicalDeviceProperties(_physicalDevice, &props);
+
+	// t@C̓ǂݍ
+	// dataSize̓t@C̑傫ƈvꍇMp (ꂽt@CŋȊmۂȂ)
+	std::vector<uint8_t> data;
+	{
+		std::ifstream file(_pipelineCachePath, std::ios::binary | std::ios::ate);
+		const auto fileSize = file ? uint64_t(std::streamoff(file.tellg())) : 0;
+		file.seekg(0, std::ios::beg);
+
+		PipelineCacheFileHeader header{};
+		if (file.read(reinterpret_cast<char*>(&header), sizeof(header))
+			&& header.magic == PipelineCacheFileMagic
+			&& header.driverVersion == props.driverVersion
+			&& header.dataSize >= sizeof(VkPipelineCacheHeaderVersionOne)
+			&& header.dataSize == fileSize - sizeof(header))
+		{
+			data.resize(size_t(header.dataSize));
+			if (!file.read(reinterpret_cast<char*>(data.data()), data.size())
+				|| HashBytes(data.data(), data.size()) != header.dataHash)
+			{
+				data.clear();
+			}
+		}
+	}
+
+	// vk̃wb_̃foCX̂̂mF
+	if (!data.empty())
+	{
+		VkPipelineCacheHeaderVersionOne cacheHeader;
+		memcpy(&cacheHeader, data.data(), sizeof(cacheHeader));
+		if (cacheHeader.headerSize < sizeof(cacheHeader)
+			|| cacheHeader.headerVersion != VK_PIPELINE_CACHE_HEADER_VERSION_ONE
+			|| cacheHeader.vendorID != props.vendorID
+			|| cacheHeader.deviceID != props.deviceID
+			|| memcmp(cacheHeader.pipelineCacheUUID, props.pipelineCacheUUID, VK_UUID_SIZE) != 0)
+		{
+			data.clear();
+		}
+	}
+
+	VkPipelineCacheCreateInfo ci{};
+	ci.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+	ci.initialDataSize = data.size();
+	ci.pInitialData = data.empty() ? nullptr : data.data();
+	auto result = vkCreatePipelineCache(_device, &ci, nullptr, &_pipelineCache);
+	if (result != VK_SUCCESS && !data.empty())
+	{
+		// ǂݍ߂Ȃꍇ͋̃LbVō蒼
+		ci.initialDataSize = 0;
+		ci.pInitialData = nullptr;
+		data.clear();
+		result = vkCreatePipelineCache(_device, &ci, nullptr, &_pipelineCache);
+	}
+	CheckResult(result);
+
+	_pipelineCacheWarm = !data.empty();
+}
+
+// pCvCLbVt@C֕ۑ
+// (ꎞt@CɏĂûŁArŗĂÕt@C͉Ȃ)
+void AppBase::SavePipelineCache()
+{
+	if (_pipelineCache == VK_NULL_HANDLE || _pipelineCachePath.empty())
+	{
+		return;
+	}
+
+	size_t size = 0;
+	vkGetPipelineCacheData(_device, _pipelineCache, &size, nullptr);
+	std::vector<uint8_t> data(size);
+	if (size == 0 || vkGetPipelineCacheData(_device, _pipelineCache, &size, data.data()) != VK_SUCCESS)
+	{
+		return;
+	}
+
+	VkPhysicalDeviceProperties props;
+	vkGetPhysicalDeviceProperties(_physicalDevice, &props);
+
+	PipelineCacheFileHeader header{};
+	header.magic = PipelineCacheFileMagic;
+	header.driverVersion = props.driverVersion;
+	header.dataSize = size;
+	header.dataHash = HashBytes(data.data(), size);
+
+	const auto tempPath = _pipelineCachePath + ".tmp";
+	{
+		std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(reinterpret_cast<const char*>(data.data()), size);
+		file.flush();
+		if (!file)
+		{
+			file.close();
+			std::remove(tempPath.c_str());
+			return;
+		}
+	}
+
+#ifdef _WIN32
+	MoveFileExA(tempPath.c_str(), _pipelineCachePath.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+#else
+	std::rename(tempPath.c_str(), _pipelineCachePath.c_str());
+#endif
+}
+
+// SurfacẽtH[}bgI
+void AppBase::SelectSurfaceFormat(VkFormat format)
+{
+	uint32_t count = 0;
+	vkGetPhysicalDeviceSurfaceFormatsKHR(_physicalDevice, _surface, &count, nullptr);
+	std::vector<VkSurfaceFormatKHR> formats(count);
+	vkGetPhysicalDeviceSurfaceFormatsKHR(_physicalDevice, _surface, &count, formats.data());
+	
+	for (const auto& f : formats)
+	{
+		if (f.format == format)
+		{
+			_surfaceFormat = f;
+		}
+	}
+}
+
+// jɍ\[hI
+void AppBase::SelectPresentMode()
+{
+	uint32_t count = 0;
+	vkGetPhysicalDeviceSurfacePresentModesKHR(_physicalDevice, _surface, &count, nullptr);
+	std::vector<VkPresentModeKHR> modes(count);
+	vkGetPhysicalDeviceSurfacePresentModesKHR(_physicalDevice, _surface, &count, modes.data());
+
+	auto isSupported = [&](VkPresentModeKHR mode)
+	{
+		return std::find(modes.begin(), modes.end(), mode) != modes.end();
+	};
+
+	// FIFO͕KT|[gĂ
+	_presentMode = VK_PRESENT_MODE_FIFO_KHR;
+	if (_presentPolicy == PresentPolicy::Throughput)
+	{
+		// eBAÔȂMAILBOXD悷
+		if (isSupported(VK_PRESENT_MODE_MAILBOX_KHR))
+		{
+			_presentMode = VK_PRESENT_MODE_MAILBOX_KHR;
+		}
+		else if (isSupported(VK_PRESENT_MODE_IMMEDIATE_KHR))
+		{
+			_presentMode = VK_PRESENT_MODE_IMMEDIATE_KHR;
+		}
+	}
+}
+
+// jɍswapchaiñC[W
+uint32_t AppBase::GetSwapchainImageCount() const
 {
 	uint32_t count = 0;
-	vkGetPhysicalDeviceSurfaceFormatsKHR(_physicalDevice, _surface, &count, nullptr);
-	std::vector<VkSurfaceFormatKHR> formats(count);
-	vkGetPhysicalDeviceSurfaceFormatsKHR(_physicalDevice, _surface, &count, formats.data());
-	
-	for (const auto& f : formats)
+	switch (_presentPolicy)
 	{
-		if (f.format == format)
-		{
-			_surfaceFormat = f;
-		}
+	case PresentPolicy::LowLatency:
+		// \҂̃C[W𑝂₳Ȃ
+		count = (std::max)(2u, _surfaceCapabilities.minImageCount);
+		break;
+	case PresentPolicy::Throughput:
+		// present҂Ɏ̃C[W֕`ł悤߂Ɏ
+		count = (std::max)(3u, _surfaceCapabilities.minImageCount + 1);
+		break;
+	default:
+		count = (std::max)(2u, _surfaceCapabilities.minImageCount);
+		break;
 	}
+
+	// maxImageCount0̏ꍇ͏Ȃ
+	if (_surfaceCapabilities.maxImageCount > 0)
+	{
+		count = (std::min)(count, _surfaceCapabilities.maxImageCount);
+	}
+	return count;
 }
 
 
 // Swapchain𐶐
 void AppBase::CreateSwapchain(GLFWwindow* window)
 {
-	auto minImageCount = (std::max)(2u, _surfaceCapabilities.minImageCount);
+	auto minImageCount = GetSwapchainImageCount();
 	auto extent = _surfaceCapabilities.currentExtent;
 	if (extent.width == ~0u)
 	{
-		// Ȓl̏ꍇAEBhETCYgp
+		// Ȓl̏ꍇAt[obt@̃TCYgp
 		int width, height;
-		glfwGetWindowSize(window, &width, &height);
-		extent.width = uint32_t(width);
-		extent.height = uint32_t(height);
+		glfwGetFramebufferSize(window, &width, &height);
+		extent.width = (std::min)((std::max)(uint32_t(width), _surfaceCapabilities.minImageExtent.width), _surfaceCapabilities.maxImageExtent.width);
+		extent.height = (std::min)((std::max)(uint32_t(height), _surfaceCapabilities.minImageExtent.height), _surfaceCapabilities.maxImageExtent.height);
 	}
 
 	//uint32_t queueFamilyIndices[] = { _graphicsQueueFamilyIndex };
@@ -273,71 +1027,160 @@ void AppBase::CreateSwapchain(GLFWwindow* window)
 	ci.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
 	ci.presentMode = _presentMode;
 	ci.clipped = VK_TRUE;
-	ci.oldSwapchain = VK_NULL_HANDLE;
+	ci.oldSwapchain = _swapchain;	// 蒼̏ꍇ͌ÂswapchainnA\[Xp
 
-	auto result = vkCreateSwapchainKHR(_device, &ci, nullptr, &_swapchain);
+	VkSwapchainKHR swapchain;
+	auto result = vkCreateSwapchainKHR(_device, &ci, nullptr, &swapchain);
 	CheckResult(result);
+	_swapchain = swapchain;
 	_swapchainExtent2D = extent;
 }
 
-// Depth Buffer𐶐
-void AppBase::CreateDepthBuffer()
+// TCYɈˑ郊\[X(swapchain, ImageView, Ot̃C[Wframebuffer)蒼
+// foCXŜ̊͑҂AÂ\[X͎gĂt[IĂj
+bool AppBase::RecreateSwapchain()
+{
+	vkGetPhysicalDeviceSurfaceCapabilitiesKHR(_physicalDevice, _surface, &_surfaceCapabilities);
+
+	// ŏ͍蒼Ȃ (TCY߂܂ŕ`XLbv)
+	auto extent = _surfaceCapabilities.currentExtent;
+	if (extent.width == ~0u)
+	{
+		int width, height;
+		glfwGetFramebufferSize(_window, &width, &height);
+		extent.width = uint32_t(width);
+		extent.height = uint32_t(height);
+	}
+	if (extent.width == 0 || extent.height == 0)
+	{
+		return false;
+	}
+
+	// Â\[Xj҂ֈڂ (swapchaiñnholdSwapchainƂĎg)
+	std::vector<std::function<void()>> retired;
+	RetireSwapchainResources(retired);
+
+	SelectPresentMode();
+
+	CreateSwapchain(_window);
+	CreateImageViews();
+	CreateRenderCompletedSemaphores();
+
+	// Ot̃C[Wƃt[obt@Â͔̂j҂ɂ
+	auto resized = _renderGraph.Resize(_swapchainExtent2D, &retired);
+	CheckResult(resized ? VK_SUCCESS : VK_ERROR_OUT_OF_DEVICE_MEMORY);
+
+	// t[obt@r[QƂĂ̂ŁAォǉOt̂̂ɔj
+	for (auto it = retired.rbegin(); it != retired.rend(); ++it)
+	{
+		_deletionQueue.Retire(GpuTimeline::Graphics, *it);
+	}
+
+	_swapchainDirty = false;
+	return true;
+}
+
+// TCYɈˑ郊\[Xj֐retired֒ǉ
+// \҂Z}tHƌÂswapchaińAM̊ł͕\Z}tHgIȂ̂ŁA
+// VswapchainŌÂC[W̐擾iłj (\IC[W擾ł邽)
+void AppBase::RetireSwapchainResources(std::vector<std::function<void()>>& retired)
+{
+	auto device = _device;
+	auto swapchain = _swapchain;
+	auto imageViews = std::move(_swapchainImageViews);
+	auto semaphores = std::move(_renderCompletedSemaphores);
+	_swapchainImageViews.clear();
+	_renderCompletedSemaphores.clear();
+	retired.emplace_back([device, imageViews]()
+	{
+		for (auto& v : imageViews)
+		{
+			vkDestroyImageView(device, v, nullptr);
+		}
+	});
+
+	RetiredPresent present;
+	present.acquireCount = _acquireCount + _swapchainImages.size();
+	present.deleter = [device, swapchain, semaphores]()
+	{
+		for (auto& v : semaphores)
+		{
+			vkDestroySemaphore(device, v, nullptr);
+		}
+		vkDestroySwapchainKHR(device, swapchain, nullptr);
+	};
+	_retiredPresents.push_back(std::move(present));
+
+	_swapchainImages.clear();
+}
+
+// 擾\ɐi񂾌ÂswapchainAMς݂̃t[̊ɔj
+void AppBase::UpdateRetiredPresents()
+{
+	auto it = _retiredPresents.begin();
+	for (; it != _retiredPresents.end() && it->acquireCount <= _acquireCount; ++it)
+	{
+		_deletionQueue.Retire(GpuTimeline::Graphics, it->deleter);
+	}
+	_retiredPresents.erase(_retiredPresents.begin(), it);
+}
+
+// Mς݂̃t[Ăj
+void AppBase::Retire(const std::function<void()>& deleter)
+{
+	_deletionQueue.Retire(GpuTimeline::Graphics, deleter);
+}
+
+// EBhẼTCYςƂɌĂ΂
+void AppBase::FramebufferSizeCallback(GLFWwindow* window, int /*width*/, int /*height*/)
+{
+	auto app = static_cast<AppBase*>(glfwGetWindowUserPointer(window));
+	if (app != nullptr)
+	{
+		app->NotifyResized();
+	}
+}
+
+// headlessswapchain̑ƂȂC[W𐶐
+void AppBase::CreateOffscreenImages()
 {
 	VkImageCreateInfo ci{};
 	ci.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
 	ci.imageType = VK_IMAGE_TYPE_2D;
-	ci.format = VK_FORMAT_D32_SFLOAT;
+	ci.format = _surfaceFormat.format;
 	ci.extent.width = _swapchainExtent2D.width;
 	ci.extent.height = _swapchainExtent2D.height;
 	ci.extent.depth = 1;
 	ci.mipLevels = 1;
 	ci.arrayLayers = 1;
 	ci.samples = VK_SAMPLE_COUNT_1_BIT;
-	ci.usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
-
-	// VkImage ̐
-	auto result = vkCreateImage(_device, &ci, nullptr, &_depthBuffer);
-	CheckResult(result);
-
-	// ̊ƃoCh
-	VkMemoryRequirements memoryRequirements;
-	vkGetImageMemoryRequirements(_device, _depthBuffer, &memoryRequirements);
-	VkMemoryAllocateInfo ai{};
-	ai.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-	ai.allocationSize = memoryRequirements.size;
-	ai.memoryTypeIndex = GetMemoryTypeIndex(memoryRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
-	vkAllocateMemory(_device, &ai, nullptr, &_depthBufferMemory);
-	vkBindImageMemory(_device, _depthBuffer, _depthBufferMemory, 0);
-}
-
-// ^Cv̎擾
-uint32_t AppBase::GetMemoryTypeIndex(uint32_t requestBits, VkMemoryPropertyFlags requestProps)const
-{
-	uint32_t result = ~0u;
-	for (uint32_t i = 0; i < _physicalDeviceMemoryProperties.memoryTypeCount; ++i)
+	ci.tiling = VK_IMAGE_TILING_OPTIMAL;
+	ci.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+	ci.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+	ci.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+	// ɏt[C[W֏܂Ȃ悤At[pӂ
+	_swapchainImages.resize(_framesInFlight);
+	_offscreenImageAllocations.resize(_framesInFlight);
+	for (uint32_t i = 0; i < _framesInFlight; ++i)
 	{
-		if (requestBits & 1)
-		{
-			const auto& types = _physicalDeviceMemoryProperties.memoryTypes[i];
-			if ((types.propertyFlags & requestProps) == requestProps)
-			{
-				result = i;
-				break;
-			}
-		}
-		requestBits >>= 1;
+		// VkImage ̐ƃ̃oCh
+		auto created = _memoryAllocator.CreateImage(ci, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, _swapchainImages[i], _offscreenImageAllocations[i]);
+		CheckResult(created ? VK_SUCCESS : VK_ERROR_OUT_OF_DEVICE_MEMORY);
 	}
-	return result;
 }
 
 // Image view ̐
 void AppBase::CreateImageViews()
 {
-	// swapchain
-	uint32_t imageCount;
-	vkGetSwapchainImagesKHR(_device, _swapchain, &imageCount, nullptr);
-	_swapchainImages.resize(imageCount);
-	vkGetSwapchainImagesKHR(_device, _swapchain, &imageCount, _swapchainImages.data());
+	// swapchain (headless̓ItXN[C[Wς)
+	uint32_t imageCount = uint32_t(_swapchainImages.size());
+	if (!_headless)
+	{
+		vkGetSwapchainImagesKHR(_device, _swapchain, &imageCount, nullptr);
+		_swapchainImages.resize(imageCount);
+		vkGetSwapchainImagesKHR(_device, _swapchain, &imageCount, _swapchainImages.data());
+	}
 	_swapchainImageViews.resize(imageCount);
 	
 	for (uint32_t i = 0; i < imageCount; ++i)
@@ -357,203 +1200,318 @@ void AppBase::CreateImageViews()
 		auto result = vkCreateImageView(_device, &ci, nullptr, &_swapchainImageViews[i]);
 		CheckResult(result);
 	}
-
-	// depthbuffer
-	{
-		VkImageViewCreateInfo ci{};
-		ci.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
-		ci.viewType = VK_IMAGE_VIEW_TYPE_2D;
-		ci.format = VK_FORMAT_D32_SFLOAT;
-		ci.components = {
-		  VK_COMPONENT_SWIZZLE_R,
-		  VK_COMPONENT_SWIZZLE_G,
-		  VK_COMPONENT_SWIZZLE_B,
-		  VK_COMPONENT_SWIZZLE_A,
-		};
-		ci.subresourceRange = { VK_IMAGE_ASPECT_DEPTH_BIT, 0, 1, 0, 1 };
-		ci.image = _depthBuffer;
-		auto result = vkCreateImageView(_device, &ci, nullptr, &_depthBufferView);
-		CheckResult(result);
-	}
 }
 
-// render pass ̐
-void AppBase::CreateRenderPass()
-{
-	// attachment descriptions
-	std::array<VkAttachmentDescription, 2> attachmentDescriptions;
-	auto& colorTarget = attachmentDescriptions[0];
-	auto& depthTarget = attachmentDescriptions[1];
-
-	colorTarget = VkAttachmentDescription{};
-	colorTarget.format = _surfaceFormat.format;
-	colorTarget.samples = VK_SAMPLE_COUNT_1_BIT;
-	colorTarget.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-	colorTarget.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-	colorTarget.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-	colorTarget.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-	colorTarget.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-	colorTarget.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
-
-	depthTarget = VkAttachmentDescription{};
-	depthTarget.format = VK_FORMAT_D32_SFLOAT;
-	depthTarget.samples = VK_SAMPLE_COUNT_1_BIT;
-	depthTarget.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-	depthTarget.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-	depthTarget.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-	depthTarget.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-	depthTarget.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-	depthTarget.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-
-	// attachment references
-	VkAttachmentReference colorReference{}, depthReference{};
-	colorReference.attachment = 0;
-	colorReference.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-
-	depthReference.attachment = 1;
-	depthReference.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-
-	// subpass description
-	VkSubpassDescription subpassDesc{};
-	subpassDesc.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
-	subpassDesc.colorAttachmentCount = 1;
-	subpassDesc.pColorAttachments = &colorReference;
-	subpassDesc.pDepthStencilAttachment = &depthReference;
-
-	// create render pass 
-	VkRenderPassCreateInfo ci{};
-	ci.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
-	ci.attachmentCount = uint32_t(attachmentDescriptions.size());
-	ci.pAttachments = attachmentDescriptions.data();
-	ci.subpassCount = 1;
-	ci.pSubpasses = &subpassDesc;
-
-	auto result = vkCreateRenderPass(_device, &ci, nullptr, &_renderPass);
-	CheckResult(result);
+// `̃pX̐錾ƃ_[pXȂǂ̐
+void AppBase::InitializeRenderGraph()
+{
+	_renderGraph.Initialize(_device, &_memoryAllocator);
+
+	// `̓t[ƂɎ擾C[Wݒ肷
+	_backbuffer = _renderGraph.ImportImage("Backbuffer", _surfaceFormat.format, VK_IMAGE_LAYOUT_UNDEFINED,
+		_headless ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+
+	// CreateCommandSetupRenderGraphԂpXŋL^
+	_commandPass = SetupRenderGraph(_renderGraph, _backbuffer);
+	_renderGraph.GetPass(_commandPass).SetExecute([this](const RenderGraph::PassContext& context) { RecordCommandTasks(context); });
+
+	auto compiled = _renderGraph.Compile(_swapchainExtent2D);
+	CheckResult(compiled ? VK_SUCCESS : VK_ERROR_INITIALIZATION_FAILED);
 }
 
-// framebuffer̐
-void AppBase::CreateFramebuffer()
+// ̕`: backbufferdepth buffer֕`1̃pX
+// depth buffer͂̃pX̒ŎĝŁAoTRANSIENTȃɒu
+uint32_t AppBase::SetupRenderGraph(RenderGraph& graph, RenderGraph::Resource backbuffer)
 {
-	VkFramebufferCreateInfo ci{};
-	ci.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
-	ci.renderPass = _renderPass;
-	ci.width = _swapchainExtent2D.width;
-	ci.height = _swapchainExtent2D.height;
-	ci.layers = 1;
+	RenderGraph::ImageDesc depthDesc;
+	depthDesc.format = VK_FORMAT_D32_SFLOAT;
+	auto depth = graph.CreateImage("Depth", depthDesc);
 
-	_framebuffers.clear();
-	for (auto& v : _swapchainImageViews)
+	// NAl̐ݒ
+	const VkClearColorValue clearColor = { { 0.5f, 0.25f, 0.25f, 1.0f } };
+	const VkClearDepthStencilValue clearDepth = { 1.0f, 0 };
+
+	auto& pass = graph.AddGraphicsPass("Main")
+		.WriteColor(backbuffer, &clearColor)
+		.WriteDepth(depth, &clearDepth);
+	return pass.GetIndex();
+}
+
+// CreateCommand^XNƂ1̃ZJ_R}hobt@֋L^t[̃^XNǉ
+// e^XN͎sXbh̃v[ZJ_R}hobt@mۂ
+void AppBase::AddCommandTasks(JobGraph::TaskId dependency)
+{
+	// ^XNꍇ̓ZJ_R}hobt@ŕ`悷
+	_commandTaskCount = GetCommandTaskCount();
+	_renderGraph.GetPass(_commandPass).SetSecondaryCommands(_commandTaskCount > 0);
+	_secondaryCommands.assign(_commandTaskCount, VK_NULL_HANDLE);
+
+	const auto renderPass = GetRenderPass();
+	const auto subpass = GetSubpass();
+	for (uint32_t i = 0; i < _commandTaskCount; ++i)
 	{
-		std::array<VkImageView, 2> imageViews;
-		ci.attachmentCount = uint32_t(imageViews.size());
-		ci.pAttachments = imageViews.data();
-		imageViews[0] = v;
-		imageViews[1] = _depthBufferView;
+		_frameTasks.AddTask("RecordCommands", [this, renderPass, subpass, i]()
+		{
+			_secondaryCommands[i] = _commandRecorder.RecordSecondary(renderPass, subpass, VK_NULL_HANDLE, i,
+				[this](VkCommandBuffer secondary, uint32_t taskIndex, uint32_t threadIndex) { CreateCommand(secondary, taskIndex, threadIndex); });
+		}, { dependency });
+	}
+}
 
-		VkFramebuffer framebuffer;
-		auto result = vkCreateFramebuffer(_device, &ci, nullptr, &framebuffer);
-		CheckResult(result);
-		_framebuffers.emplace_back(framebuffer);
+// t[̃^XNŋL^ZJ_R}hobt@s
+void AppBase::RecordCommandTasks(const RenderGraph::PassContext& context)
+{
+	if (_commandTaskCount == 0)
+	{
+		return;
 	}
+	vkCmdExecuteCommands(context.command, uint32_t(_secondaryCommands.size()), _secondaryCommands.data());
 }
 
-// command buffer ̊蓖
-void AppBase::AllocateCommandBuffers()
+// WuVXẽXbhcommand buffer̃v[̏
+void AppBase::InitializeCommandRecorder()
 {
-	VkCommandBufferAllocateInfo ai{};
-	ai.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-	ai.commandPool = _commandPool;
-	ai.commandBufferCount = uint32_t(_swapchainImageViews.size());
-	ai.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	// w肪Ȃꍇ̓RAɍ킹
+	auto threadCount = _recordThreadCount;
+	if (threadCount == 0)
+	{
+		threadCount = (std::max)(1u, std::thread::hardware_concurrency());
+	}
 
-	_commandBuffers.resize(ai.commandBufferCount);
-	auto result = vkAllocateCommandBuffers(_device, &ai, _commandBuffers.data());
-	CheckResult(result);
+	_jobSystem.Initialize(threadCount);
+	_commandRecorder.Initialize(_device, _graphicsQueueFamilyIndex, _framesInFlight, &_jobSystem);
 }
 
-// fence̐
-void AppBase::CreateFences()
+// Z}tH̐
+void AppBase::CreateSemaphores()
 {
-	VkFenceCreateInfo ci{};
-	ci.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-	ci.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+	VkSemaphoreCreateInfo ci{};
+	ci.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
 
-	_fences.resize(_commandBuffers.size());
-	for (auto& v : _fences)
+	// C[W擾̊̓t[
+	_presentCompletedSemaphores.resize(_framesInFlight);
+	for (auto& v : _presentCompletedSemaphores)
 	{
-		auto result = vkCreateFence(_device, &ci, nullptr, &v);
+		auto result = vkCreateSemaphore(_device, &ci, nullptr, &v);
 		CheckResult(result);
 	}
+
+	CreateRenderCompletedSemaphores();
 }
 
-// Z}tH̐
-void AppBase::CreateSemaphores()
+// `̊presentI܂Ŏgꑱ邽߁AswapchaiñC[WƂɐ
+void AppBase::CreateRenderCompletedSemaphores()
 {
 	VkSemaphoreCreateInfo ci{};
 	ci.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
-	vkCreateSemaphore(_device, &ci, nullptr, &_renderCompletedSemaphore);
-	vkCreateSemaphore(_device, &ci, nullptr, &_presentCompletedSemaphore);
+
+	_renderCompletedSemaphores.resize(_swapchainImages.size());
+	for (auto& v : _renderCompletedSemaphores)
+	{
+		auto result = vkCreateSemaphore(_device, &ci, nullptr, &v);
+		CheckResult(result);
+	}
+}
+
+// ̃t[n߂܂ő҂
+void AppBase::WaitForNextFrame()
+{
+	// ̃t[p̃\[XOgt[̊҂
+	// LowLatency̏ꍇ͒Õt[̊܂ő҂ACPUGPUsȂ悤ɂ
+	// (͂ǂł\܂łɋ܂t[炷)
+	auto waitFrames = _frameNumber + 1 >= _framesInFlight ? _frameNumber + 1 - _framesInFlight : 0;
+	if (_presentPolicy == PresentPolicy::LowLatency)
+	{
+		waitFrames = _frameNumber;
+	}
+	_timeline.Wait(GpuTimeline::Graphics, waitFrames);
+	CollectInputLatency();
+
+	// ̒ɓ͂ǂ
+	_inputSampleTimes[_frameIndex] = std::chrono::steady_clock::now();
+	_inputSampled = true;
+}
+
+// t[́A͂CPUmF܂ł̎ԂL^
+// (GPŮ\̎ł͂ȂAWaitForNextFrameRender̍ŏ̑ҋ@ŊmF܂)
+void AppBase::CollectInputLatency()
+{
+	const auto now = std::chrono::steady_clock::now();
+	const auto completedFrames = _timeline.GetCompleted(GpuTimeline::Graphics);
+	for (uint32_t i = 0; i < _framesInFlight; ++i)
+	{
+		if (_latencyFrameValues[i] == 0 || _latencyFrameValues[i] > completedFrames)
+		{
+			continue;
+		}
+
+		std::chrono::duration<double, std::milli> elapsed = now - _inputSampleTimes[i];
+		_inputLatencyMs = elapsed.count();
+		_profiler.AddSample("latency:input_to_cpu_observed_completion", _inputLatencyMs);
+		_latencyFrameValues[i] = 0;
+	}
 }
 
 // `s֐
 void AppBase::Render()
 {
-	uint32_t nextImageIndex = 0;
-	vkAcquireNextImageKHR(_device, _swapchain, UINT64_MAX, _presentCompletedSemaphore, VK_NULL_HANDLE, &nextImageIndex);
-	auto commandFence = _fences[nextImageIndex];
-	vkWaitForFences(_device, 1, &commandFence, VK_TRUE, UINT64_MAX);
+	// ̃t[p̃\[XOgR}h̊҂
+	// (NԖڂ̃t[̑M̓OtBbNXL[̃^CCN + 1ɂ)
+	const auto previousFrames = _frameNumber + 1 >= _framesInFlight ? _frameNumber + 1 - _framesInFlight : 0;
+	_timeline.Wait(GpuTimeline::Graphics, previousFrames);
+	CollectInputLatency();
+
+	// WaitForNextFrameĂłȂꍇ͂œ͂ǂ񂾂̂Ƃ
+	if (!_inputSampled)
+	{
+		_inputSampleTimes[_frameIndex] = std::chrono::steady_clock::now();
+		_inputSampled = true;
+	}
 
-	// NAl̐ݒ
-	std::array<VkClearValue, 2> clearValue = {
-	  { {0.5f, 0.25f, 0.25f, 1.0f}, // color
-		{1.0f, 0 } // depth
-	  }
-	};
+	// t[gĂÂswapchainȂǂj
+	_deletionQueue.Update();
+
+	// ăRpCꂽVF[_[gpCvC蒼
+	auto reloadedShaders = _shaderCache.Update();
+	if (!reloadedShaders.empty())
+	{
+		OnShadersReloaded(reloadedShaders);
+	}
+
+	// uꂽW[́AgpCvC̐SďIĂj
+	// (OnShadersReloadedŗv̂͐VW[ĝŁA҂ĂԂɌÂ̂gv͑Ȃ)
+	auto retiredModules = _shaderCache.TakeRetiredModules();
+	_retiredShaderModules.insert(_retiredShaderModules.end(), retiredModules.begin(), retiredModules.end());
+	if (!_retiredShaderModules.empty() && _pipelineManager.GetPendingCount() == 0)
+	{
+		auto device = _device;
+		auto modules = std::move(_retiredShaderModules);
+		_retiredShaderModules.clear();
+		_deletionQueue.Retire(GpuTimeline::Graphics, [device, modules]()
+		{
+			for (auto v : modules)
+			{
+				vkDestroyShaderModule(device, v, nullptr);
+			}
+		});
+	}
+
+	// TCYύXꍇswapchain蒼 (ŏ͕`悵Ȃ)
+	if (_swapchainDirty && !_headless && !RecreateSwapchain())
+	{
+		// ǂ񂾓͂͂̃t[ł͕\Ȃ̂ŁÃt[œǂݒ̂Ƃ
+		_inputSampled = false;
+		return;
+	}
+
+	// ̃t[̈ꎞ߂
+	_memoryAllocator.BeginFrame(_frameIndex);
+
+	// ]̌n (҂t[̂̂ĂΊ܂߂)
+	const auto completedFrames = _timeline.GetCompleted(GpuTimeline::Graphics);
+	_uploadManager.BeginFrame(completedFrames);
+
+	// 폜ꂽoChX̃XbĝAgĂt[̂ėpł悤ɂ
+	_bindlessTable.BeginFrame(_frameNumber, completedFrames);
 
+	// ǂݍ݂̏Imip̓]ƁAʏ̑傫Ɨ\Zɍ킹ǂݍ݁Ej
+	_textureStreamer.Update(_frameNumber, completedFrames);
+
+	// ̃t[̃R}hv[܂Ƃ߂ăZbg (ZJ_R}hobt@̓t[̃^XNŋL^)
+	auto command = _commandRecorder.BeginFrame(_frameIndex);
+
+	// t[̃^XNƃR}h̋L^n߂ (CXbh͂̊ԂɃC[W擾)
+	_frameTasks.Reset();
+	const auto recordDependency = SetupFrameTasks(_frameTasks);
+	AddCommandTasks(recordDependency);
+	_frameTasks.Dispatch(_jobSystem);
+
+	// headless̓t[Ƃ̃ItXN[C[W֕`悷
+	auto presentCompletedSemaphore = _presentCompletedSemaphores[_frameIndex];
+	uint32_t nextImageIndex = _frameIndex;
+	if (!_headless)
+	{
+		auto result = vkAcquireNextImageKHR(_device, _swapchain, UINT64_MAX, presentCompletedSemaphore, VK_NULL_HANDLE, &nextImageIndex);
+		if (result == VK_ERROR_OUT_OF_DATE_KHR)
+		{
+			// Z}tH̓VOiȂ߁Ãt[͑MɎRenderō蒼
+			_swapchainDirty = true;
+			_inputSampled = false;
+			WaitFrameTasks();
+			return;
+		}
+		else if (result == VK_SUBOPTIMAL_KHR)
+		{
+			// C[W͎擾łĂ̂ŁÃt[͕`悵Ă蒼
+			_swapchainDirty = true;
+		}
+		else
+		{
+			CheckResult(result);
+		}
+		++_acquireCount;
+		UpdateRetiredPresents();
+	}
+	auto renderCompletedSemaphore = _renderCompletedSemaphores[nextImageIndex];
+
+	// `̐ݒ
+	_imageIndex = nextImageIndex;
+	_renderGraph.SetImportedImage(_backbuffer, _swapchainImages[nextImageIndex], _swapchainImageViews[nextImageIndex]);
+
+	// ZJ_R}hobt@̋L^Ɠ]̗\܂ޑSẴ^XNI܂ő҂
+	WaitFrameTasks();
 
 	// R}hobt@ւ̏݊Jn
 	VkCommandBufferBeginInfo commandBI{};
 	commandBI.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-	auto& command = _commandBuffers[nextImageIndex];
+	commandBI.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
 
 	vkBeginCommandBuffer(command, &commandBI);
 
-	// _[pX̊Jn
-	VkRenderPassBeginInfo renderPassBI{};
-	renderPassBI.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-	renderPassBI.renderPass = _renderPass;
-	renderPassBI.framebuffer = _framebuffers[nextImageIndex];
-	renderPassBI.renderArea.offset = VkOffset2D{ 0, 0 };
-	renderPassBI.renderArea.extent = _swapchainExtent2D;
-	renderPassBI.pClearValues = clearValue.data();
-	renderPassBI.clearValueCount = uint32_t(clearValue.size());
-	
-	vkCmdBeginRenderPass(command, &renderPassBI, VK_SUBPASS_CONTENTS_INLINE);
+	// \񂳂ꂽ]𑗐MÃt[g]Ɗ]̏L]pL[擾
+	// (`͎gƐ錾ꂽ]AgXe[Wő҂)
+	_submitWaits.Clear();
+	_uploadManager.Flush();
+	_renderGraph.RequireUploads(_uploadManager);
+	_uploadManager.RecordAcquire(command, _frameNumber, _submitWaits);
+
+	// Xg[~Oō蒼eNX`ցA풓ĂmipÂC[WRs[
+	_textureStreamer.RecordCopies(command);
+
+	// Rs[gpX̑M (OtBbNX͌ʂgXe[Wł҂)
+	_asyncCompute.Submit(_frameIndex, _submitWaits);
 
-	//_imageIndex = nextImageIndex;
-	//CreateCommand(command);
+	// v̊Jn (̃t[̑Ǒʂŉ)
+	_profiler.BeginFrame(command, _frameIndex);
+	_profiler.BeginGpuScope(command, "RenderPass");
 
-	// _[pX̏I
-	vkCmdEndRenderPass(command);
+	// SẴpX̋L^ (CAEgJڂƃ_[pẌˑ֌W̓Ot߂)
+	_renderGraph.Execute(command);
+	_profiler.EndGpuScope(command);
+	_profiler.EndFrame(command);
 
 	// R}hobt@ւ̏ݏI
 	vkEndCommandBuffer(command);
 
-	// R}hfoCXL[ɑM
-	VkPipelineStageFlags waitStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+	// R}hfoCXL[ɑM (OtBbNXL[̃^CC_frameNumber + 1ɂ)
+	if (!_headless)
+	{
+		_submitWaits.Add(presentCompletedSemaphore, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
+	}
 
-	VkSubmitInfo submitInfo{};
-	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-	submitInfo.commandBufferCount = 1;
-	submitInfo.pCommandBuffers = &command;
-	submitInfo.pWaitDstStageMask = &waitStageMask;
-	submitInfo.waitSemaphoreCount = 1;
-	submitInfo.pWaitSemaphores = &_presentCompletedSemaphore;
-	submitInfo.signalSemaphoreCount = 1;
-	submitInfo.pSignalSemaphores = &_renderCompletedSemaphore;
-	vkResetFences(_device, 1, &commandFence);
-	vkQueueSubmit(_deviceQueue, 1, &submitInfo, commandFence);
+	const auto frameValue = _timeline.Submit(GpuTimeline::Graphics, _deviceQueue, command, &_submitWaits,
+		_headless ? VK_NULL_HANDLE : renderCompletedSemaphore);
+	CheckResult(frameValue != 0 ? VK_SUCCESS : VK_ERROR_DEVICE_LOST);
+	_latencyFrameValues[_frameIndex] = frameValue;
+	_inputSampled = false;
+
+	if (_headless)
+	{
+		// ʂȂ̂present͂Ȃ
+		++_frameNumber;
+		_frameIndex = (_frameIndex + 1) % _framesInFlight;
+		return;
+	}
 
 	// ʂʂɔf鏈
 	VkPresentInfoKHR presentInfo{};
@@ -562,8 +1520,120 @@ void AppBase::Render()
 	presentInfo.pSwapchains = &_swapchain;
 	presentInfo.pImageIndices = &nextImageIndex;
 	presentInfo.waitSemaphoreCount = 1;
-	presentInfo.pWaitSemaphores = &_renderCompletedSemaphore;
-	vkQueuePresentKHR(_deviceQueue, &presentInfo);
+	presentInfo.pWaitSemaphores = &renderCompletedSemaphore;
+	auto result = vkQueuePresentKHR(_deviceQueue, &presentInfo);
+	if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR)
+	{
+		_swapchainDirty = true;
+	}
+	else
+	{
+		CheckResult(result);
+	}
+
+	// ̃t[
+	++_frameNumber;
+	_frameIndex = (_frameIndex + 1) % _framesInFlight;
+}
+
+// t[̃^XN̊҂ (҂Ԃ̓CXbh^XN)
+void AppBase::WaitFrameTasks()
+{
+	{
+		Profiler::CpuScope scope(_profiler, "WaitFrameTasks");
+		_frameTasks.Wait();
+	}
+
+	// ^XNƂ̎s ([J[Xbhő)
+	for (JobGraph::TaskId i = 0; i < _frameTasks.GetTaskCount(); ++i)
+	{
+		_profiler.AddSample("task:" + _frameTasks.GetTaskName(i), _frameTasks.GetTaskMs(i));
+	}
+	_frameTasks.Reset();
+}
+
+// Ōɕ`悵ItXN[C[WCPU֓ǂݏo
+bool AppBase::ReadbackImage(std::vector<uint8_t>& pixels)
+{
+	if (!_headless)
+	{
+		return false;
+	}
+
+	// ŌɑMt[̊҂
+	_timeline.Wait(GpuTimeline::Graphics, _frameNumber);
+
+	// ǂݏop̃obt@
+	const auto width = _swapchainExtent2D.width;
+	const auto height = _swapchainExtent2D.height;
+	const VkDeviceSize size = VkDeviceSize(width) * height * 4;
+
+	VkBufferCreateInfo bufferCI{};
+	bufferCI.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	bufferCI.size = size;
+	bufferCI.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+	bufferCI.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+	VkBuffer buffer;
+	MemoryAllocation allocation;
+	if (!_memoryAllocator.CreateBuffer(bufferCI, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+		VK_MEMORY_PROPERTY_HOST_CACHED_BIT, buffer, allocation))
+	{
+		return false;
+	}
+
+	// Rs[R}h̋L^Ǝs
+	VkCommandBufferAllocateInfo commandAI{};
+	commandAI.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+	commandAI.commandPool = _commandPool;
+	commandAI.commandBufferCount = 1;
+	commandAI.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	VkCommandBuffer command;
+	vkAllocateCommandBuffers(_device, &commandAI, &command);
+
+	VkCommandBufferBeginInfo commandBI{};
+	commandBI.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	commandBI.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+	vkBeginCommandBuffer(command, &commandBI);
+
+	// _[pX̏ITRANSFER_SRC_OPTIMAL֑Jڍς
+	VkBufferImageCopy region{};
+	region.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+	region.imageExtent = { width, height, 1 };
+	vkCmdCopyImageToBuffer(command, _swapchainImages[_imageIndex], VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, buffer, 1, &region);
+
+	// zXgǂ߂悤ɂ
+	VkBufferMemoryBarrier barrier{};
+	barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+	barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+	barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.buffer = buffer;
+	barrier.size = VK_WHOLE_SIZE;
+	vkCmdPipelineBarrier(command, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 0, nullptr, 1, &barrier, 0, nullptr);
+	vkEndCommandBuffer(command);
+
+	VkFenceCreateInfo fenceCI{};
+	fenceCI.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+	VkFence fence;
+	vkCreateFence(_device, &fenceCI, nullptr, &fence);
+
+	VkSubmitInfo submitInfo{};
+	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	submitInfo.commandBufferCount = 1;
+	submitInfo.pCommandBuffers = &command;
+	vkQueueSubmit(_deviceQueue, 1, &submitInfo, fence);
+	vkWaitForFences(_device, 1, &fence, VK_TRUE, UINT64_MAX);
+
+	// sNZ̃Rs[ (AP[^}bvς)
+	pixels.resize(size_t(size));
+	memcpy(pixels.data(), allocation.mapped, size_t(size));
+
+	// n
+	vkDestroyFence(_device, fence, nullptr);
+	vkFreeCommandBuffers(_device, _commandPool, 1, &command);
+	_memoryAllocator.DestroyBuffer(buffer, allocation);
+	return true;
 }
 
 // Ȉ
@@ -571,65 +1641,125 @@ void AppBase::Terminate()
 {
 	vkDeviceWaitIdle(_device);
 
-	//Clean();
+	// pCvC̐Xbh̏IƃpCvC̔j
+	// (̂̂hNX̃pCvCCAEggĂ̂CleanO)
+	_pipelineManager.Terminate();
 
-	// R}hobt@̊J
-	vkFreeCommandBuffers(_device, _commandPool, uint32_t(_commandBuffers.size()), _commandBuffers.data());
-	_commandBuffers.clear();
+	// hNX̃\[X̔j
+	Clean();
 
-	// _[pX̔j
-	vkDestroyRenderPass(_device, _renderPass, nullptr);
-	
-	// t[obt@̔j
-	for (auto& v : _framebuffers)
+	// VF[_[W[̔j
+	_shaderCache.Terminate();
+	for (auto v : _retiredShaderModules)
 	{
-		vkDestroyFramebuffer(_device, v, nullptr);
+		vkDestroyShaderModule(_device, v, nullptr);
 	}
-	_framebuffers.clear();
+	_retiredShaderModules.clear();
 
-	// foCX̊J
-	vkFreeMemory(_device, _depthBufferMemory, nullptr);
-	
-	// Image̔j
-	vkDestroyImage(_device, _depthBuffer, nullptr);
+	// NGv[̔j
+	_profiler.Terminate();
+
+	// t[Ƃ̃R}hv[̔jƃWuVXẽXbh̏I
+	_commandRecorder.Terminate();
+	_jobSystem.Terminate();
+
+	// Xg[~OeNX`̔j
+	_textureStreamer.Terminate();
+
+	// j҂̃\[X̔j (Xg[~OeNX`̌ÂC[W܂)
+	_deletionQueue.Terminate();
+
+	// ]p̃\[X̔j
+	_uploadManager.Terminate();
+
+	// Rs[gp̃\[X̔j
+	_asyncCompute.Terminate();
+
+	// oChX̃e[u̔j
+	_bindlessTable.Terminate();
+
+	// _[pXAt[obt@AOt̃C[W̔j
+	_renderGraph.Terminate();
+
+	// 蒼Oswapchain̔j (擾i܂ɎcĂ)
+	for (auto& v : _retiredPresents)
+	{
+		v.deleter();
+	}
+	_retiredPresents.clear();
 
 	// ImageView̔j
-	vkDestroyImageView(_device, _depthBufferView, nullptr);
 	for (auto& v : _swapchainImageViews)
 	{
 		vkDestroyImageView(_device, v, nullptr);
 	}
+
+	// swapchain̔j (headless̓ItXN[C[W̔j)
+	if (_headless)
+	{
+		for (size_t i = 0; i < _swapchainImages.size(); ++i)
+		{
+			_memoryAllocator.DestroyImage(_swapchainImages[i], _offscreenImageAllocations[i]);
+		}
+		_offscreenImageAllocations.clear();
+	}
+	else
+	{
+		vkDestroySwapchainKHR(_device, _swapchain, nullptr);
+	}
 	_swapchainImages.clear();
 
-	// swapchain̔j
-	vkDestroySwapchainKHR(_device, _swapchain, nullptr);
+	// ^CC̔j
+	_timeline.Terminate();
 
-	// fence̔j
-	for (auto& v : _fences)
+	// Z}tH̔j
+	for (auto& v : _presentCompletedSemaphores)
 	{
-		vkDestroyFence(_device, v, nullptr);
+		vkDestroySemaphore(_device, v, nullptr);
 	}
-	_fences.clear();
+	_presentCompletedSemaphores.clear();
+	for (auto& v : _renderCompletedSemaphores)
+	{
+		vkDestroySemaphore(_device, v, nullptr);
+	}
+	_renderCompletedSemaphores.clear();
 
-	// Z}tH̔j
-	vkDestroySemaphore(_device, _presentCompletedSemaphore, nullptr);
-	vkDestroySemaphore(_device, _renderCompletedSemaphore, nullptr);
+	// pCvCLbV̕ۑƔj
+	SavePipelineCache();
+	vkDestroyPipelineCache(_device, _pipelineCache, nullptr);
+	_pipelineCache = VK_NULL_HANDLE;
 
 	// R}hv[̔j
 	vkDestroyCommandPool(_device, _commandPool, nullptr);
 
-	// Surface̔j
-	vkDestroySurfaceKHR(_instance, _surface, nullptr);
+	// AP[^̏I
+	_memoryAllocator.Terminate();
 
 	// foCX̔j
 	vkDestroyDevice(_device, nullptr);
 
+	// SurfaceCX^X܂ł̔j
+	DestroyInstance();
+}
+
+
+// SurfaceAfobO|[gACX^Xj (foCX̐Ɏsꍇj)
+void AppBase::DestroyInstance()
+{
+	// Surface̔j
+	if (_surface != VK_NULL_HANDLE)
+	{
+		vkDestroySurfaceKHR(_instance, _surface, nullptr);
+		_surface = VK_NULL_HANDLE;
+	}
+
 #ifdef _DEBUG
 	DisableDebugReport();
 #endif
 
 	// CX^X̔j
 	vkDestroyInstance(_instance, nullptr);
+	_instance = VK_NULL_HANDLE;
 }
 
 
@@ -651,13 +1781,23 @@ static VkBool32 VKAPI_CALL DebugReportCallback(
 	std::stringstream ss;
 	ss << "[" << pLayerPrefix << "] "  << pMessage << std::endl;
 
+#ifdef _WIN32
 	OutputDebugStringA(ss.str().c_str());
+#else
+	std::fputs(ss.str().c_str(), stderr);
+#endif
 
 	return VK_FALSE;
 }
 
 void AppBase::EnableDebugReport()
 {
+	_destroyDebugReportCallback = nullptr;
+	if (!IsInstanceExtensionEnabled(VK_EXT_DEBUG_REPORT_EXTENSION_NAME))
+	{
+		return;
+	}
+
 	// ֐|C^̎擾
 	_createDebugReportCallback 
 		= reinterpret_cast<PFN_vkCreateDebugReportCallbackEXT>(vkGetInstanceProcAddr(_instance, "vkCreateDebugReportCallbackEXT"));
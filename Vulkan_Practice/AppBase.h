@@ -1,19 +1,50 @@
 #pragma once
 
+#ifdef _WIN32
 #define VK_USE_PLATFORM_WIN32_KHR
-#define GLFW_INCLUDE_VULKAN
 #define GLFW_EXPOSE_NATIVE_WIN32
+#endif
+#define GLFW_INCLUDE_VULKAN
 #include <GLFW/glfw3.h>
 //#include <GLFW/glfw3native.h>
 //#include <vulkan/vk_layer.h>
 //#include <vulkan/vulkan_win32.h>
 
+#ifdef _WIN32
 #pragma comment(lib, "vulkan-1.lib")
+#endif
 
 #include <vector>
 #include <algorithm>
 #include <array>
 #include <sstream>
+#include <cstring>
+#include <string>
+#include <chrono>
+#include <functional>
+
+#include "Profiler.h"
+#include "MemoryAllocator.h"
+#include "GpuTimeline.h"
+#include "DeletionQueue.h"
+#include "JobSystem.h"
+#include "JobGraph.h"
+#include "CommandRecorder.h"
+#include "UploadManager.h"
+#include "AsyncCompute.h"
+#include "RenderGraph.h"
+#include "BindlessTable.h"
+#include "TextureStreamer.h"
+#include "ShaderCache.h"
+#include "PipelineManager.h"
+
+// \@̕j
+enum class PresentPolicy
+{
+	Vsync,			// FIFO (ɃT|[gĂ)
+	LowLatency,		// FIFO + ŏ̃C[WA͂̒OGPŮ҂
+	Throughput,		// MAILBOX / IMMEDIATE + ߂̃C[W
+};
 
 class AppBase
 {
@@ -22,30 +53,189 @@ public:
 	virtual ~AppBase() {}
 
 	void Initialize(GLFWwindow* window, const char* appName);
+	// foCXpӂłȂꍇVK_SUCCESSȊOԂ (r܂Ő͔̂jς݂Ȃ̂ŁATerminate͌Ă΂Ȃ)
+	VkResult InitializeHeadless(uint32_t width, uint32_t height, const char* appName);
 	void Render();
 	void Terminate();
 
-	//virtual void CreateCommand(VkCommandBuffer command) {}
+	// ɏt[̐ݒ(InitializeOɌĂ)
+	void SetFramesInFlight(uint32_t count);
+	uint32_t GetFramesInFlight() const { return _framesInFlight; }
+
+	// WuVXẽXbh̐ݒ (CXbh܂ށAInitializeOɌĂԁA0̏ꍇ̓RA猈߂)
+	// R}h̋L^ƃt[̃^XN͂̃XbhŎs
+	void SetRecordThreadCount(uint32_t count) { _recordThreadCount = count; }
+	uint32_t GetRecordThreadCount() const { return _commandRecorder.GetThreadCount(); }
+	JobSystem& GetJobSystem() { return _jobSystem; }
+
+	// headlessAŌɕ`悵C[WRGBA8œǂݏo
+	bool ReadbackImage(std::vector<uint8_t>& pixels);
+	bool IsHeadless() const { return _headless; }
+	VkExtent2D GetExtent() const { return _swapchainExtent2D; }
+
+	// t[Ԃ̌v
+	Profiler& GetProfiler() { return _profiler; }
+
+	// foCX̊m (\[X̃͑SĂmۂ)
+	MemoryAllocator& GetMemoryAllocator() { return _memoryAllocator; }
+
+	// obt@C[Wւ̓] (]pL[΂g)
+	// \񂵂]Render̊JnɑMA`RequireŐ錾] (Ot̊O\[Xɐݒ肵̂܂) ҂
+	UploadManager& GetUploadManager() { return _uploadManager; }
+
+	// Rs[gpX̓o^ (RenderƂɃOtBbNXɃRs[gL[֑M)
+	AsyncCompute& GetAsyncCompute() { return _asyncCompute; }
+
+	// eNX`ATv[AXg[Wobt@CfbNXŎQƂ邽߂̃e[u
+	// (VK_EXT_descriptor_indexingT|[gȂfoCXłIsAvailablefalse)
+	BindlessTable& GetBindlessTable() { return _bindlessTable; }
+
+	// KTX2̃eNX`ʏ̑傫ƃ̗\Zɍ킹mipŏ풓 (BindlessTableɓo^)
+	TextureStreamer& GetTextureStreamer() { return _textureStreamer; }
+
+	// `̍\ (SetupRenderGraphŐ錾pX)
+	RenderGraph& GetRenderGraph() { return _renderGraph; }
+
+	// CreateCommandŋL^pX̃_[pXƃTupX (pCvC̐Ɏg)
+	VkRenderPass GetRenderPass() const { return _renderGraph.GetRenderPass(_commandPass); }
+	uint32_t GetSubpass() const { return _renderGraph.GetSubpass(_commandPass); }
+
+	// hNXŃpCvCȂǂ𐶐邽߂̃foCX
+	VkDevice GetDevice() const { return _device; }
+	VkPhysicalDeviceProperties GetDeviceProperties() const;
+
+	// VF[_[W[ (rhɃRpCSPIR-ṼfBNgAInitializeOɐݒ肷)
+	void SetShaderDirectory(const char* path) { _shaderDirectory = path; }
+	ShaderCache& GetShaderCache() { return _shaderCache; }
+
+	// VF[_[̃\[XĎAăRpCOnShadersReloadedĂ (JpAInitializeɌĂ)
+	// compileCommandcmake/CompileShaders.cmakesR}h
+	void EnableShaderHotReload(const char* sourceDirectory, const char* compileCommand) { _shaderCache.EnableHotReload(sourceDirectory, compileCommand); }
+
+	// Mς݂̃t[gIĂj (蒼pCvČÂ̂Ȃ)
+	void Retire(const std::function<void()>& deleter);
+
+	// GPUgIĂj郊\[X̃L[ (Render̊JnɊ̂j)
+	// ̃L[̑MĝAL^̃t[ĝ͒lw肵ēo^
+	DeletionQueue& GetDeletionQueue() { return _deletionQueue; }
+
+	// L[Ƃ̃^CC (OtBbNXL[̒lRenderőMt[)
+	// fenceɁuGPUNԖڂ̃t[܂ŏIvmFEҋ@ł
+	GpuTimeline& GetTimeline() { return _timeline; }
+	uint64_t GetFrameNumber() const { return _frameNumber; }
+	uint64_t GetCompletedFrames() { return _timeline.GetCompleted(GpuTimeline::Graphics); }
+	bool WaitForFrame(uint64_t frameNumber) { return _timeline.Wait(GpuTimeline::Graphics, frameNumber + 1); }
+
+	// pCvCLbV (InitializeŃt@Cǂݍ݁ATerminateŕۑ)
+	void SetPipelineCachePath(const char* path) { _pipelineCachePath = path; }
+	VkPipelineCache GetPipelineCache() const { return _pipelineCache; }
+	bool IsPipelineCacheWarm() const { return _pipelineCacheWarm; }
+
+	// OtBbNXpCvC̐ ([J[XbhŐAI܂ł͕`΂)
+	// XbhInitializeOɐݒ肷 (0̏ꍇ̓RA猈߂)
+	void SetPipelineThreadCount(uint32_t count) { _pipelineThreadCount = count; }
+	PipelineManager& GetPipelineManager() { return _pipelineManager; }
+
+	// Initializeɂ
+	double GetStartupTimeMs() const { return _startupTimeMs; }
+
+	// Initialize̊eiKɂ (s)
+	struct StartupStage
+	{
+		std::string name;
+		double ms;
+	};
+	const std::vector<StartupStage>& GetStartupTimeline() const { return _startupTimeline; }
+
+	// gpg@\ƃfoCX̋@\̐錾 (InitializeOɌĂ)
+	// required̂̂T|[gȂfoCX͑I΂ȂBȊO̓T|[gĂꍇ̂ݗLɂ
+	void AddInstanceExtension(const char* name, bool required);
+	void AddDeviceExtension(const char* name, bool required);
+	void AddDeviceFeature(VkBool32 VkPhysicalDeviceFeatures::* feature, bool required);
+	bool IsInstanceExtensionEnabled(const char* name) const;
+	bool IsDeviceExtensionEnabled(const char* name) const;
+	const VkPhysicalDeviceFeatures& GetEnabledFeatures() const { return _enabledFeatures; }
+
+	// \@̐ݒ (InitializeɌĂ񂾏ꍇ͎Renderswapchain蒼)
+	// T|[gĂȂ[h̏ꍇFIFOɃtH[obN
+	void SetPresentPolicy(PresentPolicy policy);
+	PresentPolicy GetPresentPolicy() const { return _presentPolicy; }
+	VkPresentModeKHR GetPresentMode() const { return _presentMode; }
+
+	// ͂ǂޒOɌĂ (̃t[n߂܂ő҂)
+	void WaitForNextFrame();
+
+	// ͂ǂłÃt[GPŮCPUmF܂ł̎
+	// ̊mF̓t[̊Jn̑ҋ@łȂ̂ŁA\܂ł̎Ԃł͂ȂAX[vbgdł͍ő1t[Ȃ
+	// ("latency:input_to_cpu_observed_completion"Ƃăvt@CɂL^)
+	double GetInputLatencyMs() const { return _inputLatencyMs; }
+
+	// EBhẼTCYύXʒm (Renderswapchain蒼)
+	void NotifyResized() { _swapchainDirty = true; }
+
+	static const uint32_t MinFramesInFlight = 2;
+	static const uint32_t MaxFramesInFlight = 4;
+
+	// _[pX̃R}hGetCommandTaskCount()̃ZJ_R}hobt@ɕċL^
+	// GetCommandTaskCountSetupFrameTasks̒ɃCXbhĂ΂ACreateCommandtaskIndexƂɃt[̃^XNƂ
+	// SetupFrameTasksԂ^XŇɎs (̃Xbh瓯ɌĂ΂AthreadIndexƂɕʂ̃Xbh)
+	// framebuffer͌pȂ̂ŁAswapchaiñC[W̎擾ƕsċL^
+	virtual uint32_t GetCommandTaskCount() { return 0; }
+	virtual void CreateCommand(VkCommandBuffer /*command*/, uint32_t /*taskIndex*/, uint32_t /*threadIndex*/) {}
+
+	// t[̃^XN (V[̍XVAJOA]̏Ȃ) ǉ (RenderƂɃCXbhĂ΂)
+	// ߂l̓R}h̋L^҂^XN (InvalidTask̏ꍇ͑҂Ȃ)
+	// ^XNswapchaiñC[W̎擾ƕsăWuVXẽXbhŎsAR}h̋L^܂ޑSẴ^XNIĂ瑗M
+	// ^XNUploadManagerUploadBufferEUploadImageERequireĂׂ
+	virtual JobGraph::TaskId SetupFrameTasks(JobGraph& /*graph*/) { return JobGraph::InvalidTask; }
+
+	// `̃pXƃ\[X錾 (Initialize1xĂ΂)
+	// backbuffer͕`挋ʂswapchain(headless̓ItXN[)̃C[W
+	// ߂lCreateCommandŋL^OtBbNXpX
+	virtual uint32_t SetupRenderGraph(RenderGraph& graph, RenderGraph::Resource backbuffer);
+
+	// hNX̃\[X̐Ɣj (Initialize̍ŌTerminate̍ŏɌĂ΂)
 	virtual void Prepare() {}
 	virtual void Clean() {}
 
+	// zbg[hōăRpCꂽVF[_[̖O (Render̋L^OɌĂ΂)
+	virtual void OnShadersReloaded(const std::vector<std::string>& /*names*/) {}
+
 private:
 
-	void InitializeInstance(const char* appName);
-	void GetPhysicalDevice();
+	VkResult InitializeDevice(const char* appName, GLFWwindow* window);
+	void InitializeFrameResources();
+	VkResult InitializeInstance(const char* appName);
+	VkResult GetPhysicalDevice();
+	int64_t ScorePhysicalDevice(VkPhysicalDevice physicalDevice) const;
+	void MarkStartupStage(const char* name);
 	uint32_t  SearchGraphicsQueueFamilyIndex();
-	void CreateDevice();
+	uint32_t  SearchTransferQueueFamilyIndex();
+	uint32_t  SearchComputeQueueFamilyIndex(uint32_t& queueIndex);
+	VkResult CreateDevice();
+	void DestroyInstance();
 	void CreateCommandPool();
+	void LoadPipelineCache();
+	void SavePipelineCache();
 	void SelectSurfaceFormat(VkFormat format);
+	void SelectPresentMode();
+	uint32_t GetSwapchainImageCount() const;
+	void CollectInputLatency();
 	void CreateSwapchain(GLFWwindow* window);
-	void CreateDepthBuffer();
-	uint32_t GetMemoryTypeIndex(uint32_t requestBits, VkMemoryPropertyFlags requestProps)const;
+	bool RecreateSwapchain();
+	void RetireSwapchainResources(std::vector<std::function<void()>>& retired);
+	void UpdateRetiredPresents();
+	void CreateOffscreenImages();
 	void CreateImageViews();
-	void CreateRenderPass();
-	void CreateFramebuffer();
-	void AllocateCommandBuffers();
-	void CreateFences();
+	void InitializeRenderGraph();
+	void AddCommandTasks(JobGraph::TaskId dependency);
+	void RecordCommandTasks(const RenderGraph::PassContext& context);
+	void WaitFrameTasks();
+	void InitializeCommandRecorder();
 	void CreateSemaphores();
+	void CreateRenderCompletedSemaphores();
+
+	static void FramebufferSizeCallback(GLFWwindow* window, int width, int height);
 
 	static void CheckResult(VkResult result);
 	
@@ -66,27 +256,123 @@ private:
 	uint32_t _graphicsQueueFamilyIndex;
 	VkQueue _deviceQueue;
 
+	// ]p̃L[ (]p̃t@~[Ȃꍇ̓OtBbNXƓ)
+	uint32_t _transferQueueFamilyIndex;
+	VkQueue _transferQueue;
+
+	// Rs[gp̃L[ (OtBbNXƓt@~[̏ꍇ2ڂ̃L[)
+	uint32_t _computeQueueFamilyIndex;
+	uint32_t _computeQueueIndex;
+	VkQueue _computeQueue;
+
 	VkCommandPool _commandPool;
 	VkPresentModeKHR _presentMode;
+	PresentPolicy _presentPolicy;
+	GLFWwindow* _window;
 	VkSwapchainKHR _swapchain;
 	VkExtent2D _swapchainExtent2D;
+	bool _swapchainDirty;
 	std::vector<VkImage> _swapchainImages;
 	std::vector<VkImageView> _swapchainImageViews;
 
-	VkImage _depthBuffer;
-	VkImageView _depthBufferView;
-	VkDeviceMemory _depthBufferMemory;
+	// 蒼OswapchainƁA̕\҂Z}tH (M̊ł͕\̊Ȃ߁A
+	// VswapchainacquireCount܂ŃC[W擾ĂAMς݂̃t[̊ɔj)
+	struct RetiredPresent
+	{
+		uint64_t acquireCount;
+		std::function<void()> deleter;
+	};
+	std::vector<RetiredPresent> _retiredPresents;
+	uint64_t _acquireCount;		// swapchaiñC[W擾
 
-	VkRenderPass _renderPass;
-	std::vector<VkFramebuffer> _framebuffers;
+	// headlessswapchain̑ɃItXN[C[W֕`悷
+	bool _headless;
+	std::vector<MemoryAllocation> _offscreenImageAllocations;
 
-	std::vector<VkFence> _fences;
-	VkSemaphore _renderCompletedSemaphore;
-	VkSemaphore _presentCompletedSemaphore;
-	
-	std::vector<VkCommandBuffer> _commandBuffers;
+	// _[pXAdepth bufferAframebuffer̓Ot
+	RenderGraph _renderGraph;
+	RenderGraph::Resource _backbuffer;
+	uint32_t _commandPass;
+	uint32_t _commandTaskCount;
+
+	// t[̊̓OtBbNXL[̃^CC̒lŊmF
+	GpuTimeline _timeline;
+
+	// t[(_framesInFlight)Ɏ
+	std::vector<VkSemaphore> _presentCompletedSemaphores;
+
+	// t[̃^XNƃR}h̋L^sXbh
+	JobSystem _jobSystem;
+	JobGraph _frameTasks;
+
+	// R}hobt@̓t[ƁEXbhƂ̃v[mۂ
+	CommandRecorder _commandRecorder;
+	uint32_t _recordThreadCount;
+	std::vector<VkCommandBuffer> _secondaryCommands;
+
+	// t[̑Mő҂Z}tH
+	GpuTimeline::WaitList _submitWaits;
+
+	// ͂\܂ł̒xv (t[)
+	std::vector<std::chrono::steady_clock::time_point> _inputSampleTimes;
+	std::vector<uint64_t> _latencyFrameValues;	// ṽt[̃^CC̒l (0͌vς)
+	bool _inputSampled;
+	double _inputLatencyMs;
+
+	// swapchaiñC[WƂɎ
+	std::vector<VkSemaphore> _renderCompletedSemaphores;
 
 	uint32_t  _imageIndex;
+	uint32_t  _framesInFlight;
+	uint32_t  _frameIndex;
+	uint64_t  _frameNumber;	// ܂łɑMt[
+
+	// swapchain̍蒼ȂǂŕsvɂȂ\[X
+	// Mς݂̃t[gI܂ő҂Ăj
+	DeletionQueue _deletionQueue;
+
+	Profiler _profiler;
+	MemoryAllocator _memoryAllocator;
+	UploadManager _uploadManager;
+	AsyncCompute _asyncCompute;
+	BindlessTable _bindlessTable;
+	TextureStreamer _textureStreamer;
+	ShaderCache _shaderCache;
+	std::string _shaderDirectory;
+	std::vector<VkShaderModule> _retiredShaderModules;	// zbg[hŒuApCvC̐Î҂Ă
+
+	VkPipelineCache _pipelineCache;
+	std::string _pipelineCachePath;
+	bool _pipelineCacheWarm;
+	PipelineManager _pipelineManager;
+	uint32_t _pipelineThreadCount;
+
+	std::chrono::steady_clock::time_point _initializeStart;
+	std::chrono::steady_clock::time_point _startupStageStart;
+	double _startupTimeMs;
+	std::vector<StartupStage> _startupTimeline;
+
+	// g@\Ƌ@\̐錾
+	struct ExtensionRequest
+	{
+		std::string name;
+		bool required;
+	};
+	struct FeatureRequest
+	{
+		VkBool32 VkPhysicalDeviceFeatures::* feature;
+		bool required;
+	};
+	static void AddExtensionRequest(std::vector<ExtensionRequest>& requests, const char* name, bool required);
+	std::vector<ExtensionRequest> _instanceExtensionRequests;
+	std::vector<ExtensionRequest> _deviceExtensionRequests;
+	std::vector<FeatureRequest> _featureRequests;
+
+	// ۂɗLɂ
+	std::vector<std::string> _enabledInstanceExtensions;
+	std::vector<std::string> _enabledDeviceExtensions;
+	VkPhysicalDeviceFeatures _enabledFeatures;
+	VkPhysicalDeviceDescriptorIndexingFeaturesEXT _descriptorIndexingFeatures;
 
 	// fobO|[gp
 	PFN_vkCreateDebugReportCallbackEXT _createDebugReportCallback;
@@ -0,0 +1,438 @@
+#include "AssetPack.h"
+
+#include <fstream>
+#include <algorithm>
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#ifdef ASSETPACK_HAS_LZ4
+#include <lz4.h>
+#endif
+#ifdef ASSETPACK_HAS_ZSTD
+#include <zstd.h>
+#endif
+
+// ozstd̈kx
+static const int ZstdLevel = 9;
+
+// alignment̔{ɐ؂グ
+static uint64_t AlignUp(uint64_t value, uint64_t alignment)
+{
+	return (value + alignment - 1) / alignment * alignment;
+}
+
+
+AssetPack::AssetPack() : _data(nullptr), _size(0), _header(nullptr), _chunks(nullptr),
+#ifdef _WIN32
+	_file(INVALID_HANDLE_VALUE), _mapping(nullptr)
+#else
+	_file(-1)
+#endif
+{
+}
+
+AssetPack::~AssetPack()
+{
+	Close();
+}
+
+// t@C}bvAڎmF
+bool AssetPack::Open(const std::string& path)
+{
+	Close();
+
+#ifdef _WIN32
+	_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (_file == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+	LARGE_INTEGER size;
+	GetFileSizeEx(_file, &size);
+	_size = uint64_t(size.QuadPart);
+	_mapping = _size != 0 ? CreateFileMappingA(_file, nullptr, PAGE_READONLY, 0, 0, nullptr) : nullptr;
+	_data = _mapping != nullptr ? static_cast<const uint8_t*>(MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0)) : nullptr;
+#else
+	_file = open(path.c_str(), O_RDONLY);
+	if (_file < 0)
+	{
+		return false;
+	}
+	struct stat status;
+	fstat(_file, &status);
+	_size = uint64_t(status.st_size);
+	if (_size != 0)
+	{
+		auto mapped = mmap(nullptr, size_t(_size), PROT_READ, MAP_PRIVATE, _file, 0);
+		_data = mapped != MAP_FAILED ? static_cast<const uint8_t*>(mapped) : nullptr;
+	}
+#endif
+
+	if (_data == nullptr || _size < sizeof(Header))
+	{
+		Close();
+		return false;
+	}
+	_header = reinterpret_cast<const Header*>(_data);
+	_chunks = reinterpret_cast<const Chunk*>(_data + _header->tocOffset);
+	if (!Validate())
+	{
+		Close();
+		return false;
+	}
+	return true;
+}
+
+void AssetPack::Close()
+{
+#ifdef _WIN32
+	if (_data != nullptr)
+	{
+		UnmapViewOfFile(_data);
+	}
+	if (_mapping != nullptr)
+	{
+		CloseHandle(_mapping);
+		_mapping = nullptr;
+	}
+	if (_file != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(_file);
+		_file = INVALID_HANDLE_VALUE;
+	}
+#else
+	if (_data != nullptr)
+	{
+		munmap(const_cast<uint8_t*>(_data), size_t(_size));
+	}
+	if (_file >= 0)
+	{
+		close(_file);
+		_file = -1;
+	}
+#endif
+	_data = nullptr;
+	_size = 0;
+	_header = nullptr;
+	_chunks = nullptr;
+}
+
+// ڎƃubNt@CɎ܂Ă邩 (ꂽt@CŔ͈͊Oǂ܂Ȃ悤)
+bool AssetPack::Validate() const
+{
+	if (_header->magic != Magic || _header->version != Version || _header->blockSize == 0)
+	{
+		return false;
+	}
+	if (_header->tocOffset % alignof(Chunk) != 0 || _header->tocOffset > _size
+		|| uint64_t(_header->chunkCount) * sizeof(Chunk) > _size - _header->tocOffset)
+	{
+		return false;
+	}
+
+	for (uint32_t i = 0; i < _header->chunkCount; ++i)
+	{
+		const auto& chunk = _chunks[i];
+		if (chunk.name[NameLength - 1] != '\0' || chunk.blockTableOffset % alignof(Block) != 0 || chunk.blockTableOffset > _size
+			|| uint64_t(chunk.blockCount) * sizeof(Block) > _size - chunk.blockTableOffset)
+		{
+			return false;
+		}
+
+		uint64_t total = 0;
+		auto blocks = GetBlocks(i);
+		for (uint32_t j = 0; j < chunk.blockCount; ++j)
+		{
+			const auto& block = blocks[j];
+			if (block.offset > _size || block.storedSize > _size - block.offset || block.size > _header->blockSize
+				|| (block.storedSize != block.size && !IsCompressionSupported(chunk.compression)))
+			{
+				return false;
+			}
+			total += block.size;
+		}
+		if (total != chunk.size)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+bool AssetPack::IsCompressionSupported(Compression compression)
+{
+	switch (compression)
+	{
+	case Compression::None:
+		return true;
+#ifdef ASSETPACK_HAS_LZ4
+	case Compression::LZ4:
+		return true;
+#endif
+#ifdef ASSETPACK_HAS_ZSTD
+	case Compression::Zstd:
+		return true;
+#endif
+	default:
+		return false;
+	}
+}
+
+// Oł̌ (`N̐͑Ȃ̂ŏɔׂ)
+AssetPack::ChunkIndex AssetPack::FindChunk(const char* name) const
+{
+	for (uint32_t i = 0; i < GetChunkCount(); ++i)
+	{
+		if (std::strcmp(_chunks[i].name, name) == 0)
+		{
+			return i;
+		}
+	}
+	return InvalidChunk;
+}
+
+const AssetPack::Block* AssetPack::GetBlocks(ChunkIndex index) const
+{
+	return reinterpret_cast<const Block*>(_data + _chunks[index].blockTableOffset);
+}
+
+// kĂȂ`N̓ubNAĂ̂ŁA擪̃ubNŜQƂł
+const void* AssetPack::GetData(ChunkIndex index) const
+{
+	const auto& chunk = _chunks[index];
+	if (chunk.compression != Compression::None || chunk.blockCount == 0)
+	{
+		return nullptr;
+	}
+	return _data + GetBlocks(index)[0].offset;
+}
+
+// 1̃ubNdestinationփRs[EWJ
+bool AssetPack::DecodeBlock(const Chunk& chunk, const Block& block, void* destination) const
+{
+	const auto source = _data + block.offset;
+	if (block.storedSize == block.size)
+	{
+		std::memcpy(destination, source, block.size);
+		return true;
+	}
+
+	switch (chunk.compression)
+	{
+#ifdef ASSETPACK_HAS_LZ4
+	case Compression::LZ4:
+		return LZ4_decompress_safe(reinterpret_cast<const char*>(source), static_cast<char*>(destination),
+			int(block.storedSize), int(block.size)) == int(block.size);
+#endif
+#ifdef ASSETPACK_HAS_ZSTD
+	case Compression::Zstd:
+		return ZSTD_decompress(destination, block.size, source, block.storedSize) == block.size;
+#endif
+	default:
+		return false;
+	}
+}
+
+// ǂݏI`Ñy[WJAs[Ñgpʂ} (t@C̓e͎c)
+void AssetPack::ReleasePages(ChunkIndex index) const
+{
+#ifndef _WIN32
+	const auto& chunk = _chunks[index];
+	if (chunk.blockCount == 0)
+	{
+		return;
+	}
+	const auto blocks = GetBlocks(index);
+	const auto pageSize = uint64_t(sysconf(_SC_PAGESIZE));
+	const auto begin = blocks[0].offset / pageSize * pageSize;
+	const auto end = blocks[chunk.blockCount - 1].offset + blocks[chunk.blockCount - 1].storedSize;
+	madvise(const_cast<uint8_t*>(_data) + begin, size_t(end - begin), MADV_DONTNEED);
+#endif
+}
+
+// host visiblẽȂǂւ̓ǂݍ
+bool AssetPack::Read(ChunkIndex index, void* destination) const
+{
+	const auto& chunk = _chunks[index];
+	const auto blocks = GetBlocks(index);
+	auto output = static_cast<uint8_t*>(destination);
+	for (uint32_t i = 0; i < chunk.blockCount; ++i)
+	{
+		if (!DecodeBlock(chunk, blocks[i], output))
+		{
+			return false;
+		}
+		output += blocks[i].size;
+	}
+	ReleasePages(index);
+	return true;
+}
+
+// ubNƂɃOobt@֓WJē]\񂷂 (Oobt@傫ȃ`N]ł)
+// (ubN̓rŃOobt@tɂȂƑÕubN͐ɑM̂ŁAŌ̃ubÑ`PbgԂ)
+bool AssetPack::Upload(ChunkIndex index, UploadManager& uploadManager, VkBuffer buffer, VkDeviceSize offset, UploadTicket* ticket) const
+{
+	const auto& chunk = _chunks[index];
+	const auto blocks = GetBlocks(index);
+	UploadTicket last = 0;
+	for (uint32_t i = 0; i < chunk.blockCount; ++i)
+	{
+		auto staging = uploadManager.ReserveBufferUpload(buffer, offset, blocks[i].size, &last);
+		if (staging == nullptr || !DecodeBlock(chunk, blocks[i], staging))
+		{
+			return false;
+		}
+		offset += blocks[i].size;
+	}
+	ReleasePages(index);
+	if (ticket != nullptr)
+	{
+		*ticket = last;
+	}
+	return true;
+}
+
+// `Np̃obt@̐Ɠ]
+bool AssetPack::CreateBuffer(ChunkIndex index, MemoryAllocator& allocator, UploadManager& uploadManager, VkBufferUsageFlags usage,
+	VkBuffer& buffer, MemoryAllocation& allocation, UploadTicket* ticket) const
+{
+	VkBufferCreateInfo ci{};
+	ci.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	ci.size = (std::max)(_chunks[index].size, uint64_t(1));
+	ci.usage = usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+	ci.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+	if (!allocator.CreateBuffer(ci, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0, buffer, allocation))
+	{
+		return false;
+	}
+	if (!Upload(index, uploadManager, buffer, 0, ticket))
+	{
+		// \ς݂̓]obt@QƂĂ̂ŁAMĊ҂Ăj
+		uploadManager.Wait(uploadManager.Flush());
+		allocator.DestroyBuffer(buffer, allocation);
+		return false;
+	}
+	return true;
+}
+
+
+// `N̒ǉ (O͏I[܂߂NameLengthɎ܂钷܂)
+void AssetPackWriter::AddChunk(const char* name, AssetPack::ChunkKind kind, uint32_t stride, const void* data, uint64_t size,
+	AssetPack::Compression compression)
+{
+	if (!AssetPack::IsCompressionSupported(compression))
+	{
+		compression = AssetPack::Compression::None;
+	}
+	Source source = { std::string(name).substr(0, AssetPack::NameLength - 1), kind, stride, data, size, compression };
+	_sources.push_back(source);
+}
+
+// ubNɕĈkAf[^AڎAubN̕\̏ɏo
+bool AssetPackWriter::Write(const std::string& path) const
+{
+	std::ofstream file(path, std::ios::binary);
+	if (!file)
+	{
+		return false;
+	}
+
+	AssetPack::Header header{};
+	header.magic = AssetPack::Magic;
+	header.version = AssetPack::Version;
+	header.chunkCount = uint32_t(_sources.size());
+	header.blockSize = AssetPack::BlockSize;
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+	uint64_t position = sizeof(header);
+	auto pad = [&](uint64_t alignment)
+	{
+		static const char zeros[AssetPack::DataAlignment] = {};
+		const auto aligned = AlignUp(position, alignment);
+		file.write(zeros, std::streamsize(aligned - position));
+		position = aligned;
+	};
+
+	std::vector<AssetPack::Chunk> chunks(_sources.size());
+	std::vector<std::vector<AssetPack::Block>> blockTables(_sources.size());
+	std::vector<char> compressed;
+	for (size_t i = 0; i < _sources.size(); ++i)
+	{
+		const auto& source = _sources[i];
+		auto& chunk = chunks[i];
+		std::memset(&chunk, 0, sizeof(chunk));
+		std::memcpy(chunk.name, source.name.c_str(), source.name.size());
+		chunk.kind = source.kind;
+		chunk.compression = source.compression;
+		chunk.stride = source.stride;
+		chunk.size = source.size;
+
+		// _CfbNX̂܂܎QƂł悤A`N̐擪𑵂
+		pad(AssetPack::DataAlignment);
+		auto bytes = static_cast<const uint8_t*>(source.data);
+		for (uint64_t offset = 0; offset < source.size; offset += AssetPack::BlockSize)
+		{
+			const auto size = uint32_t((std::min)(source.size - offset, uint64_t(AssetPack::BlockSize)));
+			const char* stored = reinterpret_cast<const char*>(bytes + offset);
+			auto storedSize = size;
+
+			size_t compressedSize = 0;
+			switch (source.compression)
+			{
+#ifdef ASSETPACK_HAS_LZ4
+			case AssetPack::Compression::LZ4:
+				compressed.resize(size_t(LZ4_compressBound(int(size))));
+				compressedSize = size_t((std::max)(LZ4_compress_default(stored, compressed.data(), int(size), int(compressed.size())), 0));
+				break;
+#endif
+#ifdef ASSETPACK_HAS_ZSTD
+			case AssetPack::Compression::Zstd:
+				compressed.resize(ZSTD_compressBound(size));
+				compressedSize = ZSTD_compress(compressed.data(), compressed.size(), stored, size, ZstdLevel);
+				compressedSize = ZSTD_isError(compressedSize) ? 0 : compressedSize;
+				break;
+#endif
+			default:
+				break;
+			}
+			if (compressedSize != 0 && compressedSize < size)
+			{
+				stored = compressed.data();
+				storedSize = uint32_t(compressedSize);
+			}
+
+			AssetPack::Block block = { position, storedSize, size };
+			blockTables[i].push_back(block);
+			file.write(stored, storedSize);
+			position += storedSize;
+		}
+		chunk.blockCount = uint32_t(blockTables[i].size());
+	}
+
+	// ڎ (ubN̕\̈ʒu߂Ă珑)
+	pad(AssetPack::DataAlignment);
+	header.tocOffset = position;
+	auto tableOffset = position + sizeof(AssetPack::Chunk) * chunks.size();
+	for (size_t i = 0; i < chunks.size(); ++i)
+	{
+		chunks[i].blockTableOffset = tableOffset;
+		tableOffset += sizeof(AssetPack::Block) * blockTables[i].size();
+	}
+	file.write(reinterpret_cast<const char*>(chunks.data()), std::streamsize(sizeof(AssetPack::Chunk) * chunks.size()));
+	for (const auto& v : blockTables)
+	{
+		file.write(reinterpret_cast<const char*>(v.data()), std::streamsize(sizeof(AssetPack::Block) * v.size()));
+	}
+
+	file.seekp(0);
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	return bool(file);
+}
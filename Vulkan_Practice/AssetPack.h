@@ -0,0 +1,144 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <vector>
+#include <string>
+
+#include "MemoryAllocator.h"
+#include "UploadManager.h"
+
+// _ECfbNXȂǂ̃oCi܂Ƃ߂pbNt@C
+//   wb_[ | `Ñf[^ (DataAlignmentɑ) ... | ڎ (`N) | ubN̕\
+// `NBlockSizeƂ̃ubNɕĕۑAubNƂLZ4/zstdňkł
+// (kĂȂȂubN͂̂܂ܕۑ)
+// ǂݍݑ̓t@C}bvAubNXe[WOp̃Oobt@
+// host visiblẽobt@֒ڃRs[EWĴŁArstd::vectorȂǂɓǂݍ܂Ȃ
+class AssetPack
+{
+public:
+	enum class ChunkKind : uint32_t
+	{
+		Raw,
+		Vertices,		// stride͒_̑傫
+		Indices,		// stride24 (VK_INDEX_TYPE_UINT16 / UINT32)
+	};
+
+	enum class Compression : uint32_t
+	{
+		None,
+		LZ4,
+		Zstd,
+	};
+
+	// t@Č`
+	static const uint32_t Magic = 0x4B415056;		// "VPAK"
+	static const uint32_t Version = 1;
+	static const uint32_t NameLength = 48;
+	static const uint64_t DataAlignment = 64;
+	static const uint32_t BlockSize = 1024 * 1024;
+
+	struct Header
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint32_t chunkCount;
+		uint32_t blockSize;
+		uint64_t tocOffset;
+		uint64_t reserved;
+	};
+
+	struct Chunk
+	{
+		char name[NameLength];		// I[0܂
+		ChunkKind kind;
+		Compression compression;
+		uint32_t stride;
+		uint32_t blockCount;
+		uint64_t size;				// WJ̑傫
+		uint64_t blockTableOffset;	// Block̔z̈ʒu
+	};
+
+	struct Block
+	{
+		uint64_t offset;
+		uint32_t storedSize;		// sizeƓꍇ͈kĂȂ
+		uint32_t size;
+	};
+
+	typedef uint32_t ChunkIndex;
+	static const ChunkIndex InvalidChunk = ~0u;
+
+	AssetPack();
+	~AssetPack();
+
+	bool Open(const std::string& path);
+	void Close();
+	bool IsOpen() const { return _data != nullptr; }
+
+	// ̎st@CWJł鈳k (CMakeLZ4/zstdꍇ̂)
+	static bool IsCompressionSupported(Compression compression);
+
+	uint32_t GetChunkCount() const { return _header != nullptr ? _header->chunkCount : 0; }
+	ChunkIndex FindChunk(const char* name) const;
+	const Chunk& GetChunk(ChunkIndex index) const { return _chunks[index]; }
+
+	// kĂȂ`Ñf[^ (}bvt@C𒼐ڎwAkĂꍇnullptr)
+	const void* GetData(ChunkIndex index) const;
+
+	// host visiblẽobt@Ȃǂ֒ڃRs[EWJ (destination̓`Nsizeȏ)
+	bool Read(ChunkIndex index, void* destination) const;
+
+	// Xe[WOp̃Oobt@փubNƂɒڃRs[EWJAbufferւ̓]\񂷂
+	// ticketɂ͑SẴubN̓]܂ރ`PbgԂ (̃`N0)
+	// `Ɏgt[łUploadManager::RequireŐ錾 (_ECfbNXobt@VK_PIPELINE_STAGE_VERTEX_INPUT_BIT)
+	bool Upload(ChunkIndex index, UploadManager& uploadManager, VkBuffer buffer, VkDeviceSize offset = 0, UploadTicket* ticket = nullptr) const;
+
+	// `NƓ傫̃foCX[J̃obt@ē] (usageɂTRANSFER_DSTǉ)
+	// ticketɂ͓]̃`PbgԂ (UploadƓ)
+	bool CreateBuffer(ChunkIndex index, MemoryAllocator& allocator, UploadManager& uploadManager, VkBufferUsageFlags usage,
+		VkBuffer& buffer, MemoryAllocation& allocation, UploadTicket* ticket = nullptr) const;
+
+private:
+	const Block* GetBlocks(ChunkIndex index) const;
+	bool DecodeBlock(const Chunk& chunk, const Block& block, void* destination) const;
+	void ReleasePages(ChunkIndex index) const;
+	bool Validate() const;
+
+	const uint8_t* _data;
+	uint64_t _size;
+	const Header* _header;
+	const Chunk* _chunks;
+
+#ifdef _WIN32
+	void* _file;
+	void* _mapping;
+#else
+	int _file;
+#endif
+};
+
+
+// pbNt@C̏o (AZbg̕ϊc[Ŏg)
+class AssetPackWriter
+{
+public:
+	// dataWrite܂ŕێ (kT|[gĂȂꍇ͈kɕۑ)
+	void AddChunk(const char* name, AssetPack::ChunkKind kind, uint32_t stride, const void* data, uint64_t size,
+		AssetPack::Compression compression = AssetPack::Compression::None);
+
+	bool Write(const std::string& path) const;
+
+private:
+	struct Source
+	{
+		std::string name;
+		AssetPack::ChunkKind kind;
+		uint32_t stride;
+		const void* data;
+		uint64_t size;
+		AssetPack::Compression compression;
+	};
+
+	std::vector<Source> _sources;
+};
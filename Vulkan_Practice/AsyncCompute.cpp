@@ -0,0 +1,142 @@
+#include "AsyncCompute.h"
+
+
+AsyncCompute::AsyncCompute() : _device(VK_NULL_HANDLE), _timeline(nullptr), _queueFamilyIndex(0), _queue(VK_NULL_HANDLE), _dedicatedQueue(false)
+{
+}
+
+// t[Ƃ̃R}hv[ƃZ}tH̐
+void AsyncCompute::Initialize(VkDevice device, GpuTimeline* timeline, uint32_t queueFamilyIndex, VkQueue queue, bool dedicatedQueue,
+	uint32_t framesInFlight)
+{
+	_device = device;
+	_timeline = timeline;
+	_queueFamilyIndex = queueFamilyIndex;
+	_queue = queue;
+	_dedicatedQueue = dedicatedQueue;
+
+	_frames.resize(framesInFlight);
+	for (auto& v : _frames)
+	{
+		VkCommandPoolCreateInfo poolCI{};
+		poolCI.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+		poolCI.queueFamilyIndex = _queueFamilyIndex;
+		poolCI.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+		vkCreateCommandPool(_device, &poolCI, nullptr, &v.pool);
+
+		VkCommandBufferAllocateInfo ai{};
+		ai.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+		ai.commandPool = v.pool;
+		ai.commandBufferCount = 1;
+		ai.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+		vkAllocateCommandBuffers(_device, &ai, &v.command);
+
+		v.completed = VK_NULL_HANDLE;
+		if (!_timeline->IsSupported())
+		{
+			VkSemaphoreCreateInfo semaphoreCI{};
+			semaphoreCI.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+			vkCreateSemaphore(_device, &semaphoreCI, nullptr, &v.completed);
+		}
+	}
+}
+
+// j (GPŮ҂ĂĂ)
+void AsyncCompute::Terminate()
+{
+	for (auto& v : _frames)
+	{
+		if (v.completed != VK_NULL_HANDLE)
+		{
+			vkDestroySemaphore(_device, v.completed, nullptr);
+		}
+		vkDestroyCommandPool(_device, v.pool, nullptr);
+	}
+	_frames.clear();
+	_passes.clear();
+}
+
+// Rs[gpX̓o^
+uint32_t AsyncCompute::AddPass(const char* name, VkPipelineStageFlags waitStage, const RecordFunction& record)
+{
+	Pass pass;
+	pass.name = name;
+	pass.waitStage = waitStage;
+	pass.record = record;
+	pass.enabled = true;
+	_passes.emplace_back(pass);
+	return uint32_t(_passes.size() - 1);
+}
+
+void AsyncCompute::SetPassEnabled(uint32_t pass, bool enabled)
+{
+	if (pass < _passes.size())
+	{
+		_passes[pass].enabled = enabled;
+	}
+}
+
+// pX̋L^ƑM
+void AsyncCompute::Submit(uint32_t frameIndex, GpuTimeline::WaitList& waits)
+{
+	// OtBbNXő҂Xe[W͗LȃpX̂̂܂Ƃ߂
+	VkPipelineStageFlags waitStage = 0;
+	for (const auto& v : _passes)
+	{
+		if (v.enabled)
+		{
+			waitStage |= v.waitStage;
+		}
+	}
+	if (waitStage == 0)
+	{
+		return;
+	}
+
+	// O񂱂̃t[őMR}h́A҂OtBbNX̃t[̊Ŋۏ؂Ă
+	auto& frame = _frames[frameIndex];
+	vkResetCommandPool(_device, frame.pool, 0);
+
+	VkCommandBufferBeginInfo bi{};
+	bi.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	bi.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+	vkBeginCommandBuffer(frame.command, &bi);
+	for (const auto& v : _passes)
+	{
+		if (v.enabled)
+		{
+			v.record(frame.command);
+		}
+	}
+	vkEndCommandBuffer(frame.command);
+
+	const auto value = _timeline->Submit(GpuTimeline::Compute, _queue, frame.command, nullptr, frame.completed);
+	if (value == 0)
+	{
+		return;
+	}
+
+	if (!_timeline->AddWait(waits, GpuTimeline::Compute, value, waitStage))
+	{
+		waits.Add(frame.completed, waitStage);
+	}
+}
+
+// Rs[gpCvC̐
+VkPipeline AsyncCompute::CreatePipeline(VkShaderModule shader, const char* entryPoint, VkPipelineLayout layout, VkPipelineCache cache,
+	const VkSpecializationInfo* specialization) const
+{
+	VkComputePipelineCreateInfo ci{};
+	ci.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+	ci.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+	ci.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+	ci.stage.module = shader;
+	ci.stage.pName = entryPoint;
+	ci.stage.pSpecializationInfo = specialization;
+	ci.layout = layout;
+	ci.basePipelineIndex = -1;
+
+	VkPipeline pipeline = VK_NULL_HANDLE;
+	vkCreateComputePipelines(_device, cache, 1, &ci, nullptr, &pipeline);
+	return pipeline;
+}
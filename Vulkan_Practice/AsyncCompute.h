@@ -0,0 +1,68 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <vector>
+#include <string>
+#include <functional>
+
+#include "GpuTimeline.h"
+
+// Rs[gp̃L[ŃfBXpb`L^EM
+// OtBbNX̑MɑMAOtBbNX͌ʂgXe[WŃRs[g̃^CC̒l҂
+// (^CCɑΉĂȂꍇ̓t[Ƃ̃oCiZ}tH҂)
+// (ʂg܂ł̃OtBbNX̏ƕsĎs)
+class AsyncCompute
+{
+public:
+	using RecordFunction = std::function<void(VkCommandBuffer command)>;
+
+	AsyncCompute();
+
+	void Initialize(VkDevice device, GpuTimeline* timeline, uint32_t queueFamilyIndex, VkQueue queue, bool dedicatedQueue, uint32_t framesInFlight);
+	void Terminate();
+
+	// Rs[gpX̓o^ (o^ɋL^)
+	// waitStage̓OtBbNXŌʂgXe[W
+	uint32_t AddPass(const char* name, VkPipelineStageFlags waitStage, const RecordFunction& record);
+	void SetPassEnabled(uint32_t pass, bool enabled);
+
+	// LȃpXL^đM (̃t[̑O̊҂ɌĂ)
+	// OtBbNX̑Mő҂̂waitsɒǉ
+	void Submit(uint32_t frameIndex, GpuTimeline::WaitList& waits);
+
+	// Rs[gpCvC̐
+	VkPipeline CreatePipeline(VkShaderModule shader, const char* entryPoint, VkPipelineLayout layout, VkPipelineCache cache,
+		const VkSpecializationInfo* specialization = nullptr) const;
+
+	// OtBbNXƕʂ̃L[Ŏs邩
+	// ʂ̃L[t@~[̏ꍇAŎg\[XVK_SHARING_MODE_CONCURRENTŐ
+	bool IsDedicatedQueue() const { return _dedicatedQueue; }
+	uint32_t GetQueueFamilyIndex() const { return _queueFamilyIndex; }
+
+private:
+	struct Pass
+	{
+		std::string name;
+		VkPipelineStageFlags waitStage;
+		RecordFunction record;
+		bool enabled;
+	};
+
+	// t[Ƃ̃R}hobt@ƊʒmZ}tH (^CCɑΉĂȂꍇ̂)
+	struct Frame
+	{
+		VkCommandPool pool;
+		VkCommandBuffer command;
+		VkSemaphore completed;
+	};
+
+	VkDevice _device;
+	GpuTimeline* _timeline;
+	uint32_t _queueFamilyIndex;
+	VkQueue _queue;
+	bool _dedicatedQueue;
+
+	std::vector<Pass> _passes;
+	std::vector<Frame> _frames;
+};
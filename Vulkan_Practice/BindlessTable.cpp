@@ -0,0 +1,349 @@
+#include "BindlessTable.h"
+
+#include <algorithm>
+
+
+BindlessTable::BindlessTable() : _device(VK_NULL_HANDLE), _pool(VK_NULL_HANDLE), _pipelineLayout(VK_NULL_HANDLE), _frameNumber(0)
+{
+}
+
+// Kvȋ@\̑I
+bool BindlessTable::SelectFeatures(const VkPhysicalDeviceDescriptorIndexingFeaturesEXT& supported, VkPhysicalDeviceDescriptorIndexingFeaturesEXT& enabled)
+{
+	// 傫w肵ȂzAo^̃Xbg܂ޔzAoCh̍XVAVF[_[ł̔lȃCfbNX
+	const auto available = supported.runtimeDescriptorArray && supported.descriptorBindingPartiallyBound &&
+		supported.descriptorBindingUpdateUnusedWhilePending &&
+		supported.descriptorBindingSampledImageUpdateAfterBind && supported.descriptorBindingStorageBufferUpdateAfterBind &&
+		supported.shaderSampledImageArrayNonUniformIndexing && supported.shaderStorageBufferArrayNonUniformIndexing;
+	if (!available)
+	{
+		return false;
+	}
+
+	enabled.runtimeDescriptorArray = VK_TRUE;
+	enabled.descriptorBindingPartiallyBound = VK_TRUE;
+	enabled.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+	enabled.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+	enabled.descriptorBindingStorageBufferUpdateAfterBind = VK_TRUE;
+	enabled.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+	enabled.shaderStorageBufferArrayNonUniformIndexing = VK_TRUE;
+	return true;
+}
+
+// fXNv^v[AZbgApCvCCAEg̐
+bool BindlessTable::Initialize(VkPhysicalDevice physicalDevice, VkDevice device, const VkPhysicalDeviceDescriptorIndexingFeaturesEXT& features,
+	uint32_t textureCount, uint32_t samplerCount, uint32_t storageBufferCount)
+{
+	_device = device;
+	_frameNumber = 0;
+
+	VkPhysicalDeviceDescriptorIndexingFeaturesEXT enabled{};
+	if (!SelectFeatures(features, enabled))
+	{
+		return false;
+	}
+
+	// update-after-bind̔z̏
+	VkPhysicalDeviceDescriptorIndexingPropertiesEXT indexingProps{};
+	indexingProps.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES_EXT;
+	VkPhysicalDeviceProperties2 props{};
+	props.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+	props.pNext = &indexingProps;
+	vkGetPhysicalDeviceProperties2(physicalDevice, &props);
+
+	textureCount = (std::min)({ textureCount, indexingProps.maxPerStageDescriptorUpdateAfterBindSampledImages,
+		indexingProps.maxDescriptorSetUpdateAfterBindSampledImages });
+	samplerCount = (std::min)({ samplerCount, indexingProps.maxPerStageDescriptorUpdateAfterBindSamplers,
+		indexingProps.maxDescriptorSetUpdateAfterBindSamplers });
+	storageBufferCount = (std::min)({ storageBufferCount, indexingProps.maxPerStageDescriptorUpdateAfterBindStorageBuffers,
+		indexingProps.maxDescriptorSetUpdateAfterBindStorageBuffers });
+
+	// 3̃Zbg1̃v[mۂ
+	std::array<VkDescriptorPoolSize, KindCount> poolSizes = { {
+		{ VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, textureCount },
+		{ VK_DESCRIPTOR_TYPE_SAMPLER, samplerCount },
+		{ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, storageBufferCount },
+	} };
+
+	VkDescriptorPoolCreateInfo poolCI{};
+	poolCI.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+	poolCI.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT_EXT;
+	poolCI.maxSets = KindCount;
+	poolCI.poolSizeCount = uint32_t(poolSizes.size());
+	poolCI.pPoolSizes = poolSizes.data();
+	if (vkCreateDescriptorPool(_device, &poolCI, nullptr, &_pool) != VK_SUCCESS)
+	{
+		_pool = VK_NULL_HANDLE;
+		return false;
+	}
+
+	const auto created = CreateTable(_tables[uint32_t(Kind::Texture)], VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, textureCount) &&
+		CreateTable(_tables[uint32_t(Kind::Sampler)], VK_DESCRIPTOR_TYPE_SAMPLER, samplerCount) &&
+		CreateTable(_tables[uint32_t(Kind::StorageBuffer)], VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, storageBufferCount);
+	if (!created)
+	{
+		Terminate();
+		return false;
+	}
+
+	// SẴVF[_[Xe[W瓯CfbNXǂ߂悤ɂ
+	std::array<VkDescriptorSetLayout, KindCount> setLayouts;
+	for (uint32_t i = 0; i < KindCount; ++i)
+	{
+		setLayouts[i] = _tables[i].layout;
+	}
+
+	VkPushConstantRange pushConstantRange{};
+	pushConstantRange.stageFlags = VK_SHADER_STAGE_ALL;
+	pushConstantRange.offset = 0;
+	pushConstantRange.size = PushConstantSize;
+
+	VkPipelineLayoutCreateInfo layoutCI{};
+	layoutCI.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+	layoutCI.setLayoutCount = uint32_t(setLayouts.size());
+	layoutCI.pSetLayouts = setLayouts.data();
+	layoutCI.pushConstantRangeCount = 1;
+	layoutCI.pPushConstantRanges = &pushConstantRange;
+	if (vkCreatePipelineLayout(_device, &layoutCI, nullptr, &_pipelineLayout) != VK_SUCCESS)
+	{
+		_pipelineLayout = VK_NULL_HANDLE;
+		Terminate();
+		return false;
+	}
+	return true;
+}
+
+// ZbgCAEg̐ƃZbg̊m
+bool BindlessTable::CreateTable(Table& table, VkDescriptorType type, uint32_t capacity)
+{
+	table.type = type;
+	table.capacity = capacity;
+	table.next = 0;
+	table.freeSlots.clear();
+	table.retiredSlots.clear();
+
+	// o^̃Xbg܂񂾂܂܁AoChłgĂȂXbgXVł悤ɂ
+	const VkDescriptorBindingFlagsEXT bindingFlags = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT_EXT |
+		VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT_EXT | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT_EXT;
+
+	VkDescriptorSetLayoutBindingFlagsCreateInfoEXT flagsCI{};
+	flagsCI.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO_EXT;
+	flagsCI.bindingCount = 1;
+	flagsCI.pBindingFlags = &bindingFlags;
+
+	VkDescriptorSetLayoutBinding binding{};
+	binding.binding = 0;
+	binding.descriptorType = type;
+	binding.descriptorCount = capacity;
+	binding.stageFlags = VK_SHADER_STAGE_ALL;
+
+	VkDescriptorSetLayoutCreateInfo layoutCI{};
+	layoutCI.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+	layoutCI.pNext = &flagsCI;
+	layoutCI.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT_EXT;
+	layoutCI.bindingCount = 1;
+	layoutCI.pBindings = &binding;
+	if (vkCreateDescriptorSetLayout(_device, &layoutCI, nullptr, &table.layout) != VK_SUCCESS)
+	{
+		table.layout = VK_NULL_HANDLE;
+		return false;
+	}
+
+	VkDescriptorSetAllocateInfo setAI{};
+	setAI.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	setAI.descriptorPool = _pool;
+	setAI.descriptorSetCount = 1;
+	setAI.pSetLayouts = &table.layout;
+	return vkAllocateDescriptorSets(_device, &setAI, &table.set) == VK_SUCCESS;
+}
+
+// j (Zbg̓v[ƈꏏɊJ)
+void BindlessTable::Terminate()
+{
+	if (_pipelineLayout != VK_NULL_HANDLE)
+	{
+		vkDestroyPipelineLayout(_device, _pipelineLayout, nullptr);
+		_pipelineLayout = VK_NULL_HANDLE;
+	}
+	for (auto& v : _tables)
+	{
+		if (v.layout != VK_NULL_HANDLE)
+		{
+			vkDestroyDescriptorSetLayout(_device, v.layout, nullptr);
+		}
+		v = Table();
+	}
+	if (_pool != VK_NULL_HANDLE)
+	{
+		vkDestroyDescriptorPool(_device, _pool, nullptr);
+		_pool = VK_NULL_HANDLE;
+	}
+}
+
+// Xbg̊m (ėpłXbgD悷)
+BindlessTable::Handle BindlessTable::AllocateSlot(Table& table)
+{
+	if (!table.freeSlots.empty())
+	{
+		auto handle = table.freeSlots.back();
+		table.freeSlots.pop_back();
+		return handle;
+	}
+	if (table.next < table.capacity)
+	{
+		return table.next++;
+	}
+	return InvalidHandle;
+}
+
+// eNX`̓o^
+BindlessTable::Handle BindlessTable::AddTexture(VkImageView view, VkImageLayout layout)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	if (!IsAvailable())
+	{
+		return InvalidHandle;
+	}
+
+	auto& table = _tables[uint32_t(Kind::Texture)];
+	auto handle = AllocateSlot(table);
+	if (handle == InvalidHandle)
+	{
+		return InvalidHandle;
+	}
+
+	VkDescriptorImageInfo imageInfo{};
+	imageInfo.imageView = view;
+	imageInfo.imageLayout = layout;
+
+	VkWriteDescriptorSet write{};
+	write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	write.dstSet = table.set;
+	write.dstBinding = 0;
+	write.dstArrayElement = handle;
+	write.descriptorCount = 1;
+	write.descriptorType = table.type;
+	write.pImageInfo = &imageInfo;
+	vkUpdateDescriptorSets(_device, 1, &write, 0, nullptr);
+	return handle;
+}
+
+// Tv[̓o^
+BindlessTable::Handle BindlessTable::AddSampler(VkSampler sampler)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	if (!IsAvailable())
+	{
+		return InvalidHandle;
+	}
+
+	auto& table = _tables[uint32_t(Kind::Sampler)];
+	auto handle = AllocateSlot(table);
+	if (handle == InvalidHandle)
+	{
+		return InvalidHandle;
+	}
+
+	VkDescriptorImageInfo imageInfo{};
+	imageInfo.sampler = sampler;
+
+	VkWriteDescriptorSet write{};
+	write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	write.dstSet = table.set;
+	write.dstBinding = 0;
+	write.dstArrayElement = handle;
+	write.descriptorCount = 1;
+	write.descriptorType = table.type;
+	write.pImageInfo = &imageInfo;
+	vkUpdateDescriptorSets(_device, 1, &write, 0, nullptr);
+	return handle;
+}
+
+// Xg[Wobt@̓o^
+BindlessTable::Handle BindlessTable::AddStorageBuffer(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	if (!IsAvailable())
+	{
+		return InvalidHandle;
+	}
+
+	auto& table = _tables[uint32_t(Kind::StorageBuffer)];
+	auto handle = AllocateSlot(table);
+	if (handle == InvalidHandle)
+	{
+		return InvalidHandle;
+	}
+
+	VkDescriptorBufferInfo bufferInfo{};
+	bufferInfo.buffer = buffer;
+	bufferInfo.offset = offset;
+	bufferInfo.range = range;
+
+	VkWriteDescriptorSet write{};
+	write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	write.dstSet = table.set;
+	write.dstBinding = 0;
+	write.dstArrayElement = handle;
+	write.descriptorCount = 1;
+	write.descriptorType = table.type;
+	write.pBufferInfo = &bufferInfo;
+	vkUpdateDescriptorSets(_device, 1, &write, 0, nullptr);
+	return handle;
+}
+
+// 폜 (fXNv^͏AXbgj҂ɂ)
+void BindlessTable::Remove(Kind kind, Handle handle)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	auto& table = _tables[uint32_t(kind)];
+	if (handle >= table.next)
+	{
+		return;
+	}
+
+	RetiredSlot slot;
+	slot.handle = handle;
+	slot.removedFrame = _frameNumber;
+	table.retiredSlots.push_back(slot);
+}
+
+// t[gĂXbgėpł悤ɂ
+void BindlessTable::BeginFrame(uint64_t frameNumber, uint64_t completedFrames)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	_frameNumber = frameNumber;
+
+	// removedFrameԖڂ̃t[܂ł폜XbggĂ\
+	for (auto& table : _tables)
+	{
+		auto it = std::remove_if(table.retiredSlots.begin(), table.retiredSlots.end(), [&](const RetiredSlot& v)
+		{
+			if (v.removedFrame >= completedFrames)
+			{
+				return false;
+			}
+			table.freeSlots.push_back(v.handle);
+			return true;
+		});
+		table.retiredSlots.erase(it, table.retiredSlots.end());
+	}
+}
+
+// SẴZbg̃oCh
+void BindlessTable::Bind(VkCommandBuffer command, VkPipelineBindPoint bindPoint) const
+{
+	std::array<VkDescriptorSet, KindCount> sets;
+	for (uint32_t i = 0; i < KindCount; ++i)
+	{
+		sets[i] = _tables[i].set;
+	}
+	vkCmdBindDescriptorSets(command, bindPoint, _pipelineLayout, 0, uint32_t(sets.size()), sets.data(), 0, nullptr);
+}
+
+uint32_t BindlessTable::GetUsedCount(Kind kind) const
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	const auto& table = _tables[uint32_t(kind)];
+	return table.next - uint32_t(table.freeSlots.size() + table.retiredSlots.size());
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <vector>
+#include <array>
+#include <mutex>
+
+// eNX`ATv[AXg[Wobt@ꂼ1̑傫ȃfXNv^Zbg̔zɓo^
+// (VK_EXT_descriptor_indexing  update-after-bind g)
+// VF[_[ւ͔z̃CfbNXvbV萔œn̂ŁA`悲ƂɃfXNv^ZbgoChKvȂ
+//   set 0 : texture2D textures[]
+//   set 1 : sampler samplers[]
+//   set 2 : buffer buffers[]
+// Xbg͓o^폜܂ŕς炸A폜Xbg͎gĂt[IĂėp
+class BindlessTable
+{
+public:
+	typedef uint32_t Handle;
+	static const Handle InvalidHandle = ~0u;
+
+	enum class Kind
+	{
+		Texture,
+		Sampler,
+		StorageBuffer,
+	};
+	static const uint32_t KindCount = 3;
+
+	// vbV萔̑傫 (SẴfoCXŎg)
+	static const uint32_t PushConstantSize = 128;
+
+	BindlessTable();
+
+	// Kvȋ@\T|[gĂ邩mFALɂ@\enabledɐݒ肷
+	static bool SelectFeatures(const VkPhysicalDeviceDescriptorIndexingFeaturesEXT& supported, VkPhysicalDeviceDescriptorIndexingFeaturesEXT& enabled);
+
+	// features̓foCX̐ɗLɂ@\ (T|[gĂȂꍇfalseԂAe[u͎gȂ)
+	// ez̑傫̓foCX̏ɍ킹ďȂꍇ
+	bool Initialize(VkPhysicalDevice physicalDevice, VkDevice device, const VkPhysicalDeviceDescriptorIndexingFeaturesEXT& features,
+		uint32_t textureCount = 16384, uint32_t samplerCount = 256, uint32_t storageBufferCount = 4096);
+	void Terminate();
+	bool IsAvailable() const { return _pool != VK_NULL_HANDLE; }
+
+	// o^ (ǂ̃XbhĂׂA󂫂ȂꍇInvalidHandle)
+	Handle AddTexture(VkImageView view, VkImageLayout layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+	Handle AddSampler(VkSampler sampler);
+	Handle AddStorageBuffer(VkBuffer buffer, VkDeviceSize offset = 0, VkDeviceSize range = VK_WHOLE_SIZE);
+
+	// 폜 (Xbg͑Mς݂̃t[܂ōėpȂ)
+	void Remove(Kind kind, Handle handle);
+
+	// t[̊JnɌĂ (completedFramesGPUŊt[)
+	void BeginFrame(uint64_t frameNumber, uint64_t completedFrames);
+
+	// SẴZbgoCh (R}hobt@Ƃ1)
+	void Bind(VkCommandBuffer command, VkPipelineBindPoint bindPoint) const;
+
+	// CfbNXvbV萔œn
+	template<typename T>
+	void PushIndices(VkCommandBuffer command, const T& indices, uint32_t offset = 0) const
+	{
+		static_assert(sizeof(T) <= PushConstantSize, "push constants are limited to PushConstantSize bytes");
+		vkCmdPushConstants(command, _pipelineLayout, VK_SHADER_STAGE_ALL, offset, sizeof(T), &indices);
+	}
+
+	// pCvC͂̃CAEgŐ
+	VkPipelineLayout GetPipelineLayout() const { return _pipelineLayout; }
+	VkDescriptorSetLayout GetSetLayout(Kind kind) const { return _tables[uint32_t(kind)].layout; }
+	uint32_t GetCapacity(Kind kind) const { return _tables[uint32_t(kind)].capacity; }
+	uint32_t GetUsedCount(Kind kind) const;
+
+private:
+	// 폜Xbg (removedFramẽt[ėp)
+	struct RetiredSlot
+	{
+		Handle handle;
+		uint64_t removedFrame;
+	};
+
+	struct Table
+	{
+		VkDescriptorType type = VK_DESCRIPTOR_TYPE_SAMPLER;
+		VkDescriptorSetLayout layout = VK_NULL_HANDLE;
+		VkDescriptorSet set = VK_NULL_HANDLE;
+		uint32_t capacity = 0;
+		uint32_t next = 0;				// ܂gĂȂŏ̃Xbg
+		std::vector<Handle> freeSlots;
+		std::vector<RetiredSlot> retiredSlots;
+	};
+
+	Handle AllocateSlot(Table& table);
+	bool CreateTable(Table& table, VkDescriptorType type, uint32_t capacity);
+
+	VkDevice _device;
+	VkDescriptorPool _pool;
+	VkPipelineLayout _pipelineLayout;
+	std::array<Table, KindCount> _tables;
+	uint64_t _frameNumber;
+
+	mutable std::mutex _mutex;
+};
@@ -0,0 +1,115 @@
+#include "CommandRecorder.h"
+
+#include <algorithm>
+
+
+CommandRecorder::CommandRecorder() : _device(VK_NULL_HANDLE), _jobSystem(nullptr), _threadCount(1), _currentFrame(0)
+{
+}
+
+CommandRecorder::~CommandRecorder()
+{
+	Terminate();
+}
+
+// XbhƂ̃R}hv[̐
+void CommandRecorder::Initialize(VkDevice device, uint32_t queueFamilyIndex, uint32_t framesInFlight, JobSystem* jobSystem)
+{
+	_device = device;
+	_jobSystem = jobSystem;
+	_threadCount = (std::max)(jobSystem->GetThreadCount(), 1u);
+	_currentFrame = 0;
+
+	// t[܂Ƃ߂ăZbg邽߁Aʂ̃Zbg͋TRANSIENTɂ
+	VkCommandPoolCreateInfo ci{};
+	ci.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+	ci.queueFamilyIndex = queueFamilyIndex;
+	ci.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+
+	_pools.resize(size_t(framesInFlight) * _threadCount);
+	for (auto& v : _pools)
+	{
+		vkCreateCommandPool(_device, &ci, nullptr, &v.pool);
+	}
+
+	// vC}̓t[ƂɃXbh0̃v[mۂ
+	_primaryCommands.resize(framesInFlight);
+	for (uint32_t i = 0; i < framesInFlight; ++i)
+	{
+		VkCommandBufferAllocateInfo ai{};
+		ai.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+		ai.commandPool = GetPool(i, 0).pool;
+		ai.commandBufferCount = 1;
+		ai.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+		vkAllocateCommandBuffers(_device, &ai, &_primaryCommands[i]);
+	}
+}
+
+// R}hv[̔j (GPŮ҂ĂĂ)
+void CommandRecorder::Terminate()
+{
+	// v[̔jŊmۂR}hobt@J
+	for (auto& v : _pools)
+	{
+		vkDestroyCommandPool(_device, v.pool, nullptr);
+	}
+	_pools.clear();
+	_primaryCommands.clear();
+}
+
+// t[̊Jn
+VkCommandBuffer CommandRecorder::BeginFrame(uint32_t frameIndex)
+{
+	_currentFrame = frameIndex;
+
+	// R}hobt@ʂɃZbgAv[ƃZbg
+	for (uint32_t i = 0; i < _threadCount; ++i)
+	{
+		auto& pool = GetPool(frameIndex, i);
+		vkResetCommandPool(_device, pool.pool, 0);
+		pool.usedCount = 0;
+	}
+	return _primaryCommands[frameIndex];
+}
+
+// ZJ_R}hobt@̋L^ (sXbh̃v[mۂ)
+VkCommandBuffer CommandRecorder::RecordSecondary(VkRenderPass renderPass, uint32_t subpass, VkFramebuffer framebuffer, uint32_t taskIndex,
+	const RecordFunction& function)
+{
+	VkCommandBufferInheritanceInfo inheritance{};
+	inheritance.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+	inheritance.renderPass = renderPass;
+	inheritance.subpass = subpass;
+	inheritance.framebuffer = framebuffer;
+
+	VkCommandBufferBeginInfo bi{};
+	bi.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	bi.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+	bi.pInheritanceInfo = &inheritance;
+
+	const auto threadIndex = _jobSystem->GetThreadIndex();
+	auto command = AcquireSecondary(threadIndex);
+	vkBeginCommandBuffer(command, &bi);
+	function(command, taskIndex, threadIndex);
+	vkEndCommandBuffer(command);
+	return command;
+}
+
+// ̃Xbh̃v[ZJ_R}hobt@擾
+VkCommandBuffer CommandRecorder::AcquireSecondary(uint32_t threadIndex)
+{
+	auto& pool = GetPool(_currentFrame, threadIndex);
+	if (pool.usedCount == pool.commands.size())
+	{
+		VkCommandBufferAllocateInfo ai{};
+		ai.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+		ai.commandPool = pool.pool;
+		ai.commandBufferCount = 1;
+		ai.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+
+		VkCommandBuffer command;
+		vkAllocateCommandBuffers(_device, &ai, &command);
+		pool.commands.push_back(command);
+	}
+	return pool.commands[pool.usedCount++];
+}
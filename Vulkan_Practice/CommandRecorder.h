@@ -0,0 +1,57 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <vector>
+#include <functional>
+
+#include "JobSystem.h"
+
+// JobSystem̃XbhŃZJ_R}hobt@ɋL^
+// R}hv[̓t[ƁEXbhƂɎAt[̊Jnɂ܂Ƃ߂ăZbg
+class CommandRecorder
+{
+public:
+	// taskIndexƂ1̃ZJ_R}hobt@n
+	// threadIndex0`GetThreadCount()-1 (JobSystem̃Xbh̔ԍA0̓CXbh)
+	using RecordFunction = std::function<void(VkCommandBuffer command, uint32_t taskIndex, uint32_t threadIndex)>;
+
+	CommandRecorder();
+	~CommandRecorder();
+
+	// jobSystem̃XbhƂɃv[
+	void Initialize(VkDevice device, uint32_t queueFamilyIndex, uint32_t framesInFlight, JobSystem* jobSystem);
+	void Terminate();
+
+	// t[̊Jn (t[fence҂ɌĂ)
+	// ̃t[̃v[ZbgAvC}R}hobt@Ԃ
+	VkCommandBuffer BeginFrame(uint32_t frameIndex);
+
+	// _[pX̃TupXŎsZJ_R}hobt@ĂяõXbh1L^
+	// JobSystem̃Xbh (t[̃^XNȂ) ĂсAقȂXbh瓯ɌĂł悢
+	// framebufferVK_NULL_HANDLEł悢 (swapchaiñC[W擾OɋL^ł)
+	VkCommandBuffer RecordSecondary(VkRenderPass renderPass, uint32_t subpass, VkFramebuffer framebuffer, uint32_t taskIndex,
+		const RecordFunction& function);
+
+	uint32_t GetThreadCount() const { return _threadCount; }
+
+private:
+	// t[ƁEXbhƂ̃R}hv[
+	struct ThreadCommandPool
+	{
+		VkCommandPool pool = VK_NULL_HANDLE;
+		std::vector<VkCommandBuffer> commands;	// mۍς݂̃ZJ_ (ZbgɎg)
+		uint32_t usedCount = 0;
+	};
+
+	ThreadCommandPool& GetPool(uint32_t frameIndex, uint32_t threadIndex) { return _pools[frameIndex * _threadCount + threadIndex]; }
+	VkCommandBuffer AcquireSecondary(uint32_t threadIndex);
+
+	VkDevice _device;
+	JobSystem* _jobSystem;
+	uint32_t _threadCount;
+	uint32_t _currentFrame;
+
+	std::vector<ThreadCommandPool> _pools;		// [frameIndex * _threadCount + threadIndex]
+	std::vector<VkCommandBuffer> _primaryCommands;	// t[ (Xbh0̃v[m)
+};
@@ -0,0 +1,398 @@
+#include "DeferredRenderer.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+
+// vkCmdUpdateBuffer1xɓ]łTCY
+static const VkDeviceSize MaxUpdateSize = 65536;
+
+
+DeferredRenderer::DeferredRenderer() : _device(VK_NULL_HANDLE), _allocator(nullptr), _pipelineManager(nullptr), _deletionQueue(nullptr),
+	_maxLights(0), _vertexShader(VK_NULL_HANDLE), _fragmentShader(VK_NULL_HANDLE), _lightBuffer(VK_NULL_HANDLE), _setLayout(VK_NULL_HANDLE),
+	_pipelineLayout(VK_NULL_HANDLE), _descriptorPool(VK_NULL_HANDLE), _descriptorSet(VK_NULL_HANDLE), _boundViews{}, _renderPass(VK_NULL_HANDLE),
+	_subpass(0), _pipelineKey(0), _frame{}, _graph(nullptr), _albedoResource(RenderGraph::InvalidResource),
+	_normalResource(RenderGraph::InvalidResource), _depthResource(RenderGraph::InvalidResource), _lightResource(RenderGraph::InvalidResource)
+{
+}
+
+// Cg̃obt@AfXNv^Zbg̃CAEgApCvCCAEg̐
+bool DeferredRenderer::Initialize(VkDevice device, MemoryAllocator* allocator, PipelineManager* pipelineManager, DeletionQueue* deletionQueue,
+	VkShaderModule lightVertexShader, VkShaderModule lightFragmentShader, uint32_t maxLights)
+{
+	_device = device;
+	_allocator = allocator;
+	_pipelineManager = pipelineManager;
+	_deletionQueue = deletionQueue;
+	_vertexShader = lightVertexShader;
+	_fragmentShader = lightFragmentShader;
+	_maxLights = (std::min)(maxLights, uint32_t((MaxUpdateSize - sizeof(FrameData)) / sizeof(Light)));
+	_renderPass = VK_NULL_HANDLE;
+	_pipelineKey = 0;
+	_lights.clear();
+
+	// ̊l
+	_frame = FrameData{};
+	SetAmbient(0.1f, 0.1f, 0.1f);
+
+	// 擪Ƀt[̏ǍɃCg (t[)
+	VkBufferCreateInfo bufferCI{};
+	bufferCI.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	bufferCI.size = sizeof(FrameData) + sizeof(Light) * (std::max)(_maxLights, 1u);
+	bufferCI.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+	bufferCI.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+	if (!_allocator->CreateBuffer(bufferCI, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0, _lightBuffer, _lightAllocation))
+	{
+		Terminate();
+		return false;
+	}
+
+	// binding 0: t[̏ƃCg, 1: Axh, 2: @, 3: [x
+	std::array<VkDescriptorSetLayoutBinding, 4> bindings{};
+	for (uint32_t i = 0; i < uint32_t(bindings.size()); ++i)
+	{
+		bindings[i].binding = i;
+		bindings[i].descriptorType = i == 0 ? VK_DESCRIPTOR_TYPE_STORAGE_BUFFER : VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+		bindings[i].descriptorCount = 1;
+		bindings[i].stageFlags = i == 0 ? VkShaderStageFlags(VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT) : VK_SHADER_STAGE_FRAGMENT_BIT;
+	}
+
+	VkDescriptorSetLayoutCreateInfo setLayoutCI{};
+	setLayoutCI.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+	setLayoutCI.bindingCount = uint32_t(bindings.size());
+	setLayoutCI.pBindings = bindings.data();
+	vkCreateDescriptorSetLayout(_device, &setLayoutCI, nullptr, &_setLayout);
+
+	VkPipelineLayoutCreateInfo layoutCI{};
+	layoutCI.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+	layoutCI.setLayoutCount = 1;
+	layoutCI.pSetLayouts = &_setLayout;
+	if (vkCreatePipelineLayout(_device, &layoutCI, nullptr, &_pipelineLayout) != VK_SUCCESS)
+	{
+		_pipelineLayout = VK_NULL_HANDLE;
+		Terminate();
+		return false;
+	}
+	return true;
+}
+
+// j (GPŮ҂ĂĂԁApCvCPipelineManagerj)
+void DeferredRenderer::Terminate()
+{
+	if (_descriptorPool != VK_NULL_HANDLE)
+	{
+		vkDestroyDescriptorPool(_device, _descriptorPool, nullptr);
+		_descriptorPool = VK_NULL_HANDLE;
+	}
+	_descriptorSet = VK_NULL_HANDLE;
+	std::fill(std::begin(_boundViews), std::end(_boundViews), VkImageView(VK_NULL_HANDLE));
+
+	if (_pipelineLayout != VK_NULL_HANDLE)
+	{
+		vkDestroyPipelineLayout(_device, _pipelineLayout, nullptr);
+		_pipelineLayout = VK_NULL_HANDLE;
+	}
+	if (_setLayout != VK_NULL_HANDLE)
+	{
+		vkDestroyDescriptorSetLayout(_device, _setLayout, nullptr);
+		_setLayout = VK_NULL_HANDLE;
+	}
+	if (_allocator != nullptr)
+	{
+		_allocator->DestroyBuffer(_lightBuffer, _lightAllocation);
+	}
+
+	_renderPass = VK_NULL_HANDLE;
+	_pipelineKey = 0;
+	_lights.clear();
+	_graph = nullptr;
+}
+
+void DeferredRenderer::SetShaders(VkShaderModule lightVertexShader, VkShaderModule lightFragmentShader)
+{
+	_vertexShader = lightVertexShader;
+	_fragmentShader = lightFragmentShader;
+	if (_renderPass != VK_NULL_HANDLE)
+	{
+		_pipelineKey = RequestPipeline(_pipelineKey);
+	}
+}
+
+// [xʒu𕜌邽߁Ats߂Ă
+void DeferredRenderer::SetCamera(const float* viewProjection, const float* position)
+{
+	std::memcpy(_frame.viewProjection, viewProjection, sizeof(_frame.viewProjection));
+	Invert(viewProjection, _frame.inverseViewProjection);
+	_frame.cameraPosition[0] = position[0];
+	_frame.cameraPosition[1] = position[1];
+	_frame.cameraPosition[2] = position[2];
+	_frame.cameraPosition[3] = 1.0f;
+}
+
+void DeferredRenderer::SetAmbient(float r, float g, float b)
+{
+	_frame.ambient[0] = r;
+	_frame.ambient[1] = g;
+	_frame.ambient[2] = b;
+	_frame.ambient[3] = 0.0f;
+}
+
+bool DeferredRenderer::SetLights(const std::vector<Light>& lights)
+{
+	if (lights.size() > _maxLights)
+	{
+		return false;
+	}
+	_lights = lights;
+	return true;
+}
+
+// pX̐錾
+// Cg̓] (Rs[gpX) ̌AG-bufferƃCeBO͓TCỸA^b`gĝ1̃_[pXɂȂ
+RenderGraph::Pass& DeferredRenderer::AddPasses(RenderGraph& graph, RenderGraph::Resource target, RenderGraph::Resource depth,
+	const VkClearColorValue* background)
+{
+	_graph = &graph;
+
+	RenderGraph::ImageDesc desc;
+	desc.format = AlbedoFormat;
+	_albedoResource = graph.CreateImage("GBufferAlbedo", desc);
+	desc.format = NormalFormat;
+	_normalResource = graph.CreateImage("GBufferNormal", desc);
+	if (depth == RenderGraph::InvalidResource)
+	{
+		desc.format = VK_FORMAT_D32_SFLOAT;
+		depth = graph.CreateImage("GBufferDepth", desc);
+	}
+	_depthResource = depth;
+
+	_lightResource = graph.ImportBuffer("DeferredLights");
+	graph.SetImportedBuffer(_lightResource, _lightBuffer);
+
+	graph.AddComputePass("DeferredLightUpload")
+		.WriteBuffer(_lightResource, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT)
+		.SetExecute([this](const RenderGraph::PassContext& context) { RecordUpload(context); });
+
+	// wi̓Axh̃NAF (̃CX^X̂܂܏o)
+	const VkClearColorValue clearAlbedo = background != nullptr ? *background : VkClearColorValue{ { 0.0f, 0.0f, 0.0f, 1.0f } };
+	const VkClearColorValue clearNormal = { { 0.5f, 0.5f, 0.5f, 0.0f } };
+	const VkClearColorValue clearTarget = { { 0.0f, 0.0f, 0.0f, 1.0f } };
+	const VkClearDepthStencilValue clearDepth = { 1.0f, 0 };
+
+	auto& gbufferPass = graph.AddGraphicsPass("GBuffer")
+		.WriteColor(_albedoResource, &clearAlbedo)
+		.WriteColor(_normalResource, &clearNormal)
+		.WriteDepth(depth, &clearDepth);
+
+	// G-bufferinput attachmentƂēʒũsNZǂ (TupẌˑ֌WBY_REGIONɂȂ)
+	graph.AddGraphicsPass("DeferredLighting")
+		.WriteColor(target, &clearTarget)
+		.ReadInputAttachment(_albedoResource)
+		.ReadInputAttachment(_normalResource)
+		.ReadInputAttachment(depth)
+		.ReadBuffer(_lightResource, VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT)
+		.SetExecute([this](const RenderGraph::PassContext& context) { RecordLighting(context); });
+	return gbufferPass;
+}
+
+// t[̏ƃCg̓]
+// G-buffer͕`ƓTCYȂ̂ŁAʒu̕ɎgTCY͕`̂̂ɂ
+void DeferredRenderer::RecordUpload(const RenderGraph::PassContext& context)
+{
+	_frame.inverseExtent[0] = 1.0f / float((std::max)(context.extent.width, 1u));
+	_frame.inverseExtent[1] = 1.0f / float((std::max)(context.extent.height, 1u));
+	_frame.lightCount = uint32_t(_lights.size());
+	vkCmdUpdateBuffer(context.command, _lightBuffer, 0, sizeof(FrameData), &_frame);
+	if (!_lights.empty())
+	{
+		vkCmdUpdateBuffer(context.command, _lightBuffer, sizeof(FrameData), sizeof(Light) * _lights.size(), _lights.data());
+	}
+}
+
+// CeBŐL^ (1ƃCg̐̎lp`1ŕ`)
+void DeferredRenderer::RecordLighting(const RenderGraph::PassContext& context)
+{
+	// _[pX蒼ꂽꍇ̓pCvCv
+	if (context.renderPass != _renderPass || context.subpass != _subpass)
+	{
+		_renderPass = context.renderPass;
+		_subpass = context.subpass;
+		_pipelineKey = RequestPipeline(0);
+	}
+
+	const auto pipeline = _pipelineManager->Get(_pipelineKey);
+	if (pipeline == VK_NULL_HANDLE || !PrepareDescriptors())
+	{
+		return;
+	}
+
+	VkViewport viewport{ 0.0f, 0.0f, float(context.extent.width), float(context.extent.height), 0.0f, 1.0f };
+	VkRect2D scissor{ { 0, 0 }, context.extent };
+	vkCmdSetViewport(context.command, 0, 1, &viewport);
+	vkCmdSetScissor(context.command, 0, 1, &scissor);
+	vkCmdBindPipeline(context.command, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+	vkCmdBindDescriptorSets(context.command, VK_PIPELINE_BIND_POINT_GRAPHICS, _pipelineLayout, 0, 1, &_descriptorSet, 0, nullptr);
+	vkCmdDraw(context.command, 4, uint32_t(_lights.size()) + 1, 0, 0);
+}
+
+// fXNv^Zbg̍XV (G-buffer̃C[W蒼ꂽꍇ蒼)
+bool DeferredRenderer::PrepareDescriptors()
+{
+	const VkImageView views[3] = {
+		_graph->GetImageView(_albedoResource),
+		_graph->GetImageView(_normalResource),
+		_graph->GetImageView(_depthResource),
+	};
+	if (std::equal(std::begin(views), std::end(views), std::begin(_boundViews)))
+	{
+		return _descriptorSet != VK_NULL_HANDLE;
+	}
+
+	ReleaseDescriptors();
+	if (std::find(std::begin(views), std::end(views), VkImageView(VK_NULL_HANDLE)) != std::end(views))
+	{
+		return false;
+	}
+
+	std::array<VkDescriptorPoolSize, 2> poolSizes = { {
+		{ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1 },
+		{ VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, 3 },
+	} };
+	VkDescriptorPoolCreateInfo poolCI{};
+	poolCI.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+	poolCI.maxSets = 1;
+	poolCI.poolSizeCount = uint32_t(poolSizes.size());
+	poolCI.pPoolSizes = poolSizes.data();
+	if (vkCreateDescriptorPool(_device, &poolCI, nullptr, &_descriptorPool) != VK_SUCCESS)
+	{
+		_descriptorPool = VK_NULL_HANDLE;
+		return false;
+	}
+
+	VkDescriptorSetAllocateInfo setAI{};
+	setAI.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	setAI.descriptorPool = _descriptorPool;
+	setAI.descriptorSetCount = 1;
+	setAI.pSetLayouts = &_setLayout;
+	if (vkAllocateDescriptorSets(_device, &setAI, &_descriptorSet) != VK_SUCCESS)
+	{
+		ReleaseDescriptors();
+		return false;
+	}
+
+	// CAEg̓CeBÕTupXł̂ ([x͓ǂݍݐp)
+	const VkDescriptorBufferInfo bufferInfo{ _lightBuffer, 0, VK_WHOLE_SIZE };
+	const std::array<VkDescriptorImageInfo, 3> imageInfos = { {
+		{ VK_NULL_HANDLE, views[0], VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL },
+		{ VK_NULL_HANDLE, views[1], VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL },
+		{ VK_NULL_HANDLE, views[2], VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL },
+	} };
+	std::array<VkWriteDescriptorSet, 4> writes{};
+	for (uint32_t i = 0; i < uint32_t(writes.size()); ++i)
+	{
+		writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		writes[i].dstSet = _descriptorSet;
+		writes[i].dstBinding = i;
+		writes[i].descriptorCount = 1;
+		if (i == 0)
+		{
+			writes[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+			writes[i].pBufferInfo = &bufferInfo;
+		}
+		else
+		{
+			writes[i].descriptorType = VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+			writes[i].pImageInfo = &imageInfos[i - 1];
+		}
+	}
+	vkUpdateDescriptorSets(_device, uint32_t(writes.size()), writes.data(), 0, nullptr);
+
+	std::copy(std::begin(views), std::end(views), std::begin(_boundViews));
+	return true;
+}
+
+// ÂfXNv^ZbǵAgĂ鑗Mς݂̃t[Ăj
+void DeferredRenderer::ReleaseDescriptors()
+{
+	if (_descriptorPool != VK_NULL_HANDLE)
+	{
+		auto device = _device;
+		auto pool = _descriptorPool;
+		auto release = [device, pool]() { vkDestroyDescriptorPool(device, pool, nullptr); };
+		if (_deletionQueue != nullptr)
+		{
+			_deletionQueue->Retire(GpuTimeline::Graphics, release);
+		}
+		else
+		{
+			release();
+		}
+		_descriptorPool = VK_NULL_HANDLE;
+	}
+	_descriptorSet = VK_NULL_HANDLE;
+	std::fill(std::begin(_boundViews), std::end(_boundViews), VkImageView(VK_NULL_HANDLE));
+}
+
+// CeBÕpCvC̗v (Zŕ`A[x͎gȂ)
+PipelineManager::Key DeferredRenderer::RequestPipeline(PipelineManager::Key fallback)
+{
+	VkPipelineColorBlendAttachmentState blend{};
+	blend.blendEnable = VK_TRUE;
+	blend.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
+	blend.dstColorBlendFactor = VK_BLEND_FACTOR_ONE;
+	blend.colorBlendOp = VK_BLEND_OP_ADD;
+	blend.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+	blend.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+	blend.alphaBlendOp = VK_BLEND_OP_ADD;
+	blend.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+
+	// _gl_VertexIndexƃCĝŒ_obt@͂Ȃ
+	GraphicsPipelineState state;
+	state.AddShader(VK_SHADER_STAGE_VERTEX_BIT, _vertexShader);
+	state.AddShader(VK_SHADER_STAGE_FRAGMENT_BIT, _fragmentShader);
+	state.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP;
+	state.depthTest = VK_FALSE;
+	state.depthWrite = VK_FALSE;
+	state.blendAttachments.push_back(blend);
+	state.layout = _pipelineLayout;
+	state.renderPass = _renderPass;
+	state.subpass = _subpass;
+	return _pipelineManager->Request(state, fallback);
+}
+
+// 4x4s̋ts (DA]qWJ)
+bool DeferredRenderer::Invert(const float* m, float* out)
+{
+	float inv[16];
+	inv[0] = m[5] * m[10] * m[15] - m[5] * m[11] * m[14] - m[9] * m[6] * m[15] + m[9] * m[7] * m[14] + m[13] * m[6] * m[11] - m[13] * m[7] * m[10];
+	inv[4] = -m[4] * m[10] * m[15] + m[4] * m[11] * m[14] + m[8] * m[6] * m[15] - m[8] * m[7] * m[14] - m[12] * m[6] * m[11] + m[12] * m[7] * m[10];
+	inv[8] = m[4] * m[9] * m[15] - m[4] * m[11] * m[13] - m[8] * m[5] * m[15] + m[8] * m[7] * m[13] + m[12] * m[5] * m[11] - m[12] * m[7] * m[9];
+	inv[12] = -m[4] * m[9] * m[14] + m[4] * m[10] * m[13] + m[8] * m[5] * m[14] - m[8] * m[6] * m[13] - m[12] * m[5] * m[10] + m[12] * m[6] * m[9];
+	inv[1] = -m[1] * m[10] * m[15] + m[1] * m[11] * m[14] + m[9] * m[2] * m[15] - m[9] * m[3] * m[14] - m[13] * m[2] * m[11] + m[13] * m[3] * m[10];
+	inv[5] = m[0] * m[10] * m[15] - m[0] * m[11] * m[14] - m[8] * m[2] * m[15] + m[8] * m[3] * m[14] + m[12] * m[2] * m[11] - m[12] * m[3] * m[10];
+	inv[9] = -m[0] * m[9] * m[15] + m[0] * m[11] * m[13] + m[8] * m[1] * m[15] - m[8] * m[3] * m[13] - m[12] * m[1] * m[11] + m[12] * m[3] * m[9];
+	inv[13] = m[0] * m[9] * m[14] - m[0] * m[10] * m[13] - m[8] * m[1] * m[14] + m[8] * m[2] * m[13] + m[12] * m[1] * m[10] - m[12] * m[2] * m[9];
+	inv[2] = m[1] * m[6] * m[15] - m[1] * m[7] * m[14] - m[5] * m[2] * m[15] + m[5] * m[3] * m[14] + m[13] * m[2] * m[7] - m[13] * m[3] * m[6];
+	inv[6] = -m[0] * m[6] * m[15] + m[0] * m[7] * m[14] + m[4] * m[2] * m[15] - m[4] * m[3] * m[14] - m[12] * m[2] * m[7] + m[12] * m[3] * m[6];
+	inv[10] = m[0] * m[5] * m[15] - m[0] * m[7] * m[13] - m[4] * m[1] * m[15] + m[4] * m[3] * m[13] + m[12] * m[1] * m[7] - m[12] * m[3] * m[5];
+	inv[14] = -m[0] * m[5] * m[14] + m[0] * m[6] * m[13] + m[4] * m[1] * m[14] - m[4] * m[2] * m[13] - m[12] * m[1] * m[6] + m[12] * m[2] * m[5];
+	inv[3] = -m[1] * m[6] * m[11] + m[1] * m[7] * m[10] + m[5] * m[2] * m[11] - m[5] * m[3] * m[10] - m[9] * m[2] * m[7] + m[9] * m[3] * m[6];
+	inv[7] = m[0] * m[6] * m[11] - m[0] * m[7] * m[10] - m[4] * m[2] * m[11] + m[4] * m[3] * m[10] + m[8] * m[2] * m[7] - m[8] * m[3] * m[6];
+	inv[11] = -m[0] * m[5] * m[11] + m[0] * m[7] * m[9] + m[4] * m[1] * m[11] - m[4] * m[3] * m[9] - m[8] * m[1] * m[7] + m[8] * m[3] * m[5];
+	inv[15] = m[0] * m[5] * m[10] - m[0] * m[6] * m[9] - m[4] * m[1] * m[10] + m[4] * m[2] * m[9] + m[8] * m[1] * m[6] - m[8] * m[2] * m[5];
+
+	const auto determinant = m[0] * inv[0] + m[1] * inv[4] + m[2] * inv[8] + m[3] * inv[12];
+	if (std::fabs(determinant) <= 0.0f)
+	{
+		std::fill(out, out + 16, 0.0f);
+		return false;
+	}
+
+	const auto scale = 1.0f / determinant;
+	for (uint32_t i = 0; i < 16; ++i)
+	{
+		out[i] = inv[i] * scale;
+	}
+	return true;
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <vector>
+
+#include "RenderGraph.h"
+#include "PipelineManager.h"
+#include "DeletionQueue.h"
+
+// G-buffer֕`TupXƁAG-bufferinput attachmentœǂŃCgZTupX1̃_[pXɂ܂Ƃ߂
+// G-buffer͂̃_[pX̒ŎĝŁARenderGraphTRANSIENT (LAZILY_ALLOCATED̃) ɂAoȂ
+// (^Cx[XGPUłG-buffer^CoAȊOłǂݍ݁EȏшgȂ)
+// Cg͉e͈͂͂ގlp`CX^Xŕ` (Shaders/DeferredLight.vert, DeferredLight.frag)
+// CX^X0͉ʑŜŊA`ĂȂG-buffer̃NAF̂܂܏o
+class DeferredRenderer
+{
+public:
+	// VF[_[LightƓ (std430)
+	struct Light
+	{
+		float position[3];
+		float radius;		// e͈ (̋0ɂȂ)
+		float color[3];
+		float intensity;
+	};
+
+	// G-buffer̃J[A^b`g (G-buffer֕`pCvC̏o͂͂̏)
+	// location 0: rgb: Axh, a: ʔ˂̋
+	// location 1: rgb: [hԂ̖@ * 0.5 + 0.5
+	static const VkFormat AlbedoFormat = VK_FORMAT_R8G8B8A8_UNORM;
+	static const VkFormat NormalFormat = VK_FORMAT_A2B10G10R10_UNORM_PACK32;
+	static const uint32_t GBufferColorCount = 2;
+
+	DeferredRenderer();
+
+	// VF[_[Shaders/DeferredLight.vert, DeferredLight.fragRpC
+	// CeBÕpCvCpipelineManagerŐAÂfXNv^ZbgdeletionQueueŔj
+	// maxLightsvkCmdUpdateBuffer1xɓ]ł鐔܂
+	bool Initialize(VkDevice device, MemoryAllocator* allocator, PipelineManager* pipelineManager, DeletionQueue* deletionQueue,
+		VkShaderModule lightVertexShader, VkShaderModule lightFragmentShader, uint32_t maxLights);
+	void Terminate();
+
+	// VF[_[ăRpCꂽꍇ (I܂ł͌ÂpCvCŕ`)
+	void SetShaders(VkShaderModule lightVertexShader, VkShaderModule lightFragmentShader);
+
+	// J (viewProjection͗DAglm::mat4ƓсA[x0`1) Ɗ̐ݒ (t[)
+	void SetCamera(const float* viewProjection, const float* position);
+	void SetAmbient(float r, float g, float b);
+
+	// Cg̐ݒ (t[ƁAmaxLights𒴂ꍇfalse)
+	bool SetLights(const std::vector<Light>& lights);
+
+	// Cg̓]AG-bufferACeBÕpXǉAG-buffer̃pXԂ (V[͂̃pXŕ`)
+	// depthInvalidResourcȅꍇ͐[xOtɍ (̃pXœǂ܂ȂTRANSIENTɂȂ)
+	// background͉`ĂȂ̐F
+	RenderGraph::Pass& AddPasses(RenderGraph& graph, RenderGraph::Resource target, RenderGraph::Resource depth = RenderGraph::InvalidResource,
+		const VkClearColorValue* background = nullptr);
+
+	RenderGraph::Resource GetDepth() const { return _depthResource; }
+	uint32_t GetLightCount() const { return uint32_t(_lights.size()); }
+	uint32_t GetMaxLights() const { return _maxLights; }
+
+private:
+	// VF[_[̃Xg[Wobt@̐擪Ɠ (std430ǍLight)
+	struct FrameData
+	{
+		float viewProjection[16];
+		float inverseViewProjection[16];
+		float cameraPosition[4];
+		float ambient[4];
+		float inverseExtent[2];
+		uint32_t lightCount;
+		uint32_t reserved;
+	};
+
+	void RecordUpload(const RenderGraph::PassContext& context);
+	void RecordLighting(const RenderGraph::PassContext& context);
+	bool PrepareDescriptors();
+	void ReleaseDescriptors();
+	PipelineManager::Key RequestPipeline(PipelineManager::Key fallback);
+	static bool Invert(const float* m, float* out);
+
+	VkDevice _device;
+	MemoryAllocator* _allocator;
+	PipelineManager* _pipelineManager;
+	DeletionQueue* _deletionQueue;
+	uint32_t _maxLights;
+
+	VkShaderModule _vertexShader;
+	VkShaderModule _fragmentShader;
+
+	VkBuffer _lightBuffer;
+	MemoryAllocation _lightAllocation;
+
+	VkDescriptorSetLayout _setLayout;
+	VkPipelineLayout _pipelineLayout;
+
+	// G-buffer̃C[W蒼邽тɍ蒼
+	VkDescriptorPool _descriptorPool;
+	VkDescriptorSet _descriptorSet;
+	VkImageView _boundViews[3];
+
+	// CeBÕTupX̃_[pXĂv
+	VkRenderPass _renderPass;
+	uint32_t _subpass;
+	PipelineManager::Key _pipelineKey;
+
+	FrameData _frame;
+	std::vector<Light> _lights;
+
+	// Ot̃\[X
+	RenderGraph* _graph;
+	RenderGraph::Resource _albedoResource;
+	RenderGraph::Resource _normalResource;
+	RenderGraph::Resource _depthResource;
+	RenderGraph::Resource _lightResource;
+};
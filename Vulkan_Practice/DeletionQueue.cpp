@@ -0,0 +1,119 @@
+#include "DeletionQueue.h"
+
+#include <algorithm>
+
+
+DeletionQueue::DeletionQueue() : _timeline(nullptr)
+{
+}
+
+void DeletionQueue::Initialize(GpuTimeline* timeline)
+{
+	_timeline = timeline;
+}
+
+// SĂ̔j (o^Ƃ͌ȂAL[Ƃɂ͒l̏)
+// ֐̒œo^ꂽ̂Ă (2̃L[҂)
+void DeletionQueue::Terminate()
+{
+	for (;;)
+	{
+		std::vector<Deleter> deleters;
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			for (auto& entries : _entries)
+			{
+				for (auto& v : entries)
+				{
+					deleters.push_back(std::move(v.deleter));
+				}
+				entries.clear();
+			}
+		}
+		if (deleters.empty())
+		{
+			return;
+		}
+		for (auto& v : deleters)
+		{
+			v();
+		}
+	}
+}
+
+// l̏ɕׂēo^ (l̂̂͌)
+void DeletionQueue::Retire(GpuTimeline::Queue queue, uint64_t value, const Deleter& deleter)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	auto& entries = _entries[queue];
+	auto it = std::upper_bound(entries.begin(), entries.end(), value, [](uint64_t value, const Entry& v) { return value < v.value; });
+	entries.insert(it, Entry{ value, deleter });
+}
+
+void DeletionQueue::Retire(GpuTimeline::Queue queue, const Deleter& deleter)
+{
+	Retire(queue, _timeline->GetPending(queue), deleter);
+}
+
+// queue̊҂ĂAotherQueue܂ĂȂ΂ɓo^
+void DeletionQueue::Retire(GpuTimeline::Queue queue, uint64_t value, GpuTimeline::Queue otherQueue, uint64_t otherValue, const Deleter& deleter)
+{
+	if (otherValue == 0 || _timeline->IsCompleted(otherQueue, otherValue))
+	{
+		Retire(queue, value, deleter);
+		return;
+	}
+	Retire(queue, value, [this, otherQueue, otherValue, deleter]()
+	{
+		if (_timeline->IsCompleted(otherQueue, otherValue))
+		{
+			deleter();
+		}
+		else
+		{
+			Retire(otherQueue, otherValue, deleter);
+		}
+	});
+}
+
+// ̂̔j
+// ֐̒o^ł悤AbNOĂĂ
+uint32_t DeletionQueue::Update()
+{
+	std::vector<Deleter> ready;
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		for (uint32_t i = 0; i < GpuTimeline::QueueCount; ++i)
+		{
+			auto& entries = _entries[i];
+			if (entries.empty())
+			{
+				continue;
+			}
+
+			const auto completed = _timeline->GetCompleted(GpuTimeline::Queue(i));
+			while (!entries.empty() && entries.front().value <= completed)
+			{
+				ready.push_back(std::move(entries.front().deleter));
+				entries.pop_front();
+			}
+		}
+	}
+
+	for (auto& v : ready)
+	{
+		v();
+	}
+	return uint32_t(ready.size());
+}
+
+uint32_t DeletionQueue::GetPendingCount() const
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	size_t count = 0;
+	for (const auto& v : _entries)
+	{
+		count += v.size();
+	}
+	return uint32_t(count);
+}
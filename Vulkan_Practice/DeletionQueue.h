@@ -0,0 +1,51 @@
+#pragma once
+
+#include <deque>
+#include <functional>
+#include <mutex>
+
+#include "GpuTimeline.h"
+
+// GPUgIĂj郊\[X̃L[
+// j֐Ã\[XŌɎgM̃^CC̒lƈꏏɓo^A
+// UpdateŃL[̒l܂Ői񂾂̂Ă (foCXŜ̊҂ɔjł)
+// ֐̒ŔjɎg񂵗p̃Xg֖߂Ă悢 (o^͂ǂ̃Xbhł)
+class DeletionQueue
+{
+public:
+	using Deleter = std::function<void()>;
+
+	DeletionQueue();
+
+	void Initialize(GpuTimeline* timeline);
+
+	// cĂSĂ̊֐Ă (GPŮ҂ĂĂ)
+	void Terminate();
+
+	// queuevalueɒBĂ (l͓̂̂o^ɌĂ)
+	// L^ł܂MĂȂR}hgꍇGetPending(queue) + 1n
+	void Retire(GpuTimeline::Queue queue, uint64_t value, const Deleter& deleter);
+
+	// Mς݂̃R}hgIĂ (GetPending(queue)̊)
+	void Retire(GpuTimeline::Queue queue, const Deleter& deleter);
+
+	// 2̃L[̑MgꍇAqueuevalueɁAotherQueueotherValueɒBĂ (otherValue0̏ꍇqueue)
+	void Retire(GpuTimeline::Queue queue, uint64_t value, GpuTimeline::Queue otherQueue, uint64_t otherValue, const Deleter& deleter);
+
+	// ̂ĂсAĂ񂾐Ԃ (t[̊JnɌĂ)
+	uint32_t Update();
+
+	uint32_t GetPendingCount() const;
+
+private:
+	struct Entry
+	{
+		uint64_t value;
+		Deleter deleter;
+	};
+
+	GpuTimeline* _timeline;
+
+	mutable std::mutex _mutex;
+	std::deque<Entry> _entries[GpuTimeline::QueueCount];	// L[Ƃɒl̏
+};
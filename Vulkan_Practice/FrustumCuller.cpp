@@ -0,0 +1,307 @@
+#include "FrustumCuller.h"
+
+#include <algorithm>
+#include <cstring>
+
+// SSE/AVX2x86̂ (CPUł̓XJ[Ŕ肷)
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define FRUSTUMCULLER_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// GCC/Clangł͊֐Ƃɖ߃Zbgw肷 (t@CŜ-mavx2ŃrhȂĂ悢)
+#if defined(__GNUC__)
+#define FRUSTUMCULLER_TARGET(name) __attribute__((target(name)))
+#else
+#define FRUSTUMCULLER_TARGET(name)
+#endif
+
+
+// ʂ̎ dot(normal, center) + distance >= -radius 𖞂̂ (GpuCulling.compƓ)
+static uint32_t CullScalar(const Scene& scene, const std::array<GpuCulling::Plane, 6>& planes, uint32_t begin, uint32_t end, uint32_t* output)
+{
+	const auto x = scene.GetCenterX();
+	const auto y = scene.GetCenterY();
+	const auto z = scene.GetCenterZ();
+	const auto r = scene.GetRadius();
+
+	uint32_t count = 0;
+	for (auto i = begin; i < end; ++i)
+	{
+		bool visible = true;
+		for (const auto& p : planes)
+		{
+			visible = visible && p.normal[0] * x[i] + p.normal[1] * y[i] + p.normal[2] * z[i] + p.distance >= -r[i];
+		}
+
+		// 򂹂ɏ݁Aꍇi߂
+		output[begin + count] = i;
+		count += visible ? 1 : 0;
+	}
+	return count;
+}
+
+#ifdef FRUSTUMCULLER_X86
+// 4̔
+FRUSTUMCULLER_TARGET("sse2")
+static uint32_t CullSse(const Scene& scene, const std::array<GpuCulling::Plane, 6>& planes, uint32_t begin, uint32_t end, uint32_t* output)
+{
+	const auto x = scene.GetCenterX();
+	const auto y = scene.GetCenterY();
+	const auto z = scene.GetCenterZ();
+	const auto r = scene.GetRadius();
+
+	__m128 nx[6], ny[6], nz[6], d[6];
+	for (size_t p = 0; p < planes.size(); ++p)
+	{
+		nx[p] = _mm_set1_ps(planes[p].normal[0]);
+		ny[p] = _mm_set1_ps(planes[p].normal[1]);
+		nz[p] = _mm_set1_ps(planes[p].normal[2]);
+		d[p] = _mm_set1_ps(planes[p].distance);
+	}
+	const auto zero = _mm_setzero_ps();
+
+	uint32_t count = 0;
+	for (auto i = begin; i < end; i += 4)
+	{
+		const auto cx = _mm_load_ps(x + i);
+		const auto cy = _mm_load_ps(y + i);
+		const auto cz = _mm_load_ps(z + i);
+		const auto negativeRadius = _mm_sub_ps(zero, _mm_load_ps(r + i));
+
+		auto visible = _mm_cmpeq_ps(zero, zero);
+		for (size_t p = 0; p < planes.size(); ++p)
+		{
+			const auto distance = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(nx[p], cx), _mm_mul_ps(ny[p], cy)), _mm_mul_ps(nz[p], cz)), d[p]);
+			visible = _mm_and_ps(visible, _mm_cmpge_ps(distance, negativeRadius));
+		}
+
+		const auto mask = uint32_t(_mm_movemask_ps(visible));
+		for (uint32_t lane = 0; lane < 4; ++lane)
+		{
+			output[begin + count] = i + lane;
+			count += (mask >> lane) & 1;
+		}
+	}
+	return count;
+}
+
+// 8rbg̃}XNA郌[̔ԍl߂ (3rbg) Ɛ (8rbg) \
+static std::array<uint32_t, 256> CreatePackTable()
+{
+	std::array<uint32_t, 256> table{};
+	for (uint32_t mask = 0; mask < 256; ++mask)
+	{
+		uint32_t lanes = 0;
+		uint32_t count = 0;
+		for (uint32_t lane = 0; lane < 8; ++lane)
+		{
+			if ((mask >> lane) & 1)
+			{
+				lanes |= lane << (count * 3);
+				++count;
+			}
+		}
+		table[mask] = lanes | (count << 24);
+	}
+	return table;
+}
+static const std::array<uint32_t, 256> PackTable = CreatePackTable();
+
+// 8̔ (̂̔ԍ͕\gċl߁A8܂Ƃ߂ď)
+FRUSTUMCULLER_TARGET("avx2")
+static uint32_t CullAvx2(const Scene& scene, const std::array<GpuCulling::Plane, 6>& planes, uint32_t begin, uint32_t end, uint32_t* output)
+{
+	const auto x = scene.GetCenterX();
+	const auto y = scene.GetCenterY();
+	const auto z = scene.GetCenterZ();
+	const auto r = scene.GetRadius();
+
+	__m256 nx[6], ny[6], nz[6], d[6];
+	for (size_t p = 0; p < planes.size(); ++p)
+	{
+		nx[p] = _mm256_set1_ps(planes[p].normal[0]);
+		ny[p] = _mm256_set1_ps(planes[p].normal[1]);
+		nz[p] = _mm256_set1_ps(planes[p].normal[2]);
+		d[p] = _mm256_set1_ps(planes[p].distance);
+	}
+	const auto zero = _mm256_setzero_ps();
+	const auto shifts = _mm256_setr_epi32(0, 3, 6, 9, 12, 15, 18, 21);
+	const auto laneMask = _mm256_set1_epi32(7);
+
+	uint32_t count = 0;
+	for (auto i = begin; i < end; i += 8)
+	{
+		const auto cx = _mm256_load_ps(x + i);
+		const auto cy = _mm256_load_ps(y + i);
+		const auto cz = _mm256_load_ps(z + i);
+		const auto negativeRadius = _mm256_sub_ps(zero, _mm256_load_ps(r + i));
+
+		auto visible = _mm256_cmp_ps(zero, zero, _CMP_EQ_OQ);
+		for (size_t p = 0; p < planes.size(); ++p)
+		{
+			const auto distance = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(nx[p], cx), _mm256_mul_ps(ny[p], cy)), _mm256_mul_ps(nz[p], cz)), d[p]);
+			visible = _mm256_and_ps(visible, _mm256_cmp_ps(distance, negativeRadius, _CMP_GE_OQ));
+		}
+
+		// ݐiȉȂ̂ŁA8Ă͈̔͂𒴂Ȃ
+		const auto packed = PackTable[_mm256_movemask_ps(visible)];
+		const auto lanes = _mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32(int(packed)), shifts), laneMask);
+		const auto indices = _mm256_add_epi32(lanes, _mm256_set1_epi32(int(i)));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(output + begin + count), indices);
+		count += packed >> 24;
+	}
+	return count;
+}
+
+// CPUOSAVX2 (YMMWX^̕ۑ) ɑΉĂ邩
+static bool HasAvx2()
+{
+#ifdef _MSC_VER
+	int info[4];
+	__cpuid(info, 0);
+	if (info[0] < 7)
+	{
+		return false;
+	}
+	__cpuid(info, 1);
+	const bool osxsave = (info[2] & (1 << 27)) != 0;
+	const bool avx = (info[2] & (1 << 28)) != 0;
+	if (!osxsave || !avx || (_xgetbv(0) & 6) != 6)
+	{
+		return false;
+	}
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#else
+	return __builtin_cpu_supports("avx2") != 0;
+#endif
+}
+#endif
+
+
+FrustumCuller::FrustumCuller() : _kernel(Kernel::Scalar), _jobSystem(nullptr)
+{
+}
+
+void FrustumCuller::Initialize(JobSystem* jobSystem)
+{
+	_kernel = GetBestKernel();
+	_jobSystem = jobSystem;
+}
+
+FrustumCuller::Kernel FrustumCuller::GetBestKernel()
+{
+	if (IsKernelSupported(Kernel::AVX2))
+	{
+		return Kernel::AVX2;
+	}
+	return IsKernelSupported(Kernel::SSE) ? Kernel::SSE : Kernel::Scalar;
+}
+
+bool FrustumCuller::IsKernelSupported(Kernel kernel)
+{
+	switch (kernel)
+	{
+#ifdef FRUSTUMCULLER_X86
+	case Kernel::SSE:
+		return true;
+	case Kernel::AVX2:
+	{
+		static const bool supported = HasAvx2();
+		return supported;
+	}
+#endif
+	case Kernel::Scalar:
+		return true;
+	default:
+		return false;
+	}
+}
+
+const char* FrustumCuller::GetKernelName(Kernel kernel)
+{
+	switch (kernel)
+	{
+	case Kernel::SSE:
+		return "sse";
+	case Kernel::AVX2:
+		return "avx2";
+	default:
+		return "scalar";
+	}
+}
+
+void FrustumCuller::SetKernel(Kernel kernel)
+{
+	if (IsKernelSupported(kernel))
+	{
+		_kernel = kernel;
+	}
+}
+
+uint32_t FrustumCuller::CullRange(Kernel kernel, const Scene& scene, const std::array<GpuCulling::Plane, 6>& planes,
+	uint32_t begin, uint32_t end, uint32_t* output)
+{
+	switch (kernel)
+	{
+#ifdef FRUSTUMCULLER_X86
+	case Kernel::SSE:
+		return CullSse(scene, planes, begin, end, output);
+	case Kernel::AVX2:
+		return CullAvx2(scene, planes, begin, end, output);
+#endif
+	default:
+		return CullScalar(scene, planes, begin, end, output);
+	}
+}
+
+// `NƂɕɔ肵AŌɃ`Ňʂl߂
+uint32_t FrustumCuller::Cull(const Scene& scene, const std::array<GpuCulling::Plane, 6>& planes, std::vector<uint32_t>& visible)
+{
+	const auto paddedCount = scene.GetPaddedCount();
+	visible.resize(paddedCount);
+	if (paddedCount == 0)
+	{
+		return 0;
+	}
+
+	const auto chunkCount = (paddedCount + ChunkSize - 1) / ChunkSize;
+	_chunkVisibleCounts.resize(chunkCount);
+
+	const auto kernel = _kernel;
+	const auto output = visible.data();
+	auto counts = _chunkVisibleCounts.data();
+	const JobSystem::RangeJob cullChunks = [&](uint32_t beginChunk, uint32_t endChunk)
+	{
+		for (auto chunk = beginChunk; chunk < endChunk; ++chunk)
+		{
+			const auto begin = chunk * ChunkSize;
+			const auto end = (std::min)(begin + ChunkSize, paddedCount);
+			counts[chunk] = CullRange(kernel, scene, planes, begin, end, output);
+		}
+	};
+
+	// `N1̏ꍇ̓Wuɂx
+	if (_jobSystem != nullptr && chunkCount > 1)
+	{
+		JobCounter counter;
+		_jobSystem->ParallelFor(chunkCount, 1, cullChunks, counter);
+		_jobSystem->Wait(counter);
+	}
+	else
+	{
+		cullChunks(0, chunkCount);
+	}
+
+	uint32_t count = counts[0];
+	for (uint32_t i = 1; i < chunkCount; ++i)
+	{
+		std::memmove(output + count, output + size_t(i) * ChunkSize, sizeof(uint32_t) * counts[i]);
+		count += counts[i];
+	}
+	return count;
+}
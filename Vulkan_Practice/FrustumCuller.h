@@ -0,0 +1,55 @@
+#pragma once
+
+#include <vector>
+#include <array>
+
+#include "Scene.h"
+#include "GpuCulling.h"
+#include "JobSystem.h"
+
+// Scene̋ECPUŎJOAIuWFNg̔ԍo
+// GpuCulling.compƓ (ʂGpuCulling::ExtractFrustumŎo)
+// SSE4AAVX28肵AIuWFNgChunkSizeƂɕJobSystemŕɏ
+// AVX2͎sCPUΉĂꍇg
+class FrustumCuller
+{
+public:
+	enum class Kernel
+	{
+		Scalar,
+		SSE,
+		AVX2,
+	};
+
+	// XbhɊ蓖ĂP (Scene::LaneCount̔{)
+	static const uint32_t ChunkSize = 4096;
+
+	FrustumCuller();
+
+	// jobSystemnullptȑꍇ͌ĂяõXbhŏ
+	void Initialize(JobSystem* jobSystem);
+
+	// CPUŎgł (InitializeőI΂)
+	static Kernel GetBestKernel();
+	static bool IsKernelSupported(Kernel kernel);
+	static const char* GetKernelName(Kernel kernel);
+
+	// vr̂߂ɐ؂ւ (ΉĂȂꍇ͕ύXȂ)
+	void SetKernel(Kernel kernel);
+	Kernel GetKernel() const { return _kernel; }
+
+	uint32_t GetThreadCount() const { return _jobSystem != nullptr ? _jobSystem->GetThreadCount() : 1; }
+
+	// IuWFNg̔ԍvisibleɏ݁A̐Ԃ (visibleGetPaddedCount()Ɋg)
+	// Scene::UpdateBoundšɌĂ (JobSystem̃Wu̒Ăł悢)
+	uint32_t Cull(const Scene& scene, const std::array<GpuCulling::Plane, 6>& planes, std::vector<uint32_t>& visible);
+
+	// 1̃Xbhł̔ (beginendScene::LaneCount̔{Aoutputbeginȍ~ɏ)
+	static uint32_t CullRange(Kernel kernel, const Scene& scene, const std::array<GpuCulling::Plane, 6>& planes,
+		uint32_t begin, uint32_t end, uint32_t* output);
+
+private:
+	Kernel _kernel;
+	JobSystem* _jobSystem;
+	std::vector<uint32_t> _chunkVisibleCounts;
+};
@@ -0,0 +1,542 @@
+#include "GpuCulling.h"
+#include "ShaderCache.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+// VF[_[local_size_x (ꉻ萔0Őݒ肷)
+static const uint32_t CullGroupSize = 64;
+
+
+GpuCulling::GpuCulling() : _device(VK_NULL_HANDLE), _allocator(nullptr), _maxObjects(0), _objectCount(0), _multiDrawIndirect(false),
+	_drawIndexedIndirectCount(nullptr), _objectBuffer(VK_NULL_HANDLE), _drawBuffer(VK_NULL_HANDLE), _countBuffer(VK_NULL_HANDLE),
+	_occlusionBuffer(VK_NULL_HANDLE), _statisticsFrame(0), _dummyImage(VK_NULL_HANDLE), _dummyView(VK_NULL_HANDLE),
+	_dummySampler(VK_NULL_HANDLE), _dummyUploaded(false), _setLayout(VK_NULL_HANDLE), _descriptorPool(VK_NULL_HANDLE), _descriptorSet(VK_NULL_HANDLE),
+	_occlusionSetLayout(VK_NULL_HANDLE), _dummyOcclusionSet(VK_NULL_HANDLE), _pipelineLayout(VK_NULL_HANDLE), _pipeline(VK_NULL_HANDLE),
+	_planes{}, _hiZ(nullptr), _objectUpload(0), _graph(nullptr), _objectResource(RenderGraph::InvalidResource), _drawResource(RenderGraph::InvalidResource),
+	_countResource(RenderGraph::InvalidResource), _occlusionResource(RenderGraph::InvalidResource)
+{
+}
+
+// obt@AfXNv^ZbgApCvC̐
+bool GpuCulling::Initialize(VkDevice device, MemoryAllocator* allocator, VkShaderModule cullShader, VkPipelineCache pipelineCache,
+	uint32_t maxObjects, bool drawIndirectCount, bool multiDrawIndirect, HiZBuffer* hiZ)
+{
+	_device = device;
+	_allocator = allocator;
+	_maxObjects = maxObjects;
+	_objectCount = 0;
+	_objectUpload = 0;
+	_multiDrawIndirect = multiDrawIndirect;
+	_hiZ = hiZ;
+	_drawIndexedIndirectCount = nullptr;
+	if (drawIndirectCount)
+	{
+		_drawIndexedIndirectCount = reinterpret_cast<PFN_vkCmdDrawIndexedIndirectCountKHR>(vkGetDeviceProcAddr(_device, "vkCmdDrawIndexedIndirectCountKHR"));
+	}
+
+	// IuWFNg (])AԐڕ`̃R}hA`搔 (t[0Ŗ߂)AՕJÕp[^ (t[)
+	VkBufferCreateInfo bufferCI{};
+	bufferCI.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	bufferCI.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+	bufferCI.size = sizeof(Object) * maxObjects;
+	bufferCI.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+	auto created = _allocator->CreateBuffer(bufferCI, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0, _objectBuffer, _objectAllocation);
+
+	bufferCI.size = sizeof(VkDrawIndexedIndirectCommand) * maxObjects;
+	bufferCI.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT;
+	created = created && _allocator->CreateBuffer(bufferCI, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0, _drawBuffer, _drawAllocation);
+
+	bufferCI.size = sizeof(Statistics);
+	bufferCI.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT |
+		VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+	created = created && _allocator->CreateBuffer(bufferCI, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0, _countBuffer, _countAllocation);
+
+	bufferCI.size = sizeof(OcclusionParams);
+	bufferCI.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+	created = created && _allocator->CreateBuffer(bufferCI, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0, _occlusionBuffer, _occlusionAllocation);
+
+	// s~bhȂꍇ̃_~[ (e͓ǂ܂ȂAs~bhƓ`̗LȃC[Wɂ)
+	VkImageCreateInfo imageCI{};
+	imageCI.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+	imageCI.imageType = VK_IMAGE_TYPE_2D;
+	imageCI.format = VK_FORMAT_R32_SFLOAT;
+	imageCI.extent = { 1, 1, 1 };
+	imageCI.mipLevels = 1;
+	imageCI.arrayLayers = 1;
+	imageCI.samples = VK_SAMPLE_COUNT_1_BIT;
+	imageCI.tiling = VK_IMAGE_TILING_OPTIMAL;
+	imageCI.usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+	imageCI.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+	imageCI.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	created = created && _allocator->CreateImage(imageCI, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, _dummyImage, _dummyAllocation);
+	if (!created)
+	{
+		Terminate();
+		return false;
+	}
+
+	VkImageViewCreateInfo viewCI{};
+	viewCI.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+	viewCI.image = _dummyImage;
+	viewCI.viewType = VK_IMAGE_VIEW_TYPE_2D;
+	viewCI.format = imageCI.format;
+	viewCI.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+	VkSamplerCreateInfo samplerCI{};
+	samplerCI.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+	samplerCI.magFilter = VK_FILTER_NEAREST;
+	samplerCI.minFilter = VK_FILTER_NEAREST;
+	samplerCI.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+	samplerCI.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	samplerCI.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	samplerCI.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	if (vkCreateImageView(_device, &viewCI, nullptr, &_dummyView) != VK_SUCCESS)
+	{
+		_dummyView = VK_NULL_HANDLE;
+		Terminate();
+		return false;
+	}
+	if (vkCreateSampler(_device, &samplerCI, nullptr, &_dummySampler) != VK_SUCCESS)
+	{
+		_dummySampler = VK_NULL_HANDLE;
+		Terminate();
+		return false;
+	}
+
+	// binding 0: IuWFNg, 1: Ԑڕ`̃R}h, 2: `搔, 3: ՕJÕp[^
+	std::array<VkDescriptorSetLayoutBinding, 4> bindings{};
+	for (uint32_t i = 0; i < uint32_t(bindings.size()); ++i)
+	{
+		bindings[i].binding = i;
+		bindings[i].descriptorType = i < 3 ? VK_DESCRIPTOR_TYPE_STORAGE_BUFFER : VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+		bindings[i].descriptorCount = 1;
+		bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+	}
+
+	VkDescriptorSetLayoutCreateInfo setLayoutCI{};
+	setLayoutCI.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+	setLayoutCI.bindingCount = uint32_t(bindings.size());
+	setLayoutCI.pBindings = bindings.data();
+	vkCreateDescriptorSetLayout(_device, &setLayoutCI, nullptr, &_setLayout);
+
+	// set 1: Hi-Z̃s~bh (HiZBuffer̃fXNv^ZbgoCh)
+	_occlusionSetLayout = HiZBuffer::CreateReadSetLayout(_device);
+
+	std::array<VkDescriptorPoolSize, 3> poolSizes = { {
+		{ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 3 },
+		{ VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1 },
+		{ VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1 },
+	} };
+	VkDescriptorPoolCreateInfo poolCI{};
+	poolCI.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+	poolCI.maxSets = 2;
+	poolCI.poolSizeCount = uint32_t(poolSizes.size());
+	poolCI.pPoolSizes = poolSizes.data();
+	vkCreateDescriptorPool(_device, &poolCI, nullptr, &_descriptorPool);
+
+	// s~bhgȂꍇset 1̓_~[̃C[Ww
+	// (ՕJO̕ʂȂĂAVF[_[ÓIɎgfXNv^̓fBXpb`̎_ŗLłKv)
+	const std::array<VkDescriptorSetLayout, 2> setLayouts = { { _setLayout, _occlusionSetLayout } };
+	std::array<VkDescriptorSet, 2> sets{};
+	VkDescriptorSetAllocateInfo setAI{};
+	setAI.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	setAI.descriptorPool = _descriptorPool;
+	setAI.descriptorSetCount = uint32_t(setLayouts.size());
+	setAI.pSetLayouts = setLayouts.data();
+	vkAllocateDescriptorSets(_device, &setAI, sets.data());
+	_descriptorSet = sets[0];
+	_dummyOcclusionSet = sets[1];
+
+	std::array<VkDescriptorBufferInfo, 4> bufferInfos = { {
+		{ _objectBuffer, 0, VK_WHOLE_SIZE },
+		{ _drawBuffer, 0, VK_WHOLE_SIZE },
+		{ _countBuffer, 0, VK_WHOLE_SIZE },
+		{ _occlusionBuffer, 0, VK_WHOLE_SIZE },
+	} };
+	std::array<VkWriteDescriptorSet, 4> writes{};
+	for (uint32_t i = 0; i < uint32_t(writes.size()); ++i)
+	{
+		writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		writes[i].dstSet = _descriptorSet;
+		writes[i].dstBinding = i;
+		writes[i].descriptorCount = 1;
+		writes[i].descriptorType = bindings[i].descriptorType;
+		writes[i].pBufferInfo = &bufferInfos[i];
+	}
+	vkUpdateDescriptorSets(_device, uint32_t(writes.size()), writes.data(), 0, nullptr);
+
+	const VkDescriptorImageInfo dummyInfo{ _dummySampler, _dummyView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+	VkWriteDescriptorSet dummyWrite{};
+	dummyWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	dummyWrite.dstSet = _dummyOcclusionSet;
+	dummyWrite.dstBinding = 0;
+	dummyWrite.descriptorCount = 1;
+	dummyWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	dummyWrite.pImageInfo = &dummyInfo;
+	vkUpdateDescriptorSets(_device, 1, &dummyWrite, 0, nullptr);
+
+	// ƃIuWFNg̓vbV萔œn
+	VkPushConstantRange pushConstantRange{};
+	pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+	pushConstantRange.offset = 0;
+	pushConstantRange.size = sizeof(PushConstants);
+
+	VkPipelineLayoutCreateInfo layoutCI{};
+	layoutCI.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+	layoutCI.setLayoutCount = uint32_t(setLayouts.size());
+	layoutCI.pSetLayouts = setLayouts.data();
+	layoutCI.pushConstantRangeCount = 1;
+	layoutCI.pPushConstantRanges = &pushConstantRange;
+	vkCreatePipelineLayout(_device, &layoutCI, nullptr, &_pipelineLayout);
+
+	SpecializationConstants constants;
+	constants.Set(0, CullGroupSize);
+
+	VkComputePipelineCreateInfo pipelineCI{};
+	pipelineCI.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+	pipelineCI.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+	pipelineCI.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+	pipelineCI.stage.module = cullShader;
+	pipelineCI.stage.pName = "main";
+	pipelineCI.stage.pSpecializationInfo = constants.GetInfo();
+	pipelineCI.layout = _pipelineLayout;
+	pipelineCI.basePipelineIndex = -1;
+	if (vkCreateComputePipelines(_device, pipelineCache, 1, &pipelineCI, nullptr, &_pipeline) != VK_SUCCESS)
+	{
+		_pipeline = VK_NULL_HANDLE;
+		Terminate();
+		return false;
+	}
+	return true;
+}
+
+// j (GPŮ҂ĂĂ)
+void GpuCulling::Terminate()
+{
+	if (_pipeline != VK_NULL_HANDLE)
+	{
+		vkDestroyPipeline(_device, _pipeline, nullptr);
+		_pipeline = VK_NULL_HANDLE;
+	}
+	if (_pipelineLayout != VK_NULL_HANDLE)
+	{
+		vkDestroyPipelineLayout(_device, _pipelineLayout, nullptr);
+		_pipelineLayout = VK_NULL_HANDLE;
+	}
+	if (_descriptorPool != VK_NULL_HANDLE)
+	{
+		vkDestroyDescriptorPool(_device, _descriptorPool, nullptr);
+		_descriptorPool = VK_NULL_HANDLE;
+		_descriptorSet = VK_NULL_HANDLE;
+		_dummyOcclusionSet = VK_NULL_HANDLE;
+	}
+	if (_occlusionSetLayout != VK_NULL_HANDLE)
+	{
+		vkDestroyDescriptorSetLayout(_device, _occlusionSetLayout, nullptr);
+		_occlusionSetLayout = VK_NULL_HANDLE;
+	}
+	if (_setLayout != VK_NULL_HANDLE)
+	{
+		vkDestroyDescriptorSetLayout(_device, _setLayout, nullptr);
+		_setLayout = VK_NULL_HANDLE;
+	}
+	if (_dummySampler != VK_NULL_HANDLE)
+	{
+		vkDestroySampler(_device, _dummySampler, nullptr);
+		_dummySampler = VK_NULL_HANDLE;
+	}
+	if (_dummyView != VK_NULL_HANDLE)
+	{
+		vkDestroyImageView(_device, _dummyView, nullptr);
+		_dummyView = VK_NULL_HANDLE;
+	}
+	if (_allocator != nullptr)
+	{
+		_allocator->DestroyImage(_dummyImage, _dummyAllocation);
+		_allocator->DestroyBuffer(_objectBuffer, _objectAllocation);
+		_allocator->DestroyBuffer(_drawBuffer, _drawAllocation);
+		_allocator->DestroyBuffer(_countBuffer, _countAllocation);
+		_allocator->DestroyBuffer(_occlusionBuffer, _occlusionAllocation);
+		for (auto& v : _statistics)
+		{
+			_allocator->DestroyBuffer(v.buffer, v.allocation);
+		}
+	}
+	_statistics.clear();
+	_statisticsFrame = 0;
+	_objectCount = 0;
+	_objectUpload = 0;
+	_dummyUploaded = false;
+	_graph = nullptr;
+}
+
+// IuWFNg̓] (Oobt@Ɏ܂悤ɕ)
+bool GpuCulling::SetObjects(UploadManager& uploadManager, const std::vector<Object>& objects)
+{
+	if (_objectBuffer == VK_NULL_HANDLE || objects.size() > _maxObjects)
+	{
+		return false;
+	}
+
+	// _~[̃C[W͍ŏ̓o^œ] (Ō̓]̃`Pbg͂O̓]܂ނ̂ŁAJÕpX͂҂)
+	if (!_dummyUploaded)
+	{
+		const float farthest = 1.0f;
+		if (uploadManager.UploadImage(_dummyImage, VK_FORMAT_R32_SFLOAT, VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, { 1, 1, 1 }, &farthest, sizeof(farthest),
+			VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) == 0)
+		{
+			return false;
+		}
+		_dummyUploaded = true;
+	}
+
+	const auto chunkObjects = std::max<VkDeviceSize>(uploadManager.GetStagingSize() / 2 / sizeof(Object), 1);
+	for (VkDeviceSize first = 0; first < objects.size(); first += chunkObjects)
+	{
+		const auto count = std::min<VkDeviceSize>(chunkObjects, objects.size() - first);
+		_objectUpload = uploadManager.UploadBuffer(_objectBuffer, first * sizeof(Object), &objects[size_t(first)], count * sizeof(Object));
+		if (_objectUpload == 0)
+		{
+			return false;
+		}
+	}
+	_objectCount = uint32_t(objects.size());
+	if (_graph != nullptr)
+	{
+		_graph->SetImportedBuffer(_objectResource, _objectBuffer, _objectUpload);
+	}
+	return true;
+}
+
+// ṽRs[ (zXgǂނȂ̂ŃLbV郁D悷)
+bool GpuCulling::EnableStatistics(uint32_t frameCount)
+{
+	if (_countBuffer == VK_NULL_HANDLE || !_statistics.empty())
+	{
+		return false;
+	}
+
+	VkBufferCreateInfo bufferCI{};
+	bufferCI.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	bufferCI.size = sizeof(Statistics);
+	bufferCI.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+	bufferCI.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+	_statistics.resize(frameCount);
+	for (auto& v : _statistics)
+	{
+		if (!_allocator->CreateBuffer(bufferCI, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+			VK_MEMORY_PROPERTY_HOST_CACHED_BIT, v.buffer, v.allocation))
+		{
+			for (auto& created : _statistics)
+			{
+				_allocator->DestroyBuffer(created.buffer, created.allocation);
+			}
+			_statistics.clear();
+			return false;
+		}
+	}
+	return true;
+}
+
+bool GpuCulling::GetStatistics(uint32_t frameIndex, Statistics& statistics) const
+{
+	if (frameIndex >= _statistics.size() || !_statistics[frameIndex].written)
+	{
+		return false;
+	}
+	std::memcpy(&statistics, _statistics[frameIndex].allocation.mapped, sizeof(statistics));
+	return true;
+}
+
+// Hi-Z̃s~bhviewProjection
+void GpuCulling::SetViewProjection(const float* viewProjection)
+{
+	_planes = ExtractFrustum(viewProjection);
+	if (_hiZ != nullptr)
+	{
+		_hiZ->SetViewProjection(viewProjection);
+	}
+}
+
+// s̍s (DŊi[Ă)
+static void GetRow(const float* m, uint32_t row, float out[4])
+{
+	for (uint32_t i = 0; i < 4; ++i)
+	{
+		out[i] = m[i * 4 + row];
+	}
+}
+
+// ̕ʂ̒o (Gribb-HartmannANbvԂz0`w)
+std::array<GpuCulling::Plane, 6> GpuCulling::ExtractFrustum(const float* viewProjection)
+{
+	float r0[4], r1[4], r2[4], r3[4];
+	GetRow(viewProjection, 0, r0);
+	GetRow(viewProjection, 1, r1);
+	GetRow(viewProjection, 2, r2);
+	GetRow(viewProjection, 3, r3);
+
+	float coefficients[6][4];
+	for (uint32_t i = 0; i < 4; ++i)
+	{
+		coefficients[0][i] = r3[i] + r0[i];	// 
+		coefficients[1][i] = r3[i] - r0[i];	// E
+		coefficients[2][i] = r3[i] + r1[i];	// 
+		coefficients[3][i] = r3[i] - r1[i];	// 
+		coefficients[4][i] = r2[i];			// 
+		coefficients[5][i] = r3[i] - r2[i];	// 
+	}
+
+	// EƔrł悤@𐳋K
+	std::array<Plane, 6> planes{};
+	for (uint32_t p = 0; p < 6; ++p)
+	{
+		const auto* c = coefficients[p];
+		const auto length = std::sqrt(c[0] * c[0] + c[1] * c[1] + c[2] * c[2]);
+		const auto scale = length > 0.0f ? 1.0f / length : 0.0f;
+		planes[p].normal[0] = c[0] * scale;
+		planes[p].normal[1] = c[1] * scale;
+		planes[p].normal[2] = c[2] * scale;
+		planes[p].distance = c[3] * scale;
+	}
+	return planes;
+}
+
+// JÕpX (`搔0ɂĂSIuWFNg𔻒肷)
+RenderGraph::Pass& GpuCulling::AddCullPass(RenderGraph& graph, const char* name)
+{
+	_objectResource = graph.ImportBuffer("CullObjects");
+	_drawResource = graph.ImportBuffer("DrawCommands");
+	_countResource = graph.ImportBuffer("DrawCount");
+	_occlusionResource = graph.ImportBuffer("CullOcclusion");
+	_graph = &graph;
+	graph.SetImportedBuffer(_objectResource, _objectBuffer, _objectUpload);
+	graph.SetImportedBuffer(_drawResource, _drawBuffer);
+	graph.SetImportedBuffer(_countResource, _countBuffer);
+	graph.SetImportedBuffer(_occlusionResource, _occlusionBuffer);
+
+	auto& pass = graph.AddComputePass(name);
+	pass.ReadBuffer(_objectResource, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT)
+		.WriteBuffer(_drawResource, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT)
+		.WriteBuffer(_countResource, VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+			VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT)
+		.WriteBuffer(_occlusionResource, VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+			VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_UNIFORM_READ_BIT)
+		.SetExecute([this](const RenderGraph::PassContext& context) { RecordCull(context.command); });
+	if (_hiZ != nullptr)
+	{
+		_hiZ->ReadPyramid(graph, pass, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+	}
+	return pass;
+}
+
+// `悷pX̐錾
+void GpuCulling::ReadDraws(RenderGraph::Pass& pass) const
+{
+	pass.ReadBuffer(_drawResource, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, VK_ACCESS_INDIRECT_COMMAND_READ_BIT)
+		.ReadBuffer(_countResource, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, VK_ACCESS_INDIRECT_COMMAND_READ_BIT);
+}
+
+// JŐL^
+void GpuCulling::RecordCull(VkCommandBuffer command)
+{
+	if (_pipeline == VK_NULL_HANDLE || _objectCount == 0)
+	{
+		return;
+	}
+
+	// Õt[ōs~bhꍇՕJO
+	OcclusionParams occlusion{};
+	auto occlusionSet = _dummyOcclusionSet;
+	if (_hiZ != nullptr && _hiZ->Prepare() && _hiZ->IsValid())
+	{
+		const auto extent = _hiZ->GetExtent();
+		std::copy(_hiZ->GetBuiltViewProjection(), _hiZ->GetBuiltViewProjection() + 16, occlusion.viewProjection);
+		occlusion.pyramidSize[0] = float(extent.width);
+		occlusion.pyramidSize[1] = float(extent.height);
+		occlusion.mipCount = _hiZ->GetMipCount();
+		occlusion.enabled = 1;
+		occlusionSet = _hiZ->GetReadSet();
+	}
+	vkCmdUpdateBuffer(command, _occlusionBuffer, 0, sizeof(occlusion), &occlusion);
+
+	// l߂ďޏꍇ͕`搔Avꍇ̓JOꂽAg~bNɐ
+	vkCmdFillBuffer(command, _countBuffer, 0, sizeof(Statistics), 0);
+
+	VkMemoryBarrier barrier{};
+	barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_UNIFORM_READ_BIT;
+	vkCmdPipelineBarrier(command, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0,
+		1, &barrier, 0, nullptr, 0, nullptr);
+
+	PushConstants constants{};
+	constants.planes = _planes;
+	constants.objectCount = _objectCount;
+	constants.compact = HasDrawIndirectCount() ? 1 : 0;
+	constants.statistics = _statistics.empty() ? 0 : 1;
+
+	vkCmdBindPipeline(command, VK_PIPELINE_BIND_POINT_COMPUTE, _pipeline);
+	const VkDescriptorSet sets[] = { _descriptorSet, occlusionSet };
+	vkCmdBindDescriptorSets(command, VK_PIPELINE_BIND_POINT_COMPUTE, _pipelineLayout, 0, 2, sets, 0, nullptr);
+	vkCmdPushConstants(command, _pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(constants), &constants);
+	vkCmdDispatch(command, (_objectCount + CullGroupSize - 1) / CullGroupSize, 1, 1);
+	RecordStatisticsCopy(command);
+}
+
+// `搔Ɠṽt[̃obt@փRs[ (t[̊ɃzXgǂ)
+void GpuCulling::RecordStatisticsCopy(VkCommandBuffer command)
+{
+	if (_statisticsFrame >= _statistics.size())
+	{
+		return;
+	}
+	auto& readback = _statistics[_statisticsFrame];
+
+	VkMemoryBarrier barrier{};
+	barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+	barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+	vkCmdPipelineBarrier(command, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+		1, &barrier, 0, nullptr, 0, nullptr);
+
+	VkBufferCopy region{};
+	region.size = sizeof(Statistics);
+	vkCmdCopyBuffer(command, _countBuffer, readback.buffer, 1, &region);
+
+	barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+	vkCmdPipelineBarrier(command, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0,
+		1, &barrier, 0, nullptr, 0, nullptr);
+	readback.written = true;
+}
+
+// Ԑڕ`̋L^
+void GpuCulling::RecordDraws(VkCommandBuffer command) const
+{
+	if (_objectCount == 0)
+	{
+		return;
+	}
+
+	const uint32_t stride = sizeof(VkDrawIndexedIndirectCommand);
+	if (HasDrawIndirectCount())
+	{
+		_drawIndexedIndirectCount(command, _drawBuffer, 0, _countBuffer, 0, _objectCount, stride);
+	}
+	else if (_multiDrawIndirect)
+	{
+		vkCmdDrawIndexedIndirect(command, _drawBuffer, 0, _objectCount, stride);
+	}
+	else
+	{
+		// drawCount1܂ (IuWFNgɔႵCPUׂ̕)
+		for (uint32_t i = 0; i < _objectCount; ++i)
+		{
+			vkCmdDrawIndexedIndirect(command, _drawBuffer, VkDeviceSize(i) * stride, 1, stride);
+		}
+	}
+}
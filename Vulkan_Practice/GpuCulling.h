@@ -0,0 +1,167 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <vector>
+#include <array>
+
+#include "MemoryAllocator.h"
+#include "UploadManager.h"
+#include "RenderGraph.h"
+#include "HiZBuffer.h"
+
+// IuWFNg̋Eƕ`p[^Xg[Wobt@ɒuARs[gVF[_[ŎJO
+// VkDrawIndexedIndirectCommandƕ`搔o (Shaders/GpuCulling.comp)
+// `摤vkCmdDrawIndexedIndirectCount1L^邾Ȃ̂ŁACPUׂ̓̕IuWFNgɈˑȂ
+// VK_KHR_draw_indirect_countȂꍇ́AJOIuWFNginstanceCount0ɂvkCmdDrawIndexedIndirectŕ`悷
+// firstInstanceɂ̓IuWFNg̔ԍ (_VF[_[łgl_InstanceIndexŎQƂAdrawIndirectFirstInstanceKv)
+// HiZBuffernꍇ́A̓̃IuWFNgÕt[̐[x̃s~bhŎՕJO
+// (Õt[ŉBĂč̃t[Ō悤ɂȂ̂́A1t[xĕ`悳)
+class GpuCulling
+{
+public:
+	// VF[_[ObjectDataƓ (std430)
+	struct Object
+	{
+		float center[3];
+		float radius;
+		uint32_t indexCount;
+		uint32_t firstIndex;
+		int32_t vertexOffset;
+		uint32_t reserved;
+	};
+
+	//  (dot(normal, p) + distance >= 0 )
+	struct Plane
+	{
+		float normal[3];
+		float distance;
+	};
+
+	// VF[_[Countobt@Ɠ
+	struct Statistics
+	{
+		uint32_t drawCount;			// l߂ď񂾕`搔 (VK_KHR_draw_indirect_countȂꍇ0)
+		uint32_t frustumVisible;	// ̓ɂIuWFNg̐
+		uint32_t occluded;			// ̂Hi-Z̃s~bhŉBĂ̂̐
+	};
+
+	GpuCulling();
+
+	// cullShaderShaders/GpuCulling.compRpC
+	// drawIndirectCountVK_KHR_draw_indirect_countLɂĂꍇtrue
+	// multiDrawIndirectfalsȅꍇ́AԐڕ`IuWFNg̐L^
+	// hiZnullptȑꍇ͎JOs
+	bool Initialize(VkDevice device, MemoryAllocator* allocator, VkShaderModule cullShader, VkPipelineCache pipelineCache,
+		uint32_t maxObjects, bool drawIndirectCount, bool multiDrawIndirect, HiZBuffer* hiZ = nullptr);
+	void Terminate();
+
+	// IuWFNg̓o^ (UploadManagerœ]Agp̃t[ĂĂ)
+	// JÕpX͓]̊Rs[gVF[_[̃Xe[Wő҂ (Ot̊O\[Xɓ]̃`Pbgݒ肷)
+	bool SetObjects(UploadManager& uploadManager, const std::vector<Object>& objects);
+
+	// ̐ݒ (t[)
+	void SetFrustum(const std::array<Plane, 6>& planes) { _planes = planes; }
+
+	// ̐ݒƁÃt[ōHi-Z̃s~bhւviewProjection̐ݒ (t[)
+	void SetViewProjection(const float* viewProjection);
+
+	// viewProjection (DAglm::mat4ƓсA[x0`1) 王̕ʂo
+	static std::array<Plane, 6> ExtractFrustum(const float* viewProjection);
+
+	// Otւ̃obt@̓o^ƃJÕpX̒ǉ
+	// ՕJOsꍇ́AHiZBuffer::AddBuildPassOɒǉ (Õt[̃s~bhǂ)
+	RenderGraph::Pass& AddCullPass(RenderGraph& graph, const char* name = "GpuCulling");
+
+	// `悷pXɊԐڕ`̃obt@ǂނƂ錾
+	void ReadDraws(RenderGraph::Pass& pass) const;
+
+	// Ԑڕ`̋L^ (pCvCA_ECfbNXobt@̓oChς݂ł邱)
+	void RecordDraws(VkCommandBuffer command) const;
+
+	// JOꂽ𐔂At[ (frameCount) ̃zXgǂ߂obt@փRs[
+	bool EnableStatistics(uint32_t frameCount);
+
+	// ̃t[̓vRs[obt@̑I (JÕpX̋L^OɌĂ)
+	void SetStatisticsFrame(uint32_t frameIndex) { _statisticsFrame = frameIndex; }
+
+	// frameIndex̃obt@ɃRs[v (̃t[̊҂ĂĂԁA܂Ȃꍇfalse)
+	bool GetStatistics(uint32_t frameIndex, Statistics& statistics) const;
+
+	bool HasDrawIndirectCount() const { return _drawIndexedIndirectCount != nullptr; }
+	uint32_t GetObjectCount() const { return _objectCount; }
+
+private:
+	// VF[_[̃vbV萔Ɠ
+	struct PushConstants
+	{
+		std::array<Plane, 6> planes;
+		uint32_t objectCount;
+		uint32_t compact;		// 1̏ꍇ͌̂l߂ď
+		uint32_t statistics;	// 1̏ꍇ̓JOꂽ𐔂
+	};
+
+	// ṽRs[
+	struct StatisticsReadback
+	{
+		VkBuffer buffer = VK_NULL_HANDLE;
+		MemoryAllocation allocation;
+		bool written = false;
+	};
+
+	// VF[_[̃jtH[obt@Ɠ (std140AvbV萔Ɏ܂Ȃߕ)
+	struct OcclusionParams
+	{
+		float viewProjection[16];	// s~bh̐[x`t[̂
+		float pyramidSize[2];		// ~bv0̃TCY
+		uint32_t mipCount;
+		uint32_t enabled;			// 0̏ꍇ͎ՕJOȂ (s~bh܂ȂꍇȂ)
+	};
+
+	void RecordCull(VkCommandBuffer command);
+	void RecordStatisticsCopy(VkCommandBuffer command);
+
+	VkDevice _device;
+	MemoryAllocator* _allocator;
+	uint32_t _maxObjects;
+	uint32_t _objectCount;
+	bool _multiDrawIndirect;
+	PFN_vkCmdDrawIndexedIndirectCountKHR _drawIndexedIndirectCount;
+
+	VkBuffer _objectBuffer;
+	MemoryAllocation _objectAllocation;
+	VkBuffer _drawBuffer;
+	MemoryAllocation _drawAllocation;
+	VkBuffer _countBuffer;
+	MemoryAllocation _countAllocation;
+	VkBuffer _occlusionBuffer;
+	MemoryAllocation _occlusionAllocation;
+	std::vector<StatisticsReadback> _statistics;
+	uint32_t _statisticsFrame;
+
+	// VF[_[hiZÓIɎĝŁAՕJOȂꍇset 1ɂ͗LȃC[WKv (SetObjectsœ])
+	VkImage _dummyImage;
+	MemoryAllocation _dummyAllocation;
+	VkImageView _dummyView;
+	VkSampler _dummySampler;
+	bool _dummyUploaded;
+
+	VkDescriptorSetLayout _setLayout;
+	VkDescriptorPool _descriptorPool;
+	VkDescriptorSet _descriptorSet;
+	VkDescriptorSetLayout _occlusionSetLayout;
+	VkDescriptorSet _dummyOcclusionSet;	// s~bhgȂꍇset 1փoCh (1x1̃_~[̃C[W)
+	VkPipelineLayout _pipelineLayout;
+	VkPipeline _pipeline;
+
+	std::array<Plane, 6> _planes;
+	HiZBuffer* _hiZ;
+	UploadTicket _objectUpload;
+
+	// Ot̃\[X
+	RenderGraph* _graph;
+	RenderGraph::Resource _objectResource;
+	RenderGraph::Resource _drawResource;
+	RenderGraph::Resource _countResource;
+	RenderGraph::Resource _occlusionResource;
+};
@@ -0,0 +1,336 @@
+#include "GpuTimeline.h"
+
+#include <algorithm>
+
+
+void GpuTimeline::WaitList::Clear()
+{
+	semaphores.clear();
+	stages.clear();
+	values.clear();
+}
+
+void GpuTimeline::WaitList::Add(VkSemaphore semaphore, VkPipelineStageFlags stage, uint64_t value)
+{
+	semaphores.push_back(semaphore);
+	stages.push_back(stage);
+	values.push_back(value);
+}
+
+
+GpuTimeline::GpuTimeline() : _device(VK_NULL_HANDLE), _supported(false), _timelines{},
+	_waitSemaphores(nullptr), _signalSemaphore(nullptr), _getSemaphoreCounterValue(nullptr)
+{
+}
+
+// L[Ƃ̃^CCZ}tH̐
+void GpuTimeline::Initialize(VkDevice device, bool supported)
+{
+	_device = device;
+	_supported = false;
+	for (auto& v : _timelines)
+	{
+		v.semaphore = VK_NULL_HANDLE;
+		v.pending = 0;
+		v.completed = 0;
+	}
+
+	if (supported)
+	{
+		_waitSemaphores = reinterpret_cast<PFN_vkWaitSemaphoresKHR>(vkGetDeviceProcAddr(_device, "vkWaitSemaphoresKHR"));
+		_signalSemaphore = reinterpret_cast<PFN_vkSignalSemaphoreKHR>(vkGetDeviceProcAddr(_device, "vkSignalSemaphoreKHR"));
+		_getSemaphoreCounterValue
+			= reinterpret_cast<PFN_vkGetSemaphoreCounterValueKHR>(vkGetDeviceProcAddr(_device, "vkGetSemaphoreCounterValueKHR"));
+		_supported = _waitSemaphores != nullptr && _signalSemaphore != nullptr && _getSemaphoreCounterValue != nullptr;
+	}
+	if (!_supported)
+	{
+		return;
+	}
+
+	VkSemaphoreTypeCreateInfoKHR typeCI{};
+	typeCI.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO_KHR;
+	typeCI.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE_KHR;
+	typeCI.initialValue = 0;
+
+	VkSemaphoreCreateInfo ci{};
+	ci.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+	ci.pNext = &typeCI;
+	for (auto& v : _timelines)
+	{
+		if (vkCreateSemaphore(_device, &ci, nullptr, &v.semaphore) != VK_SUCCESS)
+		{
+			// 1łȂꍇfenceŊǗ
+			Terminate();
+			_supported = false;
+			return;
+		}
+	}
+}
+
+// j (GPŮ҂ĂĂ)
+void GpuTimeline::Terminate()
+{
+	for (auto& v : _timelines)
+	{
+		if (v.semaphore != VK_NULL_HANDLE)
+		{
+			vkDestroySemaphore(_device, v.semaphore, nullptr);
+			v.semaphore = VK_NULL_HANDLE;
+		}
+		for (auto& fence : v.fences)
+		{
+			_freeFences.push_back(fence.fence);
+		}
+		v.fences.clear();
+	}
+
+	for (auto& v : _freeFences)
+	{
+		vkDestroyFence(_device, v, nullptr);
+	}
+	_freeFences.clear();
+}
+
+// M (l̍̔Ԃ瑗M܂ł܂Ƃ߂ĔrAL[ւ̑Mƒl̏v)
+uint64_t GpuTimeline::Submit(Queue queue, VkQueue target, VkCommandBuffer command, const WaitList* waits, VkSemaphore signalSemaphore)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	auto& timeline = _timelines[queue];
+	const auto value = timeline.pending + 1;
+
+	// oCiZ}tH̒l͖邪A̓Z}tH̐Ƒ
+	VkSemaphore signalSemaphores[2];
+	uint64_t signalValues[2];
+	uint32_t signalCount = 0;
+	if (signalSemaphore != VK_NULL_HANDLE)
+	{
+		signalSemaphores[signalCount] = signalSemaphore;
+		signalValues[signalCount] = 0;
+		++signalCount;
+	}
+	if (_supported)
+	{
+		signalSemaphores[signalCount] = timeline.semaphore;
+		signalValues[signalCount] = value;
+		++signalCount;
+	}
+
+	const auto waitCount = waits != nullptr ? uint32_t(waits->semaphores.size()) : 0;
+
+	VkTimelineSemaphoreSubmitInfoKHR timelineInfo{};
+	timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR;
+	timelineInfo.waitSemaphoreValueCount = waitCount;
+	timelineInfo.pWaitSemaphoreValues = waitCount > 0 ? waits->values.data() : nullptr;
+	timelineInfo.signalSemaphoreValueCount = signalCount;
+	timelineInfo.pSignalSemaphoreValues = signalValues;
+
+	VkSubmitInfo submitInfo{};
+	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	submitInfo.pNext = _supported ? &timelineInfo : nullptr;
+	submitInfo.commandBufferCount = command != VK_NULL_HANDLE ? 1 : 0;
+	submitInfo.pCommandBuffers = &command;
+	submitInfo.waitSemaphoreCount = waitCount;
+	submitInfo.pWaitSemaphores = waitCount > 0 ? waits->semaphores.data() : nullptr;
+	submitInfo.pWaitDstStageMask = waitCount > 0 ? waits->stages.data() : nullptr;
+	submitInfo.signalSemaphoreCount = signalCount;
+	submitInfo.pSignalSemaphores = signalSemaphores;
+
+	// ^CCɑΉĂȂꍇ͒l̑fenceŊmF
+	const auto fence = _supported ? VK_NULL_HANDLE : AcquireFence();
+	if (vkQueueSubmit(target, 1, &submitInfo, fence) != VK_SUCCESS)
+	{
+		if (fence != VK_NULL_HANDLE)
+		{
+			_freeFences.push_back(fence);
+		}
+		return 0;
+	}
+
+	if (fence != VK_NULL_HANDLE)
+	{
+		timeline.fences.push_back(PendingFence{ value, fence });
+	}
+	timeline.pending = value;
+	return value;
+}
+
+// GPUm̑ҋ@̒ǉ
+bool GpuTimeline::AddWait(WaitList& waits, Queue queue, uint64_t value, VkPipelineStageFlags stage) const
+{
+	if (!_supported)
+	{
+		return false;
+	}
+	waits.Add(_timelines[queue].semaphore, stage, value);
+	return true;
+}
+
+uint64_t GpuTimeline::GetPending(Queue queue)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	return _timelines[queue].pending;
+}
+
+// l̊mF
+uint64_t GpuTimeline::GetCompleted(Queue queue)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	auto& timeline = _timelines[queue];
+	if (_supported)
+	{
+		uint64_t value = 0;
+		if (_getSemaphoreCounterValue(_device, timeline.semaphore, &value) == VK_SUCCESS)
+		{
+			timeline.completed = value;
+		}
+	}
+	else
+	{
+		CollectFences(timeline);
+	}
+	return timeline.completed;
+}
+
+// zXgł̑ҋ@
+bool GpuTimeline::Wait(Queue queue, uint64_t value, uint64_t timeout)
+{
+	std::unique_lock<std::mutex> lock(_mutex);
+	auto& timeline = _timelines[queue];
+	if (value <= timeline.completed)
+	{
+		return true;
+	}
+	if (value > timeline.pending)
+	{
+		return false;
+	}
+
+	if (_supported)
+	{
+		// ҂Ԃ͑̃XbhMł悤ɂ
+		const auto semaphore = timeline.semaphore;
+		lock.unlock();
+
+		VkSemaphoreWaitInfoKHR wi{};
+		wi.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO_KHR;
+		wi.semaphoreCount = 1;
+		wi.pSemaphores = &semaphore;
+		wi.pValues = &value;
+		if (_waitSemaphores(_device, &wi, timeout) != VK_SUCCESS)
+		{
+			return false;
+		}
+
+		lock.lock();
+		if (timeline.completed < value)
+		{
+			timeline.completed = value;
+		}
+		return true;
+	}
+
+	// lȏ̍ŏ̑Mfence҂
+	// ҂Ԃ͑̃XbhMEmFł悤rOAfence͑҂I܂Ŏg񂳂Ȃ
+	VkFence fence = VK_NULL_HANDLE;
+	for (const auto& v : timeline.fences)
+	{
+		if (v.value >= value)
+		{
+			fence = v.fence;
+			break;
+		}
+	}
+	if (fence != VK_NULL_HANDLE)
+	{
+		++_fenceWaiters[fence];
+		lock.unlock();
+		const auto result = vkWaitForFences(_device, 1, &fence, VK_TRUE, timeout);
+		lock.lock();
+
+		// Ōɑ҂IXbhAς݂fenceg񂹂悤ɂ
+		CollectFences(timeline);
+		auto found = _fenceWaiters.find(fence);
+		if (--found->second == 0)
+		{
+			_fenceWaiters.erase(found);
+			const auto pending = std::any_of(timeline.fences.begin(), timeline.fences.end(), [fence](const PendingFence& v) { return v.fence == fence; });
+			if (!pending)
+			{
+				_freeFences.push_back(fence);
+			}
+		}
+		if (result != VK_SUCCESS)
+		{
+			return false;
+		}
+	}
+	CollectFences(timeline);
+	return value <= timeline.completed;
+}
+
+// zXg̃VOi
+bool GpuTimeline::Signal(Queue queue, uint64_t value)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	auto& timeline = _timelines[queue];
+	if (!_supported || value <= timeline.pending)
+	{
+		return false;
+	}
+
+	// GPŨVOicĂꍇA傫Ȓlɂƒl߂Ă܂
+	if (timeline.completed < timeline.pending
+		&& (_getSemaphoreCounterValue(_device, timeline.semaphore, &timeline.completed) != VK_SUCCESS || timeline.completed < timeline.pending))
+	{
+		return false;
+	}
+
+	VkSemaphoreSignalInfoKHR si{};
+	si.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SIGNAL_INFO_KHR;
+	si.semaphore = timeline.semaphore;
+	si.value = value;
+	if (_signalSemaphore(_device, &si) != VK_SUCCESS)
+	{
+		return false;
+	}
+	timeline.pending = value;
+	timeline.completed = value;
+	return true;
+}
+
+// fence𑗐Mɉ
+void GpuTimeline::CollectFences(Timeline& timeline)
+{
+	while (!timeline.fences.empty())
+	{
+		const auto& v = timeline.fences.front();
+		if (vkGetFenceStatus(_device, v.fence) != VK_SUCCESS)
+		{
+			break;
+		}
+		timeline.completed = v.value;
+		if (_fenceWaiters.count(v.fence) == 0)
+		{
+			_freeFences.push_back(v.fence);
+		}
+		timeline.fences.pop_front();
+	}
+}
+
+VkFence GpuTimeline::AcquireFence()
+{
+	VkFence fence;
+	if (!_freeFences.empty())
+	{
+		fence = _freeFences.back();
+		_freeFences.pop_back();
+		vkResetFences(_device, 1, &fence);
+		return fence;
+	}
+
+	VkFenceCreateInfo ci{};
+	ci.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+	vkCreateFence(_device, &ci, nullptr, &fence);
+	return fence;
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <vector>
+#include <deque>
+#include <map>
+#include <mutex>
+
+// L[Ƃ1̃^CCZ}tHAM邽тɒl1₷
+// uGPU̒l܂Ői񂾂vŊmFEҋ@邽߁AMfenceȂĂ悢
+// VK_KHR_timeline_semaphoreȂꍇ́AMƂɎg񂵂fencetēlǗ
+// (̏ꍇAGPUm̑ҋ@̓oCiZ}tHAzXg̃VOi͂łȂ)
+class GpuTimeline
+{
+public:
+	enum Queue
+	{
+		Graphics,
+		Compute,
+		Transfer,
+		QueueCount,
+	};
+
+	// Mő҂Z}tH (oCiZ}tHƃ^CC̒l)
+	struct WaitList
+	{
+		std::vector<VkSemaphore> semaphores;
+		std::vector<VkPipelineStageFlags> stages;
+		std::vector<uint64_t> values;	// oCiZ}tH0
+
+		void Clear();
+		void Add(VkSemaphore semaphore, VkPipelineStageFlags stage, uint64_t value = 0);
+		bool Empty() const { return semaphores.empty(); }
+	};
+
+	GpuTimeline();
+
+	// supported̓foCX̐timelineSemaphore̋@\Lɂ
+	void Initialize(VkDevice device, bool supported);
+	void Terminate();
+
+	bool IsSupported() const { return _supported; }
+	VkSemaphore GetSemaphore(Queue queue) const { return _timelines[queue].semaphore; }
+
+	// command𑗐MAqueue̎̒lVOi (MlԂAsꍇ0)
+	// signalSemaphore͓ɃVOioCiZ}tH (presentfencȇGPUm̑ҋ@Ɏg)
+	uint64_t Submit(Queue queue, VkQueue target, VkCommandBuffer command, const WaitList* waits = nullptr,
+		VkSemaphore signalSemaphore = VK_NULL_HANDLE);
+
+	// waitsqueuevalueɒB܂ł̑ҋ@ǉ (^CCɑΉĂȂꍇfalse)
+	bool AddWait(WaitList& waits, Queue queue, uint64_t value, VkPipelineStageFlags stage) const;
+
+	// ŌɑM (VOi) lƁAGPUŊƂmFl
+	uint64_t GetPending(Queue queue);
+	uint64_t GetCompleted(Queue queue);
+	bool IsCompleted(Queue queue, uint64_t value) { return value <= GetCompleted(queue); }
+
+	// zXgł̑ҋ@ (MĂȂl͑҂falseԂ)
+	bool Wait(Queue queue, uint64_t value, uint64_t timeout = UINT64_MAX);
+
+	// zXg̃VOi (ŌɑMl傫AGPȖMSĊĂꍇVOi)
+	// l҂ĂGPȖMzXgWaitACPȔ̊Ői߂ꍇɎg
+	bool Signal(Queue queue, uint64_t value);
+
+private:
+	// ^CCɑΉĂȂꍇ̑MƂfence
+	struct PendingFence
+	{
+		uint64_t value;
+		VkFence fence;
+	};
+
+	struct Timeline
+	{
+		VkSemaphore semaphore;
+		uint64_t pending;
+		uint64_t completed;
+		std::deque<PendingFence> fences;	// M
+	};
+
+	void CollectFences(Timeline& timeline);
+	VkFence AcquireFence();
+
+	// l̍̔ԂƑM𑵂̏邽߂̔r
+	std::mutex _mutex;
+
+	VkDevice _device;
+	bool _supported;
+	Timeline _timelines[QueueCount];
+	std::vector<VkFence> _freeFences;
+	std::map<VkFence, uint32_t> _fenceWaiters;	// WaitrOđ҂ĂfenceƑ҂Ă鐔 (Ăg񂳂Ȃ)
+
+	PFN_vkWaitSemaphoresKHR _waitSemaphores;
+	PFN_vkSignalSemaphoreKHR _signalSemaphore;
+	PFN_vkGetSemaphoreCounterValueKHR _getSemaphoreCounterValue;
+};
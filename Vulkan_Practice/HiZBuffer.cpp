@@ -0,0 +1,382 @@
+#include "HiZBuffer.h"
+#include "ShaderCache.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+// VF[_[local_size_x, local_size_y (ꉻ萔0, 1Őݒ肷)
+static const uint32_t DownsampleGroupSize = 8;
+
+
+HiZBuffer::HiZBuffer() : _device(VK_NULL_HANDLE), _deletionQueue(nullptr), _sampler(VK_NULL_HANDLE), _buildSetLayout(VK_NULL_HANDLE),
+	_readSetLayout(VK_NULL_HANDLE), _pipelineLayout(VK_NULL_HANDLE), _pipeline(VK_NULL_HANDLE), _descriptorPool(VK_NULL_HANDLE),
+	_readSet(VK_NULL_HANDLE), _boundDepthView(VK_NULL_HANDLE), _boundPyramidView(VK_NULL_HANDLE), _valid(false), _viewProjection{},
+	_builtViewProjection{}, _graph(nullptr), _depthResource(RenderGraph::InvalidResource), _pyramidResource(RenderGraph::InvalidResource)
+{
+}
+
+// Tv[AfXNv^Zbg̃CAEgApCvC̐
+bool HiZBuffer::Initialize(VkDevice device, VkShaderModule downsampleShader, VkPipelineCache pipelineCache, DeletionQueue* deletionQueue)
+{
+	_device = device;
+	_deletionQueue = deletionQueue;
+	_valid = false;
+
+	// eNẐ܂ܓǂ (~bv̑IVF[_[ōs)
+	VkSamplerCreateInfo samplerCI{};
+	samplerCI.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+	samplerCI.magFilter = VK_FILTER_NEAREST;
+	samplerCI.minFilter = VK_FILTER_NEAREST;
+	samplerCI.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+	samplerCI.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	samplerCI.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	samplerCI.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	samplerCI.minLod = 0.0f;
+	samplerCI.maxLod = VK_LOD_CLAMP_NONE;
+	if (vkCreateSampler(_device, &samplerCI, nullptr, &_sampler) != VK_SUCCESS)
+	{
+		_sampler = VK_NULL_HANDLE;
+		Terminate();
+		return false;
+	}
+
+	// binding 0: [x, 1: Õ~bv, 2: ރ~bv
+	std::array<VkDescriptorSetLayoutBinding, 3> bindings{};
+	for (uint32_t i = 0; i < uint32_t(bindings.size()); ++i)
+	{
+		bindings[i].binding = i;
+		bindings[i].descriptorType = i == 0 ? VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER : VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+		bindings[i].descriptorCount = 1;
+		bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+	}
+
+	VkDescriptorSetLayoutCreateInfo setLayoutCI{};
+	setLayoutCI.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+	setLayoutCI.bindingCount = uint32_t(bindings.size());
+	setLayoutCI.pBindings = bindings.data();
+	vkCreateDescriptorSetLayout(_device, &setLayoutCI, nullptr, &_buildSetLayout);
+	_readSetLayout = CreateReadSetLayout(_device);
+
+	// TCYƓǂݍ݌̓vbV萔œn
+	VkPushConstantRange pushConstantRange{};
+	pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+	pushConstantRange.offset = 0;
+	pushConstantRange.size = sizeof(PushConstants);
+
+	VkPipelineLayoutCreateInfo layoutCI{};
+	layoutCI.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+	layoutCI.setLayoutCount = 1;
+	layoutCI.pSetLayouts = &_buildSetLayout;
+	layoutCI.pushConstantRangeCount = 1;
+	layoutCI.pPushConstantRanges = &pushConstantRange;
+	vkCreatePipelineLayout(_device, &layoutCI, nullptr, &_pipelineLayout);
+
+	SpecializationConstants constants;
+	constants.Set(0, DownsampleGroupSize).Set(1, DownsampleGroupSize);
+
+	VkComputePipelineCreateInfo pipelineCI{};
+	pipelineCI.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+	pipelineCI.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+	pipelineCI.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+	pipelineCI.stage.module = downsampleShader;
+	pipelineCI.stage.pName = "main";
+	pipelineCI.stage.pSpecializationInfo = constants.GetInfo();
+	pipelineCI.layout = _pipelineLayout;
+	pipelineCI.basePipelineIndex = -1;
+	if (_readSetLayout == VK_NULL_HANDLE || vkCreateComputePipelines(_device, pipelineCache, 1, &pipelineCI, nullptr, &_pipeline) != VK_SUCCESS)
+	{
+		_pipeline = VK_NULL_HANDLE;
+		Terminate();
+		return false;
+	}
+	return true;
+}
+
+// j (GPŮ҂ĂĂ)
+void HiZBuffer::Terminate()
+{
+	if (_descriptorPool != VK_NULL_HANDLE)
+	{
+		vkDestroyDescriptorPool(_device, _descriptorPool, nullptr);
+		_descriptorPool = VK_NULL_HANDLE;
+	}
+	_buildSets.clear();
+	_readSet = VK_NULL_HANDLE;
+	_boundDepthView = VK_NULL_HANDLE;
+	_boundPyramidView = VK_NULL_HANDLE;
+
+	if (_pipeline != VK_NULL_HANDLE)
+	{
+		vkDestroyPipeline(_device, _pipeline, nullptr);
+		_pipeline = VK_NULL_HANDLE;
+	}
+	if (_pipelineLayout != VK_NULL_HANDLE)
+	{
+		vkDestroyPipelineLayout(_device, _pipelineLayout, nullptr);
+		_pipelineLayout = VK_NULL_HANDLE;
+	}
+	if (_readSetLayout != VK_NULL_HANDLE)
+	{
+		vkDestroyDescriptorSetLayout(_device, _readSetLayout, nullptr);
+		_readSetLayout = VK_NULL_HANDLE;
+	}
+	if (_buildSetLayout != VK_NULL_HANDLE)
+	{
+		vkDestroyDescriptorSetLayout(_device, _buildSetLayout, nullptr);
+		_buildSetLayout = VK_NULL_HANDLE;
+	}
+	if (_sampler != VK_NULL_HANDLE)
+	{
+		vkDestroySampler(_device, _sampler, nullptr);
+		_sampler = VK_NULL_HANDLE;
+	}
+
+	_valid = false;
+	_graph = nullptr;
+	_depthResource = RenderGraph::InvalidResource;
+	_pyramidResource = RenderGraph::InvalidResource;
+}
+
+void HiZBuffer::SetViewProjection(const float* viewProjection)
+{
+	std::memcpy(_viewProjection, viewProjection, sizeof(_viewProjection));
+}
+
+void HiZBuffer::ReadPyramid(RenderGraph& graph, RenderGraph::Pass& pass, VkPipelineStageFlags stages)
+{
+	pass.ReadTexture(GetPyramid(graph), stages);
+}
+
+// s~bhpX ([xeNX`Ƃēǂ݁ASẴ~bv)
+RenderGraph::Pass& HiZBuffer::AddBuildPass(RenderGraph& graph, RenderGraph::Resource depth, const char* name)
+{
+	_depthResource = depth;
+
+	auto& pass = graph.AddComputePass(name);
+	pass.ReadTexture(depth, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT)
+		.WriteStorage(GetPyramid(graph), VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT)
+		.SetExecute([this](const RenderGraph::PassContext& context) { RecordBuild(context.command); });
+	return pass;
+}
+
+// s~bh̃C[W̐錾 (ŏɎgpXō)
+// ~bv0͐[x̔̃TCYŁA1x1܂őSẴ~bv
+RenderGraph::Resource HiZBuffer::GetPyramid(RenderGraph& graph)
+{
+	if (_graph != &graph || _pyramidResource == RenderGraph::InvalidResource)
+	{
+		RenderGraph::ImageDesc desc;
+		desc.format = VK_FORMAT_R32_SFLOAT;
+		desc.scale = 0.5f;
+		desc.mipLevels = 0;
+		_graph = &graph;
+		_pyramidResource = graph.CreateImage("HiZPyramid", desc);
+	}
+	return _pyramidResource;
+}
+
+// fXNv^Zbg̍XV (Ot̃C[W蒼ꂽꍇ蒼)
+bool HiZBuffer::Prepare()
+{
+	if (_graph == nullptr || _pyramidResource == RenderGraph::InvalidResource || _depthResource == RenderGraph::InvalidResource)
+	{
+		return false;
+	}
+
+	const auto depthView = _graph->GetImageView(_depthResource);
+	const auto pyramidView = _graph->GetImageView(_pyramidResource);
+	if (depthView == _boundDepthView && pyramidView == _boundPyramidView)
+	{
+		return _readSet != VK_NULL_HANDLE;
+	}
+
+	// VC[W̓e͂܂ĂȂ
+	ReleaseDescriptors();
+	_valid = false;
+	if (depthView == VK_NULL_HANDLE || pyramidView == VK_NULL_HANDLE)
+	{
+		return false;
+	}
+
+	// ~bvƂ̐pƁAǂݍݗp1
+	const auto mipCount = _graph->GetImageMipCount(_pyramidResource);
+	std::array<VkDescriptorPoolSize, 2> poolSizes = { {
+		{ VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, mipCount + 1 },
+		{ VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, mipCount * 2 },
+	} };
+	VkDescriptorPoolCreateInfo poolCI{};
+	poolCI.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+	poolCI.maxSets = mipCount + 1;
+	poolCI.poolSizeCount = uint32_t(poolSizes.size());
+	poolCI.pPoolSizes = poolSizes.data();
+	if (vkCreateDescriptorPool(_device, &poolCI, nullptr, &_descriptorPool) != VK_SUCCESS)
+	{
+		_descriptorPool = VK_NULL_HANDLE;
+		return false;
+	}
+
+	std::vector<VkDescriptorSetLayout> layouts(mipCount, _buildSetLayout);
+	layouts.push_back(_readSetLayout);
+	std::vector<VkDescriptorSet> sets(layouts.size());
+	VkDescriptorSetAllocateInfo setAI{};
+	setAI.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	setAI.descriptorPool = _descriptorPool;
+	setAI.descriptorSetCount = uint32_t(layouts.size());
+	setAI.pSetLayouts = layouts.data();
+	if (vkAllocateDescriptorSets(_device, &setAI, sets.data()) != VK_SUCCESS)
+	{
+		ReleaseDescriptors();
+		return false;
+	}
+	_readSet = sets.back();
+	sets.pop_back();
+	_buildSets = sets;
+
+	// ~bv0͐[xAȊO1Õ~bv (~bv0łbinding 1gȂ)
+	const VkDescriptorImageInfo depthInfo{ _sampler, depthView, VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL };
+	std::vector<VkDescriptorImageInfo> imageInfos(mipCount * 2);
+	std::vector<VkWriteDescriptorSet> writes;
+	for (uint32_t mip = 0; mip < mipCount; ++mip)
+	{
+		imageInfos[mip * 2 + 0] = { VK_NULL_HANDLE, _graph->GetImageMipView(_pyramidResource, mip > 0 ? mip - 1 : 0), VK_IMAGE_LAYOUT_GENERAL };
+		imageInfos[mip * 2 + 1] = { VK_NULL_HANDLE, _graph->GetImageMipView(_pyramidResource, mip), VK_IMAGE_LAYOUT_GENERAL };
+
+		for (uint32_t binding = 0; binding < 3; ++binding)
+		{
+			VkWriteDescriptorSet write{};
+			write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			write.dstSet = _buildSets[mip];
+			write.dstBinding = binding;
+			write.descriptorCount = 1;
+			write.descriptorType = binding == 0 ? VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER : VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+			write.pImageInfo = binding == 0 ? &depthInfo : &imageInfos[mip * 2 + binding - 1];
+			writes.emplace_back(write);
+		}
+	}
+
+	const VkDescriptorImageInfo pyramidInfo{ _sampler, pyramidView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+	VkWriteDescriptorSet write{};
+	write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	write.dstSet = _readSet;
+	write.dstBinding = 0;
+	write.descriptorCount = 1;
+	write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	write.pImageInfo = &pyramidInfo;
+	writes.emplace_back(write);
+	vkUpdateDescriptorSets(_device, uint32_t(writes.size()), writes.data(), 0, nullptr);
+
+	_boundDepthView = depthView;
+	_boundPyramidView = pyramidView;
+	return true;
+}
+
+// ǂݍݗp̃fXNv^Zbg̃CAEg (JÕpCvC̃CAEgɂg)
+VkDescriptorSetLayout HiZBuffer::CreateReadSetLayout(VkDevice device)
+{
+	VkDescriptorSetLayoutBinding binding{};
+	binding.binding = 0;
+	binding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	binding.descriptorCount = 1;
+	binding.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+
+	VkDescriptorSetLayoutCreateInfo ci{};
+	ci.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+	ci.bindingCount = 1;
+	ci.pBindings = &binding;
+
+	VkDescriptorSetLayout layout;
+	if (vkCreateDescriptorSetLayout(device, &ci, nullptr, &layout) != VK_SUCCESS)
+	{
+		return VK_NULL_HANDLE;
+	}
+	return layout;
+}
+
+VkExtent2D HiZBuffer::GetExtent() const
+{
+	return _graph != nullptr ? _graph->GetImageExtent(_pyramidResource) : VkExtent2D{};
+}
+
+uint32_t HiZBuffer::GetMipCount() const
+{
+	return _graph != nullptr ? _graph->GetImageMipCount(_pyramidResource) : 0;
+}
+
+// s~bh̐̋L^ (~bvƂ1fBXpb`AԂɑÕ~bv݂̏҂)
+void HiZBuffer::RecordBuild(VkCommandBuffer command)
+{
+	if (_pipeline == VK_NULL_HANDLE || !Prepare())
+	{
+		return;
+	}
+
+	const auto image = _graph->GetImage(_pyramidResource);
+	const auto mipCount = _graph->GetImageMipCount(_pyramidResource);
+	auto srcExtent = _graph->GetImageExtent(_depthResource);
+	auto dstExtent = _graph->GetImageExtent(_pyramidResource);
+
+	vkCmdBindPipeline(command, VK_PIPELINE_BIND_POINT_COMPUTE, _pipeline);
+	for (uint32_t mip = 0; mip < mipCount; ++mip)
+	{
+		if (mip > 0)
+		{
+			VkImageMemoryBarrier barrier{};
+			barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+			barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+			barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+			barrier.oldLayout = VK_IMAGE_LAYOUT_GENERAL;
+			barrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+			barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.image = image;
+			barrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, mip - 1, 1, 0, 1 };
+			vkCmdPipelineBarrier(command, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0,
+				0, nullptr, 0, nullptr, 1, &barrier);
+		}
+
+		PushConstants constants{};
+		constants.srcSize[0] = int32_t(srcExtent.width);
+		constants.srcSize[1] = int32_t(srcExtent.height);
+		constants.dstSize[0] = int32_t(dstExtent.width);
+		constants.dstSize[1] = int32_t(dstExtent.height);
+		constants.fromDepth = mip == 0 ? 1 : 0;
+
+		vkCmdBindDescriptorSets(command, VK_PIPELINE_BIND_POINT_COMPUTE, _pipelineLayout, 0, 1, &_buildSets[mip], 0, nullptr);
+		vkCmdPushConstants(command, _pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(constants), &constants);
+		vkCmdDispatch(command, (dstExtent.width + DownsampleGroupSize - 1) / DownsampleGroupSize,
+			(dstExtent.height + DownsampleGroupSize - 1) / DownsampleGroupSize, 1);
+
+		srcExtent = dstExtent;
+		dstExtent.width = (std::max)(1u, dstExtent.width / 2);
+		dstExtent.height = (std::max)(1u, dstExtent.height / 2);
+	}
+
+	// ̃t[̃JÓÃt[viewProjectionœe
+	std::memcpy(_builtViewProjection, _viewProjection, sizeof(_builtViewProjection));
+	_valid = true;
+}
+
+// ÂfXNv^ZbǵAgĂ鑗Mς݂̃t[Ăj
+void HiZBuffer::ReleaseDescriptors()
+{
+	if (_descriptorPool != VK_NULL_HANDLE)
+	{
+		auto device = _device;
+		auto pool = _descriptorPool;
+		auto release = [device, pool]() { vkDestroyDescriptorPool(device, pool, nullptr); };
+		if (_deletionQueue != nullptr)
+		{
+			_deletionQueue->Retire(GpuTimeline::Graphics, release);
+		}
+		else
+		{
+			release();
+		}
+		_descriptorPool = VK_NULL_HANDLE;
+	}
+	_buildSets.clear();
+	_readSet = VK_NULL_HANDLE;
+	_boundDepthView = VK_NULL_HANDLE;
+	_boundPyramidView = VK_NULL_HANDLE;
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <vector>
+
+#include "RenderGraph.h"
+#include "DeletionQueue.h"
+
+// [xobt@KwIZobt@ (Hi-Z)  (Shaders/HiZDownsample.comp)
+// ~bv0͐[x̔̃TCYŁAeeNZ͕͈͂̍ł̐[x ([x0`1AO)
+// JÕ͎t[̍ŏɁA[x`ƂviewProjectionŋE𓊉eăs~bhƔr
+// ([xtH[}bgSTORAGEɑΉȂƂ߁A~bvR32_SFLOAT̕ʂ̃C[WɎ)
+class HiZBuffer
+{
+public:
+	HiZBuffer();
+
+	// downsampleShaderShaders/HiZDownsample.compRpC
+	// ÂfXNv^ZbgdeletionQueueŔj
+	bool Initialize(VkDevice device, VkShaderModule downsampleShader, VkPipelineCache pipelineCache, DeletionQueue* deletionQueue);
+	void Terminate();
+
+	// `悷t[viewProjection (DAglm::mat4Ɠ)
+	void SetViewProjection(const float* viewProjection);
+
+	// s~bhǂރpX̐錾 (t[̍ŏ̕œǂޏꍇAs~bh͑Õt[̓eێ)
+	void ReadPyramid(RenderGraph& graph, RenderGraph::Pass& pass, VkPipelineStageFlags stages);
+
+	// depth`pX̌Ƀs~bhpXǉ
+	// Õt[̃s~bhǂރpX́ÃpXOɐ錾邱
+	RenderGraph::Pass& AddBuildPass(RenderGraph& graph, RenderGraph::Resource depth, const char* name = "HiZBuild");
+
+	// ǂݍݗp̃fXNv^Zbg݂̃C[Wɍ킹 (s~bhǂރpX̋L^̍ŏɌĂ)
+	// C[W蒼ꂽꍇ́Aɍ܂IsValidfalseɂȂ
+	bool Prepare();
+
+	// binding 0: s~bh (combined image samplerASẴ~bv)
+	static VkDescriptorSetLayout CreateReadSetLayout(VkDevice device);
+	VkDescriptorSetLayout GetReadSetLayout() const { return _readSetLayout; }
+	VkDescriptorSet GetReadSet() const { return _readSet; }
+
+	// s~bhÕt[̐[xĂ邩
+	bool IsValid() const { return _valid; }
+	const float* GetBuiltViewProjection() const { return _builtViewProjection; }
+	VkExtent2D GetExtent() const;
+	uint32_t GetMipCount() const;
+
+private:
+	// VF[_[̃vbV萔Ɠ
+	struct PushConstants
+	{
+		int32_t srcSize[2];
+		int32_t dstSize[2];
+		uint32_t fromDepth;		// 1̏ꍇ͐[x (binding 0) ǂ
+	};
+
+	RenderGraph::Resource GetPyramid(RenderGraph& graph);
+	void RecordBuild(VkCommandBuffer command);
+	void ReleaseDescriptors();
+
+	VkDevice _device;
+	DeletionQueue* _deletionQueue;
+
+	VkSampler _sampler;
+	VkDescriptorSetLayout _buildSetLayout;
+	VkDescriptorSetLayout _readSetLayout;
+	VkPipelineLayout _pipelineLayout;
+	VkPipeline _pipeline;
+
+	// C[W蒼邽тɍ蒼
+	VkDescriptorPool _descriptorPool;
+	std::vector<VkDescriptorSet> _buildSets;	// ~bv
+	VkDescriptorSet _readSet;
+	VkImageView _boundDepthView;
+	VkImageView _boundPyramidView;
+
+	bool _valid;
+	float _viewProjection[16];
+	float _builtViewProjection[16];
+
+	// Ot̃\[X
+	RenderGraph* _graph;
+	RenderGraph::Resource _depthResource;
+	RenderGraph::Resource _pyramidResource;
+};
@@ -0,0 +1,89 @@
+#include "JobGraph.h"
+
+#include <chrono>
+
+
+JobGraph::JobGraph() : _jobSystem(nullptr)
+{
+}
+
+void JobGraph::Reset()
+{
+	_tasks.clear();
+	_jobSystem = nullptr;
+}
+
+JobGraph::TaskId JobGraph::AddTask(const char* name, const std::function<void()>& function, std::initializer_list<TaskId> dependencies)
+{
+	const auto id = TaskId(_tasks.size());
+	std::unique_ptr<Task> task(new Task());
+	task->name = name;
+	task->function = function;
+	task->dependencyCount = 0;
+	task->remaining = 0;
+	task->ms = 0.0;
+	_tasks.push_back(std::move(task));
+
+	for (auto v : dependencies)
+	{
+		AddDependency(id, v);
+	}
+	return id;
+}
+
+// ˑ͐ɒǉ̂ (Ȃ͖̂)
+void JobGraph::AddDependency(TaskId task, TaskId dependency)
+{
+	if (dependency >= task || task >= _tasks.size())
+	{
+		return;
+	}
+	_tasks[dependency]->successors.push_back(task);
+	++_tasks[task]->dependencyCount;
+}
+
+void JobGraph::Dispatch(JobSystem& jobSystem)
+{
+	_jobSystem = &jobSystem;
+	for (auto& v : _tasks)
+	{
+		v->remaining = v->dependencyCount;
+	}
+	for (TaskId i = 0; i < _tasks.size(); ++i)
+	{
+		if (_tasks[i]->dependencyCount == 0)
+		{
+			Launch(i);
+		}
+	}
+}
+
+void JobGraph::Wait()
+{
+	if (_jobSystem != nullptr)
+	{
+		_jobSystem->Wait(_counter);
+	}
+}
+
+// ^XN̎s (IAŌ̈ˑ悾^XN𑱂Ĕs)
+// 㑱𔭍sĂJE^[̂ŁArWaitI邱Ƃ͂Ȃ
+void JobGraph::Launch(TaskId id)
+{
+	_jobSystem->Run([this, id]()
+	{
+		auto& task = *_tasks[id];
+		const auto start = std::chrono::steady_clock::now();
+		task.function();
+		std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+		task.ms = elapsed.count();
+
+		for (auto v : task.successors)
+		{
+			if (_tasks[v]->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+			{
+				Launch(v);
+			}
+		}
+	}, &_counter);
+}
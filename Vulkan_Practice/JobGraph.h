@@ -0,0 +1,59 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <functional>
+#include <initializer_list>
+#include <atomic>
+
+#include "JobSystem.h"
+
+// 1t[̊Ԃg^XN̈ˑ֌W
+// ˑ^XNSďÎJobSystemŕɎs
+// ˑ͐ɒǉ^XNɌ̂ŁAz͍Ȃ
+// (Resett[̏IWait܂ł1t[Ŏg)
+class JobGraph
+{
+public:
+	typedef uint32_t TaskId;
+	static const TaskId InvalidTask = ~0u;
+
+	JobGraph();
+
+	// Õt[̃^XN̂Ă (WaiťɌĂ)
+	void Reset();
+
+	// ^XN̒ǉ (dependenciesSďIĂs)
+	TaskId AddTask(const char* name, const std::function<void()>& function, std::initializer_list<TaskId> dependencies = {});
+	void AddDependency(TaskId task, TaskId dependency);
+
+	// ˑ̂Ȃ^XNsn߂ (ĂяoWait܂ő̏𑱂)
+	void Dispatch(JobSystem& jobSystem);
+
+	// SẴ^XNI܂ŁA^XNȂ҂
+	void Wait();
+
+	uint32_t GetTaskCount() const { return uint32_t(_tasks.size()); }
+	const std::string& GetTaskName(TaskId task) const { return _tasks[task]->name; }
+
+	// ODispatchł̃^XN̎s
+	double GetTaskMs(TaskId task) const { return _tasks[task]->ms; }
+
+private:
+	struct Task
+	{
+		std::string name;
+		std::function<void()> function;
+		std::vector<TaskId> successors;
+		uint32_t dependencyCount;
+		std::atomic<uint32_t> remaining;	// IĂȂˑ̐
+		double ms;
+	};
+
+	void Launch(TaskId task);
+
+	std::vector<std::unique_ptr<Task>> _tasks;
+	JobSystem* _jobSystem;
+	JobCounter _counter;
+};
@@ -0,0 +1,221 @@
+#include "JobSystem.h"
+
+#include <algorithm>
+
+// ̃XbhWuVXeƔԍ
+static thread_local const JobSystem* currentJobSystem = nullptr;
+static thread_local uint32_t currentThreadIndex = JobSystem::InvalidThread;
+
+
+JobSystem::JobSystem() : _queuedCount(0), _quit(false)
+{
+}
+
+JobSystem::~JobSystem()
+{
+	Terminate();
+}
+
+// ̍쐬ƃ[J[Xbh̋N
+void JobSystem::Initialize(uint32_t threadCount)
+{
+	Terminate();
+
+	if (threadCount == 0)
+	{
+		threadCount = (std::max)(std::thread::hardware_concurrency(), 1u);
+	}
+	for (uint32_t i = 0; i < threadCount; ++i)
+	{
+		_queues.emplace_back(new Queue());
+	}
+
+	currentJobSystem = this;
+	currentThreadIndex = 0;
+
+	_quit = false;
+	for (uint32_t i = 1; i < threadCount; ++i)
+	{
+		_workers.emplace_back(&JobSystem::WorkerMain, this, i);
+	}
+}
+
+// [J[Xbh̏I (cĂWu͎sȂAWaitĂĂ)
+void JobSystem::Terminate()
+{
+	{
+		std::lock_guard<std::mutex> lock(_sleepMutex);
+		_quit = true;
+	}
+	_wakeCondition.notify_all();
+	for (auto& v : _workers)
+	{
+		v.join();
+	}
+	_workers.clear();
+	_queues.clear();
+	_queuedCount = 0;
+
+	if (currentJobSystem == this)
+	{
+		currentJobSystem = nullptr;
+		currentThreadIndex = InvalidThread;
+	}
+}
+
+uint32_t JobSystem::GetThreadIndex() const
+{
+	return currentJobSystem == this ? currentThreadIndex : InvalidThread;
+}
+
+// ĂяõXbȟ̗ɒǉAĂ郏[J[1N
+void JobSystem::Run(const Job& job, JobCounter* counter)
+{
+	if (counter != nullptr)
+	{
+		counter->_value.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	// [J[Ȃꍇ͂̏Ŏs
+	const auto threadIndex = GetThreadIndex();
+	if (_workers.empty() || threadIndex == InvalidThread)
+	{
+		job();
+		Finish(counter);
+		return;
+	}
+
+	// oɐĂ (o0Ȃ悤)
+	_queuedCount.fetch_add(1, std::memory_order_release);
+	{
+		auto& queue = *_queues[threadIndex];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		queue.tasks.push_back(Task{ job, counter });
+	}
+
+	// [J[͖O_queuedCountmFĂ̂ŁAbNĂʒm΋N˂Ȃ
+	{
+		std::lock_guard<std::mutex> lock(_sleepMutex);
+	}
+	_wakeCondition.notify_one();
+}
+
+void JobSystem::ParallelFor(uint32_t count, uint32_t batchSize, const RangeJob& job, JobCounter& counter)
+{
+	batchSize = (std::max)(batchSize, 1u);
+	for (uint32_t begin = 0; begin < count; begin += batchSize)
+	{
+		const auto end = (std::min)(begin + batchSize, count);
+		Run([&job, begin, end]() { job(begin, end); }, &counter);
+	}
+}
+
+// ҂ĂԂ̗⑼̃Xbh̃Wu (ˑWuɎcĂĂ~܂Ȃ)
+// 񂪋ő̃Xbhs̃WucĂꍇ́A葱ɖ
+void JobSystem::Wait(JobCounter& counter)
+{
+	const auto threadIndex = GetThreadIndex();
+	while (!counter.IsDone())
+	{
+		if (threadIndex != InvalidThread && RunOne(threadIndex))
+		{
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(_sleepMutex);
+		if (threadIndex == InvalidThread)
+		{
+			_doneCondition.wait(lock, [&counter] { return counter.IsDone(); });
+		}
+		else
+		{
+			_wakeCondition.wait(lock, [this, &counter] { return counter.IsDone() || _queuedCount.load(std::memory_order_acquire) > 0; });
+		}
+	}
+}
+
+// ̗̌납o
+bool JobSystem::Pop(uint32_t threadIndex, Task& task)
+{
+	auto& queue = *_queues[threadIndex];
+	std::lock_guard<std::mutex> lock(queue.mutex);
+	if (queue.tasks.empty())
+	{
+		return false;
+	}
+	task = std::move(queue.tasks.back());
+	queue.tasks.pop_back();
+	return true;
+}
+
+// ̃Xbh̗̑O瓐 (ׂ̃Xbh珇Ɍ)
+bool JobSystem::Steal(uint32_t threadIndex, Task& task)
+{
+	const auto threadCount = GetThreadCount();
+	for (uint32_t i = 1; i < threadCount; ++i)
+	{
+		auto& queue = *_queues[(threadIndex + i) % threadCount];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		if (!queue.tasks.empty())
+		{
+			task = std::move(queue.tasks.front());
+			queue.tasks.pop_front();
+			return true;
+		}
+	}
+	return false;
+}
+
+// Wu1s (Ȃfalse)
+bool JobSystem::RunOne(uint32_t threadIndex)
+{
+	Task task;
+	if (!Pop(threadIndex, task) && !Steal(threadIndex, task))
+	{
+		return false;
+	}
+	_queuedCount.fetch_sub(1, std::memory_order_relaxed);
+
+	task.job();
+	Finish(task.counter);
+	return true;
+}
+
+// JE^[1炵A0ɂȂWaitŖĂXbhN
+// (炵counterɐGȂAWait߂ĂяoɔjĂ悢)
+void JobSystem::Finish(JobCounter* counter)
+{
+	if (counter == nullptr || counter->_value.fetch_sub(1, std::memory_order_acq_rel) != 1)
+	{
+		return;
+	}
+
+	// Wait͖OɃJE^[mFĂ̂ŁAbNĂʒm΋N˂Ȃ
+	{
+		std::lock_guard<std::mutex> lock(_sleepMutex);
+	}
+	_wakeCondition.notify_all();
+	_doneCondition.notify_all();
+}
+
+// [J[Xbh̏
+void JobSystem::WorkerMain(uint32_t threadIndex)
+{
+	currentJobSystem = this;
+	currentThreadIndex = threadIndex;
+
+	for (;;)
+	{
+		if (RunOne(threadIndex))
+		{
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(_sleepMutex);
+		_wakeCondition.wait(lock, [this] { return _quit || _queuedCount.load(std::memory_order_acquire) > 0; });
+		if (_quit)
+		{
+			return;
+		}
+	}
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+// ĂȂWu̐ (RunőAWuIƌ)
+// 0ɂȂ܂Wait邱Ƃfork/joinȂ
+class JobCounter
+{
+public:
+	JobCounter() : _value(0) {}
+	JobCounter(const JobCounter&) = delete;
+	JobCounter& operator=(const JobCounter&) = delete;
+
+	bool IsDone() const { return _value.load(std::memory_order_acquire) == 0; }
+
+private:
+	friend class JobSystem;
+	std::atomic<uint32_t> _value;
+};
+
+// [NXeB[ÕWuXPW[[
+// XbhƂɃWu̗A̗͌납 (Ōɒǉ̂) oA
+// ɂȂ瑼̃Xbh̗̑O (Â̂) 
+// Xbh0InitializeĂ񂾃XbhŁAWait̊ԂWu
+// RunWait͂̃WuVXẽXbh (Xbh0ƃ[J[AWu̒) Ă (̃XbhRun͂̏Ŏs)
+// Xbh0͍ŌInitializeWuVXê̂ɂȂ̂ŁA1̃Xbhŕ𓯎ɎgȂ
+class JobSystem
+{
+public:
+	typedef std::function<void()> Job;
+	typedef std::function<void(uint32_t begin, uint32_t end)> RangeJob;
+
+	static const uint32_t InvalidThread = ~0u;
+
+	JobSystem();
+	~JobSystem();
+
+	// threadCount͌Ăяo܂ރXbh (0̏ꍇ̓RA)
+	void Initialize(uint32_t threadCount = 0);
+	void Terminate();
+
+	uint32_t GetThreadCount() const { return uint32_t(_queues.size()); }
+
+	// ĂяõXbh̔ԍ (0`GetThreadCount()-1ÃWuVXẽXbhłȂꍇInvalidThread)
+	uint32_t GetThreadIndex() const;
+
+	// Wu̒ǉ (counter͊1)
+	void Run(const Job& job, JobCounter* counter = nullptr);
+
+	// [0, count) batchSizeɕĕɏ (jobcounter̊܂ŕێ)
+	void ParallelFor(uint32_t count, uint32_t batchSize, const RangeJob& job, JobCounter& counter);
+
+	// counter0ɂȂ܂ŁÃWuȂ҂ (Wu̒Ăł悢)
+	// łWuȂԂ́Acounter0ɂȂ邩VWuǉ܂Ŗ
+	void Wait(JobCounter& counter);
+
+private:
+	struct Task
+	{
+		Job job;
+		JobCounter* counter;
+	};
+
+	// XbhƂ̗
+	struct Queue
+	{
+		std::mutex mutex;
+		std::deque<Task> tasks;
+	};
+
+	bool Pop(uint32_t threadIndex, Task& task);
+	bool Steal(uint32_t threadIndex, Task& task);
+	bool RunOne(uint32_t threadIndex);
+	void Finish(JobCounter* counter);
+	void WorkerMain(uint32_t threadIndex);
+
+	std::vector<std::unique_ptr<Queue>> _queues;	// Xbh
+	std::vector<std::thread> _workers;				// Xbh1`
+
+	// 񂪋̃[J[Wait͂Ŗ
+	// ̃WuVXẽXbhłȂWait͗̃WułȂ̂ŁAJE^[̊_doneConditionő҂
+	std::mutex _sleepMutex;
+	std::condition_variable _wakeCondition;
+	std::condition_variable _doneCondition;
+	std::atomic<uint32_t> _queuedCount;
+	bool _quit;
+};
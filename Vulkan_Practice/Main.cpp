@@ -16,7 +16,7 @@ int __stdcall wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPWSTR lpCm
 	// glfw̐ݒ
 	glfwInit();
 	glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
-	glfwWindowHint(GLFW_RESIZABLE, 0);
+	glfwWindowHint(GLFW_RESIZABLE, GLFW_TRUE);
 	auto window = glfwCreateWindow(windowWidth, windowHeight, appTitle, nullptr, nullptr);
 
 	// Vulkan̏
@@ -24,15 +24,43 @@ int __stdcall wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPWSTR lpCm
 	app.Initialize(window, appTitle);
 
 	// C[v
+	auto& profiler = app.GetProfiler();
 	while (glfwWindowShouldClose(window) == GLFW_FALSE)
 	{
+		// ŏ͕`悹ACxg܂ő҂
+		int width, height;
+		glfwGetFramebufferSize(window, &width, &height);
+		if (width == 0 || height == 0)
+		{
+			glfwWaitEvents();
+			continue;
+		}
+
+		Profiler::CpuScope frameScope(profiler, "Frame");
+
+		// t[̊Jn҂Ă͂ǂ
+		{
+			Profiler::CpuScope scope(profiler, "WaitForFrame");
+			app.WaitForNextFrame();
+		}
+
 		// }EXȂǂ̃CxgoL^
-		glfwPollEvents();
+		{
+			Profiler::CpuScope scope(profiler, "PollEvents");
+			glfwPollEvents();
+		}
 
 		// `悷
-		app.Render();
+		{
+			Profiler::CpuScope scope(profiler, "Render");
+			app.Render();
+		}
 	}
 
+	// vʂ̏o
+	profiler.DumpCsv("frame_times.csv");
+	profiler.DumpJson("frame_times.json");
+
 	// I
 	app.Terminate();
 	glfwTerminate();
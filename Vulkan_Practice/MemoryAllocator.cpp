@@ -0,0 +1,573 @@
+#include "MemoryAllocator.h"
+
+#include <set>
+#include <unordered_map>
+#include <algorithm>
+
+// VK_EXT_memory_budgetȂꍇɃq[v̉%܂ł\ZƂ݂Ȃ
+static const VkDeviceSize DefaultBudgetPercent = 80;
+
+
+//---------------------------------------------------
+//	MemoryBlock
+//	VkDeviceMemorybuddyŐ؂蕪
+//---------------------------------------------------
+class MemoryBlock
+{
+public:
+	// ŏ̐؂oP
+	static const VkDeviceSize MinAllocationSize = 256;
+
+	MemoryBlock(VkDeviceMemory memory, VkDeviceSize size, uint32_t memoryTypeIndex, void* mapped)
+		: _memory(memory), _size(size), _memoryTypeIndex(memoryTypeIndex), _mapped(mapped), _used(0)
+	{
+		_maxOrder = OrderOf(size);
+		_freeLists.resize(_maxOrder + 1);
+		_freeLists[_maxOrder].insert(0);
+	}
+
+	// ؂o (buddẙe͎g̃TCYŃACĂ)
+	bool Allocate(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize& offset)
+	{
+		const auto order = OrderOf((std::max)(size, alignment));
+		if (order > _maxOrder)
+		{
+			return false;
+		}
+
+		// 󂫂̂ŏ̋T
+		auto found = order;
+		while (found <= _maxOrder && _freeLists[found].empty())
+		{
+			++found;
+		}
+		if (found > _maxOrder)
+		{
+			return false;
+		}
+
+		offset = *_freeLists[found].begin();
+		_freeLists[found].erase(_freeLists[found].begin());
+
+		// KvȃTCYɂȂ܂ŔɕA딼󂫂ɖ߂
+		while (found > order)
+		{
+			--found;
+			_freeLists[found].insert(offset + (MinAllocationSize << found));
+		}
+
+		_allocated[offset] = order;
+		_used += MinAllocationSize << order;
+		return true;
+	}
+
+	// J (buddy󂢂ĂΌ)
+	void Free(VkDeviceSize offset)
+	{
+		auto it = _allocated.find(offset);
+		if (it == _allocated.end())
+		{
+			return;
+		}
+
+		auto order = it->second;
+		_allocated.erase(it);
+		_used -= MinAllocationSize << order;
+
+		while (order < _maxOrder)
+		{
+			const auto buddy = offset ^ (MinAllocationSize << order);
+			auto buddyIt = _freeLists[order].find(buddy);
+			if (buddyIt == _freeLists[order].end())
+			{
+				break;
+			}
+			_freeLists[order].erase(buddyIt);
+			offset = (std::min)(offset, buddy);
+			++order;
+		}
+		_freeLists[order].insert(offset);
+	}
+
+	bool IsEmpty() const { return _allocated.empty(); }
+	VkDeviceMemory GetMemory() const { return _memory; }
+	VkDeviceSize GetSize() const { return _size; }
+	VkDeviceSize GetUsed() const { return _used; }
+	uint32_t GetMemoryTypeIndex() const { return _memoryTypeIndex; }
+	uint32_t GetAllocationCount() const { return uint32_t(_allocated.size()); }
+	void* GetMapped(VkDeviceSize offset) const { return _mapped ? static_cast<uint8_t*>(_mapped) + offset : nullptr; }
+
+private:
+	static uint32_t OrderOf(VkDeviceSize size)
+	{
+		uint32_t order = 0;
+		while ((MinAllocationSize << order) < size)
+		{
+			++order;
+		}
+		return order;
+	}
+
+	VkDeviceMemory _memory;
+	VkDeviceSize _size;
+	uint32_t _memoryTypeIndex;
+	void* _mapped;
+	VkDeviceSize _used;
+	uint32_t _maxOrder;
+
+	std::vector<std::set<VkDeviceSize>> _freeLists;
+	std::unordered_map<VkDeviceSize, uint32_t> _allocated;
+};
+
+
+//---------------------------------------------------
+//	MemoryAllocator
+//---------------------------------------------------
+MemoryAllocator::MemoryAllocator()
+	: _physicalDevice(VK_NULL_HANDLE), _device(VK_NULL_HANDLE), _bufferImageGranularity(1), _maxMemoryAllocationCount(~0u),
+	_deviceMemoryCount(0), _dedicatedCount(0), _currentFrame(0), _memoryBudgetEnabled(false)
+{
+	_heapReservedBytes.fill(0);
+	_heapDedicatedBytes.fill(0);
+	_heapBudgets.fill(MemoryBudget());
+}
+
+MemoryAllocator::~MemoryAllocator()
+{
+}
+
+// 
+void MemoryAllocator::Initialize(VkPhysicalDevice physicalDevice, VkDevice device, uint32_t framesInFlight, VkDeviceSize transientPoolSize)
+{
+	_physicalDevice = physicalDevice;
+	_device = device;
+	vkGetPhysicalDeviceMemoryProperties(physicalDevice, &_memoryProperties);
+
+	VkPhysicalDeviceProperties props;
+	vkGetPhysicalDeviceProperties(physicalDevice, &props);
+	_bufferImageGranularity = props.limits.bufferImageGranularity;
+	_maxMemoryAllocationCount = props.limits.maxMemoryAllocationCount;
+
+	// t[Ƃ̈ꎞobt@̐
+	VkBufferCreateInfo ci{};
+	ci.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	ci.size = transientPoolSize;
+	ci.usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT
+		| VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+	ci.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+	_transientPools.resize(framesInFlight);
+	for (auto& v : _transientPools)
+	{
+		CreateBuffer(ci, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, v.buffer, v.allocation);
+		v.capacity = transientPoolSize;
+		v.head = 0;
+	}
+	_currentFrame = 0;
+	UpdateBudget();
+}
+
+// I (SẴ\[X͊Jς݂ł邱)
+void MemoryAllocator::Terminate()
+{
+	for (auto& v : _transientPools)
+	{
+		DestroyBuffer(v.buffer, v.allocation);
+	}
+	_transientPools.clear();
+
+	std::lock_guard<std::mutex> lock(_mutex);
+	for (auto& blocks : _blocks)
+	{
+		for (auto& v : blocks)
+		{
+			FreeDeviceMemory(v->GetMemory(), v->GetMemoryTypeIndex(), v->GetSize());
+		}
+		blocks.clear();
+	}
+}
+
+// ^Cv̌
+uint32_t MemoryAllocator::FindMemoryType(uint32_t typeBits, VkMemoryPropertyFlags required, VkMemoryPropertyFlags preferred) const
+{
+	uint32_t result = ~0u;
+	int bestScore = 0;
+	for (uint32_t i = 0; i < _memoryProperties.memoryTypeCount; ++i)
+	{
+		if ((typeBits & (1u << i)) == 0)
+		{
+			continue;
+		}
+
+		const auto flags = _memoryProperties.memoryTypes[i].propertyFlags;
+		if ((flags & required) != required)
+		{
+			continue;
+		}
+
+		// preferredɍقǍA]vȃtOtĂقǒႭ
+		int score = 0;
+		for (uint32_t bit = 0; bit < 32; ++bit)
+		{
+			const VkMemoryPropertyFlags mask = 1u << bit;
+			if (preferred & mask)
+			{
+				score += (flags & mask) ? 4 : 0;
+			}
+			else if ((flags & mask) && !(required & mask))
+			{
+				score -= 1;
+			}
+		}
+
+		if (result == ~0u || score > bestScore)
+		{
+			bestScore = score;
+			result = i;
+		}
+	}
+	return result;
+}
+
+// ubN̑傫 (q[vł͏߂ɂ)
+VkDeviceSize MemoryAllocator::GetBlockSize(uint32_t memoryTypeIndex) const
+{
+	const auto heapIndex = _memoryProperties.memoryTypes[memoryTypeIndex].heapIndex;
+	const auto heapSize = _memoryProperties.memoryHeaps[heapIndex].size;
+
+	auto blockSize = DefaultBlockSize;
+	while (blockSize > MemoryBlock::MinAllocationSize && blockSize > heapSize / 8)
+	{
+		blockSize >>= 1;
+	}
+	return blockSize;
+}
+
+// VkDeviceMemorẙm
+VkDeviceMemory MemoryAllocator::AllocateDeviceMemory(VkDeviceSize size, uint32_t memoryTypeIndex, void** mapped)
+{
+	if (_deviceMemoryCount >= _maxMemoryAllocationCount)
+	{
+		return VK_NULL_HANDLE;
+	}
+
+	VkMemoryAllocateInfo ai{};
+	ai.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+	ai.allocationSize = size;
+	ai.memoryTypeIndex = memoryTypeIndex;
+
+	VkDeviceMemory memory = VK_NULL_HANDLE;
+	if (vkAllocateMemory(_device, &ai, nullptr, &memory) != VK_SUCCESS)
+	{
+		return VK_NULL_HANDLE;
+	}
+
+	// host visibleȃ͊mۂ܂܏Ƀ}bvĂ
+	*mapped = nullptr;
+	if (_memoryProperties.memoryTypes[memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+	{
+		vkMapMemory(_device, memory, 0, VK_WHOLE_SIZE, 0, mapped);
+	}
+
+	++_deviceMemoryCount;
+	_heapReservedBytes[_memoryProperties.memoryTypes[memoryTypeIndex].heapIndex] += size;
+	return memory;
+}
+
+// VkDeviceMemorẙJ
+void MemoryAllocator::FreeDeviceMemory(VkDeviceMemory memory, uint32_t memoryTypeIndex, VkDeviceSize size)
+{
+	vkFreeMemory(_device, memory, nullptr);
+	--_deviceMemoryCount;
+	_heapReservedBytes[_memoryProperties.memoryTypes[memoryTypeIndex].heapIndex] -= size;
+}
+
+// ̊m
+bool MemoryAllocator::Allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags required, VkMemoryPropertyFlags preferred,
+	MemoryResourceKind kind, MemoryAllocation& allocation)
+{
+	const auto memoryTypeIndex = FindMemoryType(requirements.memoryTypeBits, required, preferred);
+	if (memoryTypeIndex == ~0u)
+	{
+		return false;
+	}
+
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	allocation = MemoryAllocation{};
+	allocation.memoryTypeIndex = memoryTypeIndex;
+	allocation.size = requirements.size;
+
+	// ubN̔𒴂傫͐pɊmۂ
+	const auto blockSize = GetBlockSize(memoryTypeIndex);
+	if (requirements.size > blockSize / 2)
+	{
+		allocation.memory = AllocateDeviceMemory(requirements.size, memoryTypeIndex, &allocation.mapped);
+		if (allocation.memory == VK_NULL_HANDLE)
+		{
+			return false;
+		}
+		++_dedicatedCount;
+		_heapDedicatedBytes[_memoryProperties.memoryTypes[memoryTypeIndex].heapIndex] += requirements.size;
+		return true;
+	}
+
+	// granularityŏPʈȉȂAbufferimageׂ荇ĂȂ̂œubNg
+	const auto separateKind = _bufferImageGranularity > MemoryBlock::MinAllocationSize;
+	const auto poolIndex = memoryTypeIndex * 2 + (separateKind && kind == MemoryResourceKind::Optimal ? 1 : 0);
+	auto& blocks = _blocks[poolIndex];
+
+	// ̃ubN؂o
+	for (auto& v : blocks)
+	{
+		if (v->Allocate(requirements.size, requirements.alignment, allocation.offset))
+		{
+			allocation.memory = v->GetMemory();
+			allocation.mapped = v->GetMapped(allocation.offset);
+			allocation.block = v.get();
+			return true;
+		}
+	}
+
+	// VubNmۂ
+	void* mapped = nullptr;
+	auto memory = AllocateDeviceMemory(blockSize, memoryTypeIndex, &mapped);
+	if (memory == VK_NULL_HANDLE)
+	{
+		return false;
+	}
+	blocks.emplace_back(new MemoryBlock(memory, blockSize, memoryTypeIndex, mapped));
+
+	auto& block = blocks.back();
+	block->Allocate(requirements.size, requirements.alignment, allocation.offset);
+	allocation.memory = block->GetMemory();
+	allocation.mapped = block->GetMapped(allocation.offset);
+	allocation.block = block.get();
+	return true;
+}
+
+// ̊J
+void MemoryAllocator::Free(MemoryAllocation& allocation)
+{
+	if (allocation.memory == VK_NULL_HANDLE)
+	{
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	if (allocation.block == nullptr)
+	{
+		// pm
+		FreeDeviceMemory(allocation.memory, allocation.memoryTypeIndex, allocation.size);
+		--_dedicatedCount;
+		_heapDedicatedBytes[_memoryProperties.memoryTypes[allocation.memoryTypeIndex].heapIndex] -= allocation.size;
+	}
+	else
+	{
+		auto* block = allocation.block;
+		block->Free(allocation.offset);
+
+		// ɂȂubŃAv[ɑ̃ubNΕԋp
+		if (block->IsEmpty())
+		{
+			for (auto& blocks : _blocks)
+			{
+				auto it = std::find_if(blocks.begin(), blocks.end(),
+					[block](const std::unique_ptr<MemoryBlock>& v) { return v.get() == block; });
+				if (it != blocks.end())
+				{
+					if (blocks.size() > 1)
+					{
+						FreeDeviceMemory(block->GetMemory(), block->GetMemoryTypeIndex(), block->GetSize());
+						blocks.erase(it);
+					}
+					break;
+				}
+			}
+		}
+	}
+
+	allocation = MemoryAllocation{};
+}
+
+// Image̐ƃ̃oCh
+bool MemoryAllocator::CreateImage(const VkImageCreateInfo& ci, VkMemoryPropertyFlags required, VkImage& image, MemoryAllocation& allocation)
+{
+	if (vkCreateImage(_device, &ci, nullptr, &image) != VK_SUCCESS)
+	{
+		return false;
+	}
+
+	VkMemoryRequirements memoryRequirements;
+	vkGetImageMemoryRequirements(_device, image, &memoryRequirements);
+
+	const auto kind = ci.tiling == VK_IMAGE_TILING_OPTIMAL ? MemoryResourceKind::Optimal : MemoryResourceKind::Linear;
+	if (!Allocate(memoryRequirements, required, required, kind, allocation))
+	{
+		vkDestroyImage(_device, image, nullptr);
+		image = VK_NULL_HANDLE;
+		return false;
+	}
+
+	vkBindImageMemory(_device, image, allocation.memory, allocation.offset);
+	return true;
+}
+
+// Buffer̐ƃ̃oCh
+bool MemoryAllocator::CreateBuffer(const VkBufferCreateInfo& ci, VkMemoryPropertyFlags required, VkMemoryPropertyFlags preferred,
+	VkBuffer& buffer, MemoryAllocation& allocation)
+{
+	if (vkCreateBuffer(_device, &ci, nullptr, &buffer) != VK_SUCCESS)
+	{
+		return false;
+	}
+
+	VkMemoryRequirements memoryRequirements;
+	vkGetBufferMemoryRequirements(_device, buffer, &memoryRequirements);
+
+	if (!Allocate(memoryRequirements, required, required | preferred, MemoryResourceKind::Linear, allocation))
+	{
+		vkDestroyBuffer(_device, buffer, nullptr);
+		buffer = VK_NULL_HANDLE;
+		return false;
+	}
+
+	vkBindBufferMemory(_device, buffer, allocation.memory, allocation.offset);
+	return true;
+}
+
+// Imageƃ̔j
+void MemoryAllocator::DestroyImage(VkImage& image, MemoryAllocation& allocation)
+{
+	if (image != VK_NULL_HANDLE)
+	{
+		vkDestroyImage(_device, image, nullptr);
+		image = VK_NULL_HANDLE;
+	}
+	Free(allocation);
+}
+
+// Bufferƃ̔j
+void MemoryAllocator::DestroyBuffer(VkBuffer& buffer, MemoryAllocation& allocation)
+{
+	if (buffer != VK_NULL_HANDLE)
+	{
+		vkDestroyBuffer(_device, buffer, nullptr);
+		buffer = VK_NULL_HANDLE;
+	}
+	Free(allocation);
+}
+
+// t[̊Jn (̃t[̈ꎞ߂A\Z擾)
+void MemoryAllocator::BeginFrame(uint32_t frameIndex)
+{
+	_currentFrame = frameIndex;
+	_transientPools[frameIndex].head = 0;
+	UpdateBudget();
+}
+
+// t[Ƃ̈ꎞ̊m
+bool MemoryAllocator::AllocateTransient(VkDeviceSize size, VkDeviceSize alignment, TransientAllocation& allocation)
+{
+	auto& pool = _transientPools[_currentFrame];
+
+	alignment = (std::max)(alignment, VkDeviceSize(1));
+	const auto offset = (pool.head + alignment - 1) / alignment * alignment;
+	if (offset + size > pool.capacity)
+	{
+		return false;
+	}
+
+	allocation.buffer = pool.buffer;
+	allocation.offset = offset;
+	allocation.size = size;
+	allocation.mapped = static_cast<uint8_t*>(pool.allocation.mapped) + offset;
+	pool.head = offset + size;
+	return true;
+}
+
+// gp󋵂̎擾
+MemoryStats MemoryAllocator::GetStats() const
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	MemoryStats stats;
+	stats.deviceMemoryCount = _deviceMemoryCount;
+	stats.dedicatedCount = _dedicatedCount;
+	stats.heapReservedBytes = _heapReservedBytes;
+	stats.heapUsedBytes = _heapDedicatedBytes;
+
+	for (const auto& blocks : _blocks)
+	{
+		for (const auto& v : blocks)
+		{
+			++stats.blockCount;
+			stats.allocationCount += v->GetAllocationCount();
+			stats.heapUsedBytes[_memoryProperties.memoryTypes[v->GetMemoryTypeIndex()].heapIndex] += v->GetUsed();
+		}
+	}
+	stats.allocationCount += _dedicatedCount;
+
+	for (uint32_t i = 0; i < _memoryProperties.memoryHeapCount; ++i)
+	{
+		stats.reservedBytes += stats.heapReservedBytes[i];
+		stats.usedBytes += stats.heapUsedBytes[i];
+	}
+
+	for (const auto& v : _transientPools)
+	{
+		stats.transientCapacity += v.capacity;
+	}
+	if (!_transientPools.empty())
+	{
+		stats.transientUsedBytes = _transientPools[_currentFrame].head;
+	}
+	return stats;
+}
+
+// q[v̗\Z̍XV
+// hCo[̎gpʂɂ̓ubN̋󂫂܂܂̂ŁATuAP[VŎgp̗ʂɒu
+// (󂫂ƂɎgpʂ𑽂ςAKvȏɊJȂ悤)
+void MemoryAllocator::UpdateBudget()
+{
+	std::array<VkDeviceSize, VK_MAX_MEMORY_HEAPS> budgets{};
+	std::array<VkDeviceSize, VK_MAX_MEMORY_HEAPS> usages{};
+	if (_memoryBudgetEnabled)
+	{
+		VkPhysicalDeviceMemoryBudgetPropertiesEXT budgetProps{};
+		budgetProps.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+		VkPhysicalDeviceMemoryProperties2 props{};
+		props.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+		props.pNext = &budgetProps;
+		vkGetPhysicalDeviceMemoryProperties2(_physicalDevice, &props);
+		for (uint32_t i = 0; i < _memoryProperties.memoryHeapCount; ++i)
+		{
+			budgets[i] = budgetProps.heapBudget[i];
+			usages[i] = budgetProps.heapUsage[i];
+		}
+	}
+	else
+	{
+		for (uint32_t i = 0; i < _memoryProperties.memoryHeapCount; ++i)
+		{
+			budgets[i] = _memoryProperties.memoryHeaps[i].size / 100 * DefaultBudgetPercent;
+		}
+	}
+
+	const auto stats = GetStats();
+	std::lock_guard<std::mutex> lock(_mutex);
+	for (uint32_t i = 0; i < _memoryProperties.memoryHeapCount; ++i)
+	{
+		const auto external = usages[i] > stats.heapReservedBytes[i] ? usages[i] - stats.heapReservedBytes[i] : 0;
+		_heapBudgets[i].budget = budgets[i];
+		_heapBudgets[i].usage = external + stats.heapUsedBytes[i];
+	}
+}
+
+MemoryBudget MemoryAllocator::GetHeapBudget(uint32_t heapIndex) const
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	return heapIndex < _memoryProperties.memoryHeapCount ? _heapBudgets[heapIndex] : MemoryBudget();
+}
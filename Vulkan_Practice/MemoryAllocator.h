@@ -0,0 +1,143 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <vector>
+#include <array>
+#include <memory>
+#include <mutex>
+
+class MemoryBlock;
+
+// \[X̎
+// bufferImageGranularityCɂȂčςނ悤Abuffer(linear)image(optimal)̓ubN𕪂
+enum class MemoryResourceKind
+{
+	Linear,		// buffer, linear tiling image
+	Optimal,	// optimal tiling image
+};
+
+// mۂ̏
+struct MemoryAllocation
+{
+	VkDeviceMemory memory = VK_NULL_HANDLE;
+	VkDeviceSize offset = 0;
+	VkDeviceSize size = 0;
+	void* mapped = nullptr;			// host visiblȅꍇ̂
+	uint32_t memoryTypeIndex = ~0u;
+	MemoryBlock* block = nullptr;	// pmۂ̏ꍇnullptr
+};
+
+// t[Ƃ̈ꎞobt@̊mی
+struct TransientAllocation
+{
+	VkBuffer buffer = VK_NULL_HANDLE;
+	VkDeviceSize offset = 0;
+	VkDeviceSize size = 0;
+	void* mapped = nullptr;
+};
+
+// ̎gp
+struct MemoryStats
+{
+	uint32_t deviceMemoryCount = 0;		// vkAllocateMemorỷ(݂̐)
+	uint32_t blockCount = 0;
+	uint32_t dedicatedCount = 0;
+	uint32_t allocationCount = 0;
+	VkDeviceSize reservedBytes = 0;		// vkAllocateMemoryŊmۂ
+	VkDeviceSize usedBytes = 0;			// TuAP[VŎgp̑
+	VkDeviceSize transientCapacity = 0;
+	VkDeviceSize transientUsedBytes = 0;	// ݂̃t[Ŏgp̈ꎞ
+	std::array<VkDeviceSize, VK_MAX_MEMORY_HEAPS> heapReservedBytes{};
+	std::array<VkDeviceSize, VK_MAX_MEMORY_HEAPS> heapUsedBytes{};
+};
+
+// q[vƂ̗\Z (VK_EXT_memory_budget)
+struct MemoryBudget
+{
+	VkDeviceSize budget = 0;	// ̃vZXgĂ悢ʂ̖ڈ
+	VkDeviceSize usage = 0;		// gp (̃AP[^̃ubN̋󂫂͊܂߂Ȃ)
+};
+
+
+// ^CvƂɑ傫ȃubNmۂAbuddyŐ؂蕪AP[^
+class MemoryAllocator
+{
+public:
+	MemoryAllocator();
+	~MemoryAllocator();
+
+	void Initialize(VkPhysicalDevice physicalDevice, VkDevice device, uint32_t framesInFlight,
+		VkDeviceSize transientPoolSize = 4 * 1024 * 1024);
+	void Terminate();
+
+	// ̊mۂƊJ
+	// required𖞂^Cv̂Apreferredɍł̂I
+	bool Allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags required, VkMemoryPropertyFlags preferred,
+		MemoryResourceKind kind, MemoryAllocation& allocation);
+	void Free(MemoryAllocation& allocation);
+
+	// \[X̐ƃ̃oCh܂Ƃ߂ĂȂ
+	bool CreateImage(const VkImageCreateInfo& ci, VkMemoryPropertyFlags required, VkImage& image, MemoryAllocation& allocation);
+	bool CreateBuffer(const VkBufferCreateInfo& ci, VkMemoryPropertyFlags required, VkMemoryPropertyFlags preferred,
+		VkBuffer& buffer, MemoryAllocation& allocation);
+	void DestroyImage(VkImage& image, MemoryAllocation& allocation);
+	void DestroyBuffer(VkBuffer& buffer, MemoryAllocation& allocation);
+
+	// t[Ƃ̈ꎞ (t[fence҂BeginFrameĂ)
+	void BeginFrame(uint32_t frameIndex);
+	bool AllocateTransient(VkDeviceSize size, VkDeviceSize alignment, TransientAllocation& allocation);
+
+	// ^Cv̌ (Ȃꍇ~0u)
+	uint32_t FindMemoryType(uint32_t typeBits, VkMemoryPropertyFlags required, VkMemoryPropertyFlags preferred) const;
+
+	MemoryStats GetStats() const;
+
+	// VK_EXT_memory_budgetLɂꍇɌĂ (Ă΂Ȃꍇ̓q[v̑傫̈芄\ZƂ݂Ȃ)
+	void EnableMemoryBudget() { _memoryBudgetEnabled = true; }
+	bool IsMemoryBudgetEnabled() const { return _memoryBudgetEnabled; }
+
+	// q[v̗\ZƎgp (BeginFrameōXV)
+	MemoryBudget GetHeapBudget(uint32_t heapIndex) const;
+	const VkPhysicalDeviceMemoryProperties& GetMemoryProperties() const { return _memoryProperties; }
+
+	// ubN̑傫 (傫mۂVkDeviceMemorypɊmۂ)
+	static const VkDeviceSize DefaultBlockSize = 64ull * 1024 * 1024;
+
+private:
+	VkDeviceMemory AllocateDeviceMemory(VkDeviceSize size, uint32_t memoryTypeIndex, void** mapped);
+	void FreeDeviceMemory(VkDeviceMemory memory, uint32_t memoryTypeIndex, VkDeviceSize size);
+	VkDeviceSize GetBlockSize(uint32_t memoryTypeIndex) const;
+	void UpdateBudget();
+
+	// t[Ƃ̈ꎞobt@ (擪珇ɐ؂oAt[̊JnɊ߂)
+	struct LinearPool
+	{
+		VkBuffer buffer = VK_NULL_HANDLE;
+		MemoryAllocation allocation;
+		VkDeviceSize capacity = 0;
+		VkDeviceSize head = 0;
+	};
+
+	VkPhysicalDevice _physicalDevice;
+	VkDevice _device;
+	VkPhysicalDeviceMemoryProperties _memoryProperties;
+	VkDeviceSize _bufferImageGranularity;
+	uint32_t _maxMemoryAllocationCount;
+
+	mutable std::mutex _mutex;
+
+	// [memoryTypeIndex * 2 + kind] Ƃ̃ubN
+	std::array<std::vector<std::unique_ptr<MemoryBlock>>, VK_MAX_MEMORY_TYPES * 2> _blocks;
+
+	uint32_t _deviceMemoryCount;
+	uint32_t _dedicatedCount;
+	std::array<VkDeviceSize, VK_MAX_MEMORY_HEAPS> _heapReservedBytes;
+	std::array<VkDeviceSize, VK_MAX_MEMORY_HEAPS> _heapDedicatedBytes;
+
+	std::vector<LinearPool> _transientPools;
+	uint32_t _currentFrame;
+
+	bool _memoryBudgetEnabled;
+	std::array<MemoryBudget, VK_MAX_MEMORY_HEAPS> _heapBudgets;
+};
@@ -0,0 +1,380 @@
+#include "PipelineManager.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+// Ō߂ꍇ̃[J[Xbh̏ (L^Xbh̎זȂ悤Ȃ߂ɂ)
+static const uint32_t MaxAutoThreadCount = 4;
+
+// FNV-1a
+static uint64_t HashBytes(uint64_t hash, const void* data, size_t size)
+{
+	auto bytes = static_cast<const uint8_t*>(data);
+	for (size_t i = 0; i < size; ++i)
+	{
+		hash ^= bytes[i];
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+template<typename T>
+static uint64_t HashValue(uint64_t hash, const T& value)
+{
+	return HashBytes(hash, &value, sizeof(T));
+}
+
+// pfBÔȂ\̂̔z̔r
+template<typename T>
+static bool EqualArray(const std::vector<T>& a, const std::vector<T>& b)
+{
+	return a.size() == b.size() && (a.empty() || std::memcmp(a.data(), b.data(), sizeof(T) * a.size()) == 0);
+}
+
+template<typename T>
+static uint64_t HashArray(uint64_t hash, const std::vector<T>& values)
+{
+	hash = HashValue(hash, values.size());
+	return values.empty() ? hash : HashBytes(hash, values.data(), sizeof(T) * values.size());
+}
+
+
+GraphicsPipelineState::GraphicsPipelineState() : topology(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST), polygonMode(VK_POLYGON_MODE_FILL),
+	cullMode(VK_CULL_MODE_NONE), frontFace(VK_FRONT_FACE_COUNTER_CLOCKWISE), samples(VK_SAMPLE_COUNT_1_BIT),
+	depthTest(VK_TRUE), depthWrite(VK_TRUE), depthCompare(VK_COMPARE_OP_LESS_OR_EQUAL),
+	dynamicStates{ VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR }, layout(VK_NULL_HANDLE), renderPass(VK_NULL_HANDLE), subpass(0)
+{
+}
+
+GraphicsPipelineState& GraphicsPipelineState::AddShader(VkShaderStageFlagBits stage, VkShaderModule module, const SpecializationConstants& constants)
+{
+	Shader shader{ stage, module, constants };
+	shaders.push_back(shader);
+	return *this;
+}
+
+// SĂ̏Ԃ̃nbV (\̂̓pfBÔȂ̂܂Ƃ߂ănbV)
+uint64_t GraphicsPipelineState::GetHash() const
+{
+	auto hash = 14695981039346656037ull;
+	hash = HashValue(hash, shaders.size());
+	for (const auto& v : shaders)
+	{
+		hash = HashValue(hash, v.stage);
+		hash = HashValue(hash, v.module);
+		hash = HashValue(hash, v.constants.GetHash());
+	}
+	hash = HashArray(hash, vertexBindings);
+	hash = HashArray(hash, vertexAttributes);
+	hash = HashValue(hash, topology);
+	hash = HashValue(hash, polygonMode);
+	hash = HashValue(hash, cullMode);
+	hash = HashValue(hash, frontFace);
+	hash = HashValue(hash, samples);
+	hash = HashValue(hash, depthTest);
+	hash = HashValue(hash, depthWrite);
+	hash = HashValue(hash, depthCompare);
+	hash = HashArray(hash, blendAttachments);
+	hash = HashArray(hash, dynamicStates);
+	hash = HashValue(hash, layout);
+	hash = HashValue(hash, renderPass);
+	hash = HashValue(hash, subpass);
+
+	// 0̓tH[obNȂ\̂ŎgȂ
+	return hash != 0 ? hash : 1;
+}
+
+bool GraphicsPipelineState::operator==(const GraphicsPipelineState& other) const
+{
+	if (shaders.size() != other.shaders.size())
+	{
+		return false;
+	}
+	for (size_t i = 0; i < shaders.size(); ++i)
+	{
+		const auto& a = shaders[i];
+		const auto& b = other.shaders[i];
+		if (a.stage != b.stage || a.module != b.module || !(a.constants == b.constants))
+		{
+			return false;
+		}
+	}
+	return EqualArray(vertexBindings, other.vertexBindings)
+		&& EqualArray(vertexAttributes, other.vertexAttributes)
+		&& topology == other.topology
+		&& polygonMode == other.polygonMode
+		&& cullMode == other.cullMode
+		&& frontFace == other.frontFace
+		&& samples == other.samples
+		&& depthTest == other.depthTest
+		&& depthWrite == other.depthWrite
+		&& depthCompare == other.depthCompare
+		&& EqualArray(blendAttachments, other.blendAttachments)
+		&& dynamicStates == other.dynamicStates
+		&& layout == other.layout
+		&& renderPass == other.renderPass
+		&& subpass == other.subpass;
+}
+
+
+PipelineManager::PipelineManager() : _device(VK_NULL_HANDLE), _pipelineCache(VK_NULL_HANDLE), _compilingCount(0), _stats(), _quit(false)
+{
+}
+
+PipelineManager::~PipelineManager()
+{
+	Terminate();
+}
+
+// [J[Xbh̋N
+void PipelineManager::Initialize(VkDevice device, VkPipelineCache pipelineCache, uint32_t threadCount)
+{
+	_device = device;
+	_pipelineCache = pipelineCache;
+	if (threadCount == 0)
+	{
+		threadCount = (std::min)((std::max)(1u, std::thread::hardware_concurrency() / 2), MaxAutoThreadCount);
+	}
+
+	_quit = false;
+	for (uint32_t i = 0; i < threadCount; ++i)
+	{
+		_workers.emplace_back(&PipelineManager::WorkerMain, this);
+	}
+}
+
+// ̂̂҂ĂpCvCj (L[ɎcĂ̂͐Ȃ)
+void PipelineManager::Terminate()
+{
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_quit = true;
+		_queue.clear();
+	}
+	_queueCondition.notify_all();
+	for (auto& v : _workers)
+	{
+		v.join();
+	}
+	_workers.clear();
+
+	for (auto& v : _entries)
+	{
+		if (v.second->pipeline != VK_NULL_HANDLE)
+		{
+			vkDestroyPipeline(_device, v.second->pipeline, nullptr);
+		}
+	}
+	_entries.clear();
+	_compilingCount = 0;
+}
+
+// ̗v (Ԃ̂̂ɂ΂̃L[Ԃ)
+// nbVłԂقȂꍇ́AL[1i߂ēԂ̂̂󂢂ĂL[T
+PipelineManager::Key PipelineManager::Request(const GraphicsPipelineState& state, Key fallback)
+{
+	auto key = state.GetHash();
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		++_stats.requestCount;
+		for (auto found = _entries.find(key); found != _entries.end(); found = _entries.find(key))
+		{
+			if (found->second->state == state)
+			{
+				++_stats.dedupedCount;
+				return key;
+			}
+			key = key + 1 != 0 ? key + 1 : 1;
+		}
+
+		std::unique_ptr<Entry> entry(new Entry{ state, fallback, VK_NULL_HANDLE });
+		_entries[key] = std::move(entry);
+		_queue.push_back(key);
+	}
+	_queueCondition.notify_one();
+	return key;
+}
+
+VkPipeline PipelineManager::Get(Key key) const
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	auto found = _entries.find(key);
+	if (found == _entries.end())
+	{
+		return VK_NULL_HANDLE;
+	}
+	if (found->second->pipeline != VK_NULL_HANDLE)
+	{
+		return found->second->pipeline;
+	}
+
+	auto fallback = _entries.find(found->second->fallback);
+	return fallback != _entries.end() ? fallback->second->pipeline : VK_NULL_HANDLE;
+}
+
+bool PipelineManager::IsReady(Key key) const
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	auto found = _entries.find(key);
+	return found != _entries.end() && found->second->pipeline != VK_NULL_HANDLE;
+}
+
+void PipelineManager::WaitIdle()
+{
+	std::unique_lock<std::mutex> lock(_mutex);
+	_idleCondition.wait(lock, [this]() { return _queue.empty() && _compilingCount == 0; });
+}
+
+uint32_t PipelineManager::GetPendingCount() const
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	return uint32_t(_queue.size()) + _compilingCount;
+}
+
+PipelineManager::Stats PipelineManager::GetStats() const
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	return _stats;
+}
+
+// L[oĐ
+void PipelineManager::WorkerMain()
+{
+	std::unique_lock<std::mutex> lock(_mutex);
+	for (;;)
+	{
+		_queueCondition.wait(lock, [this]() { return _quit || !_queue.empty(); });
+		if (_quit)
+		{
+			return;
+		}
+
+		const auto key = _queue.front();
+		_queue.pop_front();
+		++_compilingCount;
+
+		// GgTerminate܂ŏȂ̂ŁAbNOĎQƂĂ悢
+		auto entry = _entries[key].get();
+		lock.unlock();
+
+		const auto start = std::chrono::steady_clock::now();
+		auto pipeline = Compile(entry->state);
+		const auto ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+		lock.lock();
+		entry->pipeline = pipeline;
+		--_compilingCount;
+		if (pipeline != VK_NULL_HANDLE)
+		{
+			++_stats.compiledCount;
+		}
+		else
+		{
+			++_stats.failedCount;
+		}
+		_stats.compileMs += ms;
+		if (_queue.empty() && _compilingCount == 0)
+		{
+			_idleCondition.notify_all();
+		}
+	}
+}
+
+// VkGraphicsPipelineCreateInfȏgݗĂƐ ([J[XbhŌĂ΂)
+VkPipeline PipelineManager::Compile(const GraphicsPipelineState& state) const
+{
+	std::vector<VkPipelineShaderStageCreateInfo> stages(state.shaders.size());
+	for (size_t i = 0; i < stages.size(); ++i)
+	{
+		const auto& shader = state.shaders[i];
+		if (shader.module == VK_NULL_HANDLE)
+		{
+			return VK_NULL_HANDLE;
+		}
+		stages[i].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+		stages[i].stage = shader.stage;
+		stages[i].module = shader.module;
+		stages[i].pName = "main";
+		stages[i].pSpecializationInfo = shader.constants.GetInfo();
+	}
+
+	VkPipelineVertexInputStateCreateInfo vertexInput{};
+	vertexInput.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+	vertexInput.vertexBindingDescriptionCount = uint32_t(state.vertexBindings.size());
+	vertexInput.pVertexBindingDescriptions = state.vertexBindings.data();
+	vertexInput.vertexAttributeDescriptionCount = uint32_t(state.vertexAttributes.size());
+	vertexInput.pVertexAttributeDescriptions = state.vertexAttributes.data();
+
+	VkPipelineInputAssemblyStateCreateInfo inputAssembly{};
+	inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+	inputAssembly.topology = state.topology;
+
+	VkPipelineViewportStateCreateInfo viewportState{};
+	viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+	viewportState.viewportCount = 1;
+	viewportState.scissorCount = 1;
+
+	VkPipelineRasterizationStateCreateInfo rasterization{};
+	rasterization.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+	rasterization.polygonMode = state.polygonMode;
+	rasterization.cullMode = state.cullMode;
+	rasterization.frontFace = state.frontFace;
+	rasterization.lineWidth = 1.0f;
+
+	VkPipelineMultisampleStateCreateInfo multisample{};
+	multisample.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+	multisample.rasterizationSamples = state.samples;
+
+	VkPipelineDepthStencilStateCreateInfo depthStencil{};
+	depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+	depthStencil.depthTestEnable = state.depthTest;
+	depthStencil.depthWriteEnable = state.depthWrite;
+	depthStencil.depthCompareOp = state.depthCompare;
+
+	VkPipelineColorBlendAttachmentState opaque{};
+	opaque.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+
+	VkPipelineColorBlendStateCreateInfo colorBlend{};
+	colorBlend.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+	if (state.blendAttachments.empty())
+	{
+		colorBlend.attachmentCount = 1;
+		colorBlend.pAttachments = &opaque;
+	}
+	else
+	{
+		colorBlend.attachmentCount = uint32_t(state.blendAttachments.size());
+		colorBlend.pAttachments = state.blendAttachments.data();
+	}
+
+	VkPipelineDynamicStateCreateInfo dynamicState{};
+	dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+	dynamicState.dynamicStateCount = uint32_t(state.dynamicStates.size());
+	dynamicState.pDynamicStates = state.dynamicStates.data();
+
+	VkGraphicsPipelineCreateInfo ci{};
+	ci.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+	ci.stageCount = uint32_t(stages.size());
+	ci.pStages = stages.data();
+	ci.pVertexInputState = &vertexInput;
+	ci.pInputAssemblyState = &inputAssembly;
+	ci.pViewportState = &viewportState;
+	ci.pRasterizationState = &rasterization;
+	ci.pMultisampleState = &multisample;
+	ci.pDepthStencilState = &depthStencil;
+	ci.pColorBlendState = &colorBlend;
+	ci.pDynamicState = state.dynamicStates.empty() ? nullptr : &dynamicState;
+	ci.layout = state.layout;
+	ci.renderPass = state.renderPass;
+	ci.subpass = state.subpass;
+	ci.basePipelineIndex = -1;
+
+	// VkPipelineCache͎Ŕr̂ŁÃ[J[瓯ɎgĂ悢
+	VkPipeline pipeline = VK_NULL_HANDLE;
+	if (vkCreateGraphicsPipelines(_device, _pipelineCache, 1, &ci, nullptr, &pipeline) != VK_SUCCESS)
+	{
+		return VK_NULL_HANDLE;
+	}
+	return pipeline;
+}
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <vector>
+#include <map>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "ShaderCache.h"
+
+// OtBbNXpCvC̏ (SĂ̒lnbṼL[ɂȂ)
+// r[|[gƃVU[͊œI (`̃TCYςĂ蒼Ȃ)
+struct GraphicsPipelineState
+{
+	struct Shader
+	{
+		VkShaderStageFlagBits stage;
+		VkShaderModule module;				// ShaderCachẽW[ (\[X̃nbVƂɈقȂ)
+		SpecializationConstants constants;
+	};
+
+	GraphicsPipelineState();
+
+	GraphicsPipelineState& AddShader(VkShaderStageFlagBits stage, VkShaderModule module, const SpecializationConstants& constants = SpecializationConstants());
+
+	std::vector<Shader> shaders;
+
+	// _̕
+	std::vector<VkVertexInputBindingDescription> vertexBindings;
+	std::vector<VkVertexInputAttributeDescription> vertexAttributes;
+	VkPrimitiveTopology topology;
+
+	// X^CY
+	VkPolygonMode polygonMode;
+	VkCullModeFlags cullMode;
+	VkFrontFace frontFace;
+	VkSampleCountFlagBits samples;
+
+	// [x
+	VkBool32 depthTest;
+	VkBool32 depthWrite;
+	VkCompareOp depthCompare;
+
+	// uh (J[A^b`gƁȀꍇ1̕sȃA^b`g)
+	std::vector<VkPipelineColorBlendAttachmentState> blendAttachments;
+
+	std::vector<VkDynamicState> dynamicStates;
+
+	VkPipelineLayout layout;
+
+	// _[pX̌݊ (RenderGraph͓\̃pXɓnhg)
+	VkRenderPass renderPass;
+	uint32_t subpass;
+
+	uint64_t GetHash() const;
+
+	// SĂ̒l (nbVՓ˂ꍇɕʂ̏ԂƋʂ)
+	bool operator==(const GraphicsPipelineState& other) const;
+};
+
+
+// pCvC̐`悩؂藣
+// Ԃ̗v1ɂ܂Ƃ߁Â̂̓[J[XbhŋLVkPipelineCachegĐ
+// I܂łGettH[obN (w肵ꍇ) VK_NULL_HANDLEԂ̂ŁA̕`͔΂
+// pCvCTerminate܂ŕێ
+class PipelineManager
+{
+public:
+	using Key = uint64_t;
+
+	struct Stats
+	{
+		uint32_t requestCount;		// RequesťĂяo
+		uint32_t dedupedCount;		// ̂̂ɂ܂Ƃ߂
+		uint32_t compiledCount;		// ɐ
+		uint32_t failedCount;
+		double compileMs;			// [J[Xbhł̐Ԃ̍v
+	};
+
+	PipelineManager();
+	~PipelineManager();
+
+	// threadCount0̏ꍇ̓RA猈߂
+	void Initialize(VkDevice device, VkPipelineCache pipelineCache, uint32_t threadCount);
+	void Terminate();
+
+	// ̗v (ǂ̃XbhĂׂ)
+	// L[͏Ԃ̃nbVŁAʂ̏ԂƃnbVՓ˂ꍇ͋󂢂Ă鎟̒lɂ
+	// fallback͐I܂GetɕԂpCvC̃L[ (0̏ꍇ͂Ȃ)
+	Key Request(const GraphicsPipelineState& state, Key fallback = 0);
+
+	// ς݂̃pCvC (܂̏ꍇ̓tH[obNAȂꍇVK_NULL_HANDLE)
+	// ҂ɕԂ̂ŁAt[̋L^ɌĂł悢
+	VkPipeline Get(Key key) const;
+	bool IsReady(Key key) const;
+
+	// vς݂̑SĂ̐I܂ő҂ ([hʂȂǂŎg)
+	void WaitIdle();
+
+	uint32_t GetPendingCount() const;
+	Stats GetStats() const;
+
+private:
+	struct Entry
+	{
+		GraphicsPipelineState state;
+		Key fallback;
+		VkPipeline pipeline;		// ɎsꍇVK_NULL_HANDLÊ܂
+	};
+
+	VkPipeline Compile(const GraphicsPipelineState& state) const;
+	void WorkerMain();
+
+	VkDevice _device;
+	VkPipelineCache _pipelineCache;
+
+	mutable std::mutex _mutex;
+	std::map<Key, std::unique_ptr<Entry>> _entries;
+	std::deque<Key> _queue;
+	uint32_t _compilingCount;
+	Stats _stats;
+
+	std::vector<std::thread> _workers;
+	std::condition_variable _queueCondition;
+	std::condition_variable _idleCondition;
+	bool _quit;
+};
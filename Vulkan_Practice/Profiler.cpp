@@ -0,0 +1,314 @@
+#include "Profiler.h"
+
+#include <algorithm>
+#include <fstream>
+
+
+//---------------------------------------------------
+//	FrameTimeHistogram
+//---------------------------------------------------
+FrameTimeHistogram::FrameTimeHistogram(size_t capacity) : _samples(capacity), _next(0), _count(0)
+{
+}
+
+// vl̒ǉ (eʂ𒴂Â̂㏑)
+void FrameTimeHistogram::Add(double ms)
+{
+	_samples[_next] = ms;
+	_next = (_next + 1) % _samples.size();
+	_count = (std::min)(_count + 1, _samples.size());
+}
+
+void FrameTimeHistogram::Clear()
+{
+	_next = 0;
+	_count = 0;
+}
+
+// p[Z^C̎擾
+double FrameTimeHistogram::Percentile(double p) const
+{
+	if (_count == 0)
+	{
+		return 0.0;
+	}
+
+	std::vector<double> sorted(_samples.begin(), _samples.begin() + _count);
+	auto rank = size_t(p / 100.0 * double(_count - 1) + 0.5);
+	rank = (std::min)(rank, _count - 1);
+	std::nth_element(sorted.begin(), sorted.begin() + rank, sorted.end());
+	return sorted[rank];
+}
+
+double FrameTimeHistogram::Average() const
+{
+	if (_count == 0)
+	{
+		return 0.0;
+	}
+
+	double sum = 0.0;
+	for (size_t i = 0; i < _count; ++i)
+	{
+		sum += _samples[i];
+	}
+	return sum / double(_count);
+}
+
+double FrameTimeHistogram::Max() const
+{
+	if (_count == 0)
+	{
+		return 0.0;
+	}
+	return *std::max_element(_samples.begin(), _samples.begin() + _count);
+}
+
+
+//---------------------------------------------------
+//	Profiler
+//---------------------------------------------------
+Profiler::Profiler() : _device(VK_NULL_HANDLE), _gpuTimestampSupported(false), _timestampPeriod(1.0), _timestampMask(~0ull), _currentFrame(0)
+{
+}
+
+// NGv[̐
+void Profiler::Initialize(VkPhysicalDevice physicalDevice, VkDevice device, uint32_t queueFamilyIndex, uint32_t framesInFlight)
+{
+	_device = device;
+
+	// ^CX^vg邩mF
+	VkPhysicalDeviceProperties props;
+	vkGetPhysicalDeviceProperties(physicalDevice, &props);
+	_timestampPeriod = double(props.limits.timestampPeriod);
+
+	uint32_t count = 0;
+	vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &count, nullptr);
+	std::vector<VkQueueFamilyProperties> queueProps(count);
+	vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &count, queueProps.data());
+
+	const auto validBits = queueProps[queueFamilyIndex].timestampValidBits;
+	_gpuTimestampSupported = validBits > 0 && props.limits.timestampPeriod > 0.0f;
+	_timestampMask = validBits >= 64 ? ~0ull : ((1ull << validBits) - 1);
+
+	// t[Ƃ̃NGv[
+	_frames.resize(framesInFlight);
+	for (auto& v : _frames)
+	{
+		v.queryPool = VK_NULL_HANDLE;
+		v.queryCount = 0;
+		if (!_gpuTimestampSupported)
+		{
+			continue;
+		}
+
+		VkQueryPoolCreateInfo ci{};
+		ci.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+		ci.queryType = VK_QUERY_TYPE_TIMESTAMP;
+		ci.queryCount = MaxQueriesPerFrame;
+		vkCreateQueryPool(_device, &ci, nullptr, &v.queryPool);
+	}
+}
+
+// NGv[̔j
+void Profiler::Terminate()
+{
+	for (auto& v : _frames)
+	{
+		if (v.queryPool != VK_NULL_HANDLE)
+		{
+			vkDestroyQueryPool(_device, v.queryPool, nullptr);
+		}
+	}
+	_frames.clear();
+}
+
+// t[̊Jn
+void Profiler::BeginFrame(VkCommandBuffer command, uint32_t frameIndex)
+{
+	_currentFrame = frameIndex;
+	_openGpuScopes.clear();
+
+	if (!_gpuTimestampSupported)
+	{
+		return;
+	}
+
+	// O񂱂̃t[ŏ񂾌ʂĂ烊Zbg
+	ResolveQueries(frameIndex);
+
+	auto& frame = _frames[frameIndex];
+	vkCmdResetQueryPool(command, frame.queryPool, 0, MaxQueriesPerFrame);
+	frame.queryCount = 0;
+	frame.scopes.clear();
+
+	BeginGpuScope(command, "Frame");
+}
+
+// t[̏I
+void Profiler::EndFrame(VkCommandBuffer command)
+{
+	if (!_gpuTimestampSupported)
+	{
+		return;
+	}
+
+	// ĂȂԂŕ
+	while (!_openGpuScopes.empty())
+	{
+		EndGpuScope(command);
+	}
+}
+
+// GPUԂ̊Jn
+void Profiler::BeginGpuScope(VkCommandBuffer command, const char* name)
+{
+	if (!_gpuTimestampSupported)
+	{
+		return;
+	}
+
+	auto& frame = _frames[_currentFrame];
+	if (frame.queryCount + 2 > MaxQueriesPerFrame)
+	{
+		// NGȂꍇ͌vȂ
+		_openGpuScopes.push_back(~size_t(0));
+		return;
+	}
+
+	GpuScope scope;
+	scope.name = name;
+	scope.beginQuery = frame.queryCount++;
+	scope.endQuery = frame.queryCount++;
+	vkCmdWriteTimestamp(command, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, frame.queryPool, scope.beginQuery);
+
+	_openGpuScopes.push_back(frame.scopes.size());
+	frame.scopes.emplace_back(scope);
+}
+
+// GPUԂ̏I
+void Profiler::EndGpuScope(VkCommandBuffer command)
+{
+	if (!_gpuTimestampSupported || _openGpuScopes.empty())
+	{
+		return;
+	}
+
+	auto index = _openGpuScopes.back();
+	_openGpuScopes.pop_back();
+	if (index == ~size_t(0))
+	{
+		return;
+	}
+
+	auto& frame = _frames[_currentFrame];
+	vkCmdWriteTimestamp(command, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, frame.queryPool, frame.scopes[index].endQuery);
+}
+
+// Ǒʂ̉ (ʂĂȂԂ͎̂Ă)
+void Profiler::ResolveQueries(uint32_t frameIndex)
+{
+	auto& frame = _frames[frameIndex];
+	if (frame.queryCount == 0)
+	{
+		return;
+	}
+
+	// [l, availability] ̑gŎ擾
+	std::vector<uint64_t> results(frame.queryCount * 2);
+	vkGetQueryPoolResults(_device, frame.queryPool, 0, frame.queryCount,
+		results.size() * sizeof(uint64_t), results.data(), sizeof(uint64_t) * 2,
+		VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+
+	for (const auto& v : frame.scopes)
+	{
+		const auto* begin = &results[v.beginQuery * 2];
+		const auto* end = &results[v.endQuery * 2];
+		if (begin[1] == 0 || end[1] == 0)
+		{
+			continue;
+		}
+
+		const auto ticks = (end[0] - begin[0]) & _timestampMask;
+		AddSample("gpu:" + v.name, double(ticks) * _timestampPeriod / 1000000.0);
+	}
+}
+
+// CPUԂ̊Jn
+void Profiler::BeginCpuScope(const char* name)
+{
+	CpuScopeEntry entry;
+	entry.name = name;
+	entry.start = std::chrono::steady_clock::now();
+	_openCpuScopes.emplace_back(entry);
+}
+
+// CPUԂ̏I
+void Profiler::EndCpuScope()
+{
+	if (_openCpuScopes.empty())
+	{
+		return;
+	}
+
+	const auto& entry = _openCpuScopes.back();
+	std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - entry.start;
+	AddSample(std::string("cpu:") + entry.name, elapsed.count());
+	_openCpuScopes.pop_back();
+}
+
+// vl̒ǉ
+void Profiler::AddSample(const std::string& name, double ms)
+{
+	_histograms[name].Add(ms);
+}
+
+const FrameTimeHistogram* Profiler::GetHistogram(const std::string& name) const
+{
+	auto it = _histograms.find(name);
+	return it != _histograms.end() ? &it->second : nullptr;
+}
+
+// CSVŏo͂
+bool Profiler::DumpCsv(const char* path) const
+{
+	std::ofstream file(path);
+	if (!file)
+	{
+		return false;
+	}
+
+	file << "name,count,avg_ms,p50_ms,p95_ms,p99_ms,max_ms\n";
+	for (const auto& v : _histograms)
+	{
+		const auto& h = v.second;
+		file << v.first << ',' << h.Count() << ',' << h.Average() << ','
+			<< h.Percentile(50.0) << ',' << h.Percentile(95.0) << ',' << h.Percentile(99.0) << ',' << h.Max() << '\n';
+	}
+	return bool(file);
+}
+
+// JSONŏo͂
+bool Profiler::DumpJson(const char* path) const
+{
+	std::ofstream file(path);
+	if (!file)
+	{
+		return false;
+	}
+
+	file << "{\n  \"scopes\": [";
+	bool first = true;
+	for (const auto& v : _histograms)
+	{
+		const auto& h = v.second;
+		file << (first ? "\n" : ",\n");
+		file << "    { \"name\": \"" << v.first << "\", \"count\": " << h.Count()
+			<< ", \"avg_ms\": " << h.Average() << ", \"p50_ms\": " << h.Percentile(50.0)
+			<< ", \"p95_ms\": " << h.Percentile(95.0) << ", \"p99_ms\": " << h.Percentile(99.0)
+			<< ", \"max_ms\": " << h.Max() << " }";
+		first = false;
+	}
+	file << "\n  ]\n}\n";
+	return bool(file);
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <vector>
+#include <map>
+#include <string>
+#include <chrono>
+
+// ߂̌vlێAp[Z^C߂
+class FrameTimeHistogram
+{
+public:
+	explicit FrameTimeHistogram(size_t capacity = 1024);
+
+	void Add(double ms);
+	void Clear();
+
+	// p  0`100
+	double Percentile(double p) const;
+	double Average() const;
+	double Max() const;
+	size_t Count() const { return _count; }
+
+private:
+	std::vector<double> _samples;
+	size_t _next;
+	size_t _count;
+};
+
+
+// GPŨ^CX^vCPŰԌvȂ
+class Profiler
+{
+public:
+	Profiler();
+
+	void Initialize(VkPhysicalDevice physicalDevice, VkDevice device, uint32_t queueFamilyIndex, uint32_t framesInFlight);
+	void Terminate();
+
+	// t[̊JnƏI (R}hobt@̋L^A_[pX̊OŌĂ)
+	// BeginFrameł͂̃t[p̃NG̑Ǒʂ
+	// (t[fence҂ɌĂԂ߁Aʂ̑҂͔Ȃ)
+	void BeginFrame(VkCommandBuffer command, uint32_t frameIndex);
+	void EndFrame(VkCommandBuffer command);
+
+	// GPŰԌv
+	void BeginGpuScope(VkCommandBuffer command, const char* name);
+	void EndGpuScope(VkCommandBuffer command);
+
+	// CPŰԌv
+	void BeginCpuScope(const char* name);
+	void EndCpuScope();
+
+	// XR[v𔲂܂łCPUԂƂČv
+	class CpuScope
+	{
+	public:
+		CpuScope(Profiler& profiler, const char* name) : _profiler(profiler) { _profiler.BeginCpuScope(name); }
+		~CpuScope() { _profiler.EndCpuScope(); }
+	private:
+		Profiler& _profiler;
+	};
+
+	// v ("cpu:O" / "gpu:O" œo^)
+	const FrameTimeHistogram* GetHistogram(const std::string& name) const;
+	const std::map<std::string, FrameTimeHistogram>& GetHistograms() const { return _histograms; }
+	void AddSample(const std::string& name, double ms);
+	void ClearSamples() { _histograms.clear(); }
+
+	// vʂ̏o
+	bool DumpCsv(const char* path) const;
+	bool DumpJson(const char* path) const;
+
+private:
+	void ResolveQueries(uint32_t frameIndex);
+
+	static const uint32_t MaxQueriesPerFrame = 64;
+
+	struct GpuScope
+	{
+		std::string name;
+		uint32_t beginQuery;
+		uint32_t endQuery;
+	};
+
+	struct FrameQueries
+	{
+		VkQueryPool queryPool;
+		uint32_t queryCount;
+		std::vector<GpuScope> scopes;
+	};
+
+	struct CpuScopeEntry
+	{
+		const char* name;
+		std::chrono::steady_clock::time_point start;
+	};
+
+	VkDevice _device;
+	bool _gpuTimestampSupported;
+	double _timestampPeriod;
+	uint64_t _timestampMask;
+
+	std::vector<FrameQueries> _frames;
+	uint32_t _currentFrame;
+	std::vector<size_t> _openGpuScopes;
+
+	std::vector<CpuScopeEntry> _openCpuScopes;
+
+	std::map<std::string, FrameTimeHistogram> _histograms;
+};
@@ -0,0 +1,1392 @@
+#include "RenderGraph.h"
+
+#include <algorithm>
+
+namespace
+{
+	// ݂ƂĈANZX
+	const VkAccessFlags WriteAccessMask = VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
+		VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_HOST_WRITE_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+
+	// TupX̑g̈ˑ֌W͂܂Ƃ߂
+	void AddDependency(std::vector<VkSubpassDependency>& dependencies, uint32_t srcSubpass, uint32_t dstSubpass,
+		VkPipelineStageFlags srcStages, VkAccessFlags srcAccess, VkPipelineStageFlags dstStages, VkAccessFlags dstAccess)
+	{
+		for (auto& v : dependencies)
+		{
+			if (v.srcSubpass == srcSubpass && v.dstSubpass == dstSubpass)
+			{
+				v.srcStageMask |= srcStages;
+				v.srcAccessMask |= srcAccess;
+				v.dstStageMask |= dstStages;
+				v.dstAccessMask |= dstAccess;
+				return;
+			}
+		}
+
+		VkSubpassDependency dependency{};
+		dependency.srcSubpass = srcSubpass;
+		dependency.dstSubpass = dstSubpass;
+		dependency.srcStageMask = srcStages;
+		dependency.srcAccessMask = srcAccess;
+		dependency.dstStageMask = dstStages;
+		dependency.dstAccessMask = dstAccess;
+
+		// TupXԂ̓sNZPʂ̈ˑő (^CŊł)
+		dependency.dependencyFlags = srcSubpass != VK_SUBPASS_EXTERNAL ? VkDependencyFlags(VK_DEPENDENCY_BY_REGION_BIT) : 0;
+		dependencies.emplace_back(dependency);
+	}
+}
+
+
+//---------------------------------------------------
+//	RenderGraph::Pass
+//---------------------------------------------------
+RenderGraph::Pass& RenderGraph::Pass::AddUse(Resource resource, UseType type, VkPipelineStageFlags stages, VkAccessFlags access, bool write)
+{
+	Use use{};
+	use.resource = resource;
+	use.type = type;
+	use.stages = stages;
+	use.access = access;
+	use.write = write;
+	use.clear = false;
+	_uses.emplace_back(use);
+	return *this;
+}
+
+RenderGraph::Pass& RenderGraph::Pass::WriteColor(Resource resource, const VkClearColorValue* clear)
+{
+	AddUse(resource, UseType::ColorWrite, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+		VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, true);
+	if (clear != nullptr)
+	{
+		_uses.back().clear = true;
+		_uses.back().clearValue.color = *clear;
+	}
+	return *this;
+}
+
+RenderGraph::Pass& RenderGraph::Pass::WriteDepth(Resource resource, const VkClearDepthStencilValue* clear)
+{
+	AddUse(resource, UseType::DepthWrite, VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+		VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT, true);
+	if (clear != nullptr)
+	{
+		_uses.back().clear = true;
+		_uses.back().clearValue.depthStencil = *clear;
+	}
+	return *this;
+}
+
+RenderGraph::Pass& RenderGraph::Pass::ReadDepth(Resource resource)
+{
+	return AddUse(resource, UseType::DepthRead, VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+		VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT, false);
+}
+
+RenderGraph::Pass& RenderGraph::Pass::ReadInputAttachment(Resource resource)
+{
+	return AddUse(resource, UseType::InputAttachment, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_INPUT_ATTACHMENT_READ_BIT, false);
+}
+
+RenderGraph::Pass& RenderGraph::Pass::ReadTexture(Resource resource, VkPipelineStageFlags stages)
+{
+	return AddUse(resource, UseType::Texture, stages, VK_ACCESS_SHADER_READ_BIT, false);
+}
+
+RenderGraph::Pass& RenderGraph::Pass::ReadStorage(Resource resource, VkPipelineStageFlags stages)
+{
+	return AddUse(resource, UseType::StorageRead, stages, VK_ACCESS_SHADER_READ_BIT, false);
+}
+
+RenderGraph::Pass& RenderGraph::Pass::WriteStorage(Resource resource, VkPipelineStageFlags stages)
+{
+	return AddUse(resource, UseType::StorageWrite, stages, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT, true);
+}
+
+RenderGraph::Pass& RenderGraph::Pass::ReadBuffer(Resource resource, VkPipelineStageFlags stages, VkAccessFlags access)
+{
+	return AddUse(resource, UseType::Buffer, stages, access, false);
+}
+
+RenderGraph::Pass& RenderGraph::Pass::WriteBuffer(Resource resource, VkPipelineStageFlags stages, VkAccessFlags access)
+{
+	return AddUse(resource, UseType::Buffer, stages, access, true);
+}
+
+RenderGraph::Pass& RenderGraph::Pass::SetExecute(const ExecuteFunction& execute)
+{
+	_execute = execute;
+	return *this;
+}
+
+
+//---------------------------------------------------
+//	RenderGraph
+//---------------------------------------------------
+RenderGraph::RenderGraph() : _device(VK_NULL_HANDLE), _allocator(nullptr), _extent{}, _aliasStages(0), _aliasAccess(0)
+{
+}
+
+void RenderGraph::Initialize(VkDevice device, MemoryAllocator* allocator)
+{
+	_device = device;
+	_allocator = allocator;
+}
+
+// IuWFNgƐ錾̔j
+void RenderGraph::Terminate()
+{
+	ReleasePhysicalResources(nullptr);
+	ReleaseRenderPasses(nullptr);
+
+	_resources.clear();
+	_passes.clear();
+	_steps.clear();
+	_passSteps.clear();
+	_passSubpasses.clear();
+	_finalBarriers.clear();
+}
+
+// OtC[W̐錾
+RenderGraph::Resource RenderGraph::CreateImage(const char* name, const ImageDesc& desc)
+{
+	ResourceInfo info;
+	info.name = name;
+	info.desc = desc;
+	_resources.emplace_back(info);
+	return Resource(_resources.size() - 1);
+}
+
+// ÕC[W̐錾
+RenderGraph::Resource RenderGraph::ImportImage(const char* name, VkFormat format, VkImageLayout initialLayout, VkImageLayout finalLayout,
+	VkPipelineStageFlags availableStage)
+{
+	ResourceInfo info;
+	info.name = name;
+	info.imported = true;
+	info.desc.format = format;
+	info.importInitialLayout = initialLayout;
+	info.importFinalLayout = finalLayout;
+	info.importStage = availableStage;
+	_resources.emplace_back(info);
+	return Resource(_resources.size() - 1);
+}
+
+// Õobt@̐錾
+RenderGraph::Resource RenderGraph::ImportBuffer(const char* name)
+{
+	ResourceInfo info;
+	info.name = name;
+	info.imported = true;
+	info.isBuffer = true;
+	_resources.emplace_back(info);
+	return Resource(_resources.size() - 1);
+}
+
+RenderGraph::Pass& RenderGraph::AddGraphicsPass(const char* name)
+{
+	_passes.emplace_back();
+	auto& pass = _passes.back();
+	pass._name = name;
+	pass._index = uint32_t(_passes.size() - 1);
+	pass._compute = false;
+	pass._secondary = false;
+	return pass;
+}
+
+RenderGraph::Pass& RenderGraph::AddComputePass(const char* name)
+{
+	auto& pass = AddGraphicsPass(name);
+	pass._compute = true;
+	return pass;
+}
+
+// 錾烌_[pXƃC[W𐶐
+bool RenderGraph::Compile(VkExtent2D extent, std::vector<std::function<void()>>* retired)
+{
+	ReleasePhysicalResources(retired);
+	ReleaseRenderPasses(retired);
+	_extent = extent;
+
+	if (!BuildSteps())
+	{
+		return false;
+	}
+	AnalyzeResources();
+
+	// 2ǂAt[܂Ŏg\[X̏ԂԂɂ
+	std::vector<ResourceState> states(_resources.size());
+	Simulate(states);
+	Simulate(states);
+
+	if (!CreateRenderPasses())
+	{
+		return false;
+	}
+	return CreatePhysicalResources();
+}
+
+// TCYɈˑIuWFNg蒼
+bool RenderGraph::Resize(VkExtent2D extent, std::vector<std::function<void()>>* retired)
+{
+	ReleasePhysicalResources(retired);
+	_extent = extent;
+	return CreatePhysicalResources();
+}
+
+void RenderGraph::SetImportedImage(Resource resource, VkImage image, VkImageView view, UploadTicket upload)
+{
+	auto& info = _resources[resource];
+	info.image = image;
+	info.view = view;
+	info.extent = _extent;
+	info.upload = upload;
+}
+
+void RenderGraph::SetImportedBuffer(Resource resource, VkBuffer buffer, UploadTicket upload)
+{
+	auto& info = _resources[resource];
+	info.buffer = buffer;
+	info.upload = upload;
+}
+
+// ]҂Xe[ẂÃ\[XgSẴpX̃Xe[W
+void RenderGraph::RequireUploads(UploadManager& uploadManager)
+{
+	for (uint32_t i = 0; i < uint32_t(_resources.size()); ++i)
+	{
+		auto& info = _resources[i];
+		if (info.upload == 0)
+		{
+			continue;
+		}
+		if (uploadManager.IsComplete(info.upload))
+		{
+			info.upload = 0;
+			continue;
+		}
+
+		VkPipelineStageFlags stages = 0;
+		for (const auto& pass : _passes)
+		{
+			for (const auto& use : pass._uses)
+			{
+				if (use.resource == i)
+				{
+					stages |= GetUseState(use).stages;
+				}
+			}
+		}
+		uploadManager.Require(info.upload, stages);
+	}
+}
+
+// SẴpX̋L^
+void RenderGraph::Execute(VkCommandBuffer command)
+{
+	// Õt[̓eǂރC[ẂAɈxԂ̃CAEg֑Jڂ
+	std::vector<Barrier> initialBarriers;
+	for (uint32_t i = 0; i < uint32_t(_resources.size()); ++i)
+	{
+		auto& info = _resources[i];
+		if (!info.persistent || info.initialized || info.image == VK_NULL_HANDLE)
+		{
+			continue;
+		}
+		info.initialized = true;
+		if (info.startLayout == VK_IMAGE_LAYOUT_UNDEFINED)
+		{
+			continue;
+		}
+
+		Barrier barrier;
+		barrier.resource = i;
+		barrier.srcStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+		barrier.dstStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+		barrier.srcAccess = 0;
+		barrier.dstAccess = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+		barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		barrier.newLayout = info.startLayout;
+		initialBarriers.emplace_back(barrier);
+	}
+	RecordBarriers(command, initialBarriers);
+
+	for (auto& step : _steps)
+	{
+		RecordBarriers(command, step.barriers);
+
+		if (step.compute)
+		{
+			auto& pass = _passes[step.passes[0]];
+			if (pass._execute)
+			{
+				PassContext context{ command, VK_NULL_HANDLE, 0, VK_NULL_HANDLE, _extent };
+				pass._execute(context);
+			}
+			continue;
+		}
+
+		VkRenderPassBeginInfo renderPassBI{};
+		renderPassBI.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+		renderPassBI.renderPass = step.renderPass;
+		renderPassBI.framebuffer = GetFramebuffer(step);
+		renderPassBI.renderArea.offset = VkOffset2D{ 0, 0 };
+		renderPassBI.renderArea.extent = step.extent;
+		renderPassBI.clearValueCount = uint32_t(step.clearValues.size());
+		renderPassBI.pClearValues = step.clearValues.data();
+
+		for (uint32_t i = 0; i < uint32_t(step.passes.size()); ++i)
+		{
+			auto& pass = _passes[step.passes[i]];
+			const auto contents = pass._secondary ? VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS : VK_SUBPASS_CONTENTS_INLINE;
+			if (i == 0)
+			{
+				vkCmdBeginRenderPass(command, &renderPassBI, contents);
+			}
+			else
+			{
+				vkCmdNextSubpass(command, contents);
+			}
+
+			if (pass._execute)
+			{
+				PassContext context{ command, step.renderPass, i, renderPassBI.framebuffer, step.extent };
+				pass._execute(context);
+			}
+		}
+		vkCmdEndRenderPass(command);
+	}
+
+	RecordBarriers(command, _finalBarriers);
+}
+
+VkRenderPass RenderGraph::GetRenderPass(uint32_t pass) const
+{
+	return pass < _passSteps.size() ? _steps[_passSteps[pass]].renderPass : VK_NULL_HANDLE;
+}
+
+uint32_t RenderGraph::GetSubpass(uint32_t pass) const
+{
+	return pass < _passSubpasses.size() ? _passSubpasses[pass] : 0;
+}
+
+VkImageView RenderGraph::GetImageMipView(Resource resource, uint32_t mip) const
+{
+	const auto& info = _resources[resource];
+	if (info.mipViews.empty())
+	{
+		return mip == 0 ? info.view : VK_NULL_HANDLE;
+	}
+	return mip < info.mipViews.size() ? info.mipViews[mip] : VK_NULL_HANDLE;
+}
+
+uint32_t RenderGraph::GetTransientCount() const
+{
+	uint32_t count = 0;
+	for (const auto& v : _resources)
+	{
+		count += v.transient ? 1 : 0;
+	}
+	return count;
+}
+
+uint32_t RenderGraph::GetAliasedCount() const
+{
+	uint32_t count = 0;
+	for (const auto& v : _slots)
+	{
+		count += v.resources.size() > 1 ? uint32_t(v.resources.size()) : 0;
+	}
+	return count;
+}
+
+// pX_[pX(Xebv)ɂ܂Ƃ߂
+// ÕpX񂾌ʂVF[_[ǂޏꍇAA^b`g̃TCYႤꍇ͐V_[pXɂ
+bool RenderGraph::BuildSteps()
+{
+	struct StepUse
+	{
+		bool attachment;
+		bool write;
+		VkImageLayout layout;
+	};
+
+	_steps.clear();
+	_passSteps.assign(_passes.size(), 0);
+	_passSubpasses.assign(_passes.size(), 0);
+
+	std::map<Resource, StepUse> stepUses;
+	auto sizeReference = InvalidResource;
+	for (uint32_t i = 0; i < uint32_t(_passes.size()); ++i)
+	{
+		const auto& pass = _passes[i];
+		for (const auto& u : pass._uses)
+		{
+			if (u.resource >= _resources.size() || (u.type == Pass::UseType::Buffer) != _resources[u.resource].isBuffer)
+			{
+				return false;
+			}
+			if (pass._compute && IsAttachmentUse(u.type))
+			{
+				return false;
+			}
+		}
+
+		auto merge = !_steps.empty() && !_steps.back().compute && !pass._compute;
+		for (const auto& u : pass._uses)
+		{
+			if (!merge)
+			{
+				break;
+			}
+
+			const auto attachment = IsAttachmentUse(u.type);
+			if (attachment && sizeReference != InvalidResource && !IsSameSize(u.resource, sizeReference))
+			{
+				merge = false;
+				break;
+			}
+
+			auto it = stepUses.find(u.resource);
+			if (it == stepUses.end())
+			{
+				continue;
+			}
+
+			// A^b`gƃVF[_[̃ANZX͍Ȃ
+			// VF[_[̃ANZX͓ǂނŁACAEgꍇ̂ݓ_[pXɓ
+			const auto& prev = it->second;
+			if (attachment != prev.attachment || (!attachment && (prev.write || u.write || prev.layout != GetUseState(u).layout)))
+			{
+				merge = false;
+			}
+		}
+
+		if (!merge)
+		{
+			_steps.emplace_back();
+			_steps.back().compute = pass._compute;
+			stepUses.clear();
+			sizeReference = InvalidResource;
+		}
+
+		auto& step = _steps.back();
+		_passSteps[i] = uint32_t(_steps.size() - 1);
+		_passSubpasses[i] = uint32_t(step.passes.size());
+		step.passes.push_back(i);
+
+		for (const auto& u : pass._uses)
+		{
+			const auto attachment = IsAttachmentUse(u.type);
+			StepUse use{ attachment, false, GetUseState(u).layout };
+			auto result = stepUses.insert(std::make_pair(u.resource, use));
+			result.first->second.write |= u.write;
+
+			if (attachment)
+			{
+				if (sizeReference == InvalidResource)
+				{
+					sizeReference = u.resource;
+				}
+				if (std::find(step.attachments.begin(), step.attachments.end(), u.resource) == step.attachments.end())
+				{
+					step.attachments.push_back(u.resource);
+				}
+			}
+		}
+	}
+	return true;
+}
+
+// \[X̎gpԂƗpr𒲂ׂ
+void RenderGraph::AnalyzeResources()
+{
+	for (auto& v : _resources)
+	{
+		v.usage = 0;
+		v.firstStep = ~0u;
+		v.lastStep = 0;
+		v.persistent = false;
+		v.transient = false;
+		v.slot = ~0u;
+	}
+
+	std::vector<bool> attachmentOnly(_resources.size(), true);
+	for (uint32_t s = 0; s < uint32_t(_steps.size()); ++s)
+	{
+		for (auto p : _steps[s].passes)
+		{
+			for (const auto& u : _passes[p]._uses)
+			{
+				auto& info = _resources[u.resource];
+				if (info.firstStep == ~0u)
+				{
+					info.firstStep = s;
+
+					// ŏɑO̓eǂރC[ẂAt[܂œeێ
+					if (!info.imported && !info.isBuffer)
+					{
+						info.persistent = !(u.clear || u.type == Pass::UseType::StorageWrite);
+					}
+				}
+				info.lastStep = s;
+
+				switch (u.type)
+				{
+				case Pass::UseType::ColorWrite:
+					info.usage |= VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+					break;
+				case Pass::UseType::DepthWrite:
+				case Pass::UseType::DepthRead:
+					info.usage |= VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+					break;
+				case Pass::UseType::InputAttachment:
+					info.usage |= VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT;
+					break;
+				case Pass::UseType::Texture:
+					info.usage |= VK_IMAGE_USAGE_SAMPLED_BIT;
+					break;
+				case Pass::UseType::StorageRead:
+				case Pass::UseType::StorageWrite:
+					info.usage |= VK_IMAGE_USAGE_STORAGE_BIT;
+					break;
+				default:
+					break;
+				}
+
+				if (!IsAttachmentUse(u.type))
+				{
+					attachmentOnly[u.resource] = false;
+				}
+			}
+		}
+	}
+
+	// 1̃_[pXŃA^b`gƂĂgC[W̓ɏoȂ
+	for (uint32_t i = 0; i < uint32_t(_resources.size()); ++i)
+	{
+		auto& info = _resources[i];
+		info.transient = !info.imported && !info.isBuffer && !info.persistent && info.desc.usage == 0 &&
+			info.firstStep != ~0u && info.firstStep == info.lastStep && !_steps[info.firstStep].compute && attachmentOnly[i];
+		if (info.transient)
+		{
+			info.usage |= VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT;
+		}
+	}
+
+	// LC[WgXe[W
+	_aliasStages = 0;
+	_aliasAccess = 0;
+	for (const auto& pass : _passes)
+	{
+		for (const auto& u : pass._uses)
+		{
+			if (IsAliasable(u.resource))
+			{
+				_aliasStages |= u.stages;
+				_aliasAccess |= u.write ? (u.access & WriteAccessMask) : 0;
+			}
+		}
+	}
+}
+
+// t[̊Jñ\[X̏
+RenderGraph::ResourceState RenderGraph::GetStartState(Resource resource, const ResourceState& endState) const
+{
+	const auto& info = _resources[resource];
+	ResourceState state;
+
+	// obt@ƑO̓eǂރC[W͑Õt[̍Ō̏Ԃ瑱
+	if (info.isBuffer || info.persistent)
+	{
+		state = endState;
+		state.valid = true;
+		return state;
+	}
+
+	if (info.imported)
+	{
+		state.layout = info.importInitialLayout;
+		state.writeStages = info.importStage;
+		state.valid = info.importInitialLayout != VK_IMAGE_LAYOUT_UNDEFINED;
+		return state;
+	}
+
+	// e͈pȂAOɓgANZX̊͑҂
+	if (IsAliasable(resource))
+	{
+		state.writeStages = _aliasStages;
+		state.writeAccess = _aliasAccess;
+	}
+	else
+	{
+		state.writeStages = endState.writeStages | endState.readStages;
+		state.writeAccess = endState.writeAccess;
+	}
+	return state;
+}
+
+// t[1ǂAoAAload/store opATupẌˑ֌W߂
+// statesɂ͑O̎̍Ō̏ԂnA̎̍Ō̏ԂԂ
+void RenderGraph::Simulate(std::vector<ResourceState>& states)
+{
+	std::vector<ResourceState> current(_resources.size());
+	for (uint32_t i = 0; i < uint32_t(_resources.size()); ++i)
+	{
+		current[i] = GetStartState(i, states[i]);
+		_resources[i].startLayout = current[i].layout;
+	}
+
+	for (uint32_t s = 0; s < uint32_t(_steps.size()); ++s)
+	{
+		auto& step = _steps[s];
+		step.barriers.clear();
+		step.attachmentDescs.clear();
+		step.dependencies.clear();
+
+		// VF[_[̃ANZX̓Xebv̑ÕoAœ
+		for (auto p : step.passes)
+		{
+			for (const auto& u : _passes[p]._uses)
+			{
+				if (!IsAttachmentUse(u.type))
+				{
+					AddBarrier(step.barriers, u.resource, current[u.resource], GetUseState(u), u.write);
+				}
+			}
+		}
+
+		if (step.compute)
+		{
+			continue;
+		}
+
+		// A^b`g̓_[pX̃CAEgJڂƈˑ֌Wœ
+		const auto subpassCount = uint32_t(step.passes.size());
+		// J[input attachment̎QƂ́AVF[_[locationinput_attachment_indexɍ킹WriteColorEReadInputAttachmentĂ񂾏ɕׂ
+		step.colorReferences.assign(subpassCount, std::vector<VkAttachmentReference>());
+		step.inputReferences.assign(subpassCount, std::vector<VkAttachmentReference>());
+		for (uint32_t i = 0; i < subpassCount; ++i)
+		{
+			const auto& uses = _passes[step.passes[i]]._uses;
+			const auto unused = VkAttachmentReference{ VK_ATTACHMENT_UNUSED, VK_IMAGE_LAYOUT_UNDEFINED };
+			step.colorReferences[i].assign(std::count_if(uses.begin(), uses.end(),
+				[](const Pass::Use& u) { return u.type == Pass::UseType::ColorWrite; }), unused);
+			step.inputReferences[i].assign(std::count_if(uses.begin(), uses.end(),
+				[](const Pass::Use& u) { return u.type == Pass::UseType::InputAttachment; }), unused);
+		}
+		step.depthReferences.assign(subpassCount, VkAttachmentReference{ VK_ATTACHMENT_UNUSED, VK_IMAGE_LAYOUT_UNDEFINED });
+		step.clearValues.assign(step.attachments.size(), VkClearValue{});
+
+		for (uint32_t a = 0; a < uint32_t(step.attachments.size()); ++a)
+		{
+			const auto resource = step.attachments[a];
+			const auto& info = _resources[resource];
+			auto& state = current[resource];
+
+			struct SubpassUse
+			{
+				uint32_t subpass;
+				VkPipelineStageFlags stages;
+				VkAccessFlags access;
+				bool write;
+			};
+			std::vector<SubpassUse> previous;
+
+			VkAttachmentDescription desc{};
+			desc.format = info.desc.format;
+			desc.samples = VK_SAMPLE_COUNT_1_BIT;
+
+			VkPipelineStageFlags allStages = 0;
+			VkAccessFlags writeAccess = 0;
+			VkImageLayout lastLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+			for (uint32_t i = 0; i < subpassCount; ++i)
+			{
+				const auto& pass = _passes[step.passes[i]];
+				for (uint32_t k = 0; k < uint32_t(pass._uses.size()); ++k)
+				{
+					const auto& u = pass._uses[k];
+					if (u.resource != resource || !IsAttachmentUse(u.type))
+					{
+						continue;
+					}
+
+					const auto use = GetUseState(u);
+					const VkAttachmentReference reference{ a, use.layout };
+					switch (u.type)
+					{
+					case Pass::UseType::ColorWrite:
+						step.colorReferences[i][GetAttachmentSlot(pass, k)] = reference;
+						break;
+					case Pass::UseType::InputAttachment:
+						step.inputReferences[i][GetAttachmentSlot(pass, k)] = reference;
+						break;
+					default:
+						step.depthReferences[i] = reference;
+						break;
+					}
+
+					if (previous.empty())
+					{
+						// ŏ̎gp: NA邩ALȓeꍇǂݍ
+						desc.loadOp = u.clear ? VK_ATTACHMENT_LOAD_OP_CLEAR : (state.valid ? VK_ATTACHMENT_LOAD_OP_LOAD : VK_ATTACHMENT_LOAD_OP_DONT_CARE);
+						desc.initialLayout = desc.loadOp == VK_ATTACHMENT_LOAD_OP_LOAD ? state.layout : VK_IMAGE_LAYOUT_UNDEFINED;
+						if (u.clear)
+						{
+							step.clearValues[a] = u.clearValue;
+						}
+						AddDependency(step.dependencies, VK_SUBPASS_EXTERNAL, i, state.writeStages | state.readStages, state.writeAccess, use.stages, use.access);
+					}
+					else
+					{
+						for (const auto& prev : previous)
+						{
+							if (prev.write || u.write)
+							{
+								AddDependency(step.dependencies, prev.subpass, i, prev.stages, prev.write ? (prev.access & WriteAccessMask) : 0, use.stages, use.access);
+							}
+						}
+					}
+
+					previous.push_back(SubpassUse{ i, use.stages, use.access, u.write });
+					allStages |= use.stages;
+					writeAccess |= u.write ? (use.access & WriteAccessMask) : 0;
+					lastLayout = use.layout;
+				}
+			}
+
+			// ŎgȂA^b`g͏oȂ
+			const auto store = info.lastStep > s || info.imported || info.persistent || info.desc.usage != 0;
+			desc.storeOp = store ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+			desc.stencilLoadOp = HasStencil(info.desc.format) ? desc.loadOp : VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+			desc.stencilStoreOp = HasStencil(info.desc.format) ? desc.storeOp : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+
+			// ÕC[W͍Ō̎gpŎw̃CAEg֑Jڂ
+			const auto toFinal = info.imported && info.lastStep == s && info.importFinalLayout != VK_IMAGE_LAYOUT_UNDEFINED;
+			desc.finalLayout = toFinal ? info.importFinalLayout : lastLayout;
+			step.attachmentDescs.push_back(desc);
+
+			state.layout = desc.finalLayout;
+			state.writeStages = allStages;
+			state.writeAccess = writeAccess;
+			state.readStages = allStages;
+			state.visibleStages = 0;
+			state.valid = store;
+		}
+	}
+
+	// VF[_[̃ANZXŏIÕC[Ww̃CAEg֖߂
+	_finalBarriers.clear();
+	for (uint32_t i = 0; i < uint32_t(_resources.size()); ++i)
+	{
+		const auto& info = _resources[i];
+		if (!info.imported || info.isBuffer || info.firstStep == ~0u || info.importFinalLayout == VK_IMAGE_LAYOUT_UNDEFINED ||
+			current[i].layout == info.importFinalLayout)
+		{
+			continue;
+		}
+
+		const UseState use{ info.importFinalLayout, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0 };
+		AddBarrier(_finalBarriers, i, current[i], use, false);
+	}
+
+	states.swap(current);
+}
+
+// KvȏꍇoAǉA\[X̏ԂXV
+void RenderGraph::AddBarrier(std::vector<Barrier>& barriers, Resource resource, ResourceState& state, const UseState& use, bool write)
+{
+	const auto& info = _resources[resource];
+	const auto layoutChange = !info.isBuffer && state.layout != use.layout;
+	const auto previousAccess = (state.writeStages | state.readStages) != 0;
+
+	// CAEgJځAݑO̓ǂݏ̊҂A݌ʂ̉
+	const auto transition = layoutChange || (write && previousAccess);
+	const auto visibility = state.writeStages != 0 && (use.stages & ~state.visibleStages) != 0;
+	if (transition || visibility)
+	{
+		Barrier barrier;
+		barrier.resource = resource;
+		barrier.srcStage = transition ? (state.writeStages | state.readStages) : state.writeStages;
+		barrier.dstStage = use.stages;
+		barrier.srcAccess = state.writeAccess;
+		barrier.dstAccess = use.access;
+		barrier.oldLayout = state.layout;
+		barrier.newLayout = use.layout;
+
+		auto it = std::find_if(barriers.begin(), barriers.end(), [resource](const Barrier& v) { return v.resource == resource; });
+		if (it != barriers.end())
+		{
+			it->srcStage |= barrier.srcStage;
+			it->dstStage |= barrier.dstStage;
+			it->srcAccess |= barrier.srcAccess;
+			it->dstAccess |= barrier.dstAccess;
+			it->newLayout = barrier.newLayout;
+		}
+		else
+		{
+			barriers.emplace_back(barrier);
+		}
+	}
+
+	if (write || layoutChange)
+	{
+		state.writeStages = use.stages;
+		state.writeAccess = write ? (use.access & WriteAccessMask) : 0;
+		state.readStages = write ? 0 : use.stages;
+		state.visibleStages = use.stages;
+	}
+	else
+	{
+		state.readStages |= use.stages;
+		state.visibleStages |= transition || visibility ? use.stages : 0;
+	}
+
+	if (!info.isBuffer)
+	{
+		state.layout = use.layout;
+	}
+	state.valid = state.valid || write;
+}
+
+// _[pX̐
+bool RenderGraph::CreateRenderPasses()
+{
+	for (auto& step : _steps)
+	{
+		if (step.compute)
+		{
+			continue;
+		}
+
+		std::vector<VkSubpassDescription> subpasses(step.passes.size());
+		for (size_t i = 0; i < subpasses.size(); ++i)
+		{
+			auto& v = subpasses[i];
+			v = VkSubpassDescription{};
+			v.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+			v.colorAttachmentCount = uint32_t(step.colorReferences[i].size());
+			v.pColorAttachments = step.colorReferences[i].data();
+			v.inputAttachmentCount = uint32_t(step.inputReferences[i].size());
+			v.pInputAttachments = step.inputReferences[i].data();
+			v.pDepthStencilAttachment = step.depthReferences[i].attachment != VK_ATTACHMENT_UNUSED ? &step.depthReferences[i] : nullptr;
+		}
+
+		// ҂̂Ȃꍇ̓pCvC̐擪
+		for (auto& v : step.dependencies)
+		{
+			if (v.srcStageMask == 0)
+			{
+				v.srcStageMask = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+			}
+		}
+
+		VkRenderPassCreateInfo ci{};
+		ci.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+		ci.attachmentCount = uint32_t(step.attachmentDescs.size());
+		ci.pAttachments = step.attachmentDescs.data();
+		ci.subpassCount = uint32_t(subpasses.size());
+		ci.pSubpasses = subpasses.data();
+		ci.dependencyCount = uint32_t(step.dependencies.size());
+		ci.pDependencies = step.dependencies.data();
+
+		if (vkCreateRenderPass(_device, &ci, nullptr, &step.renderPass) != VK_SUCCESS)
+		{
+			step.renderPass = VK_NULL_HANDLE;
+			return false;
+		}
+	}
+	return true;
+}
+
+// C[W̐ƃ̊蓖
+// gpԂdȂȂC[W͓g
+bool RenderGraph::CreatePhysicalResources()
+{
+	std::vector<VkMemoryRequirements> requirements(_resources.size());
+	std::vector<Resource> images;
+	for (uint32_t i = 0; i < uint32_t(_resources.size()); ++i)
+	{
+		auto& info = _resources[i];
+		info.initialized = false;
+		if (info.imported || info.isBuffer || info.firstStep == ~0u)
+		{
+			continue;
+		}
+		info.extent = GetResourceExtent(i);
+
+		// ~bv̐ (TCY鐔܂)
+		uint32_t maxMipLevels = 1;
+		for (auto size = (std::max)(info.extent.width, info.extent.height); size > 1; size /= 2)
+		{
+			++maxMipLevels;
+		}
+		info.mipLevels = info.desc.mipLevels == 0 ? maxMipLevels : (std::min)(info.desc.mipLevels, maxMipLevels);
+
+		VkImageCreateInfo ci{};
+		ci.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+		ci.imageType = VK_IMAGE_TYPE_2D;
+		ci.format = info.desc.format;
+		ci.extent.width = info.extent.width;
+		ci.extent.height = info.extent.height;
+		ci.extent.depth = 1;
+		ci.mipLevels = info.mipLevels;
+		ci.arrayLayers = 1;
+		ci.samples = VK_SAMPLE_COUNT_1_BIT;
+		ci.tiling = VK_IMAGE_TILING_OPTIMAL;
+		ci.usage = info.usage | info.desc.usage;
+		ci.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		ci.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		if (vkCreateImage(_device, &ci, nullptr, &info.image) != VK_SUCCESS)
+		{
+			info.image = VK_NULL_HANDLE;
+			return false;
+		}
+		vkGetImageMemoryRequirements(_device, info.image, &requirements[i]);
+		images.push_back(i);
+	}
+
+	// 傫̂珇ɁAgpԂdȂȂXbg֓
+	std::stable_sort(images.begin(), images.end(), [&](Resource a, Resource b) { return requirements[a].size > requirements[b].size; });
+	for (auto r : images)
+	{
+		auto& info = _resources[r];
+		const auto aliasable = IsAliasable(r);
+
+		uint32_t slotIndex = ~0u;
+		for (uint32_t i = 0; i < uint32_t(_slots.size()) && aliasable; ++i)
+		{
+			const auto& slot = _slots[i];
+			if (!slot.aliasable || slot.lazy != info.transient || (slot.requirements.memoryTypeBits & requirements[r].memoryTypeBits) == 0)
+			{
+				continue;
+			}
+
+			auto overlap = false;
+			for (auto other : slot.resources)
+			{
+				const auto& v = _resources[other];
+				overlap = overlap || !(v.lastStep < info.firstStep || info.lastStep < v.firstStep);
+			}
+			if (!overlap)
+			{
+				slotIndex = i;
+				break;
+			}
+		}
+
+		if (slotIndex == ~0u)
+		{
+			Slot slot;
+			slot.lazy = info.transient;
+			slot.aliasable = aliasable;
+			slot.requirements = requirements[r];
+			_slots.emplace_back(slot);
+			slotIndex = uint32_t(_slots.size() - 1);
+		}
+		else
+		{
+			auto& slotRequirements = _slots[slotIndex].requirements;
+			slotRequirements.size = (std::max)(slotRequirements.size, requirements[r].size);
+			slotRequirements.alignment = (std::max)(slotRequirements.alignment, requirements[r].alignment);
+			slotRequirements.memoryTypeBits &= requirements[r].memoryTypeBits;
+		}
+		_slots[slotIndex].resources.push_back(r);
+		info.slot = slotIndex;
+	}
+
+	// XbgƂɃmۂAC[WoCh
+	// TRANSIENTȃA^b`gLAZILY_ALLOCATED̃D悷 (^CŊ)
+	for (auto& slot : _slots)
+	{
+		const VkMemoryPropertyFlags preferred = slot.lazy ? VkMemoryPropertyFlags(VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT) : 0;
+		if (!_allocator->Allocate(slot.requirements, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, preferred, MemoryResourceKind::Optimal, slot.allocation))
+		{
+			return false;
+		}
+
+		for (auto r : slot.resources)
+		{
+			auto& info = _resources[r];
+			vkBindImageMemory(_device, info.image, slot.allocation.memory, slot.allocation.offset);
+
+			VkImageViewCreateInfo ci{};
+			ci.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+			ci.viewType = VK_IMAGE_VIEW_TYPE_2D;
+			ci.format = info.desc.format;
+			ci.components = {
+			  VK_COMPONENT_SWIZZLE_R,
+			  VK_COMPONENT_SWIZZLE_G,
+			  VK_COMPONENT_SWIZZLE_B,
+			  VK_COMPONENT_SWIZZLE_A,
+			};
+			ci.subresourceRange = { GetAspect(info.desc.format), 0, info.mipLevels, 0, 1 };
+			ci.image = info.image;
+			if (vkCreateImageView(_device, &ci, nullptr, &info.view) != VK_SUCCESS)
+			{
+				info.view = VK_NULL_HANDLE;
+				return false;
+			}
+
+			// ~bvƂ̃r[ (Xg[WC[Wւ݂̏A^b`gɎg)
+			if (info.mipLevels > 1)
+			{
+				info.mipViews.resize(info.mipLevels, VK_NULL_HANDLE);
+				for (uint32_t mip = 0; mip < info.mipLevels; ++mip)
+				{
+					ci.subresourceRange = { GetAspect(info.desc.format), mip, 1, 0, 1 };
+					if (vkCreateImageView(_device, &ci, nullptr, &info.mipViews[mip]) != VK_SUCCESS)
+					{
+						info.mipViews[mip] = VK_NULL_HANDLE;
+						return false;
+					}
+				}
+			}
+		}
+	}
+
+	// _[pX̃TCY͍ŏ̃A^b`gɍ킹
+	for (auto& step : _steps)
+	{
+		step.extent = step.attachments.empty() ? _extent : GetResourceExtent(step.attachments[0]);
+	}
+	return true;
+}
+
+// TCYɈˑIuWFNg̔j
+void RenderGraph::ReleasePhysicalResources(std::vector<std::function<void()>>* retired)
+{
+	std::vector<VkFramebuffer> framebuffers;
+	for (auto& step : _steps)
+	{
+		for (auto& v : step.framebuffers)
+		{
+			framebuffers.push_back(v.second);
+		}
+		step.framebuffers.clear();
+	}
+
+	std::vector<VkImageView> views;
+	std::vector<VkImage> images;
+	for (auto& v : _resources)
+	{
+		if (v.imported)
+		{
+			continue;
+		}
+		if (v.view != VK_NULL_HANDLE)
+		{
+			views.push_back(v.view);
+		}
+		for (auto view : v.mipViews)
+		{
+			if (view != VK_NULL_HANDLE)
+			{
+				views.push_back(view);
+			}
+		}
+		if (v.image != VK_NULL_HANDLE)
+		{
+			images.push_back(v.image);
+		}
+		v.mipViews.clear();
+		v.view = VK_NULL_HANDLE;
+		v.image = VK_NULL_HANDLE;
+		v.slot = ~0u;
+	}
+
+	std::vector<MemoryAllocation> allocations;
+	for (auto& v : _slots)
+	{
+		if (v.allocation.memory != VK_NULL_HANDLE)
+		{
+			allocations.push_back(v.allocation);
+		}
+	}
+	_slots.clear();
+
+	auto device = _device;
+	auto allocator = _allocator;
+	auto release = [device, allocator, framebuffers, views, images, allocations]() mutable
+	{
+		for (auto& v : framebuffers)
+		{
+			vkDestroyFramebuffer(device, v, nullptr);
+		}
+		for (auto& v : views)
+		{
+			vkDestroyImageView(device, v, nullptr);
+		}
+		for (auto& v : images)
+		{
+			vkDestroyImage(device, v, nullptr);
+		}
+		for (auto& v : allocations)
+		{
+			allocator->Free(v);
+		}
+	};
+
+	if (retired != nullptr)
+	{
+		retired->emplace_back(release);
+	}
+	else
+	{
+		release();
+	}
+}
+
+// _[pX̔j
+void RenderGraph::ReleaseRenderPasses(std::vector<std::function<void()>>* retired)
+{
+	std::vector<VkRenderPass> renderPasses;
+	for (auto& step : _steps)
+	{
+		if (step.renderPass != VK_NULL_HANDLE)
+		{
+			renderPasses.push_back(step.renderPass);
+		}
+		step.renderPass = VK_NULL_HANDLE;
+	}
+
+	auto device = _device;
+	auto release = [device, renderPasses]()
+	{
+		for (auto& v : renderPasses)
+		{
+			vkDestroyRenderPass(device, v, nullptr);
+		}
+	};
+
+	if (retired != nullptr)
+	{
+		retired->emplace_back(release);
+	}
+	else
+	{
+		release();
+	}
+}
+
+// t[obt@̎擾 (ÕC[W̃r[̑gݍ킹ƂɍĂ)
+VkFramebuffer RenderGraph::GetFramebuffer(Step& step)
+{
+	std::vector<VkImageView> views;
+	for (auto r : step.attachments)
+	{
+		views.push_back(GetAttachmentView(r));
+	}
+
+	auto it = step.framebuffers.find(views);
+	if (it != step.framebuffers.end())
+	{
+		return it->second;
+	}
+
+	VkFramebufferCreateInfo ci{};
+	ci.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+	ci.renderPass = step.renderPass;
+	ci.attachmentCount = uint32_t(views.size());
+	ci.pAttachments = views.data();
+	ci.width = step.extent.width;
+	ci.height = step.extent.height;
+	ci.layers = 1;
+
+	VkFramebuffer framebuffer;
+	if (vkCreateFramebuffer(_device, &ci, nullptr, &framebuffer) != VK_SUCCESS)
+	{
+		return VK_NULL_HANDLE;
+	}
+	step.framebuffers.insert(std::make_pair(views, framebuffer));
+	return framebuffer;
+}
+
+// oA̋L^ (XebvƂ1vkCmdPipelineBarrierɂ܂Ƃ߂)
+void RenderGraph::RecordBarriers(VkCommandBuffer command, const std::vector<Barrier>& barriers)
+{
+	if (barriers.empty())
+	{
+		return;
+	}
+
+	VkPipelineStageFlags srcStages = 0;
+	VkPipelineStageFlags dstStages = 0;
+	VkMemoryBarrier memoryBarrier{};
+	memoryBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	std::vector<VkImageMemoryBarrier> imageBarriers;
+	for (const auto& v : barriers)
+	{
+		const auto& info = _resources[v.resource];
+		srcStages |= v.srcStage;
+		dstStages |= v.dstStage;
+
+		// obt@͔͈͂ʂɂ܂Ƃ߂
+		if (info.isBuffer)
+		{
+			memoryBarrier.srcAccessMask |= v.srcAccess;
+			memoryBarrier.dstAccessMask |= v.dstAccess;
+			continue;
+		}
+
+		VkImageMemoryBarrier barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		barrier.srcAccessMask = v.srcAccess;
+		barrier.dstAccessMask = v.dstAccess;
+		barrier.oldLayout = v.oldLayout;
+		barrier.newLayout = v.newLayout;
+		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.image = info.image;
+		barrier.subresourceRange = { GetAspect(info.desc.format), 0, VK_REMAINING_MIP_LEVELS, 0, 1 };
+		imageBarriers.emplace_back(barrier);
+	}
+
+	const auto hasMemoryBarrier = memoryBarrier.srcAccessMask != 0 || memoryBarrier.dstAccessMask != 0;
+	vkCmdPipelineBarrier(command,
+		srcStages != 0 ? srcStages : VkPipelineStageFlags(VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT),
+		dstStages != 0 ? dstStages : VkPipelineStageFlags(VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT),
+		0, hasMemoryBarrier ? 1 : 0, &memoryBarrier, 0, nullptr, uint32_t(imageBarriers.size()), imageBarriers.data());
+}
+
+// gƂ̃CAEgAXe[WAANZX
+RenderGraph::UseState RenderGraph::GetUseState(const Pass::Use& use) const
+{
+	const auto depth = IsDepthFormat(_resources[use.resource].desc.format);
+
+	UseState state{ VK_IMAGE_LAYOUT_UNDEFINED, use.stages, use.access };
+	switch (use.type)
+	{
+	case Pass::UseType::ColorWrite:
+		state.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+		break;
+	case Pass::UseType::DepthWrite:
+		state.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+		break;
+	case Pass::UseType::DepthRead:
+		state.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+		break;
+	case Pass::UseType::InputAttachment:
+	case Pass::UseType::Texture:
+		state.layout = depth ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		break;
+	case Pass::UseType::StorageRead:
+	case Pass::UseType::StorageWrite:
+		state.layout = VK_IMAGE_LAYOUT_GENERAL;
+		break;
+	default:
+		break;
+	}
+	return state;
+}
+
+VkExtent2D RenderGraph::GetResourceExtent(Resource resource) const
+{
+	const auto& info = _resources[resource];
+	if (info.imported)
+	{
+		return _extent;
+	}
+	if (!info.desc.relative)
+	{
+		return info.desc.extent;
+	}
+
+	VkExtent2D extent;
+	extent.width = (std::max)(1u, uint32_t(float(_extent.width) * info.desc.scale));
+	extent.height = (std::max)(1u, uint32_t(float(_extent.height) * info.desc.scale));
+	return extent;
+}
+
+// A^b`gɂ̓~bv0̃r[g
+VkImageView RenderGraph::GetAttachmentView(Resource resource) const
+{
+	const auto& info = _resources[resource];
+	return info.mipViews.empty() ? info.view : info.mipViews[0];
+}
+
+// TCYɓ (`̃TCYɂ炸ɔ肷)
+bool RenderGraph::IsSameSize(Resource a, Resource b) const
+{
+	const auto& descA = _resources[a].desc;
+	const auto& descB = _resources[b].desc;
+	const auto relativeA = _resources[a].imported || descA.relative;
+	const auto relativeB = _resources[b].imported || descB.relative;
+	if (relativeA != relativeB)
+	{
+		return false;
+	}
+	if (relativeA)
+	{
+		const auto scaleA = _resources[a].imported ? 1.0f : descA.scale;
+		const auto scaleB = _resources[b].imported ? 1.0f : descB.scale;
+		return scaleA == scaleB;
+	}
+	return descA.extent.width == descB.extent.width && descA.extent.height == descB.extent.height;
+}
+
+// ̃C[WƃLł邩
+bool RenderGraph::IsAliasable(Resource resource) const
+{
+	const auto& info = _resources[resource];
+	return !info.imported && !info.isBuffer && !info.persistent && info.desc.usage == 0 && info.firstStep != ~0u;
+}
+
+bool RenderGraph::IsAttachmentUse(Pass::UseType type)
+{
+	return type == Pass::UseType::ColorWrite || type == Pass::UseType::DepthWrite ||
+		type == Pass::UseType::DepthRead || type == Pass::UseType::InputAttachment;
+}
+
+// ނ̃A^b`g̎gp̂AԖڂɐ錾ꂽ̂
+uint32_t RenderGraph::GetAttachmentSlot(const Pass& pass, uint32_t useIndex)
+{
+	const auto type = pass._uses[useIndex].type;
+	return uint32_t(std::count_if(pass._uses.begin(), pass._uses.begin() + useIndex, [type](const Pass::Use& u) { return u.type == type; }));
+}
+
+bool RenderGraph::IsDepthFormat(VkFormat format)
+{
+	switch (format)
+	{
+	case VK_FORMAT_D16_UNORM:
+	case VK_FORMAT_X8_D24_UNORM_PACK32:
+	case VK_FORMAT_D32_SFLOAT:
+	case VK_FORMAT_S8_UINT:
+	case VK_FORMAT_D16_UNORM_S8_UINT:
+	case VK_FORMAT_D24_UNORM_S8_UINT:
+	case VK_FORMAT_D32_SFLOAT_S8_UINT:
+		return true;
+	default:
+		return false;
+	}
+}
+
+bool RenderGraph::HasStencil(VkFormat format)
+{
+	switch (format)
+	{
+	case VK_FORMAT_S8_UINT:
+	case VK_FORMAT_D16_UNORM_S8_UINT:
+	case VK_FORMAT_D24_UNORM_S8_UINT:
+	case VK_FORMAT_D32_SFLOAT_S8_UINT:
+		return true;
+	default:
+		return false;
+	}
+}
+
+VkImageAspectFlags RenderGraph::GetAspect(VkFormat format)
+{
+	if (format == VK_FORMAT_S8_UINT)
+	{
+		return VK_IMAGE_ASPECT_STENCIL_BIT;
+	}
+	if (HasStencil(format))
+	{
+		return VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+	}
+	return IsDepthFormat(format) ? VK_IMAGE_ASPECT_DEPTH_BIT : VK_IMAGE_ASPECT_COLOR_BIT;
+}
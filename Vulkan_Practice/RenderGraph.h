@@ -0,0 +1,297 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <vector>
+#include <deque>
+#include <map>
+#include <string>
+#include <functional>
+
+#include "MemoryAllocator.h"
+#include "UploadManager.h"
+
+// pXǂݏ郊\[X錾A_[pXETupẌˑ֌WECAEgJځEload/store op𓱏o
+// AOtBbNXpX1̃_[pX̃TupXɂ܂Ƃ߂
+// (ÕpX̌ʂeNX`Ƃēǂޏꍇ̓_[pX𕪂)
+// 1̃_[pXŎgA^b`gTRANSIENTɂALAZILY_ALLOCATED̃D悷
+// t[ŎgpԂdȂȂC[W̓L
+class RenderGraph
+{
+public:
+	typedef uint32_t Resource;
+	static const Resource InvalidResource = ~0u;
+
+	// OtC[W
+	struct ImageDesc
+	{
+		VkFormat format = VK_FORMAT_UNDEFINED;
+		bool relative = true;		// truȅꍇ͕`̃TCY * scale
+		float scale = 1.0f;
+		VkExtent2D extent = {};		// relativefalsȅꍇ̃TCY
+		VkImageUsageFlags usage = 0;	// pX̐錾ȊOŕKvȗpr (Rs[Ȃ)
+		uint32_t mipLevels = 1;		// 0̏ꍇ̓TCY狁߂SẴ~bv
+	};
+
+	// pX̎sɓn
+	struct PassContext
+	{
+		VkCommandBuffer command;
+		VkRenderPass renderPass;	// Rs[gpXłVK_NULL_HANDLE
+		uint32_t subpass;
+		VkFramebuffer framebuffer;
+		VkExtent2D extent;
+	};
+	using ExecuteFunction = std::function<void(const PassContext& context)>;
+
+	// pX̐錾 (\bh̓`FCł)
+	class Pass
+	{
+	public:
+		// A^b`g (clearnullptȑꍇ͑O̓eǂݍ)
+		Pass& WriteColor(Resource resource, const VkClearColorValue* clear = nullptr);
+		Pass& WriteDepth(Resource resource, const VkClearDepthStencilValue* clear = nullptr);
+		Pass& ReadDepth(Resource resource);
+		Pass& ReadInputAttachment(Resource resource);
+
+		// VF[_[̃ANZX
+		Pass& ReadTexture(Resource resource, VkPipelineStageFlags stages);
+		Pass& ReadStorage(Resource resource, VkPipelineStageFlags stages);
+		Pass& WriteStorage(Resource resource, VkPipelineStageFlags stages);
+
+		// obt@ (ImportBufferœo^)
+		Pass& ReadBuffer(Resource resource, VkPipelineStageFlags stages, VkAccessFlags access);
+		Pass& WriteBuffer(Resource resource, VkPipelineStageFlags stages, VkAccessFlags access);
+
+		Pass& SetExecute(const ExecuteFunction& execute);
+
+		// TupX̓eZJ_R}hobt@ŋL^ (t[ƂɕύXł)
+		void SetSecondaryCommands(bool secondary) { _secondary = secondary; }
+
+		uint32_t GetIndex() const { return _index; }
+		const std::string& GetName() const { return _name; }
+
+	private:
+		friend class RenderGraph;
+
+		enum class UseType
+		{
+			ColorWrite,
+			DepthWrite,
+			DepthRead,
+			InputAttachment,
+			Texture,
+			StorageRead,
+			StorageWrite,
+			Buffer,
+		};
+
+		struct Use
+		{
+			Resource resource;
+			UseType type;
+			VkPipelineStageFlags stages;
+			VkAccessFlags access;
+			bool write;
+			bool clear;
+			VkClearValue clearValue;
+		};
+
+		Pass& AddUse(Resource resource, UseType type, VkPipelineStageFlags stages, VkAccessFlags access, bool write);
+
+		std::string _name;
+		uint32_t _index;
+		bool _compute;
+		bool _secondary;
+		std::vector<Use> _uses;
+		ExecuteFunction _execute;
+	};
+
+	RenderGraph();
+
+	void Initialize(VkDevice device, MemoryAllocator* allocator);
+
+	// IuWFNgƐ錾SĔj
+	void Terminate();
+
+	// \[X̐錾
+	Resource CreateImage(const char* name, const ImageDesc& desc);
+
+	// ÕC[W (swapchainȂ)
+	// availableStage͊OŃC[Wg悤ɂȂXe[W (swapchain̎擾҂Xe[W)
+	Resource ImportImage(const char* name, VkFormat format, VkImageLayout initialLayout, VkImageLayout finalLayout,
+		VkPipelineStageFlags availableStage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
+	Resource ImportBuffer(const char* name);
+
+	// pX̐錾 (錾Ɏs)
+	Pass& AddGraphicsPass(const char* name);
+	Pass& AddComputePass(const char* name);
+	Pass& GetPass(uint32_t index) { return _passes[index]; }
+
+	// 錾烌_[pXȂǂ𐶐Aextentɍ킹ăC[W𐶐
+	// retirednꍇAÂIuWFNg͒ڔjj֐ǉ
+	bool Compile(VkExtent2D extent, std::vector<std::function<void()>>* retired = nullptr);
+
+	// TCYɈˑIuWFNg(C[WAt[obt@)蒼
+	bool Resize(VkExtent2D extent, std::vector<std::function<void()>>* retired = nullptr);
+
+	// Õ\[X̐ݒ (ExecutȇOɃt[Ƃɐݒ肷)
+	// upload̓\[Xւ̓]̃`Pbg (UploadManagerœ]ꍇ)
+	void SetImportedImage(Resource resource, VkImage image, VkImageView view, UploadTicket upload = 0);
+	void SetImportedBuffer(Resource resource, VkBuffer buffer, UploadTicket upload = 0);
+
+	// Õ\[Xւ̓]̂ĂȂ̂A\[XgpX̃Xe[Wő҂悤錾
+	// (UploadManager::RecordAcquirȇOɃt[ƂɌĂ)
+	void RequireUploads(UploadManager& uploadManager);
+
+	// SẴpXL^
+	void Execute(VkCommandBuffer command);
+
+	// ꂽIuWFNg (pCvC̐ȂǂɎg)
+	VkRenderPass GetRenderPass(uint32_t pass) const;
+	uint32_t GetSubpass(uint32_t pass) const;
+	VkImage GetImage(Resource resource) const { return _resources[resource].image; }
+	VkImageView GetImageView(Resource resource) const { return _resources[resource].view; }
+	VkBuffer GetBuffer(Resource resource) const { return _resources[resource].buffer; }
+	VkExtent2D GetImageExtent(Resource resource) const { return _resources[resource].extent; }
+
+	// ~bvC[W (GetImageView͑SẴ~bvAGetImageMipView1̃~bṽr[)
+	uint32_t GetImageMipCount(Resource resource) const { return _resources[resource].mipLevels; }
+	VkImageView GetImageMipView(Resource resource, uint32_t mip) const;
+
+	// TRANSIENTɂA^b`g̐ƁALĂC[W̐
+	uint32_t GetTransientCount() const;
+	uint32_t GetAliasedCount() const;
+
+private:
+	struct ResourceInfo
+	{
+		std::string name;
+		bool imported = false;
+		bool isBuffer = false;
+		ImageDesc desc;
+		VkImageLayout importInitialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		VkImageLayout importFinalLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		VkPipelineStageFlags importStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+		UploadTicket upload = 0;	// mF܂ł̊Õ\[Xւ̓]
+
+		// CompileŌ܂
+		VkImageUsageFlags usage = 0;
+		uint32_t firstStep = ~0u;
+		uint32_t lastStep = 0;
+		bool persistent = false;	// Õt[̓eǂ (LȂ)
+		bool transient = false;		// 1̃_[pXŎg
+		uint32_t slot = ~0u;
+
+		// 
+		VkImage image = VK_NULL_HANDLE;
+		VkImageView view = VK_NULL_HANDLE;
+		VkBuffer buffer = VK_NULL_HANDLE;
+		VkExtent2D extent = {};
+		uint32_t mipLevels = 1;
+		std::vector<VkImageView> mipViews;	// ~bv2ȏ̏ꍇ̃~bvƂ̃r[
+		bool initialized = false;	// Õt[̓eǂރC[W̍ŏ̃CAEgJڂςł邩
+		VkImageLayout startLayout = VK_IMAGE_LAYOUT_UNDEFINED;	// t[̊JñCAEg
+	};
+
+	// pX̑OɋL^oA
+	struct Barrier
+	{
+		Resource resource;
+		VkPipelineStageFlags srcStage;
+		VkPipelineStageFlags dstStage;
+		VkAccessFlags srcAccess;
+		VkAccessFlags dstAccess;
+		VkImageLayout oldLayout;
+		VkImageLayout newLayout;
+	};
+
+	// _[pX1A܂̓Rs[gpX1
+	struct Step
+	{
+		bool compute = false;
+		std::vector<uint32_t> passes;
+		std::vector<Barrier> barriers;
+
+		VkRenderPass renderPass = VK_NULL_HANDLE;
+		std::vector<Resource> attachments;
+		std::vector<VkClearValue> clearValues;
+
+		// _[pX̐ (SimulateŌ܂)
+		std::vector<VkAttachmentDescription> attachmentDescs;
+		std::vector<std::vector<VkAttachmentReference>> colorReferences;	// TupX
+		std::vector<std::vector<VkAttachmentReference>> inputReferences;
+		std::vector<VkAttachmentReference> depthReferences;		// gȂꍇVK_ATTACHMENT_UNUSED
+		std::vector<VkSubpassDependency> dependencies;
+		VkExtent2D extent = {};
+		std::map<std::vector<VkImageView>, VkFramebuffer> framebuffers;
+	};
+
+	// LC[Ŵ܂Ƃ܂
+	struct Slot
+	{
+		bool lazy = false;
+		bool aliasable = false;
+		VkMemoryRequirements requirements = {};
+		std::vector<Resource> resources;
+		MemoryAllocation allocation;
+	};
+
+	// \[X̏ (CompileɒǐՂ)
+	struct ResourceState
+	{
+		VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+		VkPipelineStageFlags writeStages = 0;	// Ōɏ񂾃Xe[W (CAEgJڂ܂)
+		VkAccessFlags writeAccess = 0;
+		VkPipelineStageFlags readStages = 0;	// ݌ɓǂ񂾃Xe[W
+		VkPipelineStageFlags visibleStages = 0;	// ݂悤ɂȂĂXe[W
+		bool valid = false;		// eL
+	};
+
+	// gƂ̃CAEgƃANZX
+	struct UseState
+	{
+		VkImageLayout layout;
+		VkPipelineStageFlags stages;
+		VkAccessFlags access;
+	};
+
+	bool BuildSteps();
+	void AnalyzeResources();
+	void Simulate(std::vector<ResourceState>& states);
+	void AddBarrier(std::vector<Barrier>& barriers, Resource resource, ResourceState& state, const UseState& use, bool write);
+	ResourceState GetStartState(Resource resource, const ResourceState& endState) const;
+	bool CreateRenderPasses();
+	bool CreatePhysicalResources();
+	void ReleasePhysicalResources(std::vector<std::function<void()>>* retired);
+	void ReleaseRenderPasses(std::vector<std::function<void()>>* retired);
+	VkFramebuffer GetFramebuffer(Step& step);
+	void RecordBarriers(VkCommandBuffer command, const std::vector<Barrier>& barriers);
+
+	UseState GetUseState(const Pass::Use& use) const;
+	VkExtent2D GetResourceExtent(Resource resource) const;
+	VkImageView GetAttachmentView(Resource resource) const;
+	bool IsSameSize(Resource a, Resource b) const;
+	bool IsAliasable(Resource resource) const;
+	static bool IsAttachmentUse(Pass::UseType type);
+	static uint32_t GetAttachmentSlot(const Pass& pass, uint32_t useIndex);
+	static bool IsDepthFormat(VkFormat format);
+	static bool HasStencil(VkFormat format);
+	static VkImageAspectFlags GetAspect(VkFormat format);
+
+	VkDevice _device;
+	MemoryAllocator* _allocator;
+	VkExtent2D _extent;
+
+	std::vector<ResourceInfo> _resources;
+	std::deque<Pass> _passes;
+	std::vector<Step> _steps;
+	std::vector<uint32_t> _passSteps;	// pXƂ̃Xebv
+	std::vector<uint32_t> _passSubpasses;	// pXƂ̃TupX
+	std::vector<Slot> _slots;
+	std::vector<Barrier> _finalBarriers;	// SẴpX̌ɋL^oA (ÕC[Ww̃CAEg֖߂)
+
+	// LC[WgXe[W (ŏɎgO͂SĂ̊҂)
+	VkPipelineStageFlags _aliasStages;
+	VkAccessFlags _aliasAccess;
+};
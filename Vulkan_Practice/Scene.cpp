@@ -0,0 +1,121 @@
+#include "Scene.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+
+Scene::Scene() : _objectCount(0)
+{
+}
+
+// IuWFNg̒ǉ (E͎UpdateBoundsŌvZ)
+Scene::ObjectId Scene::Add(const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale,
+	const glm::vec3& boundCenter, float boundRadius)
+{
+	const auto id = _objectCount++;
+	_positionX.push_back(0.0f);
+	_positionY.push_back(0.0f);
+	_positionZ.push_back(0.0f);
+	_rotationX.push_back(0.0f);
+	_rotationY.push_back(0.0f);
+	_rotationZ.push_back(0.0f);
+	_rotationW.push_back(1.0f);
+	_scaleX.push_back(1.0f);
+	_scaleY.push_back(1.0f);
+	_scaleZ.push_back(1.0f);
+	_localX.push_back(boundCenter.x);
+	_localY.push_back(boundCenter.y);
+	_localZ.push_back(boundCenter.z);
+	_localRadius.push_back(boundRadius);
+	_dirtyFlags.push_back(0);
+
+	// a-FLT_MAXɂvf͕ʂƂ̋Ɋ֌WȂȂƔ肳
+	if (_objectCount > _centerX.size())
+	{
+		const auto padded = _centerX.size() + LaneCount;
+		_centerX.resize(padded, 0.0f);
+		_centerY.resize(padded, 0.0f);
+		_centerZ.resize(padded, 0.0f);
+		_radius.resize(padded, -FLT_MAX);
+	}
+
+	SetTransform(id, position, rotation, scale);
+	return id;
+}
+
+void Scene::SetTransform(ObjectId id, const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale)
+{
+	_positionX[id] = position.x;
+	_positionY[id] = position.y;
+	_positionZ[id] = position.z;
+	_rotationX[id] = rotation.x;
+	_rotationY[id] = rotation.y;
+	_rotationZ[id] = rotation.z;
+	_rotationW[id] = rotation.w;
+	_scaleX[id] = scale.x;
+	_scaleY[id] = scale.y;
+	_scaleZ[id] = scale.z;
+
+	if (_dirtyFlags[id] == 0)
+	{
+		_dirtyFlags[id] = 1;
+		_dirtyObjects.push_back(id);
+	}
+}
+
+void Scene::Reserve(uint32_t count)
+{
+	for (auto v : { &_positionX, &_positionY, &_positionZ, &_rotationX, &_rotationY, &_rotationZ, &_rotationW,
+		&_scaleX, &_scaleY, &_scaleZ, &_localX, &_localY, &_localZ, &_localRadius })
+	{
+		v->reserve(count);
+	}
+
+	const auto padded = (count + LaneCount - 1) / LaneCount * LaneCount;
+	for (auto v : { &_centerX, &_centerY, &_centerZ, &_radius })
+	{
+		v->reserve(padded);
+	}
+	_dirtyFlags.reserve(count);
+}
+
+void Scene::Clear()
+{
+	_objectCount = 0;
+	for (auto v : { &_positionX, &_positionY, &_positionZ, &_rotationX, &_rotationY, &_rotationZ, &_rotationW,
+		&_scaleX, &_scaleY, &_scaleZ, &_localX, &_localY, &_localZ, &_localRadius })
+	{
+		v->clear();
+	}
+	for (auto v : { &_centerX, &_centerY, &_centerZ, &_radius })
+	{
+		v->clear();
+	}
+	_dirtyObjects.clear();
+	_dirtyFlags.clear();
+}
+
+void Scene::UpdateBounds()
+{
+	for (auto id : _dirtyObjects)
+	{
+		UpdateBound(id);
+		_dirtyFlags[id] = 0;
+	}
+	_dirtyObjects.clear();
+}
+
+// [J̋E[hԂֈڂ (a͍ł傫̊g嗦Ŋg)
+void Scene::UpdateBound(ObjectId id)
+{
+	const glm::vec3 scale = GetScale(id);
+	const glm::vec3 local(_localX[id], _localY[id], _localZ[id]);
+	const glm::vec3 center = GetPosition(id) + GetRotation(id) * (scale * local);
+
+	const auto maxScale = (std::max)((std::max)(std::fabs(scale.x), std::fabs(scale.y)), std::fabs(scale.z));
+	_centerX[id] = center.x;
+	_centerY[id] = center.y;
+	_centerZ[id] = center.z;
+	_radius[id] = _localRadius[id] * maxScale;
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <vector>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+// SIMDœǂނ߂32oCgEɑAP[^[
+template<class T>
+class SimdAllocator
+{
+public:
+	typedef T value_type;
+	static const size_t Alignment = 32;
+
+	SimdAllocator() {}
+	template<class U> SimdAllocator(const SimdAllocator<U>&) {}
+
+	T* allocate(size_t count)
+	{
+#ifdef _WIN32
+		auto p = _aligned_malloc(count * sizeof(T), Alignment);
+#else
+		void* p = nullptr;
+		if (posix_memalign(&p, Alignment, count * sizeof(T)) != 0)
+		{
+			p = nullptr;
+		}
+#endif
+		if (p == nullptr)
+		{
+			throw std::bad_alloc();
+		}
+		return static_cast<T*>(p);
+	}
+
+	void deallocate(T* p, size_t)
+	{
+#ifdef _WIN32
+		_aligned_free(p);
+#else
+		free(p);
+#endif
+	}
+
+	template<class U> bool operator==(const SimdAllocator<U>&) const { return true; }
+	template<class U> bool operator!=(const SimdAllocator<U>&) const { return false; }
+};
+
+
+// IuWFNg̃gXtH[ƋEvfƂ̔z (SoA) Ŏ
+// [hԂ̋ELaneCount̔{܂ŌČȂ̂Ŗ߂̂ŁAJO͒[킸LaneCountł
+// ObjectId͒ǉ̔ԍ (Clear܂ŕςȂ)
+class Scene
+{
+public:
+	typedef uint32_t ObjectId;
+	typedef std::vector<float, SimdAllocator<float>> FloatArray;
+
+	// E̔z̒̒P (AVX2ňxɔ肷鐔)
+	static const uint32_t LaneCount = 8;
+
+	Scene();
+
+	// boundCenter, boundRadius̓bṼ[JԂ̋E
+	ObjectId Add(const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale,
+		const glm::vec3& boundCenter, float boundRadius);
+	void SetTransform(ObjectId id, const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale);
+	void Reserve(uint32_t count);
+	void Clear();
+
+	// SetTransformIuWFNg̃[hԂ̋EXV (JȎOɌĂ)
+	void UpdateBounds();
+
+	uint32_t GetObjectCount() const { return _objectCount; }
+	uint32_t GetPaddedCount() const { return uint32_t(_centerX.size()); }
+
+	glm::vec3 GetPosition(ObjectId id) const { return glm::vec3(_positionX[id], _positionY[id], _positionZ[id]); }
+	glm::quat GetRotation(ObjectId id) const { return glm::quat(_rotationW[id], _rotationX[id], _rotationY[id], _rotationZ[id]); }
+	glm::vec3 GetScale(ObjectId id) const { return glm::vec3(_scaleX[id], _scaleY[id], _scaleZ[id]); }
+
+	// [hԂ̋E (GetPaddedCount())
+	const float* GetCenterX() const { return _centerX.data(); }
+	const float* GetCenterY() const { return _centerY.data(); }
+	const float* GetCenterZ() const { return _centerZ.data(); }
+	const float* GetRadius() const { return _radius.data(); }
+
+private:
+	void UpdateBound(ObjectId id);
+
+	uint32_t _objectCount;
+
+	// gXtH[
+	std::vector<float> _positionX, _positionY, _positionZ;
+	std::vector<float> _rotationX, _rotationY, _rotationZ, _rotationW;
+	std::vector<float> _scaleX, _scaleY, _scaleZ;
+
+	// [JԂ̋E
+	std::vector<float> _localX, _localY, _localZ, _localRadius;
+
+	// [hԂ̋E (JOœǂ)
+	FloatArray _centerX, _centerY, _centerZ, _radius;
+
+	// UpdateBoundsōXV
+	std::vector<ObjectId> _dirtyObjects;
+	std::vector<uint8_t> _dirtyFlags;
+};
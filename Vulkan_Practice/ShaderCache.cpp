@@ -0,0 +1,345 @@
+#include "ShaderCache.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <cstdlib>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+// ύXmFԊu
+static const auto HotReloadPollInterval = std::chrono::milliseconds(500);
+
+// FNV-1a
+static uint64_t HashBytes(uint64_t hash, const void* data, size_t size)
+{
+	auto bytes = static_cast<const uint8_t*>(data);
+	for (size_t i = 0; i < size; ++i)
+	{
+		hash ^= bytes[i];
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+// t@C̍ŏIXV (݂Ȃꍇ-1)
+static int64_t GetFileTime(const std::string& path)
+{
+	struct stat status;
+	if (stat(path.c_str(), &status) != 0)
+	{
+		return -1;
+	}
+	return int64_t(status.st_mtime);
+}
+
+
+const VkSpecializationInfo* SpecializationConstants::GetInfo() const
+{
+	if (_entries.empty())
+	{
+		return nullptr;
+	}
+	_info.mapEntryCount = uint32_t(_entries.size());
+	_info.pMapEntries = _entries.data();
+	_info.dataSize = _data.size();
+	_info.pData = _data.data();
+	return &_info;
+}
+
+uint64_t SpecializationConstants::GetHash() const
+{
+	auto hash = 14695981039346656037ull;
+	for (const auto& v : _entries)
+	{
+		hash = HashBytes(hash, &v.constantID, sizeof(v.constantID));
+		hash = HashBytes(hash, _data.data() + v.offset, v.size);
+	}
+	return hash;
+}
+
+bool SpecializationConstants::operator==(const SpecializationConstants& other) const
+{
+	if (_entries.size() != other._entries.size() || _data != other._data)
+	{
+		return false;
+	}
+	for (size_t i = 0; i < _entries.size(); ++i)
+	{
+		const auto& a = _entries[i];
+		const auto& b = other._entries[i];
+		if (a.constantID != b.constantID || a.offset != b.offset || a.size != b.size)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+
+ShaderCache::ShaderCache() : _device(VK_NULL_HANDLE)
+{
+}
+
+// Ή\̓ǂݍ
+bool ShaderCache::Initialize(VkDevice device, const std::string& spirvDirectory)
+{
+	_device = device;
+	_spirvDirectory = spirvDirectory;
+
+	std::map<std::string, Entry> entries;
+	auto loaded = LoadManifest(entries);
+
+	std::lock_guard<std::mutex> lock(_mutex);
+	_entries.swap(entries);
+	return loaded;
+}
+
+// SẴW[̔j (ăRpC̏ꍇ͏I܂ő҂)
+void ShaderCache::Terminate()
+{
+	if (_compile.valid())
+	{
+		_compile.wait();
+		_compile = std::future<int>();
+	}
+
+	std::lock_guard<std::mutex> lock(_mutex);
+	for (auto& v : _modules)
+	{
+		vkDestroyShaderModule(_device, v.second, nullptr);
+	}
+	_modules.clear();
+	for (auto v : _retiredModules)
+	{
+		vkDestroyShaderModule(_device, v, nullptr);
+	}
+	_retiredModules.clear();
+	_entries.clear();
+	_compileCommand.clear();
+	_sourceTimes.clear();
+}
+
+// shaders.manifest ̓ǂݍ (es: O nbV CN[ht@C...)
+bool ShaderCache::LoadManifest(std::map<std::string, Entry>& entries) const
+{
+	std::ifstream file(_spirvDirectory + "/shaders.manifest");
+	if (!file)
+	{
+		return false;
+	}
+
+	std::string line;
+	while (std::getline(file, line))
+	{
+		std::istringstream stream(line);
+		std::string name, hash;
+		if (!(stream >> name >> hash))
+		{
+			continue;
+		}
+
+		Entry entry;
+		entry.hash = std::strtoull(hash.c_str(), nullptr, 16);
+		entry.dependencies.push_back(name);
+		std::string include;
+		while (stream >> include)
+		{
+			entry.dependencies.push_back(include);
+		}
+		entries[name] = entry;
+	}
+	return true;
+}
+
+// <hash>.spv 烂W[𐶐
+VkShaderModule ShaderCache::CreateModule(uint64_t hash) const
+{
+	char fileName[32];
+	std::snprintf(fileName, sizeof(fileName), "%016llx.spv", static_cast<unsigned long long>(hash));
+
+	std::ifstream file(_spirvDirectory + "/" + fileName, std::ios::binary | std::ios::ate);
+	if (!file)
+	{
+		return VK_NULL_HANDLE;
+	}
+	const auto size = size_t(file.tellg());
+	std::vector<uint32_t> code((size + 3) / 4);
+	file.seekg(0);
+	file.read(reinterpret_cast<char*>(code.data()), size);
+	if (!file || size == 0)
+	{
+		return VK_NULL_HANDLE;
+	}
+
+	VkShaderModuleCreateInfo ci{};
+	ci.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+	ci.codeSize = size;
+	ci.pCode = code.data();
+	VkShaderModule module = VK_NULL_HANDLE;
+	if (vkCreateShaderModule(_device, &ci, nullptr, &module) != VK_SUCCESS)
+	{
+		return VK_NULL_HANDLE;
+	}
+	return module;
+}
+
+// W[̎擾 (nbṼW[͎g)
+VkShaderModule ShaderCache::GetModule(const std::string& name)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	auto entry = _entries.find(name);
+	if (entry == _entries.end())
+	{
+		return VK_NULL_HANDLE;
+	}
+
+	const auto hash = entry->second.hash;
+	auto found = _modules.find(hash);
+	if (found != _modules.end())
+	{
+		return found->second;
+	}
+
+	auto module = CreateModule(hash);
+	if (module != VK_NULL_HANDLE)
+	{
+		_modules[hash] = module;
+	}
+	return module;
+}
+
+uint64_t ShaderCache::GetHash(const std::string& name) const
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	auto entry = _entries.find(name);
+	return entry != _entries.end() ? entry->second.hash : 0;
+}
+
+// \[X̊Ď̊Jn (݂̍XVL^Ă)
+void ShaderCache::EnableHotReload(const std::string& sourceDirectory, const std::string& compileCommand)
+{
+	_sourceDirectory = sourceDirectory;
+	_compileCommand = compileCommand;
+	_sourceTimes.clear();
+	HasSourceChanged();
+	_lastPoll = std::chrono::steady_clock::now();
+}
+
+// O̊mFXVꂽt@C邩
+bool ShaderCache::HasSourceChanged()
+{
+	std::vector<std::string> files;
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		for (const auto& v : _entries)
+		{
+			files.insert(files.end(), v.second.dependencies.begin(), v.second.dependencies.end());
+		}
+	}
+
+	auto changed = false;
+	for (const auto& v : files)
+	{
+		const auto time = GetFileTime(_sourceDirectory + "/" + v);
+		auto found = _sourceTimes.find(v);
+		if (found == _sourceTimes.end())
+		{
+			_sourceTimes[v] = time;
+		}
+		else if (found->second != time)
+		{
+			found->second = time;
+			changed = true;
+		}
+	}
+	return changed;
+}
+
+// \[X̊ĎƍăRpC̊̊mF
+std::vector<std::string> ShaderCache::Update()
+{
+	std::vector<std::string> reloaded;
+	if (!IsHotReloadEnabled())
+	{
+		return reloaded;
+	}
+
+	// ăRpC̊ (sVF[_[͑ÕnbV̂܂)
+	if (_compile.valid())
+	{
+		if (_compile.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+		{
+			return reloaded;
+		}
+		if (_compile.get() != 0)
+		{
+			std::fprintf(stderr, "shader compilation failed, keeping the previous SPIR-V\n");
+		}
+
+		std::map<std::string, Entry> entries;
+		if (LoadManifest(entries))
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			for (const auto& v : entries)
+			{
+				auto found = _entries.find(v.first);
+				if (found == _entries.end() || found->second.hash != v.second.hash)
+				{
+					reloaded.push_back(v.first);
+				}
+			}
+			_entries.swap(entries);
+
+			// ǂ̖ÕnbVłȂȂW[͒uꂽ̂ŁAj҂ɂ
+			for (auto it = _modules.begin(); it != _modules.end();)
+			{
+				const auto hash = it->first;
+				const auto used = std::any_of(_entries.begin(), _entries.end(), [hash](const std::pair<const std::string, Entry>& v) { return v.second.hash == hash; });
+				if (used)
+				{
+					++it;
+					continue;
+				}
+				_retiredModules.push_back(it->second);
+				it = _modules.erase(it);
+			}
+		}
+
+		// VCN[h̎L^ (RpCɕύXĂꍇ͂xRpC)
+		if (HasSourceChanged())
+		{
+			StartCompile();
+		}
+		return reloaded;
+	}
+
+	const auto now = std::chrono::steady_clock::now();
+	if (now - _lastPoll < HotReloadPollInterval)
+	{
+		return reloaded;
+	}
+	_lastPoll = now;
+
+	if (HasSourceChanged())
+	{
+		StartCompile();
+	}
+	return reloaded;
+}
+
+std::vector<VkShaderModule> ShaderCache::TakeRetiredModules()
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	std::vector<VkShaderModule> modules;
+	modules.swap(_retiredModules);
+	return modules;
+}
+
+// obNOEhōăRpC
+void ShaderCache::StartCompile()
+{
+	const auto command = _compileCommand;
+	_compile = std::async(std::launch::async, [command]() { return std::system(command.c_str()); });
+}
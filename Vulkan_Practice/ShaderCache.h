@@ -0,0 +1,113 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <vector>
+#include <map>
+#include <string>
+#include <mutex>
+#include <future>
+#include <chrono>
+#include <cstring>
+#include <type_traits>
+
+// ꉻ萔 (\[X𕪂ɃoG[ṼpCvC𐶐)
+//   SpecializationConstants constants;
+//   constants.Set(0, 64u).Set(1, VkBool32(VK_TRUE));
+//   stage.pSpecializationInfo = constants.GetInfo();
+class SpecializationConstants
+{
+public:
+	// VF[_[ layout(constant_id = id) ɒlݒ肷 (boolVkBool32œn)
+	template<typename T>
+	SpecializationConstants& Set(uint32_t constantId, const T& value)
+	{
+		static_assert(std::is_trivially_copyable<T>::value && (sizeof(T) == 4 || sizeof(T) == 8), "specialization constants are 32 or 64 bit scalars");
+		VkSpecializationMapEntry entry{};
+		entry.constantID = constantId;
+		entry.offset = uint32_t(_data.size());
+		entry.size = sizeof(T);
+		_entries.push_back(entry);
+		_data.resize(_data.size() + sizeof(T));
+		std::memcpy(_data.data() + entry.offset, &value, sizeof(T));
+		return *this;
+	}
+
+	// 萔Ȃꍇnullptr (̃IuWFNgύX܂ŗL)
+	const VkSpecializationInfo* GetInfo() const;
+
+	// oG[Vʂ邽߂̃nbV
+	uint64_t GetHash() const;
+
+	// 萔ɓlݒ肵Ă邩 (nbVՓ˂ꍇ̊mFɎg)
+	bool operator==(const SpecializationConstants& other) const;
+
+	bool IsEmpty() const { return _entries.empty(); }
+
+private:
+	std::vector<VkSpecializationMapEntry> _entries;
+	std::vector<uint8_t> _data;
+	mutable VkSpecializationInfo _info = {};
+};
+
+
+// rhɃRpCSPIR-V (cmake/CompileShaders.cmake) VF[_[W[𐶐
+// W[̓\[X̃nbVƂ1ATerminate܂ŕێ
+// zbg[hLɂꍇ́AUpdateŃ\[X̕ύXĎčăRpC
+// (ǂ̖OgȂȂW[TakeRetiredModulesŌĂяoɓn)
+class ShaderCache
+{
+public:
+	ShaderCache();
+
+	// spirvDirectoryshaders.manifest<hash>.spv̂fBNg
+	bool Initialize(VkDevice device, const std::string& spirvDirectory);
+	void Terminate();
+
+	// O (\[X̃t@CA: "GpuCulling.comp") 烂W[擾
+	// ǂ̃XbhĂׂBȂꍇVK_NULL_HANDLE
+	VkShaderModule GetModule(const std::string& name);
+
+	// OɑΉ錻݂̃nbV (Ȃꍇ0)
+	uint64_t GetHash(const std::string& name) const;
+
+	// \[X̕ύXĎ (Jp)
+	// compileCommand̓\[XύXꂽƂɃobNOEhŎsR}h (CompileShaders.cmakěĂяo)
+	void EnableHotReload(const std::string& sourceDirectory, const std::string& compileCommand);
+	bool IsHotReloadEnabled() const { return !_compileCommand.empty(); }
+
+	// t[ƂɃCXbhĂ
+	// ăRpCIꍇAnbVςVF[_[̖OԂ (W[͎GetModuleŐ)
+	std::vector<std::string> Update();
+
+	// UpdateŒuꂽÂW[󂯎
+	// ĂяoAÂW[ŗvpCvC̐IĂj
+	std::vector<VkShaderModule> TakeRetiredModules();
+
+private:
+	struct Entry
+	{
+		uint64_t hash;
+		std::vector<std::string> dependencies;		// \[XƃCN[ht@C
+	};
+
+	bool LoadManifest(std::map<std::string, Entry>& entries) const;
+	VkShaderModule CreateModule(uint64_t hash) const;
+	bool HasSourceChanged();
+	void StartCompile();
+
+	VkDevice _device;
+	std::string _spirvDirectory;
+
+	mutable std::mutex _mutex;
+	std::map<std::string, Entry> _entries;
+	std::map<uint64_t, VkShaderModule> _modules;
+	std::vector<VkShaderModule> _retiredModules;	// uāA܂ĂяoɓnĂȂ
+
+	// zbg[h
+	std::string _sourceDirectory;
+	std::string _compileCommand;
+	std::map<std::string, int64_t> _sourceTimes;	// t@CƂ̍ŏIXV
+	std::chrono::steady_clock::time_point _lastPoll;
+	std::future<int> _compile;
+};
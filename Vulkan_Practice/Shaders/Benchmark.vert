@@ -0,0 +1,25 @@
+#version 450
+
+// ベンチマークの四角形 (頂点バッファを使わず、gl_VertexIndexから作る)
+// インスタンスは矩形をcolumns x columnsのマス目に分けて並べる
+
+layout(push_constant) uniform Params
+{
+	vec4 rect;		// xy: 左上 (NDC), zw: 大きさ
+	vec4 color;
+	uint columns;
+} params;
+
+layout(location = 0) out vec4 outColor;
+
+void main()
+{
+	// 三角形ストリップの4頂点
+	vec2 corner = vec2(gl_VertexIndex & 1, (gl_VertexIndex >> 1) & 1);
+	uint column = uint(gl_InstanceIndex) % params.columns;
+	uint row = uint(gl_InstanceIndex) / params.columns;
+	vec2 cell = params.rect.zw / float(params.columns);
+
+	gl_Position = vec4(params.rect.xy + (vec2(column, row) + corner) * cell, 0.5, 1.0);
+	outColor = params.color;
+}
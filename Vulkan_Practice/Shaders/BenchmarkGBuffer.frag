@@ -0,0 +1,19 @@
+#version 450
+
+// ベンチマークの立方体をDeferredRendererのG-bufferへ描く (出力の順はDeferredRenderer::AlbedoFormat, NormalFormat)
+
+layout(location = 0) in vec4 inColor;
+layout(location = 1) in vec3 inPosition;
+
+layout(location = 0) out vec4 outAlbedo;	// rgb: アルベド, a: 鏡面反射の強さ
+layout(location = 1) out vec4 outNormal;	// rgb: ワールド空間の法線 * 0.5 + 0.5
+
+void main()
+{
+	// 頂点は法線を持たないので、位置の微分から面の法線を求める
+	// (フレームバッファのyは下向きなので、cross(dFdy, dFdx)がカメラの方を向く)
+	vec3 normal = normalize(cross(dFdy(inPosition), dFdx(inPosition)));
+
+	outAlbedo = vec4(inColor.rgb, 0.5);
+	outNormal = vec4(normal * 0.5 + 0.5, 0.0);
+}
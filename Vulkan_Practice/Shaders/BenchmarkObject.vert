@@ -0,0 +1,33 @@
+#version 450
+
+// ベンチマークの立方体 (頂点バッファを使わず、インデックスの値から角の位置を作る)
+// オブジェクトの番号はfirstInstance (gl_InstanceIndex) で受け取る
+
+struct ObjectData
+{
+	mat4 model;
+	vec4 color;
+};
+
+layout(std430, set = 0, binding = 0) readonly buffer Frame
+{
+	mat4 viewProjection;
+	ObjectData objects[];
+} frame;
+
+layout(location = 0) out vec4 outColor;
+layout(location = 1) out vec3 outPosition;	// ワールド空間 (BenchmarkGBuffer.fragで面の法線を求める)
+
+void main()
+{
+	// インデックスのビット0・1・2が角のx・y・zの0/1 (中心が原点で辺の長さが1)
+	vec3 corner = vec3(gl_VertexIndex & 1, (gl_VertexIndex >> 1) & 1, (gl_VertexIndex >> 2) & 1);
+	ObjectData object = frame.objects[gl_InstanceIndex];
+
+	vec4 position = object.model * vec4(corner - 0.5, 1.0);
+	gl_Position = frame.viewProjection * position;
+	outPosition = position.xyz;
+
+	// 法線を持たないので、角ごとに明るさを変えて面を見分けられるようにする
+	outColor = vec4(object.color.rgb * (0.55 + 0.45 * dot(corner, vec3(0.2, 0.5, 0.3))), object.color.a);
+}
@@ -0,0 +1,72 @@
+#version 450
+
+// G-bufferをinput attachmentで読み、ライトの寄与を加算する (DeferredRenderer.cppから使う)
+// 同じ位置のピクセルしか読まないので、タイルベースのGPUではG-bufferがタイルメモリから出ない
+
+layout(input_attachment_index = 0, set = 0, binding = 1) uniform subpassInput albedoInput;	// rgb: アルベド, a: 鏡面反射の強さ
+layout(input_attachment_index = 1, set = 0, binding = 2) uniform subpassInput normalInput;	// rgb: 法線 * 0.5 + 0.5
+layout(input_attachment_index = 2, set = 0, binding = 3) uniform subpassInput depthInput;
+
+// DeferredRenderer::Lightと同じ並び
+struct Light
+{
+	vec4 sphere;	// xyz: 位置, w: 影響する範囲
+	vec4 color;		// rgb: 色, a: 強さ
+};
+
+// DeferredRenderer::FrameDataとLightの配列
+layout(std430, set = 0, binding = 0) readonly buffer Lights
+{
+	mat4 viewProjection;
+	mat4 inverseViewProjection;
+	vec4 cameraPosition;
+	vec4 ambient;
+	vec2 inverseExtent;
+	uint lightCount;
+	uint reserved;
+	Light lights[];
+};
+
+layout(location = 0) flat in int inLight;	// -1: 環境光
+layout(location = 0) out vec4 outColor;
+
+void main()
+{
+	float depth = subpassLoad(depthInput).r;
+	vec4 albedo = subpassLoad(albedoInput);
+
+	// 環境光 (何も描かれていない所はアルベドのクリア色をそのまま出す)
+	if (inLight < 0)
+	{
+		outColor = vec4(depth < 1.0 ? albedo.rgb * ambient.rgb : albedo.rgb, 1.0);
+		return;
+	}
+	if (depth >= 1.0)
+	{
+		discard;
+	}
+
+	// 深度からワールド空間の位置を復元する
+	vec2 ndc = gl_FragCoord.xy * inverseExtent * 2.0 - 1.0;
+	vec4 world = inverseViewProjection * vec4(ndc, depth, 1.0);
+	vec3 position = world.xyz / world.w;
+
+	Light light = lights[inLight];
+	vec3 toLight = light.sphere.xyz - position;
+	float distance = length(toLight);
+	if (distance >= light.sphere.w)
+	{
+		discard;
+	}
+
+	// 範囲の端で0になる減衰、拡散反射とBlinn-Phongの鏡面反射
+	vec3 normal = normalize(subpassLoad(normalInput).rgb * 2.0 - 1.0);
+	vec3 lightDirection = toLight / distance;
+	vec3 halfVector = normalize(lightDirection + normalize(cameraPosition.xyz - position));
+	float attenuation = 1.0 - distance / light.sphere.w;
+	attenuation *= attenuation;
+
+	float diffuse = max(dot(normal, lightDirection), 0.0);
+	float specular = diffuse > 0.0 ? pow(max(dot(normal, halfVector), 0.0), 32.0) * albedo.a : 0.0;
+	outColor = vec4(light.color.rgb * light.color.a * attenuation * (albedo.rgb * diffuse + specular), 0.0);
+}
@@ -0,0 +1,64 @@
+#version 450
+
+// ライトが影響する範囲を囲む四角形 (頂点バッファを使わず、gl_VertexIndexから作る)
+// インスタンス0は画面全体の環境光、それ以降はライトごと (DeferredRenderer.cppから使う)
+
+// DeferredRenderer::Lightと同じ並び
+struct Light
+{
+	vec4 sphere;	// xyz: 位置, w: 影響する範囲
+	vec4 color;		// rgb: 色, a: 強さ
+};
+
+// DeferredRenderer::FrameDataとLightの配列
+layout(std430, set = 0, binding = 0) readonly buffer Lights
+{
+	mat4 viewProjection;
+	mat4 inverseViewProjection;
+	vec4 cameraPosition;
+	vec4 ambient;
+	vec2 inverseExtent;
+	uint lightCount;
+	uint reserved;
+	Light lights[];
+};
+
+layout(location = 0) flat out int outLight;	// -1: 環境光
+
+void main()
+{
+	// 三角形ストリップの4頂点
+	vec2 corner = vec2(gl_VertexIndex & 1, (gl_VertexIndex >> 1) & 1);
+	vec2 rectMin = vec2(-1.0);
+	vec2 rectMax = vec2(1.0);
+
+	outLight = gl_InstanceIndex - 1;
+	if (outLight >= 0)
+	{
+		// 範囲の球を囲む箱を投影する (視点の後ろにかかる場合は画面全体)
+		vec4 sphere = lights[outLight].sphere;
+		vec2 projectedMin = vec2(1.0);
+		vec2 projectedMax = vec2(-1.0);
+		bool behind = false;
+		for (int i = 0; i < 8; ++i)
+		{
+			vec3 position = sphere.xyz + sphere.w * vec3((i & 1) != 0 ? 1.0 : -1.0, (i & 2) != 0 ? 1.0 : -1.0, (i & 4) != 0 ? 1.0 : -1.0);
+			vec4 clip = viewProjection * vec4(position, 1.0);
+			behind = behind || clip.w <= 0.0;
+			if (clip.w > 0.0)
+			{
+				projectedMin = min(projectedMin, clip.xy / clip.w);
+				projectedMax = max(projectedMax, clip.xy / clip.w);
+			}
+		}
+
+		// 画面の外の場合は面積が0になり、何も描かない
+		if (!behind)
+		{
+			rectMin = clamp(projectedMin, -1.0, 1.0);
+			rectMax = clamp(projectedMax, -1.0, 1.0);
+		}
+	}
+
+	gl_Position = vec4(mix(rectMin, rectMax, corner), 0.0, 1.0);
+}
@@ -0,0 +1,780 @@
+#include "TextureStreamer.h"
+
+#include <fstream>
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstring>
+
+// ɓǂݍmip̐̏ (]1t[ɏWȂ悤)
+static const uint32_t MaxPendingLoads = 4;
+
+// 1t[œ]ʂ̖ڈ (ȂƂ1͓])
+static const VkDeviceSize MaxUploadBytesPerFrame = 16 * 1024 * 1024;
+
+// \Ẑ߂Ɏ̂Ămipxǂݍނ܂ł̃t[ (ǂݍ݂ƔjJԂȂ悤)
+static const uint64_t EvictionCooldownFrames = 120;
+
+// eNX`ǂރXe[W (`͓]̃eNX`̊ő҂)
+static const VkPipelineStageFlags TextureReadStages = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+
+// KTX2̃t@Cʎq
+static const uint8_t Ktx2Identifier[12] = { 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+
+// KTX2̃wb_[ (t@C̐擪A64bit̒l8oCgEɗ)
+struct Ktx2Header
+{
+	uint8_t identifier[12];
+	uint32_t vkFormat;
+	uint32_t typeSize;
+	uint32_t pixelWidth;
+	uint32_t pixelHeight;
+	uint32_t pixelDepth;
+	uint32_t layerCount;
+	uint32_t faceCount;
+	uint32_t levelCount;
+	uint32_t supercompressionScheme;
+	uint32_t dfdByteOffset;
+	uint32_t dfdByteLength;
+	uint32_t kvdByteOffset;
+	uint32_t kvdByteLength;
+	uint64_t sgdByteOffset;
+	uint64_t sgdByteLength;
+};
+
+struct Ktx2LevelIndex
+{
+	uint64_t byteOffset;
+	uint64_t byteLength;
+	uint64_t uncompressedByteLength;
+};
+
+// mipx̑傫
+static uint32_t MipSize(uint32_t size, uint32_t level)
+{
+	return (std::max)(size >> level, 1u);
+}
+
+
+TextureStreamer::TextureStreamer() : _device(VK_NULL_HANDLE), _allocator(nullptr), _uploadManager(nullptr), _bindlessTable(nullptr), _deletionQueue(nullptr),
+	_budgetScale(0.9f), _frameNumber(0), _heapIndex(~0u), _residentBytes(0), _loadingBytes(0), _pendingLoads(0), _streamedInCount(0), _evictedCount(0),
+	_retiringBytes(0), _quit(false)
+{
+}
+
+TextureStreamer::~TextureStreamer()
+{
+	Terminate();
+}
+
+// ǂݍ݃Xbh̋N
+void TextureStreamer::Initialize(VkDevice device, MemoryAllocator* allocator, UploadManager* uploadManager, BindlessTable* bindlessTable,
+	DeletionQueue* deletionQueue, float budgetScale)
+{
+	_device = device;
+	_allocator = allocator;
+	_uploadManager = uploadManager;
+	_bindlessTable = bindlessTable;
+	_deletionQueue = deletionQueue;
+	_budgetScale = budgetScale;
+	_quit = false;
+	_loader = std::thread(&TextureStreamer::LoaderMain, this);
+}
+
+// SẴeNX`̔j (GPȔIĂĂ)
+void TextureStreamer::Terminate()
+{
+	if (_loader.joinable())
+	{
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_quit = true;
+			_requests.clear();
+		}
+		_condition.notify_all();
+		_loader.join();
+	}
+	_results.clear();
+
+	// C[WDeletionQueueTerminateŔj
+	// GPŮ҂Ȃ̂őMς݂̓]͏IĂ (MĂȂ]UploadManager̂Ă)
+	for (auto& v : _textures)
+	{
+		v->upload = 0;
+		v->nextUpload = 0;
+		RetireImage(*v);
+		RetireNext(*v);
+	}
+	_textures.clear();
+	_copies.clear();
+	_retiring.clear();
+	_residentBytes = 0;
+	_loadingBytes = 0;
+	_retiringBytes = 0;
+	_pendingLoads = 0;
+}
+
+// t@C̑傫 (JȂꍇ0)
+static uint64_t GetFileSize(std::ifstream& file)
+{
+	file.seekg(0, std::ios::end);
+	const auto size = file ? uint64_t(std::streamoff(file.tellg())) : 0;
+	file.seekg(0, std::ios::beg);
+	return size;
+}
+
+// KTX2̃wb_[mipẍʒu̓ǂݍ
+// Ή̂͒kȂ2DeNX` (zAL[u}bvA3D͏)
+// ꂽt@CŋȊmۂȂ悤Amip̐Ɗemip͈̔͂͊mۂOɃt@C̑傫Ɣׂ
+bool TextureStreamer::ReadHeader(const std::string& path, Texture& texture)
+{
+	static_assert(sizeof(Ktx2Header) == 80, "KTX2 header is 80 bytes");
+
+	std::ifstream file(path, std::ios::binary);
+	const auto fileSize = GetFileSize(file);
+	Ktx2Header header;
+	if (!file.read(reinterpret_cast<char*>(&header), sizeof(header))
+		|| std::memcmp(header.identifier, Ktx2Identifier, sizeof(Ktx2Identifier)) != 0)
+	{
+		return false;
+	}
+	if (header.vkFormat == VK_FORMAT_UNDEFINED || header.supercompressionScheme != 0 || header.pixelWidth == 0
+		|| header.pixelDepth > 1 || header.layerCount > 1 || header.faceCount != 1 || header.levelCount == 0)
+	{
+		return false;
+	}
+
+	// mip̐͂̑傫mip`F[̒܂ (32rbg̑傫Ȃ̂ōő32)
+	uint32_t maxLevels = 1;
+	for (auto size = (std::max)(header.pixelWidth, header.pixelHeight); size > 1; size >>= 1)
+	{
+		++maxLevels;
+	}
+	if (header.levelCount > maxLevels || sizeof(header) + sizeof(Ktx2LevelIndex) * uint64_t(header.levelCount) > fileSize)
+	{
+		return false;
+	}
+
+	std::vector<Ktx2LevelIndex> index(header.levelCount);
+	if (!file.read(reinterpret_cast<char*>(index.data()), sizeof(Ktx2LevelIndex) * index.size()))
+	{
+		return false;
+	}
+	for (const auto& v : index)
+	{
+		if (v.byteOffset > fileSize || v.byteLength > fileSize - v.byteOffset)
+		{
+			return false;
+		}
+	}
+
+	texture.path = path;
+	texture.format = VkFormat(header.vkFormat);
+	texture.extent = { header.pixelWidth, (std::max)(header.pixelHeight, 1u) };
+	texture.levels.resize(index.size());
+	for (size_t i = 0; i < index.size(); ++i)
+	{
+		texture.levels[i].offset = index[i].byteOffset;
+		texture.levels[i].length = index[i].byteLength;
+	}
+	return true;
+}
+
+// baseMipendMip̑O܂łmipɋl߂ēǂݍ (ǂݍ݃XbhĂ΂)
+bool TextureStreamer::ReadLevels(const std::string& path, const std::vector<Level>& levels, uint32_t baseMip, uint32_t endMip, std::vector<uint8_t>& data)
+{
+	std::ifstream file(path, std::ios::binary);
+	if (!file)
+	{
+		return false;
+	}
+
+	// wb_[ǂ񂾌Ƀt@CςĂꍇ̂ŁAmۂOɂx͈͂mF
+	const auto fileSize = GetFileSize(file);
+	uint64_t total = 0;
+	for (auto i = baseMip; i < endMip; ++i)
+	{
+		if (levels[i].offset > fileSize || levels[i].length > fileSize - levels[i].offset)
+		{
+			return false;
+		}
+		total += levels[i].length;
+	}
+	data.resize(size_t(total));
+
+	size_t offset = 0;
+	for (auto i = baseMip; i < endMip; ++i)
+	{
+		file.seekg(std::streamoff(levels[i].offset));
+		if (!file.read(reinterpret_cast<char*>(data.data() + offset), std::streamsize(levels[i].length)))
+		{
+			data.clear();
+			return false;
+		}
+		offset += size_t(levels[i].length);
+	}
+	return true;
+}
+
+// baseMipŌ܂łmipC[W̑傫̖ڈ (t@C̑傫̍v)
+VkDeviceSize TextureStreamer::GetChainBytes(const Texture& texture, uint32_t baseMip)
+{
+	VkDeviceSize bytes = 0;
+	for (auto i = baseMip; i < texture.levels.size(); ++i)
+	{
+		bytes += texture.levels[i].length;
+	}
+	return bytes;
+}
+
+// eNX`̓ǂݍ (mip͂œǂœ])
+TextureStreamer::TextureId TextureStreamer::Load(const std::string& path)
+{
+	std::unique_ptr<Texture> texture(new Texture());
+	if (!ReadHeader(path, *texture))
+	{
+		std::fprintf(stderr, "failed to read KTX2 header: %s\n", path.c_str());
+		return InvalidTexture;
+	}
+
+	const auto levelCount = uint32_t(texture->levels.size());
+	uint32_t baseMip = 0;
+	while (baseMip + 1 < levelCount
+		&& (std::max)(MipSize(texture->extent.width, baseMip), MipSize(texture->extent.height, baseMip)) > InitialResidentSize)
+	{
+		++baseMip;
+	}
+
+	texture->residentMip = levelCount;
+	texture->image = VK_NULL_HANDLE;
+	texture->view = VK_NULL_HANDLE;
+	texture->handle = BindlessTable::InvalidHandle;
+	texture->upload = 0;
+	texture->nextMip = InvalidMip;
+	texture->nextImage = VK_NULL_HANDLE;
+	texture->nextView = VK_NULL_HANDLE;
+	texture->nextUpload = 0;
+	texture->loadingMip = InvalidMip;
+	texture->limitMip = 0;
+	texture->wantedMip = baseMip;
+	texture->lastUsedFrame = 0;
+	texture->evictedFrame = 0;
+	texture->requestedSize = 0;
+
+	std::vector<uint8_t> data;
+	if (!ReadLevels(path, texture->levels, baseMip, levelCount, data) || !MakeResident(*texture, baseMip, levelCount, data))
+	{
+		std::fprintf(stderr, "failed to load KTX2 mip chain: %s\n", path.c_str());
+		return InvalidTexture;
+	}
+
+	_textures.push_back(std::move(texture));
+	return TextureId(_textures.size() - 1);
+}
+
+// ʏ̑傫̕ (t[̍őlc)
+void TextureStreamer::RequestSize(TextureId id, uint32_t pixels)
+{
+	auto& requested = _textures[id]->requestedSize;
+	auto current = requested.load(std::memory_order_relaxed);
+	while (current < pixels && !requested.compare_exchange_weak(current, pixels, std::memory_order_relaxed))
+	{
+	}
+}
+
+// baseMipmipC[W
+// baseMipcopyMip̑O܂łdata]AcopyMip͍̃C[WRecordCopiesŃRs[
+// ŏ̃C[W͂Ɏgn߁A蒼C[W͓]ĂUpdateō̃C[Wƒu
+bool TextureStreamer::MakeResident(Texture& texture, uint32_t baseMip, uint32_t copyMip, const std::vector<uint8_t>& data)
+{
+	const auto levelCount = uint32_t(texture.levels.size());
+	if (texture.nextImage != VK_NULL_HANDLE || (copyMip < levelCount && (texture.image == VK_NULL_HANDLE || copyMip < texture.residentMip)))
+	{
+		return false;
+	}
+
+	VkImageCreateInfo imageCI{};
+	imageCI.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+	imageCI.imageType = VK_IMAGE_TYPE_2D;
+	imageCI.format = texture.format;
+	imageCI.extent = { MipSize(texture.extent.width, baseMip), MipSize(texture.extent.height, baseMip), 1 };
+	imageCI.mipLevels = levelCount - baseMip;
+	imageCI.arrayLayers = 1;
+	imageCI.samples = VK_SAMPLE_COUNT_1_BIT;
+	imageCI.tiling = VK_IMAGE_TILING_OPTIMAL;
+	imageCI.usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+	imageCI.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+	imageCI.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+	VkImage image = VK_NULL_HANDLE;
+	MemoryAllocation allocation;
+	if (!_allocator->CreateImage(imageCI, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, image, allocation))
+	{
+		return false;
+	}
+
+	// ] (ŏ̃C[W̏ꍇA`͊܂UpdateŐ錾Xe[Wœ]҂)
+	UploadTicket upload = 0;
+	size_t offset = 0;
+	for (auto i = baseMip; i < copyMip; ++i)
+	{
+		const auto size = texture.levels[i].length;
+		const VkExtent3D extent = { MipSize(texture.extent.width, i), MipSize(texture.extent.height, i), 1 };
+		const auto ticket = _uploadManager->UploadImage(image, texture.format, VK_IMAGE_ASPECT_COLOR_BIT, i - baseMip, 0, extent,
+			data.data() + offset, size, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+		if (ticket == 0)
+		{
+			// \ς݂̓]̓C[WQƂĂ̂ŁAj͂̃t[Ƃ̓]IĂ
+			RetireImage(image, allocation, VK_NULL_HANDLE, upload);
+			return false;
+		}
+		upload = ticket;
+		offset += size_t(size);
+	}
+
+	VkImageView view = VK_NULL_HANDLE;
+	VkImageViewCreateInfo viewCI{};
+	viewCI.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+	viewCI.image = image;
+	viewCI.viewType = VK_IMAGE_VIEW_TYPE_2D;
+	viewCI.format = texture.format;
+	viewCI.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, imageCI.mipLevels, 0, 1 };
+	vkCreateImageView(_device, &viewCI, nullptr, &view);
+
+	_residentBytes += allocation.size;
+	_heapIndex = _allocator->GetMemoryProperties().memoryTypes[allocation.memoryTypeIndex].heapIndex;
+	if (texture.image == VK_NULL_HANDLE)
+	{
+		texture.residentMip = baseMip;
+		texture.image = image;
+		texture.allocation = allocation;
+		texture.view = view;
+		texture.handle = _bindlessTable->IsAvailable() ? _bindlessTable->AddTexture(view) : BindlessTable::InvalidHandle;
+		texture.upload = upload;
+		return true;
+	}
+
+	// 풓Ămip̃Rs[ (̃C[W͒u܂ŎĝŁARs[̌`悪ǂރCAEgɖ߂)
+	if (copyMip < levelCount)
+	{
+		Copy copy;
+		copy.source = texture.image;
+		copy.destination = image;
+		copy.sourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, copyMip - texture.residentMip, levelCount - copyMip, 0, 1 };
+		copy.destinationRange = { VK_IMAGE_ASPECT_COLOR_BIT, copyMip - baseMip, levelCount - copyMip, 0, 1 };
+		for (auto i = copyMip; i < levelCount; ++i)
+		{
+			VkImageCopy region{};
+			region.srcSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, i - texture.residentMip, 0, 1 };
+			region.dstSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, i - baseMip, 0, 1 };
+			region.extent = { MipSize(texture.extent.width, i), MipSize(texture.extent.height, i), 1 };
+			copy.regions.push_back(region);
+		}
+		_copies.push_back(std::move(copy));
+	}
+
+	texture.nextMip = baseMip;
+	texture.nextImage = image;
+	texture.nextAllocation = allocation;
+	texture.nextView = view;
+	texture.nextUpload = upload;
+	return true;
+}
+
+// 蒼C[Wɒu (gĂXbg͏AVXbgɓo^)
+// ]͊Ă̂ŁA`悪҂Ƃ͂Ȃ
+void TextureStreamer::PublishNext(Texture& texture)
+{
+	RetireImage(texture);
+	texture.residentMip = texture.nextMip;
+	texture.image = texture.nextImage;
+	texture.allocation = texture.nextAllocation;
+	texture.view = texture.nextView;
+	texture.handle = _bindlessTable->IsAvailable() ? _bindlessTable->AddTexture(texture.view) : BindlessTable::InvalidHandle;
+	texture.upload = 0;
+
+	texture.nextMip = InvalidMip;
+	texture.nextImage = VK_NULL_HANDLE;
+	texture.nextAllocation = MemoryAllocation();
+	texture.nextView = VK_NULL_HANDLE;
+	texture.nextUpload = 0;
+}
+
+// ̃C[Wj҂ɂ (XbgBindlessTablegIĂėp)
+void TextureStreamer::RetireImage(Texture& texture)
+{
+	if (texture.image == VK_NULL_HANDLE)
+	{
+		return;
+	}
+	if (texture.handle != BindlessTable::InvalidHandle)
+	{
+		_bindlessTable->Remove(BindlessTable::Kind::Texture, texture.handle);
+	}
+	_residentBytes -= texture.allocation.size;
+
+	RetireImage(texture.image, texture.allocation, texture.view, texture.upload);
+	texture.image = VK_NULL_HANDLE;
+	texture.allocation = MemoryAllocation();
+	texture.view = VK_NULL_HANDLE;
+	texture.handle = BindlessTable::InvalidHandle;
+	texture.upload = 0;
+	texture.residentMip = uint32_t(texture.levels.size());
+}
+
+// 蒼̃C[Wj҂ɂ
+void TextureStreamer::RetireNext(Texture& texture)
+{
+	if (texture.nextImage == VK_NULL_HANDLE)
+	{
+		return;
+	}
+	_residentBytes -= texture.nextAllocation.size;
+
+	RetireImage(texture.nextImage, texture.nextAllocation, texture.nextView, texture.nextUpload);
+	texture.nextMip = InvalidMip;
+	texture.nextImage = VK_NULL_HANDLE;
+	texture.nextAllocation = MemoryAllocation();
+	texture.nextView = VK_NULL_HANDLE;
+	texture.nextUpload = 0;
+}
+
+// j҂ɂ
+// _frameNumberԖڂ̃t[ (ꂩL^) gĂ\̂ŁAOtBbNXL[̒l
+// _frameNumber + 1 (̃t[̑M) ɒBĂj
+// `͎gȂ]̊҂Ȃ̂ŁAupload̓]IĂȂΓ]L[̒l̑MɒB̂҂
+void TextureStreamer::RetireImage(VkImage image, MemoryAllocation allocation, VkImageView view, UploadTicket upload)
+{
+	_retiring.push_back(Retiring{ _frameNumber + 1, allocation.size });
+	_retiringBytes += allocation.size;
+
+	const auto transferValue = upload != 0 && !_uploadManager->IsComplete(upload) ? _uploadManager->GetTransferValue(upload) : 0;
+	auto device = _device;
+	auto allocator = _allocator;
+	_deletionQueue->Retire(GpuTimeline::Graphics, _frameNumber + 1, GpuTimeline::Transfer, transferValue,
+		[device, allocator, image, allocation, view]() mutable
+	{
+		vkDestroyImageView(device, view, nullptr);
+		allocator->DestroyImage(image, allocation);
+	});
+}
+
+// t[Ƃ̍XV
+void TextureStreamer::Update(uint64_t frameNumber, uint64_t completedFrames)
+{
+	_frameNumber = frameNumber;
+
+	// t[gĂC[WDeletionQueueŔjĂ
+	while (!_retiring.empty() && _retiring.front().frame <= completedFrames)
+	{
+		_retiringBytes -= _retiring.front().bytes;
+		_retiring.pop_front();
+	}
+
+	// ǂݍ݂̏Imip]
+	std::vector<LoadResult> results;
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		VkDeviceSize bytes = 0;
+		auto count = size_t(0);
+		while (count < _results.size() && (count == 0 || bytes + _results[count].data.size() <= MaxUploadBytesPerFrame))
+		{
+			bytes += _results[count].data.size();
+			++count;
+		}
+		results.assign(std::make_move_iterator(_results.begin()), std::make_move_iterator(_results.begin() + count));
+		_results.erase(_results.begin(), _results.begin() + count);
+	}
+	for (auto& v : results)
+	{
+		auto& texture = *_textures[v.id];
+		texture.loadingMip = InvalidMip;
+		--_pendingLoads;
+		_loadingBytes -= (std::min)(_loadingBytes, GetChainBytes(texture, v.baseMip));
+
+		// ǂmip]A菬mip͍̃C[WRs[
+		if (v.data.empty() || !MakeResident(texture, v.baseMip, v.baseMip + 1, v.data))
+		{
+			// ǂ߂ȂA܂͓]łȂ傫mip͂ȏǂ܂Ȃ
+			std::fprintf(stderr, "failed to stream mip %u of %s\n", v.baseMip, texture.path.c_str());
+			texture.limitMip = (std::max)(texture.limitMip, v.baseMip + 1);
+		}
+	}
+
+	// 񍐂ꂽ傫Kvmip߂
+	for (auto& v : _textures)
+	{
+		const auto size = v->requestedSize.exchange(0, std::memory_order_relaxed);
+		if (size == 0)
+		{
+			continue;
+		}
+
+		const auto levelCount = uint32_t(v->levels.size());
+		uint32_t mip = 0;
+		while (mip + 1 < levelCount && (std::max)(MipSize(v->extent.width, mip + 1), MipSize(v->extent.height, mip + 1)) >= size)
+		{
+			++mip;
+		}
+		v->wantedMip = (std::max)(mip, v->limitMip);
+		v->lastUsedFrame = frameNumber;
+	}
+
+	// ]̏IĂȂC[W͂̃t[̕`悪ǂނȂ̂ŁAǂރXe[WŊ҂
+	for (auto& v : _textures)
+	{
+		if (v->upload == 0)
+		{
+			continue;
+		}
+		if (_uploadManager->IsComplete(v->upload))
+		{
+			v->upload = 0;
+			continue;
+		}
+		_uploadManager->Require(v->upload, TextureReadStages);
+	}
+
+	// 蒼C[ŴARs[L^ē]̂ɒu
+	// (]͂̃t[RecordAcquireŏLڂ)
+	for (auto& v : _textures)
+	{
+		if (v->nextImage == VK_NULL_HANDLE || (v->nextUpload != 0 && !_uploadManager->IsComplete(v->nextUpload)))
+		{
+			continue;
+		}
+		const auto nextImage = v->nextImage;
+		const auto copying = std::any_of(_copies.begin(), _copies.end(), [nextImage](const Copy& copy) { return copy.destination == nextImage; });
+		if (!copying)
+		{
+			PublishNext(*v);
+		}
+	}
+
+	DecideLoads(frameNumber);
+}
+
+// \Zɍ킹ēǂݍmipƎ̂Ămip߂
+void TextureStreamer::DecideLoads(uint64_t frameNumber)
+{
+	if (_heapIndex == ~0u)
+	{
+		return;
+	}
+
+	const auto budget = _allocator->GetHeapBudget(_heapIndex);
+	const auto target = VkDeviceSize(double(budget.budget) * _budgetScale);
+
+	// j҂̃C[WƁAC[Wɍ蒼Ăr̍̃C[W͖̃߂Ă̂ŁA
+	// ̂Ă邩ǂ͂Č߂
+	auto returning = _retiringBytes;
+	for (const auto& v : _textures)
+	{
+		if (v->nextImage != VK_NULL_HANDLE && v->nextMip > v->residentMip)
+		{
+			returning += GetChainBytes(*v, v->residentMip) - GetChainBytes(*v, v->nextMip);
+		}
+	}
+	auto usage = budget.usage - (std::min)(budget.usage, returning);
+
+	// \Z𒴂Ăꍇ́AgĂȂ̂1i̂Ă
+	// (t@C͓ǂ܂Acmip̃C[WRs[C[Wɒu)
+	// Rs[ɂȂ̂ŁA]̏IĂȂ̂͏
+	if (usage > target)
+	{
+		std::vector<TextureId> candidates;
+		for (TextureId i = 0; i < _textures.size(); ++i)
+		{
+			const auto& v = *_textures[i];
+			if (v.loadingMip == InvalidMip && v.nextImage == VK_NULL_HANDLE && v.upload == 0 && v.residentMip + 1 < v.levels.size())
+			{
+				candidates.push_back(i);
+			}
+		}
+
+		// Kvȏɑ傫mipẮAẤA傫̂̏
+		std::sort(candidates.begin(), candidates.end(), [this](TextureId a, TextureId b)
+		{
+			const auto& x = *_textures[a];
+			const auto& y = *_textures[b];
+			const auto xExcess = x.wantedMip > x.residentMip;
+			const auto yExcess = y.wantedMip > y.residentMip;
+			if (xExcess != yExcess)
+			{
+				return xExcess;
+			}
+			if (x.lastUsedFrame != y.lastUsedFrame)
+			{
+				return x.lastUsedFrame < y.lastUsedFrame;
+			}
+			return x.allocation.size > y.allocation.size;
+		});
+
+		for (auto id : candidates)
+		{
+			if (usage <= target)
+			{
+				break;
+			}
+			auto& texture = *_textures[id];
+			const auto bytes = VkDeviceSize(texture.levels[texture.residentMip].length);
+			const auto baseMip = texture.residentMip + 1;
+			if (!MakeResident(texture, baseMip, baseMip, std::vector<uint8_t>()))
+			{
+				continue;
+			}
+			texture.evictedFrame = frameNumber;
+			usage -= (std::min)(usage, bytes);
+			++_evictedCount;
+		}
+		return;
+	}
+
+	// \ZɎ܂͈͂ŁAŋߎgꂽ̂1i傫mipǂ
+	// 蒼C[W͌ÂC[W̔j܂œɑ݂̂ŁAj҂̂̂Ɠǂݍݒ̂̂܂߂gpʂ
+	// Vmip`F[Ŝ̑傫ė\ZƔׂ (ÂC[WRs[Ȃ̂ŁA]̏IĂȂ̂͏)
+	if (_pendingLoads >= MaxPendingLoads)
+	{
+		return;
+	}
+	usage = budget.usage + _loadingBytes;
+
+	std::vector<TextureId> candidates;
+	for (TextureId i = 0; i < _textures.size(); ++i)
+	{
+		const auto& v = *_textures[i];
+		const auto coolingDown = v.evictedFrame != 0 && v.evictedFrame + EvictionCooldownFrames > frameNumber;
+		if (v.loadingMip == InvalidMip && v.nextImage == VK_NULL_HANDLE && v.upload == 0 && v.wantedMip < v.residentMip
+			&& v.residentMip < v.levels.size() && !coolingDown)
+		{
+			candidates.push_back(i);
+		}
+	}
+	std::sort(candidates.begin(), candidates.end(), [this](TextureId a, TextureId b)
+	{
+		const auto& x = *_textures[a];
+		const auto& y = *_textures[b];
+		if (x.lastUsedFrame != y.lastUsedFrame)
+		{
+			return x.lastUsedFrame > y.lastUsedFrame;
+		}
+		return x.residentMip - x.wantedMip > y.residentMip - y.wantedMip;
+	});
+
+	for (auto id : candidates)
+	{
+		if (_pendingLoads >= MaxPendingLoads)
+		{
+			break;
+		}
+		auto& texture = *_textures[id];
+		const auto bytes = GetChainBytes(texture, texture.residentMip - 1);
+		if (usage + bytes > target)
+		{
+			break;
+		}
+		usage += bytes;
+		QueueLoad(id, texture.residentMip - 1);
+		++_streamedInCount;
+	}
+}
+
+// ǂݍ݃Xbhւ̈˗
+void TextureStreamer::QueueLoad(TextureId id, uint32_t baseMip)
+{
+	auto& texture = *_textures[id];
+	texture.loadingMip = baseMip;
+	++_pendingLoads;
+	_loadingBytes += GetChainBytes(texture, baseMip);
+
+	LoadRequest request = { id, baseMip, texture.path, texture.levels[baseMip] };
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_requests.push_back(std::move(request));
+	}
+	_condition.notify_one();
+}
+
+// t@Cǂ݁AʂUpdateɓn
+void TextureStreamer::LoaderMain()
+{
+	std::unique_lock<std::mutex> lock(_mutex);
+	for (;;)
+	{
+		_condition.wait(lock, [this]() { return _quit || !_requests.empty(); });
+		if (_quit)
+		{
+			return;
+		}
+
+		auto request = std::move(_requests.front());
+		_requests.pop_front();
+		lock.unlock();
+
+		LoadResult result;
+		result.id = request.id;
+		result.baseMip = request.baseMip;
+		ReadLevels(request.path, std::vector<Level>(1, request.level), 0, 1, result.data);
+
+		lock.lock();
+		_results.push_back(std::move(result));
+	}
+}
+
+// 풓Ămip̃Rs[
+// Rs[͕`悪ǂł郌CAEgꎞIɓ]֕ςARs[̎cmip͖`]ɂ
+// (蒼C[WɎ̃Rs[ɂȂꍇ̂ŁA1ɋL^)
+void TextureStreamer::RecordCopies(VkCommandBuffer command)
+{
+	for (const auto& v : _copies)
+	{
+		std::array<VkImageMemoryBarrier, 2> barriers{};
+		for (auto& barrier : barriers)
+		{
+			barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+			barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		}
+		barriers[0].image = v.source;
+		barriers[0].subresourceRange = v.sourceRange;
+		barriers[1].image = v.destination;
+		barriers[1].subresourceRange = v.destinationRange;
+
+		// Õt[̕`悪ǂݏIĂRs[
+		barriers[0].oldLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		barriers[0].newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+		barriers[0].dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+		barriers[1].oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		barriers[1].newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		barriers[1].dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		vkCmdPipelineBarrier(command, TextureReadStages | VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr,
+			uint32_t(barriers.size()), barriers.data());
+
+		vkCmdCopyImage(command, v.source, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, v.destination, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+			uint32_t(v.regions.size()), v.regions.data());
+
+		// ǂ`悪ǂރCAEg
+		barriers[0].oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+		barriers[0].newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		barriers[0].srcAccessMask = 0;
+		barriers[0].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+		barriers[1].oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		barriers[1].newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		barriers[1].srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barriers[1].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+		vkCmdPipelineBarrier(command, VK_PIPELINE_STAGE_TRANSFER_BIT, TextureReadStages | VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr,
+			uint32_t(barriers.size()), barriers.data());
+	}
+	_copies.clear();
+}
+
+TextureStreamer::Stats TextureStreamer::GetStats() const
+{
+	Stats stats;
+	stats.textureCount = uint32_t(_textures.size());
+	stats.pendingLoads = _pendingLoads;
+	stats.residentBytes = _residentBytes;
+	stats.streamedInCount = _streamedInCount;
+	stats.evictedCount = _evictedCount;
+	return stats;
+}
@@ -0,0 +1,191 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <vector>
+#include <deque>
+#include <string>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+#include "MemoryAllocator.h"
+#include "UploadManager.h"
+#include "BindlessTable.h"
+#include "DeletionQueue.h"
+
+// KTX2mip`F[eNX`Aʏ̑傫ɍ킹ĕKvmip풓
+// ǂݍݒ͏mip (InitialResidentSizeȉ) A`掞ɕ񍐂ꂽ傫ɍ킹
+// 1i傫mipǉ (t@Cǂœ]̂͒ǉmip)
+// foCX[J̃q[v\Z (VK_EXT_memory_budget) 𒴂ꍇ́AgĂȂ̂傫mip̂Ă
+// 풓mipςƃC[W蒼A풓Ămip͌ÂC[WGPUŃRs[ (RecordCopies)
+// 蒼C[W͓]ĂBindlessTable̐VXbgɓo^A܂ł͌ÂC[Wg
+// (`悪Xg[~O̓]҂Ƃ͂ȂAÂ͎̂gĂt[̊ɔj)
+// (RequestSizeȊO̓CXbhĂ)
+class TextureStreamer
+{
+public:
+	typedef uint32_t TextureId;
+	static const TextureId InvalidTexture = ~0u;
+
+	// ǂݍݎɏ풓mip̑傫̏ (ƍ̑傫)
+	static const uint32_t InitialResidentSize = 64;
+
+	struct Stats
+	{
+		uint32_t textureCount;
+		uint32_t pendingLoads;			// t@C̓ǂݍݑ҂
+		VkDeviceSize residentBytes;		// SẴeNX`gĂfoCX
+		uint32_t streamedInCount;		// mipǉ
+		uint32_t evictedCount;			// \Z𒴂߂mip̂Ă
+	};
+
+	TextureStreamer();
+	~TextureStreamer();
+
+	// budgetScale̓q[v̗\ẐgĂ悢 (̃\[X̂߂ɗ]Tc)
+	void Initialize(VkDevice device, MemoryAllocator* allocator, UploadManager* uploadManager, BindlessTable* bindlessTable,
+		DeletionQueue* deletionQueue, float budgetScale = 0.9f);
+	void Terminate();
+
+	// KTX2t@C̓ǂݍ (wb_[ƏmipǂށAsꍇInvalidTexture)
+	// t[̋L^ɂ͌Ă΂Ȃ
+	TextureId Load(const std::string& path);
+
+	// `悷eNX`̉ʏ̑傫 (sNZ) 񍐂 (L^ɂǂ̃XbhĂׂ)
+	// t[̍ől玟UpdateŕKvmip߂
+	void RequestSize(TextureId id, uint32_t pixels);
+
+	// VF[_[֓nXbg (Updateŕς邱Ƃ̂Ńt[ƂɎ擾)
+	// 蒼̃C[W͓]܂ŕԂȂ
+	BindlessTable::Handle GetHandle(TextureId id) const { return _textures[id]->handle; }
+	VkImageView GetView(TextureId id) const { return _textures[id]->view; }
+
+	// 풓Ăł傫mip
+	uint32_t GetResidentMip(TextureId id) const { return _textures[id]->residentMip; }
+
+	// t[̊JnɌĂ (frameNumber͂ꂩL^t[AcompletedFramesGPUt[)
+	// ǂݍ݂̏Imip̓]ƁA\Zɍ킹ǂݍ݁EǰȂ
+	void Update(uint64_t frameNumber, uint64_t completedFrames);
+
+	// Updateō蒼C[WցA풓ĂmipÂC[WRs[
+	// (UpdatěAeNX`ǂޕ`OɃOtBbNXL[̃R}hobt@֋L^)
+	void RecordCopies(VkCommandBuffer command);
+
+	Stats GetStats() const;
+
+private:
+	struct Level
+	{
+		uint64_t offset;
+		uint64_t length;
+	};
+
+	struct Texture
+	{
+		std::string path;
+		VkFormat format;
+		VkExtent2D extent;
+		std::vector<Level> levels;		// 0ł傫
+
+		// 풓Ă (baseMiplevels.size()-1܂)
+		uint32_t residentMip;
+		VkImage image;
+		MemoryAllocation allocation;
+		VkImageView view;
+		BindlessTable::Handle handle;
+		UploadTicket upload;			// C[Wւ̓] (mF0)
+
+		// 蒼̃C[W (nextMipmipA蒼łȂnextMipInvalidMip)
+		// Vmip̓]Ə풓Ămip̃Rs[I獡̃C[Wƒu
+		uint32_t nextMip;
+		VkImage nextImage;
+		MemoryAllocation nextAllocation;
+		VkImageView nextView;
+		UploadTicket nextUpload;
+
+		uint32_t loadingMip;			// ǂݍݒbaseMip (ǂݍݒłȂInvalidMip)
+		uint32_t limitMip;				// 傫mip͓ǂ܂Ȃ (]łȂꍇ)
+		uint32_t wantedMip;
+		uint64_t lastUsedFrame;
+		uint64_t evictedFrame;
+		std::atomic<uint32_t> requestedSize;
+	};
+
+	// obNOEhXbhł̓ǂݍ (ǉ1mipǂ)
+	struct LoadRequest
+	{
+		TextureId id;
+		uint32_t baseMip;
+		std::string path;
+		Level level;
+	};
+	struct LoadResult
+	{
+		TextureId id;
+		uint32_t baseMip;
+		std::vector<uint8_t> data;		// baseMipmip (̏ꍇ͎s)
+	};
+
+	// ÂC[W蒼C[Wւmip̃Rs[
+	struct Copy
+	{
+		VkImage source;
+		VkImage destination;
+		VkImageSubresourceRange sourceRange;
+		VkImageSubresourceRange destinationRange;
+		std::vector<VkImageCopy> regions;
+	};
+
+	// j҂̃C[W̃ (GPUframe܂ł̃t[߂)
+	struct Retiring
+	{
+		uint64_t frame;
+		VkDeviceSize bytes;
+	};
+
+	static const uint32_t InvalidMip = ~0u;
+
+	static bool ReadHeader(const std::string& path, Texture& texture);
+	static bool ReadLevels(const std::string& path, const std::vector<Level>& levels, uint32_t baseMip, uint32_t endMip, std::vector<uint8_t>& data);
+	static VkDeviceSize GetChainBytes(const Texture& texture, uint32_t baseMip);
+	bool MakeResident(Texture& texture, uint32_t baseMip, uint32_t copyMip, const std::vector<uint8_t>& data);
+	void PublishNext(Texture& texture);
+	void RetireImage(Texture& texture);
+	void RetireNext(Texture& texture);
+	void RetireImage(VkImage image, MemoryAllocation allocation, VkImageView view, UploadTicket upload);
+	void DecideLoads(uint64_t frameNumber);
+	void QueueLoad(TextureId id, uint32_t baseMip);
+	void LoaderMain();
+
+	VkDevice _device;
+	MemoryAllocator* _allocator;
+	UploadManager* _uploadManager;
+	BindlessTable* _bindlessTable;
+	DeletionQueue* _deletionQueue;
+	float _budgetScale;
+	uint64_t _frameNumber;
+	uint32_t _heapIndex;		// eNX`uq[v (ŏ̃eNX`܂~0u)
+
+	std::vector<std::unique_ptr<Texture>> _textures;
+	VkDeviceSize _residentBytes;
+	VkDeviceSize _loadingBytes;		// ǂݍݒmipōC[W̑傫 (܂mۂĂȂ)
+	uint32_t _pendingLoads;
+	uint32_t _streamedInCount;
+	uint32_t _evictedCount;
+
+	// L^҂̃Rs[ƁAj҂̃C[W̃
+	std::vector<Copy> _copies;
+	std::deque<Retiring> _retiring;
+	VkDeviceSize _retiringBytes;
+
+	// ǂݍ݃Xbh
+	std::thread _loader;
+	std::mutex _mutex;
+	std::condition_variable _condition;
+	std::deque<LoadRequest> _requests;
+	std::vector<LoadResult> _results;
+	bool _quit;
+};
@@ -0,0 +1,627 @@
+#include "UploadManager.h"
+
+#include <algorithm>
+#include <cstring>
+
+// Oobt@̃Rs[̃ACg
+// (C[Wւ̃Rs[ł́AeNZ(ubN)̃TCY16ȉ2ׂ̂̃tH[}bg̃ACgő)
+static const VkDeviceSize StagingAlignment = 16;
+
+static VkDeviceSize AlignUp(VkDeviceSize value, VkDeviceSize alignment)
+{
+	return (value + alignment - 1) / alignment * alignment;
+}
+
+
+UploadManager::UploadManager() : _device(VK_NULL_HANDLE), _allocator(nullptr), _timeline(nullptr), _transferQueueFamilyIndex(0), _graphicsQueueFamilyIndex(0),
+	_transferQueue(VK_NULL_HANDLE), _commandPool(VK_NULL_HANDLE), _stagingBuffer(VK_NULL_HANDLE), _stagingSize(0), _stagingHead(0), _stagingTail(0),
+	_stagingEmpty(true), _nextTicket(1), _completedTicket(0)
+{
+}
+
+// R}hv[ƃXe[WOp̃Oobt@̐
+void UploadManager::Initialize(VkDevice device, MemoryAllocator* allocator, GpuTimeline* timeline, uint32_t transferQueueFamilyIndex,
+	VkQueue transferQueue, uint32_t graphicsQueueFamilyIndex, VkDeviceSize stagingSize)
+{
+	_device = device;
+	_allocator = allocator;
+	_timeline = timeline;
+	_transferQueueFamilyIndex = transferQueueFamilyIndex;
+	_transferQueue = transferQueue;
+	_graphicsQueueFamilyIndex = graphicsQueueFamilyIndex;
+
+	VkCommandPoolCreateInfo poolCI{};
+	poolCI.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+	poolCI.queueFamilyIndex = _transferQueueFamilyIndex;
+	poolCI.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+	vkCreateCommandPool(_device, &poolCI, nullptr, &_commandPool);
+
+	// ݂݂̂Ȃ̂HOST_CACHED͕sv
+	VkBufferCreateInfo bufferCI{};
+	bufferCI.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	bufferCI.size = stagingSize;
+	bufferCI.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+	bufferCI.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+	if (_allocator->CreateBuffer(bufferCI, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, 0,
+		_stagingBuffer, _stagingAllocation))
+	{
+		_stagingSize = stagingSize;
+	}
+
+	_stagingHead = 0;
+	_stagingTail = 0;
+	_stagingEmpty = true;
+}
+
+// SẴIuWFNg̔j (GPŮ҂ĂĂ)
+void UploadManager::Terminate()
+{
+	_pendingBuffers.clear();
+	_pendingImages.clear();
+
+	for (auto& v : _batches)
+	{
+		if (v.semaphore != VK_NULL_HANDLE)
+		{
+			_freeSemaphores.push_back(v.semaphore);
+		}
+	}
+	_batches.clear();
+	for (auto& v : _waitingSemaphores)
+	{
+		_freeSemaphores.push_back(v.semaphore);
+	}
+	_waitingSemaphores.clear();
+	_requirements.clear();
+
+	for (auto& v : _freeSemaphores)
+	{
+		vkDestroySemaphore(_device, v, nullptr);
+	}
+	_freeSemaphores.clear();
+
+	// R}hobt@̓v[ƈꏏɊJ
+	_freeCommandBuffers.clear();
+	if (_commandPool != VK_NULL_HANDLE)
+	{
+		vkDestroyCommandPool(_device, _commandPool, nullptr);
+		_commandPool = VK_NULL_HANDLE;
+	}
+
+	if (_stagingBuffer != VK_NULL_HANDLE)
+	{
+		_allocator->DestroyBuffer(_stagingBuffer, _stagingAllocation);
+	}
+	_stagingSize = 0;
+}
+
+// obt@ւ̓]̗\ (Rs[I܂ŃbNArő̃XbhFlushɑMȂ悤ɂ)
+UploadTicket UploadManager::UploadBuffer(VkBuffer buffer, VkDeviceSize offset, const void* data, VkDeviceSize size)
+{
+	std::lock_guard<std::recursive_mutex> lock(_mutex);
+	UploadTicket ticket = 0;
+	auto staging = ReserveBufferUpload(buffer, offset, size, &ticket);
+	if (staging == nullptr)
+	{
+		return 0;
+	}
+	memcpy(staging, data, size_t(size));
+	return ticket;
+}
+
+// ]𒼐ڏޗ̗̈\
+// (Oobt@t̏ꍇ͗\񒆂̓]M̂ŁA`Pbg͊mۂ̌Ō܂)
+void* UploadManager::ReserveBufferUpload(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize size, UploadTicket* ticket)
+{
+	std::lock_guard<std::recursive_mutex> lock(_mutex);
+	VkDeviceSize stagingOffset;
+	if (!AllocateStaging(size, StagingAlignment, stagingOffset))
+	{
+		return nullptr;
+	}
+
+	PendingBufferCopy copy;
+	copy.buffer = buffer;
+	copy.region.srcOffset = stagingOffset;
+	copy.region.dstOffset = offset;
+	copy.region.size = size;
+	_pendingBuffers.push_back(copy);
+	if (ticket != nullptr)
+	{
+		*ticket = _nextTicket;
+	}
+	return static_cast<uint8_t*>(_stagingAllocation.mapped) + stagingOffset;
+}
+
+// C[Wւ̓]̗\
+UploadTicket UploadManager::UploadImage(VkImage image, VkFormat format, VkImageAspectFlags aspect, uint32_t mipLevel, uint32_t arrayLayer,
+	VkExtent3D extent, const void* data, VkDeviceSize size, VkImageLayout finalLayout)
+{
+	std::lock_guard<std::recursive_mutex> lock(_mutex);
+	VkDeviceSize stagingOffset;
+	if (!AllocateStaging(size, GetImageCopyAlignment(format), stagingOffset))
+	{
+		return 0;
+	}
+	memcpy(static_cast<uint8_t*>(_stagingAllocation.mapped) + stagingOffset, data, size_t(size));
+
+	PendingImageCopy copy;
+	copy.image = image;
+	copy.region = VkBufferImageCopy{};
+	copy.region.bufferOffset = stagingOffset;
+	copy.region.imageSubresource = { aspect, mipLevel, arrayLayer, 1 };
+	copy.region.imageExtent = extent;
+	copy.finalLayout = finalLayout;
+	_pendingImages.push_back(copy);
+	return _nextTicket;
+}
+
+// \񂵂]܂Ƃ߂đM
+UploadTicket UploadManager::Flush()
+{
+	std::lock_guard<std::recursive_mutex> lock(_mutex);
+	if (_pendingBuffers.empty() && _pendingImages.empty())
+	{
+		return _nextTicket - 1;
+	}
+
+	const bool dedicated = HasDedicatedQueue();
+	const auto srcFamily = dedicated ? _transferQueueFamilyIndex : VK_QUEUE_FAMILY_IGNORED;
+	const auto dstFamily = dedicated ? _graphicsQueueFamilyIndex : VK_QUEUE_FAMILY_IGNORED;
+	const VkAccessFlags dstAccess = dedicated ? 0 : VkAccessFlags(VK_ACCESS_MEMORY_READ_BIT);
+
+	Batch batch;
+	batch.ticket = _nextTicket++;
+	batch.command = AcquireCommandBuffer();
+	batch.value = 0;
+	batch.semaphore = dedicated && !_timeline->IsSupported() ? AcquireSemaphore() : VK_NULL_HANDLE;
+	batch.stagingEnd = _stagingHead;
+	batch.acquired = !dedicated;
+
+	auto command = batch.command;
+	VkCommandBufferBeginInfo bi{};
+	bi.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	bi.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+	vkBeginCommandBuffer(command, &bi);
+
+	// C[W]̃CAEg֑Jڂ
+	std::vector<VkImageMemoryBarrier> imageBarriers(_pendingImages.size());
+	for (size_t i = 0; i < _pendingImages.size(); ++i)
+	{
+		const auto& copy = _pendingImages[i];
+		auto& barrier = imageBarriers[i];
+		barrier = VkImageMemoryBarrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		barrier.srcAccessMask = 0;
+		barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.image = copy.image;
+		barrier.subresourceRange = { copy.region.imageSubresource.aspectMask, copy.region.imageSubresource.mipLevel, 1,
+			copy.region.imageSubresource.baseArrayLayer, 1 };
+	}
+	if (!imageBarriers.empty())
+	{
+		vkCmdPipelineBarrier(command, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+			0, nullptr, 0, nullptr, uint32_t(imageBarriers.size()), imageBarriers.data());
+	}
+
+	// obt@ւ̃Rs[1vkCmdCopyBufferɂ܂Ƃ߂
+	std::stable_sort(_pendingBuffers.begin(), _pendingBuffers.end(), [](const PendingBufferCopy& a, const PendingBufferCopy& b)
+	{
+		return a.buffer < b.buffer;
+	});
+
+	std::vector<VkBufferMemoryBarrier> bufferBarriers;
+	std::vector<VkBufferCopy> regions;
+	for (size_t i = 0; i < _pendingBuffers.size();)
+	{
+		auto buffer = _pendingBuffers[i].buffer;
+		regions.clear();
+		for (; i < _pendingBuffers.size() && _pendingBuffers[i].buffer == buffer; ++i)
+		{
+			regions.push_back(_pendingBuffers[i].region);
+		}
+		vkCmdCopyBuffer(command, _stagingBuffer, buffer, uint32_t(regions.size()), regions.data());
+
+		VkBufferMemoryBarrier barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.dstAccessMask = dstAccess;
+		barrier.srcQueueFamilyIndex = srcFamily;
+		barrier.dstQueueFamilyIndex = dstFamily;
+		barrier.buffer = buffer;
+		barrier.offset = 0;
+		barrier.size = VK_WHOLE_SIZE;
+		bufferBarriers.push_back(barrier);
+	}
+
+	for (size_t i = 0; i < _pendingImages.size(); ++i)
+	{
+		const auto& copy = _pendingImages[i];
+		vkCmdCopyBufferToImage(command, _stagingBuffer, copy.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &copy.region);
+
+		// ŏIIȃCAEgւ̑J (]pL[̏ꍇ͏L̊J˂)
+		auto& barrier = imageBarriers[i];
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.dstAccessMask = dstAccess;
+		barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		barrier.newLayout = copy.finalLayout;
+		barrier.srcQueueFamilyIndex = srcFamily;
+		barrier.dstQueueFamilyIndex = dstFamily;
+	}
+
+	// ]pL[̏ꍇ͊Ĵ݂ŁA擾̓OtBbNXL[RecordAcquireȂ
+	// L[̏ꍇ͌㑱̃R}h]ʂǂ߂悤ɂ
+	vkCmdPipelineBarrier(command, VK_PIPELINE_STAGE_TRANSFER_BIT,
+		dedicated ? VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT : VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0,
+		0, nullptr, uint32_t(bufferBarriers.size()), bufferBarriers.data(), uint32_t(imageBarriers.size()), imageBarriers.data());
+	vkEndCommandBuffer(command);
+
+	if (dedicated)
+	{
+		// 擾̃oA͊JƓJڂw肷
+		for (auto& v : bufferBarriers)
+		{
+			v.srcAccessMask = 0;
+			v.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+		}
+		for (auto& v : imageBarriers)
+		{
+			v.srcAccessMask = 0;
+			v.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+		}
+		batch.bufferAcquires.swap(bufferBarriers);
+		batch.imageAcquires.swap(imageBarriers);
+	}
+
+	// MɎsꍇ͒l0ɂȂÂƂĈ
+	batch.value = _timeline->Submit(GpuTimeline::Transfer, _transferQueue, command, nullptr, batch.semaphore);
+
+	_pendingBuffers.clear();
+	_pendingImages.clear();
+	_batches.emplace_back(std::move(batch));
+	return _batches.back().ticket;
+}
+
+// ]
+bool UploadManager::IsComplete(UploadTicket ticket)
+{
+	std::lock_guard<std::recursive_mutex> lock(_mutex);
+	RetireBatches(false);
+	return ticket <= _completedTicket;
+}
+
+// ]̊҂
+void UploadManager::Wait(UploadTicket ticket)
+{
+	std::lock_guard<std::recursive_mutex> lock(_mutex);
+	// \񒆂̓]͑MĂ҂ (\̂Ȃ`Pbg͑҂Ȃ)
+	if (ticket >= _nextTicket)
+	{
+		Flush();
+		if (ticket >= _nextTicket)
+		{
+			return;
+		}
+	}
+
+	while (!IsComplete(ticket))
+	{
+		RetireBatches(true);
+	}
+}
+
+// `Pbg̑M̓]L[̃^CC̒l
+uint64_t UploadManager::GetTransferValue(UploadTicket ticket)
+{
+	std::lock_guard<std::recursive_mutex> lock(_mutex);
+	if (ticket == 0)
+	{
+		return 0;
+	}
+	if (ticket >= _nextTicket)
+	{
+		Flush();
+	}
+
+	for (const auto& v : _batches)
+	{
+		if (v.ticket == ticket)
+		{
+			return v.value;
+		}
+	}
+	return 0;
+}
+
+// ̃t[Ŏg]̐錾
+void UploadManager::Require(UploadTicket ticket, VkPipelineStageFlags stages)
+{
+	if (ticket == 0 || stages == 0)
+	{
+		return;
+	}
+	std::lock_guard<std::recursive_mutex> lock(_mutex);
+	_requirements.push_back(Requirement{ ticket, stages });
+}
+
+// t[̊Jn
+void UploadManager::BeginFrame(uint64_t completedFrames)
+{
+	std::lock_guard<std::recursive_mutex> lock(_mutex);
+	// t[ő҂Z}tH͎g񂹂
+	auto it = std::remove_if(_waitingSemaphores.begin(), _waitingSemaphores.end(), [&](const WaitingSemaphore& v)
+	{
+		if (v.frameNumber >= completedFrames)
+		{
+			return false;
+		}
+		_freeSemaphores.push_back(v.semaphore);
+		return true;
+	});
+	_waitingSemaphores.erase(it, _waitingSemaphores.end());
+
+	RetireBatches(false);
+}
+
+// L̎擾
+// ҋ@Ǝ擾̃oÁA̓]gXe[W~߂ (㑱̃t[̃oǍɕ)
+void UploadManager::RecordAcquire(VkCommandBuffer command, uint64_t frameNumber, GpuTimeline::WaitList& waits)
+{
+	std::lock_guard<std::recursive_mutex> lock(_mutex);
+	const auto completed = _timeline->GetCompleted(GpuTimeline::Transfer);
+	for (auto& v : _batches)
+	{
+		if (v.acquired)
+		{
+			continue;
+		}
+
+		// ̃t[ŎgXe[W (̑M̃`Pbg̐錾́AȎM̊҂)
+		VkPipelineStageFlags stages = 0;
+		for (const auto& r : _requirements)
+		{
+			if (r.ticket >= v.ticket)
+			{
+				stages |= r.stages;
+			}
+		}
+
+		// 錾ĂȂ]́AĂ擾 (Ă̂őҋ@Ŏ~܂Ȃ)
+		const auto complete = v.value <= completed;
+		if (stages == 0)
+		{
+			if (!complete)
+			{
+				continue;
+			}
+			stages = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+		}
+
+		// oCiZ}tH1x҂ (^CC̏ꍇ͊ĂȂΒl҂)
+		if (v.semaphore != VK_NULL_HANDLE)
+		{
+			waits.Add(v.semaphore, stages);
+			_waitingSemaphores.push_back(WaitingSemaphore{ frameNumber, v.semaphore });
+			v.semaphore = VK_NULL_HANDLE;
+		}
+		else if (!complete)
+		{
+			_timeline->AddWait(waits, GpuTimeline::Transfer, v.value, stages);
+		}
+
+		if (!v.bufferAcquires.empty() || !v.imageAcquires.empty())
+		{
+			vkCmdPipelineBarrier(command, stages, stages, 0, 0, nullptr, uint32_t(v.bufferAcquires.size()), v.bufferAcquires.data(),
+				uint32_t(v.imageAcquires.size()), v.imageAcquires.data());
+		}
+		v.bufferAcquires.clear();
+		v.imageAcquires.clear();
+		v.acquired = true;
+	}
+	_requirements.clear();
+
+	RetireBatches(false);
+}
+
+// C[Wւ̃Rs[̃ACg
+// bufferOffset̓eNZ(ubN)̃TCY4̗̔{łKv̂ŁA̍ŏ{ɂ
+// 3E6E12E24E32oCg̃eNZȊOStagingAlignmentő (ktH[}bg̃ubN816oCg)
+VkDeviceSize UploadManager::GetImageCopyAlignment(VkFormat format)
+{
+	VkDeviceSize texelSize = StagingAlignment;
+	switch (format)
+	{
+	case VK_FORMAT_R8G8B8_UNORM:
+	case VK_FORMAT_R8G8B8_SNORM:
+	case VK_FORMAT_R8G8B8_USCALED:
+	case VK_FORMAT_R8G8B8_SSCALED:
+	case VK_FORMAT_R8G8B8_UINT:
+	case VK_FORMAT_R8G8B8_SINT:
+	case VK_FORMAT_R8G8B8_SRGB:
+	case VK_FORMAT_B8G8R8_UNORM:
+	case VK_FORMAT_B8G8R8_SNORM:
+	case VK_FORMAT_B8G8R8_USCALED:
+	case VK_FORMAT_B8G8R8_SSCALED:
+	case VK_FORMAT_B8G8R8_UINT:
+	case VK_FORMAT_B8G8R8_SINT:
+	case VK_FORMAT_B8G8R8_SRGB:
+		texelSize = 3;
+		break;
+	case VK_FORMAT_R16G16B16_UNORM:
+	case VK_FORMAT_R16G16B16_SNORM:
+	case VK_FORMAT_R16G16B16_USCALED:
+	case VK_FORMAT_R16G16B16_SSCALED:
+	case VK_FORMAT_R16G16B16_UINT:
+	case VK_FORMAT_R16G16B16_SINT:
+	case VK_FORMAT_R16G16B16_SFLOAT:
+		texelSize = 6;
+		break;
+	case VK_FORMAT_R32G32B32_UINT:
+	case VK_FORMAT_R32G32B32_SINT:
+	case VK_FORMAT_R32G32B32_SFLOAT:
+		texelSize = 12;
+		break;
+	case VK_FORMAT_R64G64B64_UINT:
+	case VK_FORMAT_R64G64B64_SINT:
+	case VK_FORMAT_R64G64B64_SFLOAT:
+		texelSize = 24;
+		break;
+	case VK_FORMAT_R64G64B64A64_UINT:
+	case VK_FORMAT_R64G64B64A64_SINT:
+	case VK_FORMAT_R64G64B64A64_SFLOAT:
+		texelSize = 32;
+		break;
+	default:
+		break;
+	}
+
+	auto alignment = texelSize;
+	while (alignment % 4 != 0)
+	{
+		alignment += texelSize;
+	}
+	return alignment;
+}
+
+// Oobt@̊m (󂫂Ȃꍇ͌Â]̊҂)
+bool UploadManager::AllocateStaging(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize& offset)
+{
+	if (size > _stagingSize)
+	{
+		return false;
+	}
+
+	while (!FindStagingSpace(size, alignment, offset))
+	{
+		// \񒆂̓]Oobt@gĂꍇ͐ɑM
+		Flush();
+
+		auto inFlight = std::find_if(_batches.begin(), _batches.end(), [](const Batch& v) { return v.command != VK_NULL_HANDLE; });
+		if (inFlight == _batches.end())
+		{
+			return false;
+		}
+		RetireBatches(true);
+	}
+
+	_stagingHead = offset + size;
+	_stagingEmpty = false;
+	return true;
+}
+
+// Oobt@̋󂫂T ([_stagingTail, _stagingHead) gpAvꍇ͖t)
+bool UploadManager::FindStagingSpace(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize& offset) const
+{
+	if (_stagingEmpty)
+	{
+		offset = 0;
+		return true;
+	}
+
+	const auto begin = AlignUp(_stagingHead, alignment);
+	if (_stagingTail < _stagingHead)
+	{
+		// ɓȂꍇ͐擪֖߂
+		if (begin + size <= _stagingSize)
+		{
+			offset = begin;
+			return true;
+		}
+		if (size <= _stagingTail)
+		{
+			offset = 0;
+			return true;
+		}
+		return false;
+	}
+
+	if (begin + size <= _stagingTail)
+	{
+		offset = begin;
+		return true;
+	}
+	return false;
+}
+
+// ]̌n (wait̏ꍇ͍łÂ]̊҂)
+void UploadManager::RetireBatches(bool wait)
+{
+	auto completed = _timeline->GetCompleted(GpuTimeline::Transfer);
+	for (auto& v : _batches)
+	{
+		if (v.command == VK_NULL_HANDLE)
+		{
+			continue;
+		}
+
+		// L[ւ̑M͏Ɋ邽߁Â̂I
+		if (v.value > completed)
+		{
+			if (!wait)
+			{
+				break;
+			}
+			_timeline->Wait(GpuTimeline::Transfer, v.value);
+			completed = v.value;
+			wait = false;
+		}
+
+		_freeCommandBuffers.push_back(v.command);
+		v.command = VK_NULL_HANDLE;
+		_completedTicket = v.ticket;
+
+		// Oobt@̊J
+		_stagingTail = v.stagingEnd;
+		if (v.stagingEnd == _stagingHead && _pendingBuffers.empty() && _pendingImages.empty())
+		{
+			_stagingHead = 0;
+			_stagingTail = 0;
+			_stagingEmpty = true;
+		}
+	}
+
+	// L̎擾܂ŏÎ菜
+	while (!_batches.empty() && _batches.front().command == VK_NULL_HANDLE && _batches.front().acquired)
+	{
+		_batches.pop_front();
+	}
+}
+
+VkCommandBuffer UploadManager::AcquireCommandBuffer()
+{
+	if (!_freeCommandBuffers.empty())
+	{
+		auto command = _freeCommandBuffers.back();
+		_freeCommandBuffers.pop_back();
+		return command;
+	}
+
+	VkCommandBufferAllocateInfo ai{};
+	ai.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+	ai.commandPool = _commandPool;
+	ai.commandBufferCount = 1;
+	ai.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	VkCommandBuffer command;
+	vkAllocateCommandBuffers(_device, &ai, &command);
+	return command;
+}
+
+VkSemaphore UploadManager::AcquireSemaphore()
+{
+	VkSemaphore semaphore;
+	if (!_freeSemaphores.empty())
+	{
+		semaphore = _freeSemaphores.back();
+		_freeSemaphores.pop_back();
+		return semaphore;
+	}
+
+	VkSemaphoreCreateInfo ci{};
+	ci.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+	vkCreateSemaphore(_device, &ci, nullptr, &semaphore);
+	return semaphore;
+}
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <vector>
+#include <deque>
+#include <mutex>
+
+#include "MemoryAllocator.h"
+#include "GpuTimeline.h"
+
+// ]̊\ԍ (0͓]Ȃ)
+// \񂵂]́A̗\܂ޑM̃`PbgԂ (L[̑M͏Ɋ邽߁A`Pbg̊͂ȑO̓]̊\)
+typedef uint64_t UploadTicket;
+
+// ]pL[găobt@C[Wփf[^]
+// iIɃ}bvXe[WOp̃Oobt@փRs[AFlushł܂Ƃ߂ē]L[֑M
+// ]p̃L[t@~[Ȃꍇ̓OtBbNXL[œ]
+// ]̊GpuTimeline̓]L[̒lŊmF
+// OtBbNXL[́ARequireŐ錾ꂽ]gXe[Wő҂ (錾ĂȂ]͊t[ŏL擾)
+// (UploadBufferAUploadImageARequire̓t[̃^XN瓯ɌĂׂAȊO̓CXbhĂ)
+class UploadManager
+{
+public:
+	UploadManager();
+
+	void Initialize(VkDevice device, MemoryAllocator* allocator, GpuTimeline* timeline, uint32_t transferQueueFamilyIndex, VkQueue transferQueue,
+		uint32_t graphicsQueueFamilyIndex, VkDeviceSize stagingSize = 32 * 1024 * 1024);
+	void Terminate();
+
+	// ]̗\ (Flush܂ł͑MȂAsꍇ0Ԃ)
+	// Oobt@ɋ󂫂Ȃꍇ͌Â]̊҂
+	UploadTicket UploadBuffer(VkBuffer buffer, VkDeviceSize offset, const void* data, VkDeviceSize size);
+
+	// Oobt@̗̈\񂵁A]ރ|C^Ԃ (󂫂Ȃꍇnullptr)
+	// Flush܂łsizeoCg (t@C璼ړWJꍇȂǂɃRs[1񌸂点)
+	// ݂̓rő̃XbhɑMȂ悤At[̃^XN̎sɂ͌Ă΂Ȃ
+	void* ReserveBufferUpload(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize size, UploadTicket* ticket = nullptr);
+
+	// C[W1mipxEC[ւ̓] (format̓C[W̃tH[}bgARs[̃ACg߂)
+	// ]finalLayout֑Jڂ (܂ł̓e͔j)
+	UploadTicket UploadImage(VkImage image, VkFormat format, VkImageAspectFlags aspect, uint32_t mipLevel, uint32_t arrayLayer, VkExtent3D extent,
+		const void* data, VkDeviceSize size, VkImageLayout finalLayout);
+
+	// \񂵂]𑗐M (\񂪂Ȃ΍Ō̃`PbgԂ)
+	UploadTicket Flush();
+
+	// ]̊mFƑҋ@ (MĂȂ`Pbg҂ꍇ͐ɑM)
+	bool IsComplete(UploadTicket ticket);
+	void Wait(UploadTicket ticket);
+
+	// `Pbg̑MƂ̓]L[̃^CC̒l (MĂȂꍇ͑M)
+	// Ď菜́A0̃`Pbg0Ԃ (\[X̔jDeletionQueueœ]̊܂Œx点ꍇɎg)
+	uint64_t GetTransferValue(UploadTicket ticket);
+
+	// ̃t[̃OtBbNXL[ticket܂ł̓]̌ʂstagesŎgƂ錾 (RecordAcquire܂łɌĂ)
+	// ႦΒ_obt@VK_PIPELINE_STAGE_VERTEX_INPUT_BITAeNX`VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT
+	void Require(UploadTicket ticket, VkPipelineStageFlags stages);
+
+	// t[̊JnɌĂ (completedFramesGPUŊt[)
+	void BeginFrame(uint64_t completedFrames);
+
+	// Mς݂̓]̂ARequireŐ錾ꂽ̂Ɗ̂̏LOtBbNXL[Ŏ擾
+	// 錾ꂽ]ĂȂꍇ́A錾ꂽXe[Wł̑ҋ@waitsɒǉ (OtBbNXL[ւ̑Mő҂)
+	// ȊO̊ĂȂ]͑҂Ãt[Ŏ擾
+	void RecordAcquire(VkCommandBuffer command, uint64_t frameNumber, GpuTimeline::WaitList& waits);
+
+	bool HasDedicatedQueue() const { return _transferQueueFamilyIndex != _graphicsQueueFamilyIndex; }
+	VkDeviceSize GetStagingSize() const { return _stagingSize; }
+
+private:
+	struct PendingBufferCopy
+	{
+		VkBuffer buffer;
+		VkBufferCopy region;
+	};
+
+	struct PendingImageCopy
+	{
+		VkImage image;
+		VkBufferImageCopy region;
+		VkImageLayout finalLayout;
+	};
+
+	// Mς݂̓]
+	struct Batch
+	{
+		UploadTicket ticket;
+		VkCommandBuffer command;		// VK_NULL_HANDLE
+		uint64_t value;					// ]L[̃^CC̒l
+		VkSemaphore semaphore;			// ]pL[ŁA^CCɑΉĂȂꍇ̂
+		VkDeviceSize stagingEnd;		// 炱܂ł̃Oobt@
+		std::vector<VkBufferMemoryBarrier> bufferAcquires;
+		std::vector<VkImageMemoryBarrier> imageAcquires;
+		bool acquired;
+	};
+
+	static VkDeviceSize GetImageCopyAlignment(VkFormat format);
+	bool AllocateStaging(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize& offset);
+	bool FindStagingSpace(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize& offset) const;
+	void RetireBatches(bool wait);
+	VkCommandBuffer AcquireCommandBuffer();
+	VkSemaphore AcquireSemaphore();
+
+	// \ƑM̔r (\̃Oobt@t̏ꍇ͗\̒瑗M)
+	std::recursive_mutex _mutex;
+
+	VkDevice _device;
+	MemoryAllocator* _allocator;
+	GpuTimeline* _timeline;
+	uint32_t _transferQueueFamilyIndex;
+	uint32_t _graphicsQueueFamilyIndex;
+	VkQueue _transferQueue;
+	VkCommandPool _commandPool;
+
+	// Xe[WOp̃Oobt@ ([_stagingTail, _stagingHead) gp)
+	VkBuffer _stagingBuffer;
+	MemoryAllocation _stagingAllocation;
+	VkDeviceSize _stagingSize;
+	VkDeviceSize _stagingHead;
+	VkDeviceSize _stagingTail;
+	bool _stagingEmpty;
+
+	std::vector<PendingBufferCopy> _pendingBuffers;
+	std::vector<PendingImageCopy> _pendingImages;
+
+	std::deque<Batch> _batches;		// M
+	UploadTicket _nextTicket;		// \񒆂̓]𑗐MƂ̃`Pbg
+	UploadTicket _completedTicket;
+
+	// ̃t[ŎgƐ錾ꂽ] (RecordAcquireŎ擾)
+	struct Requirement
+	{
+		UploadTicket ticket;
+		VkPipelineStageFlags stages;
+	};
+	std::vector<Requirement> _requirements;
+
+	// g񂷃IuWFNg
+	std::vector<VkCommandBuffer> _freeCommandBuffers;
+	std::vector<VkSemaphore> _freeSemaphores;
+
+	// OtBbNXL[̑Mő҂ĂZ}tH (̃t[g)
+	struct WaitingSemaphore
+	{
+		uint64_t frameNumber;
+		VkSemaphore semaphore;
+	};
+	std::vector<WaitingSemaphore> _waitingSemaphores;
+};
@@ -0,0 +1,116 @@
+# GLSL/HLSLのシェーダーをSPIR-Vへコンパイルする
+#   cmake -DSOURCE_DIR=<dir> -DOUTPUT_DIR=<dir> -DGLSLANG_VALIDATOR=<path> -P CompileShaders.cmake
+#
+# 出力は内容のハッシュを名前にした <hash>.spv と、名前とハッシュの対応表 shaders.manifest
+#   manifest の各行: <シェーダー名> <ハッシュ> [インクルードしたファイル...]
+# ハッシュはソース、インクルードしたファイル、コンパイラとオプションから求めるので、変更のないシェーダーはコンパイルしない
+# コンパイルに失敗したシェーダーは前回のハッシュを残す (実行中のアプリは前回のSPIR-Vを使い続ける)
+#
+# 対象の拡張子: .vert .tesc .tese .geom .frag .comp (GLSL)
+#               .vert.hlsl .frag.hlsl .comp.hlsl など (HLSL、エントリーポイントはmain)
+
+cmake_minimum_required(VERSION 3.10)
+
+if(NOT SOURCE_DIR OR NOT OUTPUT_DIR OR NOT GLSLANG_VALIDATOR)
+	message(FATAL_ERROR "usage: cmake -DSOURCE_DIR=<dir> -DOUTPUT_DIR=<dir> -DGLSLANG_VALIDATOR=<path> -P CompileShaders.cmake")
+endif()
+
+set(STAGES vert tesc tese geom frag comp)
+set(GLSL_FLAGS -V --target-env vulkan1.1)
+set(HLSL_FLAGS -V -D -e main --target-env vulkan1.1)
+
+file(MAKE_DIRECTORY "${OUTPUT_DIR}")
+set(MANIFEST "${OUTPUT_DIR}/shaders.manifest")
+
+# 前回の対応表 (失敗したシェーダーの行を引き継ぐ)
+set(previous "")
+if(EXISTS "${MANIFEST}")
+	file(STRINGS "${MANIFEST}" previous)
+endif()
+
+set(patterns)
+foreach(stage ${STAGES})
+	list(APPEND patterns "${SOURCE_DIR}/*.${stage}" "${SOURCE_DIR}/*.${stage}.hlsl")
+endforeach()
+file(GLOB sources ${patterns})
+list(SORT sources)
+
+set(manifest "")
+set(compiled 0)
+set(failed 0)
+foreach(source ${sources})
+	get_filename_component(name "${source}" NAME)
+
+	# 1段目のインクルードまでをハッシュに含める (#include "file")
+	file(READ "${source}" content)
+	set(hashInput "${GLSLANG_VALIDATOR}|${GLSL_FLAGS}|${HLSL_FLAGS}|${content}")
+	string(REGEX MATCHALL "#include[ \t]*\"[^\"]+\"" includeLines "${content}")
+	set(includes "")
+	foreach(line ${includeLines})
+		string(REGEX REPLACE "#include[ \t]*\"([^\"]+)\"" "\\1" include "${line}")
+		if(EXISTS "${SOURCE_DIR}/${include}")
+			file(READ "${SOURCE_DIR}/${include}" includeContent)
+			string(APPEND hashInput "|${include}|${includeContent}")
+			list(APPEND includes "${include}")
+		endif()
+	endforeach()
+	string(SHA256 hash "${hashInput}")
+	string(SUBSTRING "${hash}" 0 16 hash)
+
+	set(output "${OUTPUT_DIR}/${hash}.spv")
+	set(entry "${name} ${hash}")
+	foreach(include ${includes})
+		string(APPEND entry " ${include}")
+	endforeach()
+
+	if(NOT EXISTS "${output}")
+		if(name MATCHES "\\.([a-z]+)\\.hlsl$")
+			set(flags ${HLSL_FLAGS} -S ${CMAKE_MATCH_1})
+		else()
+			set(flags ${GLSL_FLAGS})
+		endif()
+
+		# 途中で止まっても壊れたファイルが残らないよう、一時ファイルに出力してから名前を変える
+		execute_process(
+			COMMAND "${GLSLANG_VALIDATOR}" ${flags} "${source}" -o "${output}.tmp"
+			RESULT_VARIABLE result
+			OUTPUT_VARIABLE log
+			ERROR_VARIABLE log)
+		if(result EQUAL 0)
+			file(RENAME "${output}.tmp" "${output}")
+			math(EXPR compiled "${compiled} + 1")
+		else()
+			file(REMOVE "${output}.tmp")
+			message(WARNING "${name}: compile failed\n${log}")
+			math(EXPR failed "${failed} + 1")
+
+			set(entry "")
+			foreach(line ${previous})
+				string(FIND "${line}" "${name} " position)
+				if(position EQUAL 0)
+					set(entry "${line}")
+				endif()
+			endforeach()
+		endif()
+	endif()
+
+	if(entry)
+		string(APPEND manifest "${entry}\n")
+	endif()
+endforeach()
+
+# 内容が変わらない場合は書き換えない (監視しているアプリに再読み込みさせない)
+set(current "")
+if(EXISTS "${MANIFEST}")
+	file(READ "${MANIFEST}" current)
+endif()
+if(NOT current STREQUAL manifest)
+	file(WRITE "${MANIFEST}.tmp" "${manifest}")
+	file(RENAME "${MANIFEST}.tmp" "${MANIFEST}")
+endif()
+
+list(LENGTH sources total)
+message(STATUS "shaders: ${total} total, ${compiled} compiled, ${failed} failed")
+if(failed GREATER 0)
+	message(FATAL_ERROR "shader compilation failed")
+endif()